@@ -44,6 +44,53 @@ struct Vertex_PosUvNorTan
     float3 tangent		: TANGENT0;
 };
 
+// Compact version of Vertex_PosUvNorTan, see VertexQuantizer.cpp
+struct Vertex_PosUvNorTan_Quantized
+{
+	float4 position 	: POSITION0;	// unorm, relative to the mesh bounds
+    float2 uv 			: TEXCOORD0;	// unorm, relative to the uv bounds
+    float2 normal 		: NORMAL0;		// snorm, octahedral
+    float2 tangent		: TANGENT0;		// snorm, octahedral
+};
+
+#if VERTEX_QUANTIZED
+cbuffer VertexQuantizationBuffer : register(b3)
+{
+	float3 g_vertex_position_offset;
+	float g_vertex_padding;
+	float3 g_vertex_position_scale;
+	float g_vertex_padding2;
+	float2 g_vertex_uv_offset;
+	float2 g_vertex_uv_scale;
+};
+
+// Octahedral mapping - http://jcgt.org/published/0003/02/01/
+float3 octahedral_decode(float2 value)
+{
+	float3 v = float3(value, 1.0f - abs(value.x) - abs(value.y));
+	if (v.z < 0.0f)
+	{
+		v.xy = (1.0f - abs(v.yx)) * (v.xy >= 0.0f ? 1.0f : -1.0f);
+	}
+	return normalize(v);
+}
+
+float4 dequantize_position(float4 position)
+{
+	return float4(g_vertex_position_offset + position.xyz * g_vertex_position_scale, 1.0f);
+}
+
+Vertex_PosUvNorTan dequantize(Vertex_PosUvNorTan_Quantized input)
+{
+	Vertex_PosUvNorTan output;
+	output.position	= dequantize_position(input.position);
+	output.uv		= g_vertex_uv_offset + input.uv * g_vertex_uv_scale;
+	output.normal	= octahedral_decode(input.normal);
+	output.tangent	= octahedral_decode(input.tangent);
+	return output;
+}
+#endif
+
 struct Pixel_Pos
 {
     float4 position : SV_POSITION;
@@ -28,6 +28,16 @@ cbuffer ObjectBuffer : register(b1)
 	matrix mvp;
 };
 
+#if VERTEX_QUANTIZED
+Pixel_Pos mainVS(Vertex_PosUvNorTan_Quantized input)
+{
+	Pixel_Pos output;
+
+    output.position 	= mul(dequantize_position(input.position), mvp);
+		
+	return output;
+}
+#else
 Pixel_Pos mainVS(Vertex_Pos input)
 {
 	Pixel_Pos output;
@@ -36,4 +46,5 @@ Pixel_Pos mainVS(Vertex_Pos input)
     output.position 	= mul(input.position, mvp);
 		
 	return output;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
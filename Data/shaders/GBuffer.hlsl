@@ -79,7 +79,7 @@ struct PixelOutputType
 	float2 velocity	: SV_Target3;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+PixelInputType transform_vertex(Vertex_PosUvNorTan input)
 {
     PixelInputType output;
     
@@ -96,6 +96,12 @@ PixelInputType mainVS(Vertex_PosUvNorTan input)
 	return output;
 }
 
+#if VERTEX_QUANTIZED
+PixelInputType mainVS(Vertex_PosUvNorTan_Quantized input)	{ return transform_vertex(dequantize(input)); }
+#else
+PixelInputType mainVS(Vertex_PosUvNorTan input)				{ return transform_vertex(input); }
+#endif
+
 PixelOutputType mainPS(PixelInputType input)
 {
 	PixelOutputType g_buffer;
@@ -151,8 +157,9 @@ PixelOutputType mainPS(PixelInputType input)
 	#endif
 	
 	#if NORMAL_MAP
-		// Get tangent space normal and apply intensity
-		float3 tangent_normal 	= normalize(unpack(texNormal.Sample(samplerAniso, texCoords).rgb));
+		// Get tangent space normal (z is reconstructed, since BC5 normal maps only store xy) and apply intensity
+		float3 tangent_normal 	= float3(unpack(texNormal.Sample(samplerAniso, texCoords).rg), 0.0f);
+		tangent_normal.z 		= sqrt(saturate(1.0f - dot(tangent_normal.xy, tangent_normal.xy)));
 		tangent_normal.xy 		*= saturate(normal_intensity);
 		normal 					= normalize(mul(tangent_normal, TBN).xyz); // Transform to world space
 	#endif
@@ -537,7 +537,10 @@ void Widget_Properties::ShowCollider(shared_ptr<Collider>& collider) const
 			"Cylinder",
 			"Capsule",
 			"Cone",
-			"Mesh"
+			"Mesh",
+			"Heightfield",
+			"Triangle Mesh",
+			"Convex Decomposition"
 		};
 		const char* shape_char_ptr		= type[static_cast<int>(collider->GetShapeType())];
 		bool optimize					= collider->GetOptimize();
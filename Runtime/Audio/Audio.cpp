@@ -19,23 +19,37 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =============================
+//= INCLUDES ===============================
 #include "Audio.h"
 #include <fmod.hpp>
 #include <fmod_errors.h>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 #include "../Core/Engine.h"
 #include "../Core/EventSystem.h"
 #include "../Core/Settings.h"
 #include "../Core/Context.h"
 #include "../Profiling/Profiler.h"
 #include "../World/Components/Transform.h"
-//========================================
+#include "../World/Components/AudioSource.h"
+#include "AudioClip.h"
+//==========================================
 
-//= NAMESPACES ======
+//= NAMESPACES ================
 using namespace std;
+using namespace Spartan::Math;
 using namespace FMOD;
-//===================
+//=============================
+
+namespace _Audio
+{
+	// Voices quieter than this (-60 dB) are culled, they stay virtual no matter how many channels are free
+	static const float audibility_min = 0.001f;
+
+	// Per stream, file data read ahead of the decoder by FMOD's stream thread (default is 16 KB)
+	static const uint32_t stream_buffer_size = 64 * 1024;
+}
 
 namespace Spartan
 {
@@ -52,6 +66,13 @@ namespace Spartan
 		if (!m_system_fmod)
 			return;
 
+		// Release the sample bank
+		for (auto& it : m_bank)
+		{
+			it.second.sound->release();
+		}
+		m_bank.clear();
+
 		// Close FMOD
 		m_result_fmod = m_system_fmod->close();
 		if (m_result_fmod != FMOD_OK)
@@ -102,6 +123,18 @@ namespace Spartan
             return false;
         }
 
+        // Without a sound card (e.g. a headless Linux machine), FMOD still mixes but discards the output
+        if (driver_count == 0)
+        {
+            LOG_WARNING("No audio output device found, audio will be mixed without being heard");
+            m_result_fmod = m_system_fmod->setOutput(FMOD_OUTPUTTYPE_NOSOUND);
+            if (m_result_fmod != FMOD_OK)
+            {
+                LogErrorFmod(m_result_fmod);
+                return false;
+            }
+        }
+
         // Initialize FMOD
         m_result_fmod = m_system_fmod->init(m_max_channels, FMOD_INIT_NORMAL, nullptr);
         if (m_result_fmod != FMOD_OK)
@@ -110,6 +143,14 @@ namespace Spartan
             return false;
         }
 
+        // Streams prefetch on FMOD's stream thread, give them a larger ring buffer so that busy soundscapes seek less
+        m_result_fmod = m_system_fmod->setStreamBufferSize(_Audio::stream_buffer_size, FMOD_TIMEUNIT_RAWBYTES);
+        if (m_result_fmod != FMOD_OK)
+        {
+            LogErrorFmod(m_result_fmod);
+            return false;
+        }
+
         // Set 3D settings
         m_result_fmod = m_system_fmod->set3DSettings(1.0, m_distance_entity, 0.0f);
         if (m_result_fmod != FMOD_OK)
@@ -148,13 +189,8 @@ namespace Spartan
 
 		TIME_BLOCK_START_CPU(m_profiler);
 
-		// Update FMOD
-		m_result_fmod = m_system_fmod->update();
-		if (m_result_fmod != FMOD_OK)
-		{
-			LogErrorFmod(m_result_fmod);
-			return;
-		}
+		// Decide which voices get a channel and update the 3D attributes of those that do
+		Voices_Update(delta_time);
 
 		//= 3D Attributes =============================================
 		if (m_listener)
@@ -175,11 +211,17 @@ namespace Spartan
 			if (m_result_fmod != FMOD_OK)
 			{
 				LogErrorFmod(m_result_fmod);
-				return;
 			}
 		}
 		//=============================================================
 
+		// Update FMOD, everything set above is applied in one go
+		m_result_fmod = m_system_fmod->update();
+		if (m_result_fmod != FMOD_OK)
+		{
+			LogErrorFmod(m_result_fmod);
+		}
+
 		TIME_BLOCK_END(m_profiler);
 	}
 
@@ -188,6 +230,208 @@ namespace Spartan
 		m_listener = transform;
 	}
 
+	Sound* Audio::Bank_Acquire(const string& file_path)
+	{
+		lock_guard<mutex> lock(m_bank_mutex);
+
+		auto& sample = m_bank[file_path];
+		sample.last_used = m_bank_clock++;
+
+		// Decode it if it's not resident
+		if (!sample.sound)
+		{
+			// Loop and rolloff modes are set per channel, since the sound is shared
+			m_result_fmod = m_system_fmod->createSound(file_path.c_str(), FMOD_3D | FMOD_CREATESAMPLE, nullptr, &sample.sound);
+			if (m_result_fmod != FMOD_OK)
+			{
+				LogErrorFmod(m_result_fmod);
+				m_bank.erase(file_path);
+				return nullptr;
+			}
+
+			unsigned int size = 0;
+			sample.sound->getLength(&size, FMOD_TIMEUNIT_PCMBYTES);
+			sample.size = size;
+			m_bank_size += sample.size;
+		}
+
+		sample.references++;
+		auto sound = sample.sound;
+
+		// Make room for what was just decoded
+		Bank_Evict();
+
+		return sound;
+	}
+
+	void Audio::Bank_Release(Sound* sound)
+	{
+		lock_guard<mutex> lock(m_bank_mutex);
+
+		for (auto& it : m_bank)
+		{
+			auto& sample = it.second;
+			if (sample.sound != sound)
+				continue;
+
+			sample.references--;
+			sample.last_used = m_bank_clock++;
+			break;
+		}
+
+		Bank_Evict();
+	}
+
+	uint32_t Audio::GetBankSampleCount()
+	{
+		lock_guard<mutex> lock(m_bank_mutex);
+		return static_cast<uint32_t>(m_bank.size());
+	}
+
+	void Audio::Bank_Evict()
+	{
+		// Referenced samples are never evicted, so the budget can be exceeded by what's actually in use
+		while (m_bank_size > m_bank_size_max)
+		{
+			auto oldest = m_bank.end();
+			for (auto it = m_bank.begin(); it != m_bank.end(); it++)
+			{
+				if (it->second.references == 0 && (oldest == m_bank.end() || it->second.last_used < oldest->second.last_used))
+				{
+					oldest = it;
+				}
+			}
+
+			if (oldest == m_bank.end())
+				return;
+
+			m_bank_size -= oldest->second.size;
+			oldest->second.sound->release();
+			m_bank.erase(oldest);
+		}
+	}
+
+	void Audio::Voice_Play(AudioSource* source)
+	{
+		// Already playing, don't bother
+		for (const auto& voice : m_voices)
+		{
+			if (voice.source == source)
+				return;
+		}
+
+		// It starts virtual, the next tick decides if it's worth a channel
+		Audio_Voice voice;
+		voice.source = source;
+		m_voices.emplace_back(voice);
+	}
+
+	void Audio::Voice_Stop(AudioSource* source)
+	{
+		for (auto it = m_voices.begin(); it != m_voices.end(); it++)
+		{
+			if (it->source != source)
+				continue;
+
+			if (it->real)
+			{
+				source->Channel_Stop();
+				m_voice_real_count--;
+			}
+
+			m_voices.erase(it);
+			return;
+		}
+	}
+
+	void Audio::Voices_Update(const float delta_time)
+	{
+		const auto listener_position = m_listener ? m_listener->GetPosition() : Vector3::Zero;
+
+		// Advance playback and measure how loud each voice would be, without touching FMOD
+		for (size_t i = 0; i < m_voices.size();)
+		{
+			auto& voice			= m_voices[i];
+			auto source			= voice.source;
+			const auto& clip	= source->GetAudioClip();
+			const auto length	= clip->GetLength();
+
+			voice.position += delta_time * source->GetPitch();
+			auto finished = false;
+			if (voice.position >= length)
+			{
+				if (source->GetLoop() && length > 0.0f)
+				{
+					voice.position = fmod(voice.position, length);
+				}
+				else
+				{
+					// Virtual voices end on their own clock, real ones when their channel does
+					finished = !voice.real;
+				}
+			}
+			finished = finished || (voice.real && !clip->IsPlaying());
+
+			if (finished)
+			{
+				if (voice.real)
+				{
+					source->Channel_Stop();
+				}
+
+				m_voices[i] = m_voices.back();
+				m_voices.pop_back();
+				continue;
+			}
+
+			const auto distance	= Vector3::Distance(listener_position, source->GetTransform()->GetPosition());
+			voice.audibility	= source->GetMute() ? 0.0f : source->GetVolume() * clip->GetAttenuation(distance);
+			voice.priority		= source->GetPriority();
+			i++;
+		}
+
+		// Audible voices first, then by priority (0 is the most important) and then by audibility
+		sort(m_voices.begin(), m_voices.end(), [](const Audio_Voice& a, const Audio_Voice& b)
+		{
+			const auto a_audible = a.audibility >= _Audio::audibility_min;
+			const auto b_audible = b.audibility >= _Audio::audibility_min;
+			if (a_audible != b_audible)	return a_audible;
+			if (a.priority != b.priority)	return a.priority < b.priority;
+			return a.audibility > b.audibility;
+		});
+
+		// Release the channels of the voices that lost them first, so that they are free for the ones that won
+		for (size_t i = 0; i < m_voices.size(); i++)
+		{
+			auto& voice = m_voices[i];
+			if (voice.real && (i >= m_max_channels || voice.audibility < _Audio::audibility_min))
+			{
+				voice.source->Channel_Stop();
+				voice.real = false;
+			}
+		}
+
+		// Start the voices that won a channel and update the 3D attributes of the ones that already had one
+		m_voice_real_count = 0;
+		for (size_t i = 0; i < m_voices.size() && i < m_max_channels; i++)
+		{
+			auto& voice = m_voices[i];
+			if (voice.audibility < _Audio::audibility_min)
+				break;
+
+			if (voice.real)
+			{
+				voice.source->GetAudioClip()->Update();
+			}
+			else
+			{
+				voice.real = voice.source->Channel_Start(voice.position);
+			}
+
+			m_voice_real_count += voice.real ? 1 : 0;
+		}
+	}
+
 	void Audio::LogErrorFmod(int error) const
 	{
 		LOG_ERROR("Audio::FMOD: " + string(FMOD_ErrorString(static_cast<FMOD_RESULT>(error))));
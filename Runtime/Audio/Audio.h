@@ -24,12 +24,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==================
 #include "../Core/ISubsystem.h"
 #include <cstdint>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <unordered_map>
 //=============================
 
 //= FORWARD DECLARATIONS =
 namespace FMOD
 {
 	class System;
+	class Sound;
 }
 //========================
 
@@ -37,6 +42,27 @@ namespace Spartan
 {
 	class Transform;
 	class Profiler;
+	class AudioSource;
+
+	// A playing audio source. Only the most important audible voices own an FMOD channel (real), the rest are
+	// virtual, they keep their playback position advancing so that they can resume in place once they get a channel back.
+	struct Audio_Voice
+	{
+		AudioSource* source	= nullptr;
+		float position		= 0.0f; // seconds
+		float audibility	= 0.0f; // volume after distance attenuation
+		int priority		= 0;
+		bool real			= false;
+	};
+
+	// A sound decoded into memory, shared by every clip that plays the same file
+	struct Audio_Sample
+	{
+		FMOD::Sound* sound	= nullptr;
+		uint64_t size		= 0; // decoded bytes
+		uint32_t references	= 0;
+		uint64_t last_used	= 0;
+	};
 
 	class Audio : public ISubsystem
 	{
@@ -52,11 +78,38 @@ namespace Spartan
 		auto GetSystemFMOD() const { return m_system_fmod; }
 		void SetListenerTransform(Transform* transform);
 
+		//= VOICES ===================================================================
+		void Voice_Play(AudioSource* source);
+		void Voice_Stop(AudioSource* source);
+		auto GetVoiceCount() const		{ return static_cast<uint32_t>(m_voices.size()); }
+		auto GetVoiceRealCount() const	{ return m_voice_real_count; }
+		//============================================================================
+
+		//= SAMPLE BANK ==============================================================================================
+		// Decodes a file once and shares it. Samples nobody references stay resident, so that replaying them is free,
+		// until the bank exceeds its memory budget, then the least recently used ones go first.
+		FMOD::Sound* Bank_Acquire(const std::string& file_path);
+		void Bank_Release(FMOD::Sound* sound);
+		uint32_t GetBankSampleCount();
+		uint64_t GetBankSize() const			{ return m_bank_size; }
+		uint64_t GetBankSizeMax() const			{ return m_bank_size_max; }
+		void SetBankSizeMax(uint64_t size_max)	{ m_bank_size_max = size_max; }
+		//============================================================================================================
+
 	private:
+		void Bank_Evict();
+		void Voices_Update(float delta_time);
 		void LogErrorFmod(int error) const;
 
 		uint32_t m_result_fmod		= 0;
-		uint32_t m_max_channels		= 32;
+		uint32_t m_max_channels		= 32; // real voices
+		uint32_t m_voice_real_count	= 0;
+		std::vector<Audio_Voice> m_voices;
+		std::unordered_map<std::string, Audio_Sample> m_bank;
+		uint64_t m_bank_size		= 0;
+		uint64_t m_bank_size_max	= 64 * 1024 * 1024;
+		uint64_t m_bank_clock		= 0;
+		std::mutex m_bank_mutex;
 		float m_distance_entity		= 1.0f;
 		bool m_initialized			= false;
 		Transform* m_listener		= nullptr;
@@ -34,39 +34,41 @@ using namespace Spartan::Math;
 using namespace FMOD;
 //=============================
 
+namespace _AudioClip
+{
+	// Play_Auto streams anything longer than this (seconds), music and ambience, while short effects are shared from memory
+	static const float stream_length_min = 10.0f;
+}
+
 namespace Spartan
 {
 	AudioClip::AudioClip(Context* context) : IResource(context, Resource_Audio)
 	{
 		// AudioClip
 		m_transform		= nullptr;
+		m_audio			= context->GetSubsystem<Audio>();
 		m_systemFMOD	= static_cast<System*>(context->GetSubsystem<Audio>()->GetSystemFMOD());
 		m_result		= FMOD_OK;
 		m_soundFMOD		= nullptr;
 		m_channelFMOD	= nullptr;
-		m_playMode		= Play_Memory;
+		m_playMode		= Play_Auto;
+		m_sound_shared	= false;
+		m_stream_length_min	= _AudioClip::stream_length_min;
 		m_minDistance	= 1.0f;
 		m_maxDistance	= 10000.0f;
+		m_length		= 0.0f;
 		m_modeRolloff	= FMOD_3D_LINEARROLLOFF;
 		m_modeLoop		= FMOD_LOOP_OFF;
 	}
 
 	AudioClip::~AudioClip()
 	{
-		if (!m_soundFMOD)
-			return;
-
-		m_result = m_soundFMOD->release();
-		if (m_result != FMOD_OK)
-		{
-			LogErrorFmod(m_result);
-		}
+		ReleaseSound();
 	}
 
 	bool AudioClip::LoadFromFile(const string& file_path)
 	{
-		m_soundFMOD     = nullptr;
-		m_channelFMOD   = nullptr;
+		ReleaseSound();
 
         // Native
         if (FileSystem::GetExtensionFromFilePath(file_path) == EXTENSION_AUDIO)
@@ -76,6 +78,12 @@ namespace Spartan
                 return false;
 
             SetResourceFilePath(file->ReadAs<string>());
+            m_playMode = static_cast<PlayMode>(file->ReadAs<uint32_t>());
+            // Missing from older files
+            if (const auto stream_length_min = file->ReadAs<float>())
+            {
+                m_stream_length_min = stream_length_min;
+            }
 
             file->Close();
         }
@@ -85,7 +93,17 @@ namespace Spartan
             SetResourceFilePath(file_path);
         }
 
-		return (m_playMode == Play_Memory) ? CreateSound(GetResourceFilePath()) : CreateStream(GetResourceFilePath());
+		// Play_Auto decides by length, it's read from the file header without decoding anything
+		auto stream = m_playMode == Play_Stream;
+		if (m_playMode == Play_Auto)
+		{
+			if (!AcquireLength(GetResourceFilePath()))
+				return false;
+
+			stream = m_length > m_stream_length_min;
+		}
+
+		return stream ? CreateStream(GetResourceFilePath()) : CreateSound(GetResourceFilePath());
 	}
 
     bool AudioClip::SaveToFile(const string& file_path)
@@ -95,13 +113,15 @@ namespace Spartan
             return false;
 
         file->Write(GetResourceFilePath());
+        file->Write(static_cast<uint32_t>(m_playMode));
+        file->Write(m_stream_length_min);
 
         file->Close();
 
         return true;
     }
 
-    bool AudioClip::Play()
+    bool AudioClip::Play(const bool paused /*= false*/)
 	{
 		// Check if the sound is playing
 		if (IsChannelValid())
@@ -119,15 +139,24 @@ namespace Spartan
 				return true;
 		}
 
+		// Streams open asynchronously, they can't play until they have buffered
+		if (!IsSoundReady())
+			return false;
+
 		// Start playing the sound
-		m_result = m_systemFMOD->playSound(m_soundFMOD, nullptr, false, &m_channelFMOD);
+		m_result = m_systemFMOD->playSound(m_soundFMOD, nullptr, true, &m_channelFMOD);
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFmod(m_result);
 			return false;
 		}
 
-		return true;
+		// The sound can be shared with other clips, so the mode is set on the channel
+		m_channelFMOD->setMode(GetSoundMode());
+		m_channelFMOD->setLoopCount(m_modeLoop == FMOD_LOOP_NORMAL ? -1 : 0);
+		m_channelFMOD->set3DMinMaxDistance(m_minDistance, m_maxDistance);
+
+		return paused ? true : SetPaused(false);
 	}
 
 	bool AudioClip::Pause()
@@ -159,6 +188,21 @@ namespace Spartan
 		return true;
 	}
 
+	bool AudioClip::SetPaused(const bool paused)
+	{
+		if (!IsChannelValid())
+			return false;
+
+		m_result = m_channelFMOD->setPaused(paused);
+		if (m_result != FMOD_OK)
+		{
+			LogErrorFmod(m_result);
+			return false;
+		}
+
+		return true;
+	}
+
 	bool AudioClip::Stop()
 	{
 		if (!IsChannelValid())
@@ -189,6 +233,10 @@ namespace Spartan
 		if (!m_soundFMOD)
 			return false;
 
+		// Shared sounds loop per channel (see Play()), streams have to know before they play
+		if (m_sound_shared || !IsSoundReady())
+			return true;
+
 		// Infinite loops
 		if (loop)
 		{
@@ -360,49 +408,152 @@ namespace Spartan
 		return is_playing;
 	}
 
+	bool AudioClip::SetPosition(const float position)
+	{
+		if (!IsChannelValid())
+			return false;
+
+		m_result = m_channelFMOD->setPosition(static_cast<unsigned int>(position * 1000.0f), FMOD_TIMEUNIT_MS);
+		if (m_result != FMOD_OK)
+		{
+			LogErrorFmod(m_result);
+			return false;
+		}
+
+		return true;
+	}
+
+	float AudioClip::GetAttenuation(const float distance) const
+	{
+		if (distance >= m_maxDistance)
+			return 0.0f;
+
+		if (m_modeRolloff != FMOD_3D_LINEARROLLOFF || distance <= m_minDistance)
+			return 1.0f;
+
+		return (m_maxDistance - distance) / (m_maxDistance - m_minDistance);
+	}
+
 	//= CREATION ================================================
 	bool AudioClip::CreateSound(const string& file_path)
 	{
-		// Create sound
-		m_result = m_systemFMOD->createSound(file_path.c_str(), GetSoundMode(), nullptr, &m_soundFMOD);
+		const auto audio = m_audio.lock();
+		if (!audio)
+			return false;
+
+		// Decoded once and shared with every other clip that plays this file
+		m_soundFMOD = audio->Bank_Acquire(file_path);
+		if (!m_soundFMOD)
+			return false;
+
+		m_sound_shared = true;
+
+		unsigned int length_ms = 0;
+		m_result = m_soundFMOD->getLength(&length_ms, FMOD_TIMEUNIT_MS);
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFmod(m_result);
 			return false;
 		}
+		m_length = length_ms / 1000.0f;
+
+		return true;
+	}
+
+	bool AudioClip::CreateStream(const string& file_path)
+	{
+		// The length is needed before the stream is ready, virtual voices keep time with it
+		if (m_length == 0.0f && !AcquireLength(file_path))
+			return false;
 
-		// Set 3D min max distance
-		m_result = m_soundFMOD->set3DMinMaxDistance(m_minDistance, m_maxDistance);
+		// Non blocking, FMOD opens the file and fills the stream's ring buffer on its own thread, Play() waits for it
+		m_result = m_systemFMOD->createStream(file_path.c_str(), GetSoundMode() | FMOD_NONBLOCKING, nullptr, &m_soundFMOD);
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFmod(m_result);
 			return false;
 		}
 
+		m_sound_shared = false;
+
 		return true;
 	}
 
-	bool AudioClip::CreateStream(const string& file_path)
+	bool AudioClip::AcquireLength(const string& file_path)
 	{
-		// Create sound
-		m_result = m_systemFMOD->createStream(file_path.c_str(), GetSoundMode(), nullptr, &m_soundFMOD);
+		// Only parses the header
+		Sound* sound = nullptr;
+		m_result = m_systemFMOD->createSound(file_path.c_str(), FMOD_OPENONLY, nullptr, &sound);
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFmod(m_result);
 			return false;
 		}
 
-		// Set 3D min max distance
-		m_result = m_soundFMOD->set3DMinMaxDistance(m_minDistance, m_maxDistance);
+		unsigned int length_ms = 0;
+		m_result = sound->getLength(&length_ms, FMOD_TIMEUNIT_MS);
+		sound->release();
 		if (m_result != FMOD_OK)
 		{
 			LogErrorFmod(m_result);
 			return false;
 		}
 
+		m_length = length_ms / 1000.0f;
+
 		return true;
 	}
 
+	void AudioClip::ReleaseSound()
+	{
+		const auto sound	= m_soundFMOD;
+		const auto channel	= m_channelFMOD;
+		m_soundFMOD			= nullptr;
+		m_channelFMOD		= nullptr;
+		m_length			= 0.0f;
+
+		// If audio is gone, so is FMOD and everything it owned
+		const auto audio = m_audio.lock();
+		if (!sound || !audio)
+			return;
+
+		if (m_sound_shared)
+		{
+			// Stop the channel, the bank may keep the sound around
+			bool is_playing = false;
+			if (channel && channel->isPlaying(&is_playing) == FMOD_OK)
+			{
+				channel->stop();
+			}
+
+			audio->Bank_Release(sound);
+			return;
+		}
+
+		m_result = sound->release();
+		if (m_result != FMOD_OK)
+		{
+			LogErrorFmod(m_result);
+		}
+	}
+
+	bool AudioClip::IsSoundReady()
+	{
+		if (!m_soundFMOD)
+			return false;
+
+		FMOD_OPENSTATE state = FMOD_OPENSTATE_READY;
+		m_result = m_soundFMOD->getOpenState(&state, nullptr, nullptr, nullptr);
+		if (state == FMOD_OPENSTATE_ERROR)
+		{
+			LogErrorFmod(m_result);
+			ReleaseSound();
+			return false;
+		}
+
+		return state == FMOD_OPENSTATE_READY;
+	}
+
 	int AudioClip::GetSoundMode() const
 	{
 		return FMOD_3D | m_modeLoop | m_modeRolloff;
@@ -38,11 +38,13 @@ namespace FMOD
 namespace Spartan
 {
 	class Transform;
+	class Audio;
 
 	enum PlayMode
 	{
-		Play_Memory,
-		Play_Stream
+		Play_Memory,	// Decoded into memory, shared through the audio sample bank
+		Play_Stream,	// Decoded while playing, every clip streams its own copy
+		Play_Auto		// Streams when longer than the stream length threshold
 	};
 
 	enum Rolloff
@@ -62,8 +64,9 @@ namespace Spartan
         bool SaveToFile(const std::string& file_path) override;
         //=======================================================
 
-		bool Play();
+		bool Play(bool paused = false);
 		bool Pause();
+		bool SetPaused(bool paused);
 		bool Stop();
 
 		// Set's sound looping
@@ -96,23 +99,47 @@ namespace Spartan
 
 		bool IsPlaying();
 
+		// Decode mode, applies on the next load
+		PlayMode GetPlayMode() const			{ return m_playMode; }
+		void SetPlayMode(const PlayMode mode)	{ m_playMode = mode; }
+
+		// Length in seconds above which Play_Auto streams
+		float GetStreamLengthMin() const				{ return m_stream_length_min; }
+		void SetStreamLengthMin(const float length)	{ m_stream_length_min = length; }
+
+		// Seeks the channel, in seconds
+		bool SetPosition(float position);
+
+		// Length of the sound, in seconds
+		float GetLength() const { return m_length; }
+
+		// Volume factor [0.0f, 1.0f] at a given distance from the listener, custom rolloff curves only cull beyond the max distance
+		float GetAttenuation(float distance) const;
+
 	private:
 		//= CREATION ===================================
 		bool CreateSound(const std::string& file_path);
 		bool CreateStream(const std::string& file_path);
 		//==============================================
+		bool AcquireLength(const std::string& file_path);
+		void ReleaseSound();
+		bool IsSoundReady();
 		int GetSoundMode() const;
 		void LogErrorFmod(int error) const;
 		bool IsChannelValid() const;
 
 		Transform* m_transform;
+		std::weak_ptr<Audio> m_audio;
 		FMOD::System* m_systemFMOD;
 		FMOD::Sound* m_soundFMOD;
 		FMOD::Channel* m_channelFMOD;	
 		PlayMode m_playMode;
+		bool m_sound_shared;
+		float m_stream_length_min;
 		int m_modeLoop;
 		float m_minDistance;
 		float m_maxDistance;
+		float m_length;
 		int m_modeRolloff;
 		int m_result;
 	};
@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ========================
+//= INCLUDES ================================
 #include "Settings.h"
 #include "Timer.h"
 #include "Context.h"
@@ -28,8 +28,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../FileSystem/FileSystem.h"
 #include "../Rendering/Renderer.h"
 #include "../Threading/Threading.h"
+#include "../Physics/Physics.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/Import/ImageImporter.h"
 #include "pugixml.hpp"
-//===================================
+//===========================================
 
 //= NAMESPACES ================
 using namespace std;
@@ -103,6 +106,8 @@ namespace Spartan
         LOGF_INFO("Shadow resolution: %d", m_shadow_map_resolution);
         LOGF_INFO("Anisotropy: %d", m_anisotropy);
         LOGF_INFO("Max threads: %d", m_max_thread_count);
+        LOGF_INFO("Physics threads: %d", m_physics_thread_count);
+        LOGF_INFO("Physics async: %d", m_physics_async);
 
         return true;
     }
@@ -122,6 +127,9 @@ namespace Spartan
 		_Settings::write_setting(_Settings::fout, "fFPSLimit",              m_fps_limit);
 		_Settings::write_setting(_Settings::fout, "iMaxThreadCount",        m_max_thread_count);
         _Settings::write_setting(_Settings::fout, "iRendererFlags",         m_renderer_flags);
+        _Settings::write_setting(_Settings::fout, "iTextureCompression",    m_texture_compression);
+        _Settings::write_setting(_Settings::fout, "iPhysicsThreadCount",    m_physics_thread_count);
+        _Settings::write_setting(_Settings::fout, "bPhysicsAsync",          m_physics_async);
 
 		// Close the file.
 		_Settings::fout.close();
@@ -145,6 +153,9 @@ namespace Spartan
 		_Settings::read_setting(_Settings::fin, "fFPSLimit",               m_fps_limit);
 		_Settings::read_setting(_Settings::fin, "iMaxThreadCount",         m_max_thread_count);
         _Settings::read_setting(_Settings::fin, "iRendererFlags",          m_renderer_flags);
+        _Settings::read_setting(_Settings::fin, "iTextureCompression",     m_texture_compression);
+        _Settings::read_setting(_Settings::fin, "iPhysicsThreadCount",     m_physics_thread_count);
+        _Settings::read_setting(_Settings::fin, "bPhysicsAsync",           m_physics_async);
 
 		// Close the file.
 		_Settings::fin.close();
@@ -160,6 +171,9 @@ namespace Spartan
         m_shadow_map_resolution = renderer->GetShadowResolution();
         m_anisotropy            = renderer->GetAnisotropy();
         m_renderer_flags        = renderer->GetFlags();
+        m_texture_compression   = m_context->GetSubsystem<ResourceCache>()->GetImageImporter()->GetCompressionQuality();
+        m_physics_thread_count  = m_context->GetSubsystem<Physics>()->GetThreadCount();
+        m_physics_async         = m_context->GetSubsystem<Physics>()->GetAsync();
     }
 
     void Settings::Map()
@@ -170,5 +184,8 @@ namespace Spartan
         renderer->SetAnisotropy(m_anisotropy);
         renderer->SetShadowResolution(m_shadow_map_resolution);
         renderer->SetFlags(m_renderer_flags);
+        m_context->GetSubsystem<ResourceCache>()->GetImageImporter()->SetCompressionQuality(static_cast<Texture_Compression_Quality>(m_texture_compression));
+        m_context->GetSubsystem<Physics>()->SetThreadCount(m_physics_thread_count);
+        m_context->GetSubsystem<Physics>()->SetAsync(m_physics_async);
     }
 }
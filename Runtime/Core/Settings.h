@@ -70,6 +70,9 @@ namespace Spartan
         Math::Vector2 m_resolution          = Math::Vector2::Zero;
 		uint32_t m_anisotropy				= 0;
 		uint32_t m_max_thread_count			= 0;
+        uint32_t m_texture_compression      = 1; // Compression_Normal, same as the image importer
+        uint32_t m_physics_thread_count     = 0;
+        bool m_physics_async                = true;
         double m_fps_limit                  = 0;
         Context* m_context                  = nullptr;
 	};
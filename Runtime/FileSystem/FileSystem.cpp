@@ -299,6 +299,14 @@ namespace Spartan
 		}
 	}
 
+	uint64_t FileSystem::GetLastWriteTime(const string& file_path)
+	{
+		// Polled, so it doesn't log
+		error_code error;
+		const auto time = last_write_time(file_path, error);
+		return error ? 0 : static_cast<uint64_t>(time.time_since_epoch().count());
+	}
+
     string FileSystem::GetFileNameFromFilePath(const string& file_path)
 	{
         size_t last_index = file_path.find_last_of("\\/");
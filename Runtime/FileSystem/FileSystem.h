@@ -59,6 +59,7 @@ namespace Spartan
         static bool IsFilePath(const std::string& file_path);
 		static bool DeleteFile_(const std::string& file_path);
 		static bool CopyFileFromTo(const std::string& source, const std::string& destination);
+		static uint64_t GetLastWriteTime(const std::string& file_path);
 		//====================================================================================
 
 		//= DIRECTORY PARSING  =============================================================================
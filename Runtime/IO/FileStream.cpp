@@ -22,6 +22,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==============
 #include "FileStream.h"
 #include "../Logging/Log.h"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 //=========================
 
 //= NAMESPACES =====
@@ -30,29 +40,42 @@ using namespace std;
 
 namespace Spartan
 {
+	namespace _FileStream
+	{
+		static const uint64_t buffer_size = 4 * 1024 * 1024; // writes are flushed in blocks of this size
+	}
+
 	FileStream::FileStream(const string& path, uint32_t flags)
 	{
 		m_is_open	= false;
 		m_flags		= flags;
 
-		int ios_flags	= ios::binary;
-		ios_flags		|= (flags & FileStream_Read)	? ios::in	: 0;
-		ios_flags		|= (flags & FileStream_Write)	? ios::out	: 0;
-		ios_flags		|= (flags & FileStream_Append)	? ios::app	: 0;
-
 		if (m_flags & FileStream_Write)
 		{
+			auto ios_flags = ios::binary | ios::out;
+			if (flags & FileStream_Append)
+			{
+				ios_flags |= ios::app;
+			}
+
 			out.open(path, ios_flags);
 			if (out.fail())
 			{
 				LOGF_ERROR("Failed to open \"%s\" for writing", path.c_str());
 				return;
 			}
+
+			if (flags & FileStream_Append)
+			{
+				out.seekp(0, ios::end);
+				m_buffer_offset = static_cast<uint64_t>(out.tellp());
+			}
+
+			m_buffer.resize(_FileStream::buffer_size);
 		}
 		else if (m_flags & FileStream_Read)
 		{
-			in.open(path, ios_flags);
-			if(in.fail())
+			if (!Map(path))
 			{
 				LOGF_ERROR("Failed to open \"%s\" for reading", path.c_str());
 				return;
@@ -62,6 +85,28 @@ namespace Spartan
 		m_is_open = true;
 	}
 
+	FileStream::FileStream(vector<std::byte>* memory, uint32_t flags)
+	{
+		m_memory			= memory;
+		m_memory_position	= (memory && (flags & FileStream_Append)) ? memory->size() : 0;
+		m_flags				= flags;
+		m_is_open			= memory != nullptr;
+
+		if (memory && (flags & FileStream_Read))
+		{
+			m_read_data = memory->data();
+			m_read_size = memory->size();
+		}
+	}
+
+	FileStream::FileStream(const std::byte* data, const uint64_t size)
+	{
+		m_read_data	= data;
+		m_read_size	= data ? size : 0;
+		m_flags		= FileStream_Read;
+		m_is_open	= data != nullptr;
+	}
+
 	FileStream::~FileStream()
 	{
 		Close();
@@ -69,24 +114,58 @@ namespace Spartan
 
 	void FileStream::Close()
 	{
-		if (m_flags & FileStream_Write)
+		if (!m_is_open)
+			return;
+
+		if (!m_memory && (m_flags & FileStream_Write))
 		{
-			out.flush();
+			Flush();
 			out.close();
 		}
+
+		Unmap();
+		m_is_open = false;
+	}
+
+	uint64_t FileStream::GetPosition() const
+	{
+		if (m_memory && (m_flags & FileStream_Write))
+			return m_memory_position;
+
+		if (m_flags & FileStream_Write)
+			return m_buffer_offset + m_buffer_size;
+
+		return m_read_position;
+	}
+
+	void FileStream::Seek(const uint64_t position)
+	{
+		if (m_memory && (m_flags & FileStream_Write))
+		{
+			m_memory_position = position;
+		}
+		else if (m_flags & FileStream_Write)
+		{
+			Flush();
+			out.seekp(position, ios::beg);
+			m_buffer_offset = position;
+		}
 		else if (m_flags & FileStream_Read)
 		{
-			in.clear();
-			in.close();
+			m_read_position = position;
 		}
 	}
 
+	void FileStream::Skip(uint32_t n)
+	{
+		Seek(GetPosition() + n);
+	}
+
 	void FileStream::Write(const string& value)
 	{
 		const auto length = static_cast<uint32_t>(value.length());
 		Write(length);
-
-		out.write(const_cast<char*>(value.c_str()), length);
+		WriteBytes(value.data(), length);
 	}
 
 	void FileStream::Write(const vector<string>& value)
@@ -104,50 +183,93 @@ namespace Spartan
 	{
 		const auto length = static_cast<uint32_t>(value.size());
 		Write(length);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+		WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
+	}
+
+	void FileStream::Write(const vector<RHI_Vertex_PosTexNorTanBone>& value)
+	{
+		const auto length = static_cast<uint32_t>(value.size());
+		Write(length);
+		WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTanBone) * length);
+	}
+
+	void FileStream::Write(const vector<RHI_Vertex_PosTexNorTan_Quantized>& value)
+	{
+		const auto length = static_cast<uint32_t>(value.size());
+		Write(length);
+		WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTan_Quantized) * length);
 	}
 
 	void FileStream::Write(const vector<uint32_t>& value)
 	{
 		const auto length = static_cast<uint32_t>(value.size());
 		Write(length);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+		WriteBytes(value.data(), sizeof(uint32_t) * length);
 	}
 
 	void FileStream::Write(const vector<unsigned char>& value)
 	{
 		const auto size = static_cast<uint32_t>(value.size());
 		Write(size);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+		WriteBytes(value.data(), sizeof(unsigned char) * size);
 	}
 
 	void FileStream::Write(const vector<std::byte>& value)
 	{
 		const auto size = static_cast<uint32_t>(value.size());
 		Write(size);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+		WriteBytes(value.data(), sizeof(std::byte) * size);
 	}
 
-	void FileStream::Skip(uint32_t n)
+	void FileStream::WriteBytes_Slow(const void* data, const uint64_t size)
 	{
-		// Set the seek cursor to offset n from the current position
-		if (m_flags & FileStream_Write)
+		if (size == 0)
+			return;
+
+		if (m_memory)
 		{
-			out.seekp(n, ios::cur);
+			// Overwrite (after a Seek()) or grow
+			if (m_memory_position + size > m_memory->size())
+			{
+				m_memory->resize(m_memory_position + size);
+			}
+			memcpy(m_memory->data() + m_memory_position, data, size);
+			m_memory_position += size;
+			return;
 		}
-		else if (m_flags & FileStream_Read)
+
+		if (!(m_flags & FileStream_Write))
+			return;
+
+		Flush();
+
+		// Large writes (e.g. vertices or mips) bypass the buffer
+		if (size >= m_buffer.size())
 		{
-			in.ignore(n, ios::cur);
+			out.write(reinterpret_cast<const char*>(data), size);
+			m_buffer_offset += size;
+			return;
 		}
+
+		memcpy(m_buffer.data(), data, size);
+		m_buffer_size = size;
 	}
 
-	void FileStream::Read(string* value)
+	void FileStream::Flush()
 	{
-		uint32_t length = 0;
-		Read(&length);
+		if (m_buffer_size == 0)
+			return;
+
+		out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer_size);
+		m_buffer_offset	+= m_buffer_size;
+		m_buffer_size	= 0;
+	}
 
+	void FileStream::Read(string* value)
+	{
+		const auto length = ReadLength(sizeof(char));
 		value->resize(length);
-		in.read(const_cast<char*>(value->c_str()), length);
+		ReadBytes(value->data(), length);
 	}
 
 	void FileStream::Read(vector<string>* vec)
@@ -155,34 +277,40 @@ namespace Spartan
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
-
-		uint32_t size = 0;
-		Read(&size);
-
-		string str;
-		for (uint32_t i = 0; i < size; i++)
+		vec->resize(ReadLength(sizeof(uint32_t)));
+		for (auto& str : *vec)
 		{
 			Read(&str);
-			vec->emplace_back(str);
 		}
 	}
 
+	// Arrays are read straight into their destination, reusing its memory when it's large enough
+
 	void FileStream::Read(vector<RHI_Vertex_PosTexNorTan>* vec)
 	{
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
+		vec->resize(ReadLength(sizeof(RHI_Vertex_PosTexNorTan)));
+		ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTan) * vec->size());
+	}
 
-		auto length = ReadAs<uint32_t>();
+	void FileStream::Read(vector<RHI_Vertex_PosTexNorTanBone>* vec)
+	{
+		if (!vec)
+			return;
+
+		vec->resize(ReadLength(sizeof(RHI_Vertex_PosTexNorTanBone)));
+		ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTanBone) * vec->size());
+	}
 
-		vec->reserve(length);
-		vec->resize(length);
+	void FileStream::Read(vector<RHI_Vertex_PosTexNorTan_Quantized>* vec)
+	{
+		if (!vec)
+			return;
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+		vec->resize(ReadLength(sizeof(RHI_Vertex_PosTexNorTan_Quantized)));
+		ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTan_Quantized) * vec->size());
 	}
 
 	void FileStream::Read(vector<uint32_t>* vec)
@@ -190,46 +318,135 @@ namespace Spartan
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
-
-		auto length = ReadAs<uint32_t>();
+		vec->resize(ReadLength(sizeof(uint32_t)));
+		ReadBytes(vec->data(), sizeof(uint32_t) * vec->size());
+	}
 
-		vec->reserve(length);
-		vec->resize(length);
+	void FileStream::Read(vector<unsigned char>* vec)
+	{
+		if (!vec)
+			return;
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+		vec->resize(ReadLength(sizeof(unsigned char)));
+		ReadBytes(vec->data(), sizeof(unsigned char) * vec->size());
 	}
 
-	void FileStream::Read(vector<unsigned char>* vec)
+	void FileStream::Read(vector<std::byte>* vec)
 	{
 		if (!vec)
 			return;
 
-		vec->clear();
-		vec->shrink_to_fit();
+		vec->resize(ReadLength(sizeof(std::byte)));
+		ReadBytes(vec->data(), sizeof(std::byte) * vec->size());
+	}
+
+	void FileStream::ReadBytes_Slow(void* data, const uint64_t size)
+	{
+		// Reading past the end yields zeros, so a truncated file can't take the reader down with it
+		const auto available	= m_read_position < m_read_size ? m_read_size - m_read_position : 0;
+		const auto read			= size < available ? size : available;
+		if (read != 0)
+		{
+			memcpy(data, m_read_data + m_read_position, read);
+		}
+		memset(static_cast<std::byte*>(data) + read, 0, size - read);
+		m_read_position += size;
+	}
 
-		auto length = ReadAs<uint32_t>();
+	// Lengths come from the data, a corrupt one can't claim more elements than there are bytes left
+	uint32_t FileStream::ReadLength(const uint64_t element_size)
+	{
+		const auto length		= ReadAs<uint32_t>();
+		const auto available	= GetRemaining();
+		return static_cast<uint32_t>(length * element_size <= available ? length : available / element_size);
+	}
 
-		vec->reserve(length);
-		vec->resize(length);
+	const std::byte* FileStream::ReadSpan(const uint64_t size)
+	{
+		// Written so that a size read from a corrupt file can't overflow
+		if (m_read_position > m_read_size || size > m_read_size - m_read_position)
+			return nullptr;
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+		const auto span = m_read_data + m_read_position;
+		m_read_position += size;
+		return span;
 	}
 
-	void FileStream::Read(vector<std::byte>* vec)
+	bool FileStream::Map(const string& path)
 	{
-		if (!vec)
-			return;
+		uint64_t size = 0;
+		void* view = nullptr;
 
-		vec->clear();
-		vec->shrink_to_fit();
+#if defined(_WIN32)
+		const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
 
-		const auto length = ReadAs<uint32_t>();
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+		size = static_cast<uint64_t>(file_size.QuadPart);
+
+		// Empty files can't be mapped, there is nothing to read anyway
+		if (size != 0)
+		{
+			// The view keeps the mapping (and the file) alive, so both handles can be closed right away
+			if (const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+			{
+				view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		const auto file = open(path.c_str(), O_RDONLY);
+		if (file == -1)
+			return false;
+
+		struct stat file_stat;
+		if (fstat(file, &file_stat) != 0)
+		{
+			close(file);
+			return false;
+		}
+		size = static_cast<uint64_t>(file_stat.st_size);
+
+		// Empty files can't be mapped, there is nothing to read anyway
+		if (size != 0)
+		{
+			view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+			view = (view == MAP_FAILED) ? nullptr : view;
+		}
+		close(file);
+#endif
+
+		if (size != 0 && !view)
+			return false;
+
+		m_mapping		= view;
+		m_read_data		= static_cast<const std::byte*>(view);
+		m_read_size		= size;
+		m_read_position	= 0;
+
+		return true;
+	}
+
+	void FileStream::Unmap()
+	{
+		if (!m_mapping)
+			return;
 
-		vec->reserve(length);
-		vec->resize(length);
+#if defined(_WIN32)
+		UnmapViewOfFile(m_mapping);
+#else
+		munmap(m_mapping, m_read_size);
+#endif
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+		m_mapping	= nullptr;
+		m_read_data	= nullptr;
+		m_read_size	= 0;
 	}
 }
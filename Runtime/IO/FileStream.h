@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===================
 #include <vector>
 #include <fstream>
+#include <cstring>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -42,15 +43,26 @@ namespace Spartan
 		FileStream_Append	= 1 << 2,
 	};
 
+	// File streams write through a large buffer and read from a memory mapped view of the file
 	class SPARTAN_CLASS FileStream
 	{
 	public:
 		FileStream(const std::string& path, uint32_t flags);
+		// Memory streams, they read from or write to the provided memory instead of a file. Useful for
+		// assembling or parsing parts of a file independently (e.g. on different threads).
+		FileStream(std::vector<std::byte>* memory, uint32_t flags);
+		FileStream(const std::byte* data, uint64_t size);
 		~FileStream();
 
 		auto IsOpen() const { return m_is_open; }
 		void Close();
 
+		// Position (in bytes) from the start of the stream
+		uint64_t GetPosition() const;
+		void Seek(uint64_t position);
+		// Bytes left to read
+		uint64_t GetRemaining() const { return m_read_position < m_read_size ? m_read_size - m_read_position : 0; }
+
 		//= WRITING ==================================================
 		template <class T, class = typename std::enable_if<
 			std::is_same<T, bool>::value				||
@@ -73,16 +85,31 @@ namespace Spartan
 		>::type>
 		void Write(T value)
 		{
-			out.write(reinterpret_cast<char*>(&value), sizeof(value));
+			WriteBytes(&value, sizeof(value));
 		}
 
 		void Write(const std::string& value);
 		void Write(const std::vector<std::string>& value);
 		void Write(const std::vector<RHI_Vertex_PosTexNorTan>& value);
+		void Write(const std::vector<RHI_Vertex_PosTexNorTanBone>& value);
+		void Write(const std::vector<RHI_Vertex_PosTexNorTan_Quantized>& value);
 		void Write(const std::vector<uint32_t>& value);
 		void Write(const std::vector<unsigned char>& value);
 		void Write(const std::vector<std::byte>& value);
 		void Skip(uint32_t n);
+
+		void WriteBytes(const void* data, const uint64_t size)
+		{
+			// Most writes are a handful of bytes, they go straight to the buffer
+			if (m_buffer_size + size <= m_buffer.size())
+			{
+				memcpy(m_buffer.data() + m_buffer_size, data, size);
+				m_buffer_size += size;
+				return;
+			}
+
+			WriteBytes_Slow(data, size);
+		}
 		//===========================================================
 		
 		//= READING ===========================================
@@ -108,15 +135,32 @@ namespace Spartan
 		>::type>
 		void Read(T* value)
 		{
-			in.read(reinterpret_cast<char*>(value), sizeof(T));
+			ReadBytes(value, sizeof(T));
 		}
 		void Read(std::string* value);
 		void Read(std::vector<std::string>* vec);
 		void Read(std::vector<RHI_Vertex_PosTexNorTan>* vec);
+		void Read(std::vector<RHI_Vertex_PosTexNorTanBone>* vec);
+		void Read(std::vector<RHI_Vertex_PosTexNorTan_Quantized>* vec);
 		void Read(std::vector<uint32_t>* vec);
 		void Read(std::vector<unsigned char>* vec);
 		void Read(std::vector<std::byte>* vec);
 
+		void ReadBytes(void* data, const uint64_t size)
+		{
+			if (m_read_position + size <= m_read_size)
+			{
+				memcpy(data, m_read_data + m_read_position, size);
+				m_read_position += size;
+				return;
+			}
+
+			ReadBytes_Slow(data, size);
+		}
+
+		// Zero copy read, returns the next size bytes (valid until the stream is closed) or nullptr if there aren't that many left
+		const std::byte* ReadSpan(uint64_t size);
+
 		// Reading with explicit type definition
 		template <class T, class = typename std::enable_if
 		<
@@ -143,9 +187,28 @@ namespace Spartan
 		//=====================================================
 
 	private:
+		void WriteBytes_Slow(const void* data, uint64_t size);
+		void ReadBytes_Slow(void* data, uint64_t size);
+		uint32_t ReadLength(uint64_t element_size);
+		void Flush();
+		bool Map(const std::string& path);
+		void Unmap();
+
+		// Writing, file streams are buffered while memory streams write to m_memory
 		std::ofstream out;
-		std::ifstream in;
-		uint32_t m_flags;
-		bool m_is_open;
+		std::vector<std::byte> m_buffer;
+		uint64_t m_buffer_size				= 0;
+		uint64_t m_buffer_offset			= 0; // position of the buffer in the file
+		std::vector<std::byte>* m_memory	= nullptr;
+		uint64_t m_memory_position			= 0;
+
+		// Reading, file streams read from a memory mapped view while memory streams read from the provided memory
+		const std::byte* m_read_data	= nullptr;
+		uint64_t m_read_size			= 0;
+		uint64_t m_read_position		= 0;
+		void* m_mapping					= nullptr;
+
+		uint32_t m_flags	= 0;
+		bool m_is_open		= false;
 	};
 }
@@ -227,6 +227,22 @@ namespace Spartan::Math
                 return Identity;
 		}
 
+		float Dot(const Quaternion& rhs) const { return (x * rhs.x) + (y * rhs.y) + (z * rhs.z) + (w * rhs.w); }
+
+		// Normalized linear interpolation along the shortest path, cheaper than a slerp and close to it between nearby rotations
+		static Quaternion Lerp(const Quaternion& from, const Quaternion& to, const float t)
+		{
+			const float t_from	= 1.0f - t;
+			const float t_to	= from.Dot(to) < 0.0f ? -t : t;
+
+			return Quaternion(
+				from.x * t_from + to.x * t_to,
+				from.y * t_from + to.y * t_to,
+				from.z * t_from + to.z * t_to,
+				from.w * t_from + to.w * t_to
+			).Normalized();
+		}
+
 		Quaternion& operator =(const Quaternion& rhs)
 		{			
 			x = rhs.x;
@@ -19,22 +19,30 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ===================================================================
+//= INCLUDES =====================================================================
+#include <algorithm>
 #include "Physics.h"
 #include "PhysicsDebugDraw.h"
 #include "BulletPhysicsHelper.h"
+#include "PhysicsTaskScheduler.h"
 #include "../Core/Engine.h"
 #include "../Core/Context.h"
 #include "../Core/Settings.h"
 #include "../Profiling/Profiler.h"
 #include "../Rendering/Renderer.h"
+#include "../Threading/Threading.h"
+#include "../World/Components/RigidBody.h"
+#include "../World/Entity.h"
 #pragma warning(push, 0) // Hide warnings which belong to Bullet
 #include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
 #include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
-#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
-#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletCollision/CollisionShapes/btSphereShape.h>
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
 #pragma warning(pop)
-//==============================================================================
+//================================================================================
 
 //= NAMESPACES ================
 using namespace std;
@@ -42,15 +50,69 @@ using namespace Spartan::Math;
 //=============================
 
 namespace Spartan
-{ 
+{
+	namespace _Physics
+	{
+		static const uint32_t cast_batch_grain = 32; // Casts per task, fewer and the tasks cost more than the casts
+
+		// Bodies point to their RigidBody, which is what entities are known by
+		Entity* entity(const btCollisionObject* object)
+		{
+			const auto rigid_body = object ? static_cast<RigidBody*>(object->getUserPointer()) : nullptr;
+			return rigid_body ? rigid_body->GetEntity_PtrRaw() : nullptr;
+		}
+
+		// Queries belong to every layer, so that they only filter by the layers they ask for and not by the masks of the bodies
+		template <typename Callback>
+		void set_filter(Callback* callback, const uint32_t layers)
+		{
+			callback->m_collisionFilterGroup	= static_cast<int>(Physics_Layers_All);
+			callback->m_collisionFilterMask		= static_cast<int>(layers);
+		}
+
+		struct overlap_callback : public btCollisionWorld::ContactResultCallback
+		{
+			overlap_callback(const btCollisionObject* query, vector<Entity*>* entities) : m_query(query), m_entities(entities), m_first(entities->size()) {}
+
+			btScalar addSingleResult(btManifoldPoint& point, const btCollisionObjectWrapper* a, int, int, const btCollisionObjectWrapper* b, int, int) override
+			{
+				if (point.getDistance() > 0.0f)
+					return 0.0f;
+
+				// Bodies report a point per contact, entities are only added once
+				const auto other = entity(a->getCollisionObject() == m_query ? b->getCollisionObject() : a->getCollisionObject());
+				if (other && find(m_entities->begin() + m_first, m_entities->end(), other) == m_entities->end())
+				{
+					m_entities->emplace_back(other);
+				}
+
+				return 0.0f;
+			}
+
+			const btCollisionObject* m_query;
+			vector<Entity*>* m_entities;
+			size_t m_first;
+		};
+	}
+
 	Physics::Physics(Context* context) : ISubsystem(context)
 	{
+		// Bullet's parallel-for runs on the job system, the scheduler has to be set from the main thread before any of the Mt classes are created
+		m_task_scheduler = new PhysicsTaskScheduler(m_context->GetSubsystem<Threading>().get());
+		btSetTaskScheduler(m_task_scheduler);
+
+		// Contacts and collision algorithms are allocated from pools which every thread shares, so they are sized for that
+		btDefaultCollisionConstructionInfo collision_info;
+		collision_info.m_defaultMaxPersistentManifoldPoolSize	= 80000;
+		collision_info.m_defaultMaxCollisionAlgorithmPoolSize	= 80000;
+
 		// Create physics objects
 		m_broadphase				= new btDbvtBroadphase();
-		m_collision_configuration	= new btDefaultCollisionConfiguration();
-		m_dispatcher				= new btCollisionDispatcher(m_collision_configuration);
-		m_constraint_solver			= new btSequentialImpulseConstraintSolver();
-		m_world						= new btDiscreteDynamicsWorld(m_dispatcher, m_broadphase, m_constraint_solver, m_collision_configuration);
+		m_collision_configuration	= new btDefaultCollisionConfiguration(collision_info);
+		m_dispatcher				= new btCollisionDispatcherMt(m_collision_configuration);
+		m_constraint_solver			= new btConstraintSolverPoolMt(m_task_scheduler->getMaxNumThreads());
+		m_constraint_solver_mt		= new btSequentialImpulseConstraintSolverMt();
+		m_world						= new btDiscreteDynamicsWorldMt(m_dispatcher, m_broadphase, static_cast<btConstraintSolverPoolMt*>(m_constraint_solver), m_constraint_solver_mt, m_collision_configuration);
 
 		// Setup world
 		m_world->setGravity(ToBtVector3(m_gravity));
@@ -61,12 +123,18 @@ namespace Spartan
 
 	Physics::~Physics()
 	{
+		StepWait();
+
 		safe_delete(m_world);
+		safe_delete(m_constraint_solver_mt);
 		safe_delete(m_constraint_solver);
 		safe_delete(m_dispatcher);
 		safe_delete(m_collision_configuration);
 		safe_delete(m_broadphase);
 		safe_delete(m_debug_draw);
+
+		btSetTaskScheduler(nullptr);
+		safe_delete(m_task_scheduler);
 	}
 
 	bool Physics::Initialize()
@@ -74,6 +142,7 @@ namespace Spartan
         // Get dependencies
 		m_renderer = m_context->GetSubsystem<Renderer>().get();
 		m_profiler = m_context->GetSubsystem<Profiler>().get();
+		m_threading = m_context->GetSubsystem<Threading>().get();
 
         // Get version
         const auto major = to_string(btGetVersion() / 100);
@@ -91,6 +160,9 @@ namespace Spartan
 	{
 		if (!m_world)
 			return;
+
+		// Sync point, the step which was kicked off last frame has to be done before anything touches the world
+		StepWait();
 		
 		// Debug draw
 		if (m_renderer->GetFlags() & Render_Debug_Physics)
@@ -100,29 +172,342 @@ namespace Spartan
 
 		// Don't simulate physics if they are turned off or the we are in editor mode
 		if (!m_context->m_engine->EngineMode_IsSet(Engine_Physics) || !m_context->m_engine->EngineMode_IsSet(Engine_Game))
+		{
+			m_step_accumulator = 0.0f;
 			return;
+		}
 
 		TIME_BLOCK_START_CPU(m_profiler);
 
-		// This equation must be met: timeStep < maxSubSteps * fixedTimeStep
-		auto internal_time_step	= 1.0f / m_internal_fps;
-		auto max_substeps		= static_cast<int>(delta_time_sec * m_internal_fps) + 1;
+		// Write the results of the previous step to the transforms
+		Present();
+
+		// Step at a fixed rate, whatever time is left over is what rigid bodies get interpolated by
+		auto step_duration	= 1.0f / m_internal_fps;
+		auto step_count		= 0u;
 		if (m_max_sub_steps < 0)
 		{
-			internal_time_step	= delta_time_sec;
-			max_substeps		= 1;
+			step_duration		= delta_time_sec;
+			step_count			= 1;
+			m_step_alpha		= 1.0f;
 		}
-		else if (m_max_sub_steps > 0)
+		else
 		{
-			max_substeps = Min(max_substeps, m_max_sub_steps);
+			m_step_accumulator	+= delta_time_sec;
+			step_count			= static_cast<uint32_t>(m_step_accumulator / step_duration);
+			m_step_accumulator	-= step_count * step_duration;
+
+			// Drop the time which the sub step limit doesn't allow for, instead of falling further behind every frame
+			if (m_max_sub_steps > 0 && step_count > static_cast<uint32_t>(m_max_sub_steps))
+			{
+				step_count = static_cast<uint32_t>(m_max_sub_steps);
+			}
+			m_step_alpha = Clamp(m_step_accumulator / step_duration, 0.0f, 1.0f);
 		}
 
-		// Step the physics world. 
+		if (step_count != 0)
+		{
+			if (m_async)
+			{
+				// Step on a worker, the renderer draws the presented transforms in the meantime
+				{
+					lock_guard<mutex> lock(m_step_mutex);
+					m_stepping = true;
+				}
+
+				m_threading->AddTask([this, step_count, step_duration]()
+				{
+					Step(step_count, step_duration);
+
+					lock_guard<mutex> lock(m_step_mutex);
+					m_stepping = false;
+					m_step_condition.notify_all();
+				});
+			}
+			else
+			{
+				Step(step_count, step_duration);
+				Present();
+			}
+		}
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	void Physics::StepWait()
+	{
+		unique_lock<mutex> lock(m_step_mutex);
+		m_step_condition.wait(lock, [this] { return !m_stepping; });
+	}
+
+	void Physics::SetAsync(const bool async)
+	{
+		StepWait();
+		m_async = async;
+	}
+
+	void Physics::Step(const uint32_t step_count, const float step_duration)
+	{
+		// Bodies record their previous and current state as Bullet synchronizes them, tagged with the step they moved in
 		m_simulating = true;
-		m_world->stepSimulation(delta_time_sec, max_substeps, internal_time_step);
+		for (uint32_t i = 0; i < step_count; i++)
+		{
+			m_step_count++;
+			m_world->stepSimulation(step_duration, 0, step_duration);
+		}
 		m_simulating = false;
+	}
 
-		TIME_BLOCK_END(m_profiler);
+	void Physics::Present()
+	{
+		// Bodies which the step moved join the ones which are still being presented, bodies at rest are never visited
+		m_body_active_count = static_cast<uint32_t>(m_bodies_moved.size());
+		for (const auto body : m_bodies_moved)
+		{
+			body->m_state_moved = false;
+			Body_Present(body);
+		}
+		m_bodies_moved.clear();
+
+		// Transforms are only ever written here, on the main thread
+		m_body_presented_count = 0;
+		for (size_t i = 0; i < m_bodies_presenting.size();)
+		{
+			const auto body = m_bodies_presenting[i];
+			if (body->m_rigidBody && !body->m_rigidBody->isStaticOrKinematicObject() && body->Present(m_step_count, m_step_alpha))
+			{
+				m_body_presented_count++;
+			}
+
+			// Once it rests where it was last presented, it's left alone until it moves again
+			if (!body->m_rigidBody || body->m_rigidBody->isStaticOrKinematicObject() || body->IsPresented())
+			{
+				body->m_state_presenting	= false;
+				m_bodies_presenting[i]		= m_bodies_presenting.back();
+				m_bodies_presenting.pop_back();
+				continue;
+			}
+
+			i++;
+		}
+	}
+
+	void Physics::Body_Moved(RigidBody* body)
+	{
+		if (!body->m_state_moved)
+		{
+			body->m_state_moved = true;
+			m_bodies_moved.emplace_back(body);
+		}
+	}
+
+	void Physics::Body_Present(RigidBody* body)
+	{
+		if (!body->m_state_presenting)
+		{
+			body->m_state_presenting = true;
+			m_bodies_presenting.emplace_back(body);
+		}
+	}
+
+	void Physics::Body_Removed(RigidBody* body)
+	{
+		if (body->m_state_moved)
+		{
+			m_bodies_moved.erase(remove(m_bodies_moved.begin(), m_bodies_moved.end(), body), m_bodies_moved.end());
+			body->m_state_moved = false;
+		}
+
+		if (body->m_state_presenting)
+		{
+			m_bodies_presenting.erase(remove(m_bodies_presenting.begin(), m_bodies_presenting.end(), body), m_bodies_presenting.end());
+			body->m_state_presenting = false;
+		}
+	}
+
+	uint32_t Physics::GetBodyCount() const
+	{
+		return static_cast<uint32_t>(m_world->getNumCollisionObjects());
+	}
+
+	bool Physics::Raycast(const Vector3& start, const Vector3& end, Physics_Hit* hit, const uint32_t layers)
+	{
+		Physics_Cast cast;
+		cast.start	= start;
+		cast.end	= end;
+		cast.layers	= layers;
+
+		StepWait();
+		return CastSingle(cast, hit);
+	}
+
+	bool Physics::SweepSphere(const Vector3& start, const Vector3& end, const float radius, Physics_Hit* hit, const uint32_t layers)
+	{
+		Physics_Cast cast;
+		cast.start		= start;
+		cast.end		= end;
+		cast.shape		= Physics_Cast_Sphere;
+		cast.extents	= Vector3(radius);
+		cast.layers		= layers;
+
+		StepWait();
+		return CastSingle(cast, hit);
+	}
+
+	bool Physics::SweepBox(const Vector3& start, const Vector3& end, const Vector3& half_extents, const Quaternion& rotation, Physics_Hit* hit, const uint32_t layers)
+	{
+		Physics_Cast cast;
+		cast.start		= start;
+		cast.end		= end;
+		cast.shape		= Physics_Cast_Box;
+		cast.extents	= half_extents;
+		cast.rotation	= rotation;
+		cast.layers		= layers;
+
+		StepWait();
+		return CastSingle(cast, hit);
+	}
+
+	uint32_t Physics::OverlapSphere(const Vector3& center, const float radius, vector<Entity*>* entities, const uint32_t layers)
+	{
+		btSphereShape shape(radius);
+		btTransform transform;
+		transform.setIdentity();
+		transform.setOrigin(ToBtVector3(center));
+
+		StepWait();
+		return Overlap(&shape, transform, entities, layers);
+	}
+
+	uint32_t Physics::OverlapBox(const Vector3& center, const Vector3& half_extents, const Quaternion& rotation, vector<Entity*>* entities, const uint32_t layers)
+	{
+		btBoxShape shape(ToBtVector3(half_extents));
+
+		StepWait();
+		return Overlap(&shape, btTransform(ToBtQuaternion(rotation), ToBtVector3(center)), entities, layers);
+	}
+
+	void Physics::Cast(const vector<Physics_Cast>& casts, vector<Physics_Hit>* hits)
+	{
+		if (!hits)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		hits->resize(casts.size());
+		if (casts.empty())
+			return;
+
+		StepWait();
+		const auto count = static_cast<uint32_t>(casts.size());
+#if BT_THREADSAFE
+		// Casts only read the world, as long as it doesn't step. The broadphase traverses with a stack per call only when
+		// Bullet is built with BT_THREADSAFE, otherwise every cast shares one and they have to run one after the other.
+		m_threading->Loop([this, &casts, hits](const uint32_t start, const uint32_t end)
+		{
+			for (auto i = start; i < end; i++)
+			{
+				CastSingle(casts[i], &(*hits)[i]);
+			}
+		}, count, count / _Physics::cast_batch_grain + 1);
+#else
+		for (uint32_t i = 0; i < count; i++)
+		{
+			CastSingle(casts[i], &(*hits)[i]);
+		}
+#endif
+	}
+
+	bool Physics::CastSingle(const Physics_Cast& cast, Physics_Hit* hit) const
+	{
+		if (!hit)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		*hit = Physics_Hit();
+		const auto start	= ToBtVector3(cast.start);
+		const auto end		= ToBtVector3(cast.end);
+
+		if (cast.shape == Physics_Cast_Ray)
+		{
+			btCollisionWorld::ClosestRayResultCallback callback(start, end);
+			_Physics::set_filter(&callback, cast.layers);
+			m_world->rayTest(start, end, callback);
+			if (!callback.hasHit())
+				return false;
+
+			hit->entity		= _Physics::entity(callback.m_collisionObject);
+			hit->position	= ToVector3(callback.m_hitPointWorld);
+			hit->normal		= ToVector3(callback.m_hitNormalWorld);
+			hit->fraction	= callback.m_closestHitFraction;
+		}
+		else
+		{
+			// The shape lives on the stack, so sweeps can run on any thread
+			btCollisionWorld::ClosestConvexResultCallback callback(start, end);
+			_Physics::set_filter(&callback, cast.layers);
+			const auto sweep = [this, &cast, &start, &end, &callback](const btConvexShape* shape)
+			{
+				const auto rotation = ToBtQuaternion(cast.rotation);
+				m_world->convexSweepTest(shape, btTransform(rotation, start), btTransform(rotation, end), callback);
+			};
+
+			if (cast.shape == Physics_Cast_Sphere)
+			{
+				btSphereShape sphere(cast.extents.x);
+				sweep(&sphere);
+			}
+			else
+			{
+				btBoxShape box(ToBtVector3(cast.extents));
+				sweep(&box);
+			}
+
+			if (!callback.hasHit())
+				return false;
+
+			hit->entity		= _Physics::entity(callback.m_hitCollisionObject);
+			hit->position	= ToVector3(callback.m_hitPointWorld);
+			hit->normal		= ToVector3(callback.m_hitNormalWorld);
+			hit->fraction	= callback.m_closestHitFraction;
+		}
+
+		hit->hit = true;
+		return true;
+	}
+
+	uint32_t Physics::Overlap(btCollisionShape* shape, const btTransform& transform, vector<Entity*>* entities, const uint32_t layers) const
+	{
+		if (!entities)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return 0;
+		}
+
+		btCollisionObject query;
+		query.setCollisionShape(shape);
+		query.setWorldTransform(transform);
+
+		const auto count = entities->size();
+		_Physics::overlap_callback callback(&query, entities);
+		_Physics::set_filter(&callback, layers);
+		m_world->contactTest(&query, callback);
+
+		return static_cast<uint32_t>(entities->size() - count);
+	}
+
+	uint32_t Physics::GetThreadCount() const
+	{
+		return m_thread_count;
+	}
+
+	void Physics::SetThreadCount(const uint32_t thread_count)
+	{
+		m_thread_count = thread_count;
+		m_task_scheduler->setNumThreads(thread_count != 0 ? static_cast<int>(thread_count) : m_task_scheduler->getMaxNumThreads());
 	}
 
 	Vector3 Physics::GetGravity() const
@@ -22,8 +22,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ==================
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 #include "../Core/ISubsystem.h"
 #include "../Math/Vector3.h"
+#include "../Math/Quaternion.h"
 //=============================
 
 //= FORWARD DECLARATIONS =============
@@ -32,15 +37,51 @@ class btCollisionDispatcher;
 class btConstraintSolver;
 class btDefaultCollisionConfiguration;
 class btDiscreteDynamicsWorld;
+class btCollisionShape;
+class btTransform;
 //====================================
 
 namespace Spartan
 {
 	class Renderer;
 	class PhysicsDebugDraw;
+	class PhysicsTaskScheduler;
 	class Profiler;
+	class Threading;
+	class Entity;
+	class RigidBody;
 	namespace Math { class Vector3; }	
 
+	// Collision layer masks, a body in layer n is in the mask 1 << n (see RigidBody::SetCollisionLayer)
+	static const uint32_t Physics_Layers_All = 0xFFFFFFFF;
+
+	enum Physics_Cast_Shape
+	{
+		Physics_Cast_Ray,
+		Physics_Cast_Sphere,
+		Physics_Cast_Box
+	};
+
+	// A ray, or a shape which sweeps from start to end
+	struct Physics_Cast
+	{
+		Math::Vector3 start			= Math::Vector3::Zero;
+		Math::Vector3 end			= Math::Vector3::Zero;
+		Physics_Cast_Shape shape	= Physics_Cast_Ray;
+		Math::Vector3 extents		= Math::Vector3::Zero;		// Radius of a sphere (x) or half extents of a box
+		Math::Quaternion rotation	= Math::Quaternion::Identity;	// Of a box
+		uint32_t layers				= Physics_Layers_All;		// Layers whose bodies can be hit
+	};
+
+	struct Physics_Hit
+	{
+		bool hit				= false;
+		Entity* entity			= nullptr;
+		Math::Vector3 position	= Math::Vector3::Zero;
+		Math::Vector3 normal	= Math::Vector3::Zero;
+		float fraction			= 1.0f; // Of the way from start to end
+	};
+
 	class Physics : public ISubsystem
 	{
 	public:
@@ -57,22 +98,76 @@ namespace Spartan
         auto GetPhysicsDebugDraw()  const { return m_debug_draw; }
 		bool IsSimulating()         const { return m_simulating; }
 
+		// Threads the simulation is split across, the calling one included (zero uses every thread of the job system)
+		uint32_t GetThreadCount() const;
+		void SetThreadCount(uint32_t thread_count);
+
+		// When asynchronous, the world steps on a worker while the rest of the frame runs and rigid bodies present results a frame later
+		bool GetAsync() const { return m_async; }
+		void SetAsync(bool async);
+
+		// Sync point, blocks until an in-flight step is done (anything which touches the world while the game runs has to call it first)
+		void StepWait();
+		uint64_t GetStepCount() const { return m_step_count; }
+
+		// Only bodies which moved are presented, bodies at rest cost nothing. Active bodies are those that the last step moved.
+		void Body_Moved(RigidBody* body);	// By the step, as it moves a body
+		void Body_Present(RigidBody* body);	// By the main thread, when a body is teleported
+		void Body_Removed(RigidBody* body);
+		uint32_t GetBodyCount() const;
+		uint32_t GetBodyActiveCount() const		{ return m_body_active_count; }
+		uint32_t GetBodyPresentedCount() const	{ return m_body_presented_count; }
+
+		// Queries, they wait for an in-flight step and see the bodies where the last step left them. Casts report the closest hit.
+		bool Raycast(const Math::Vector3& start, const Math::Vector3& end, Physics_Hit* hit, uint32_t layers = Physics_Layers_All);
+		bool SweepSphere(const Math::Vector3& start, const Math::Vector3& end, float radius, Physics_Hit* hit, uint32_t layers = Physics_Layers_All);
+		bool SweepBox(const Math::Vector3& start, const Math::Vector3& end, const Math::Vector3& half_extents, const Math::Quaternion& rotation, Physics_Hit* hit, uint32_t layers = Physics_Layers_All);
+		uint32_t OverlapSphere(const Math::Vector3& center, float radius, std::vector<Entity*>* entities, uint32_t layers = Physics_Layers_All);
+		uint32_t OverlapBox(const Math::Vector3& center, const Math::Vector3& half_extents, const Math::Quaternion& rotation, std::vector<Entity*>* entities, uint32_t layers = Physics_Layers_All);
+
+		// Batched casts, split across the job system (e.g. line of sight checks for many agents), a hit per cast
+		void Cast(const std::vector<Physics_Cast>& casts, std::vector<Physics_Hit>* hits);
+
 	private:
+		void Step(uint32_t step_count, float step_duration);
+		void Present();
+		bool CastSingle(const Physics_Cast& cast, Physics_Hit* hit) const;
+		uint32_t Overlap(btCollisionShape* shape, const btTransform& transform, std::vector<Entity*>* entities, uint32_t layers) const;
+
 		btBroadphaseInterface* m_broadphase                         = nullptr;
 		btCollisionDispatcher* m_dispatcher                         = nullptr;
-		btConstraintSolver* m_constraint_solver                     = nullptr;
+		btConstraintSolver* m_constraint_solver                     = nullptr; // A pool, islands are solved in parallel
+		btConstraintSolver* m_constraint_solver_mt                  = nullptr; // Splits islands which are too large for one thread
 		btDefaultCollisionConfiguration* m_collision_configuration  = nullptr;
 		btDiscreteDynamicsWorld* m_world                            = nullptr;
 		PhysicsDebugDraw* m_debug_draw                              = nullptr;
+		PhysicsTaskScheduler* m_task_scheduler                      = nullptr;
         Renderer* m_renderer                                        = nullptr;
         Profiler* m_profiler                                        = nullptr;
+        Threading* m_threading                                      = nullptr;
 
 		//= PROPERTIES =================================================
-        int m_max_sub_steps         = 1;
-        int m_max_solve_iterations  = 256;
-        float m_internal_fps        = 60.0f;
-        Math::Vector3 m_gravity     = Math::Vector3(0.0f, -9.81f, 0.0f);
-        bool m_simulating           = false;
+        int m_max_sub_steps             = 1;
+        int m_max_solve_iterations      = 256;
+        float m_internal_fps            = 60.0f;
+        Math::Vector3 m_gravity         = Math::Vector3(0.0f, -9.81f, 0.0f);
+        std::atomic<bool> m_simulating  = false;
+        uint32_t m_thread_count         = 0;
+        bool m_async                    = true;
 		//==============================================================
+
+		// Fixed step state, rigid bodies are presented at step_alpha between their last two states
+		uint64_t m_step_count		= 0;
+		float m_step_accumulator	= 0.0f;
+		float m_step_alpha			= 1.0f;
+		bool m_stepping				= false;
+		std::mutex m_step_mutex;
+		std::condition_variable m_step_condition;
+
+		// Bodies which the step moved, then the ones which are presented every tick until they rest
+		std::vector<RigidBody*> m_bodies_moved;
+		std::vector<RigidBody*> m_bodies_presenting;
+		uint32_t m_body_active_count	= 0;
+		uint32_t m_body_presented_count	= 0;
 	};
 }
@@ -0,0 +1,160 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================================================================
+#include "PhysicsBenchmark.h"
+#include "PhysicsTaskScheduler.h"
+#include <memory>
+#include <cmath>
+#include "../Core/Stopwatch.h"
+#include "../Logging/Log.h"
+#include "../Threading/Threading.h"
+#pragma warning(push, 0) // Hide warnings which belong to Bullet
+#include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <BulletCollision/CollisionShapes/btStaticPlaneShape.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletDynamics/Dynamics/btRigidBody.h>
+#pragma warning(pop)
+//================================================================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+	namespace _PhysicsBenchmark
+	{
+		static const float time_step		= 1.0f / 60.0f;
+		static const float stack_spacing	= 3.0f; // Between stack centers, far enough for the stacks not to touch
+
+		PhysicsBenchmark_Result run(const PhysicsBenchmark_Settings& settings, const uint32_t thread_count)
+		{
+			// Same setup as the Physics subsystem
+			btDefaultCollisionConstructionInfo collision_info;
+			collision_info.m_defaultMaxPersistentManifoldPoolSize	= 80000;
+			collision_info.m_defaultMaxCollisionAlgorithmPoolSize	= 80000;
+			btDefaultCollisionConfiguration configuration(collision_info);
+			btCollisionDispatcherMt dispatcher(&configuration);
+			btDbvtBroadphase broadphase;
+			btConstraintSolverPoolMt solver_pool(static_cast<int>(thread_count));
+			btSequentialImpulseConstraintSolverMt solver_mt;
+			btDiscreteDynamicsWorldMt world(&dispatcher, &broadphase, &solver_pool, &solver_mt, &configuration);
+			world.setGravity(btVector3(0.0f, -9.81f, 0.0f));
+			world.getSolverInfo().m_numIterations = static_cast<int>(settings.solver_iterations);
+
+			// A ground plane and stacks of unit boxes on a square grid
+			btStaticPlaneShape shape_ground(btVector3(0.0f, 1.0f, 0.0f), 0.0f);
+			btBoxShape shape_box(btVector3(0.5f, 0.5f, 0.5f));
+			btVector3 inertia_box;
+			shape_box.calculateLocalInertia(1.0f, inertia_box);
+
+			vector<unique_ptr<btRigidBody>> bodies;
+			bodies.emplace_back(make_unique<btRigidBody>(btRigidBody::btRigidBodyConstructionInfo(0.0f, nullptr, &shape_ground)));
+
+			const auto side = static_cast<uint32_t>(ceil(sqrt(static_cast<double>(settings.stack_count))));
+			for (uint32_t stack = 0; stack < settings.stack_count; stack++)
+			{
+				const auto x = (stack % side) * stack_spacing;
+				const auto z = (stack / side) * stack_spacing;
+				for (uint32_t level = 0; level < settings.stack_height; level++)
+				{
+					btRigidBody::btRigidBodyConstructionInfo info(1.0f, nullptr, &shape_box, inertia_box);
+					info.m_startWorldTransform.setIdentity();
+					info.m_startWorldTransform.setOrigin(btVector3(x, 0.5f + level, z));
+					bodies.emplace_back(make_unique<btRigidBody>(info));
+
+					// Resting stacks would fall asleep and there would be nothing left to measure
+					bodies.back()->setActivationState(DISABLE_DEACTIVATION);
+				}
+			}
+
+			vector<btVector3> positions_start;
+			for (const auto& body : bodies)
+			{
+				world.addRigidBody(body.get());
+				positions_start.emplace_back(body->getWorldTransform().getOrigin());
+			}
+
+			PhysicsBenchmark_Result result;
+			result.thread_count = thread_count;
+			Stopwatch timer;
+			for (uint32_t step = 0; step < settings.step_count; step++)
+			{
+				timer.Start();
+				world.stepSimulation(time_step, 1, time_step);
+				const double step_ms	= timer.GetElapsedTimeMs();
+				result.step_ms_average	+= step_ms;
+				result.step_ms_max		= max(result.step_ms_max, step_ms);
+			}
+			result.step_ms_average /= max(settings.step_count, 1u);
+
+			for (size_t i = 0; i < bodies.size(); i++)
+			{
+				const auto& body = bodies[i];
+				result.bodies_moved += positions_start[i].distance(body->getWorldTransform().getOrigin()) > 0.5f ? 1 : 0;
+
+				// The world still refers to them as it goes away
+				world.removeRigidBody(body.get());
+			}
+
+			return result;
+		}
+	}
+
+	vector<PhysicsBenchmark_Result> PhysicsBenchmark::Run(Threading* threading, const PhysicsBenchmark_Settings& settings /*= PhysicsBenchmark_Settings()*/)
+	{
+		vector<PhysicsBenchmark_Result> results;
+		if (!threading)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return results;
+		}
+
+		// Runs on a scheduler of its own, the one which was set before (e.g. by the Physics subsystem) is restored afterwards
+		const auto scheduler_previous = btGetTaskScheduler();
+		PhysicsTaskScheduler scheduler(threading);
+		btSetTaskScheduler(&scheduler);
+
+		const auto bodies = settings.stack_count * settings.stack_height;
+		for (int thread_count = 1; thread_count <= scheduler.getMaxNumThreads(); thread_count++)
+		{
+			scheduler.setNumThreads(thread_count);
+			const auto& result = results.emplace_back(_PhysicsBenchmark::run(settings, static_cast<uint32_t>(thread_count)));
+
+			LOGF_INFO("%d bodies, %d threads: %.3f ms per step on average, %.3f ms at most, %d bodies moved",
+				static_cast<int>(bodies),
+				thread_count,
+				result.step_ms_average,
+				result.step_ms_max,
+				static_cast<int>(result.bodies_moved)
+			);
+		}
+
+		btSetTaskScheduler(scheduler_previous);
+
+		return results;
+	}
+}
@@ -0,0 +1,57 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <cstdint>
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Spartan
+{
+	class Threading;
+
+	struct PhysicsBenchmark_Settings
+	{
+		uint32_t stack_count		= 64;	// Laid out on a square grid, every stack is an island of its own
+		uint32_t stack_height		= 10;	// Boxes per stack
+		uint32_t step_count			= 300;	// At 60 steps per second
+		uint32_t solver_iterations	= 10;
+	};
+
+	struct PhysicsBenchmark_Result
+	{
+		uint32_t thread_count	= 0;
+		double step_ms_average	= 0.0;
+		double step_ms_max		= 0.0;
+		uint32_t bodies_moved	= 0;	// More than half a box away from where they started, the stacks should stand still with any thread count
+	};
+
+	// Steps a scene of stacked boxes in a world of its own (no entities, nothing is rendered) once for
+	// every thread count, from one up to what the job system has. Has to be called from the main thread.
+	class SPARTAN_CLASS PhysicsBenchmark
+	{
+	public:
+		static std::vector<PhysicsBenchmark_Result> Run(Threading* threading, const PhysicsBenchmark_Settings& settings = PhysicsBenchmark_Settings());
+	};
+}
@@ -0,0 +1,175 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "PhysicsTaskScheduler.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "../Threading/Threading.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+// Defined in btThreads.cpp, which doesn't declare them in its header (its own schedulers live in the same file)
+void btPushThreadsAreRunning();
+void btPopThreadsAreRunning();
+
+namespace Spartan
+{
+	namespace _PhysicsTaskScheduler
+	{
+		// The chunks of a parallel section, taken one at a time by whichever thread gets to them first
+		struct section
+		{
+			atomic<uint32_t> next	= 0;
+			atomic<uint32_t> done	= 0;
+			uint32_t count			= 0;
+			const function<void(uint32_t)>* job = nullptr; // Only called while a chunk is left, the caller is still waiting then
+			mutex mutex_done;
+			condition_variable condition_done;
+
+			void run()
+			{
+				for (auto chunk = next++; chunk < count; chunk = next++)
+				{
+					(*job)(chunk);
+					if (++done == count)
+					{
+						lock_guard<mutex> lock(mutex_done);
+						condition_done.notify_one();
+					}
+				}
+			}
+		};
+
+		// A few chunks per thread, so that a thread which gets to it late or runs slower doesn't hold the others up
+		inline uint32_t chunk_count(const int range, const int grain_size, const int threads)
+		{
+			return static_cast<uint32_t>(max(1, min(range / max(grain_size, 1), threads * 4)));
+		}
+
+		inline pair<int, int> chunk_bounds(const int range, const uint32_t chunk_count, const uint32_t chunk)
+		{
+			const auto start	= static_cast<int>(static_cast<int64_t>(range) * chunk / chunk_count);
+			const auto end		= static_cast<int>(static_cast<int64_t>(range) * (chunk + 1) / chunk_count);
+			return { start, end };
+		}
+	}
+
+	PhysicsTaskScheduler::PhysicsTaskScheduler(Threading* threading) : btITaskScheduler("Spartan")
+	{
+		m_threading		= threading;
+		m_thread_count	= getMaxNumThreads();
+	}
+
+	int PhysicsTaskScheduler::getMaxNumThreads() const
+	{
+		// Bullet gives every thread which runs its tasks an index of its own, the calling thread included, and it has room for so many
+		const auto threads = static_cast<int>(m_threading->GetThreadCount()) + 1;
+		return min(threads, static_cast<int>(BT_MAX_THREAD_COUNT));
+	}
+
+	void PhysicsTaskScheduler::setNumThreads(const int numThreads)
+	{
+		m_thread_count = max(1, min(numThreads, getMaxNumThreads()));
+	}
+
+	void PhysicsTaskScheduler::parallelFor(const int iBegin, const int iEnd, const int grainSize, const btIParallelForBody& body)
+	{
+		const auto range	= iEnd - iBegin;
+		const auto threads	= GetThreadCount(range, grainSize);
+		if (threads <= 1)
+		{
+			if (range > 0)
+			{
+				body.forLoop(iBegin, iEnd);
+			}
+			return;
+		}
+
+		// Bullet checks this to tell apart code which runs within a parallel section
+		btPushThreadsAreRunning();
+		const auto chunks = _PhysicsTaskScheduler::chunk_count(range, grainSize, threads);
+		Run(chunks, static_cast<uint32_t>(threads), [&body, iBegin, range, chunks](const uint32_t chunk)
+		{
+			const auto bounds = _PhysicsTaskScheduler::chunk_bounds(range, chunks, chunk);
+			body.forLoop(iBegin + bounds.first, iBegin + bounds.second);
+		});
+		btPopThreadsAreRunning();
+	}
+
+	btScalar PhysicsTaskScheduler::parallelSum(const int iBegin, const int iEnd, const int grainSize, const btIParallelSumBody& body)
+	{
+		const auto range	= iEnd - iBegin;
+		const auto threads	= GetThreadCount(range, grainSize);
+		if (threads <= 1)
+			return range > 0 ? body.sumLoop(iBegin, iEnd) : btScalar(0);
+
+		// Every chunk has a partial sum of its own, they are added in order so that the result doesn't depend on the timing
+		btPushThreadsAreRunning();
+		const auto chunks = _PhysicsTaskScheduler::chunk_count(range, grainSize, threads);
+		vector<btScalar> sums(chunks, btScalar(0));
+		Run(chunks, static_cast<uint32_t>(threads), [&body, &sums, iBegin, range, chunks](const uint32_t chunk)
+		{
+			const auto bounds	= _PhysicsTaskScheduler::chunk_bounds(range, chunks, chunk);
+			sums[chunk]			= body.sumLoop(iBegin + bounds.first, iBegin + bounds.second);
+		});
+		btPopThreadsAreRunning();
+
+		btScalar sum = 0;
+		for (const auto partial : sums)
+		{
+			sum += partial;
+		}
+		return sum;
+	}
+
+	void PhysicsTaskScheduler::Run(const uint32_t chunk_count, const uint32_t thread_count, const function<void(uint32_t)>& job)
+	{
+		// Tasks which start once every chunk has been taken (the pool may be busy with other work) return right away,
+		// so the calling thread only waits for chunks which are running. The section outlives it for such late tasks.
+		auto section	= make_shared<_PhysicsTaskScheduler::section>();
+		section->count	= chunk_count;
+		section->job	= &job;
+
+		for (uint32_t i = 1; i < thread_count; i++)
+		{
+			m_threading->AddTask([section]() { section->run(); });
+		}
+
+		section->run();
+
+		unique_lock<mutex> lock(section->mutex_done);
+		section->condition_done.wait(lock, [&section] { return section->done == section->count; });
+	}
+
+	int PhysicsTaskScheduler::GetThreadCount(const int range, const int grain_size) const
+	{
+		// Bullet's grain size is the smallest range that's worth a task
+		if (range <= 0)
+			return 0;
+
+		return max(1, min(m_thread_count, range / max(grain_size, 1)));
+	}
+}
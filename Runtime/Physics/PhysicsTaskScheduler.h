@@ -0,0 +1,66 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========================
+#include <cstdint>
+#include <functional>
+// Hide warnings which belong to Bullet
+#pragma warning(push, 0)
+#include <LinearMath/btThreads.h>
+#pragma warning(pop)
+//=====================================
+
+#if !BT_THREADSAFE
+#error "Bullet has to be built with BT_THREADSAFE=1, otherwise its multithreaded world steps sequentially"
+#endif
+
+namespace Spartan
+{
+	class Threading;
+
+	// Runs the parallel-for of Bullet's multithreaded ("Mt") classes on the engine's thread pool. Bullet only
+	// calls into it when built with BT_THREADSAFE, which Scripts/premake.lua does (it builds Bullet from source).
+	// A parallel section only ever runs its own chunks, on the calling thread too, never other queued work.
+	class PhysicsTaskScheduler : public btITaskScheduler
+	{
+	public:
+		PhysicsTaskScheduler(Threading* threading);
+		~PhysicsTaskScheduler() = default;
+
+		//= btITaskScheduler ====================================================================================
+		int getMaxNumThreads() const override;
+		int getNumThreads() const override				{ return m_thread_count; }
+		void setNumThreads(int numThreads) override;
+		void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+		btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+		//=======================================================================================================
+
+	private:
+		int GetThreadCount(int range, int grain_size) const;
+		// Runs job(chunk) for every chunk in [0, chunk_count) on up to thread_count threads (the calling one included) and waits for them
+		void Run(uint32_t chunk_count, uint32_t thread_count, const std::function<void(uint32_t)>& job);
+
+		Threading* m_threading	= nullptr;
+		int m_thread_count		= 1;
+	};
+}
@@ -0,0 +1,134 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================================================
+#include "PhysicsTriangleMesh.h"
+#include <cstring>
+#pragma warning(push, 0) // Hide warnings which belong to Bullet
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#pragma warning(pop)
+//=====================================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	PhysicsTriangleMesh::PhysicsTriangleMesh(vector<uint32_t>&& indices, vector<Vector3>&& positions, const vector<std::byte>& bvh)
+	{
+		m_indices	= move(indices);
+		m_positions	= move(positions);
+		m_mesh		= new btTriangleIndexVertexArray(
+			static_cast<int>(m_indices.size() / 3),
+			reinterpret_cast<int*>(m_indices.data()),
+			static_cast<int>(sizeof(uint32_t) * 3),
+			static_cast<int>(m_positions.size()),
+			reinterpret_cast<btScalar*>(m_positions.data()),
+			static_cast<int>(sizeof(Vector3))
+		);
+
+		if (DeserializeBvh(bvh))
+		{
+			m_shape = new btBvhTriangleMeshShape(m_mesh, true, false);
+			m_shape->setOptimizedBvh(m_bvh);
+		}
+		else
+		{
+			m_shape = new btBvhTriangleMeshShape(m_mesh, true, true);
+		}
+	}
+
+	PhysicsTriangleMesh::~PhysicsTriangleMesh()
+	{
+		delete m_shape; // Doesn't own a deserialized hierarchy
+		ReleaseBvh();
+		delete m_mesh;
+	}
+
+	void PhysicsTriangleMesh::SerializeBvh(vector<std::byte>* bvh) const
+	{
+		const auto source = m_shape->getOptimizedBvh();
+		if (!bvh || !source)
+			return;
+
+		const auto size		= source->calculateSerializeBufferSize();
+		const auto buffer	= btAlignedAlloc(size, 16);
+		if (source->serializeInPlace(buffer, size, false))
+		{
+			bvh->resize(size);
+			memcpy(bvh->data(), buffer, size);
+		}
+		btAlignedFree(buffer);
+	}
+
+	bool PhysicsTriangleMesh::DeserializeBvh(const vector<std::byte>& bvh)
+	{
+		const auto triangle_count = static_cast<int>(m_indices.size() / 3);
+		if (bvh.empty() || triangle_count == 0)
+			return false;
+
+		// The hierarchy is read in place, so it needs a buffer with the alignment it was written with
+		m_bvh_buffer = btAlignedAlloc(bvh.size(), 16);
+		memcpy(m_bvh_buffer, bvh.data(), bvh.size());
+		m_bvh = static_cast<btOptimizedBvh*>(btOptimizedBvh::deSerializeInPlace(m_bvh_buffer, static_cast<unsigned int>(bvh.size()), false));
+
+		// A binary tree with a leaf per triangle, whose root bounds every triangle
+		auto valid = m_bvh && m_bvh->isQuantized() && m_bvh->getQuantizedNodeArray().size() == 2 * triangle_count - 1;
+		if (valid)
+		{
+			const auto& root	= m_bvh->getQuantizedNodeArray()[0];
+			const auto min		= m_bvh->unQuantize(root.m_quantizedAabbMin);
+			const auto max		= m_bvh->unQuantize(root.m_quantizedAabbMax);
+			for (const auto& position : m_positions)
+			{
+				const btVector3 point(position.x, position.y, position.z);
+				if (point.x() < min.x() || point.y() < min.y() || point.z() < min.z() || point.x() > max.x() || point.y() > max.y() || point.z() > max.z())
+				{
+					valid = false;
+					break;
+				}
+			}
+		}
+
+		if (!valid)
+		{
+			ReleaseBvh();
+		}
+
+		return valid;
+	}
+
+	void PhysicsTriangleMesh::ReleaseBvh()
+	{
+		if (m_bvh)
+		{
+			m_bvh->~btOptimizedBvh(); // Constructed in place
+			m_bvh = nullptr;
+		}
+
+		btAlignedFree(m_bvh_buffer);
+		m_bvh_buffer = nullptr;
+	}
+}
@@ -0,0 +1,61 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "../Math/Vector3.h"
+//=============================
+
+class btTriangleIndexVertexArray;
+class btBvhTriangleMeshShape;
+class btOptimizedBvh;
+
+namespace Spartan
+{
+	// Static triangle geometry for Bullet, it keeps the triangles that its shape points to. Building the bounding volume hierarchy
+	// takes a while for large meshes, so it can be serialized (on import) and handed back in (on load) instead of being rebuilt.
+	class PhysicsTriangleMesh
+	{
+	public:
+		// A serialized hierarchy is only used if it matches the triangles and the platform, otherwise it's rebuilt
+		PhysicsTriangleMesh(std::vector<uint32_t>&& indices, std::vector<Math::Vector3>&& positions, const std::vector<std::byte>& bvh = std::vector<std::byte>());
+		~PhysicsTriangleMesh();
+
+		void SerializeBvh(std::vector<std::byte>* bvh) const;
+		bool IsBvhDeserialized() const		{ return m_bvh_buffer != nullptr; }
+		btBvhTriangleMeshShape* GetShape()	{ return m_shape; }
+
+	private:
+		bool DeserializeBvh(const std::vector<std::byte>& bvh);
+		void ReleaseBvh();
+
+		std::vector<uint32_t> m_indices;
+		std::vector<Math::Vector3> m_positions;
+		btTriangleIndexVertexArray* m_mesh	= nullptr;
+		btBvhTriangleMeshShape* m_shape		= nullptr;
+		btOptimizedBvh* m_bvh				= nullptr; // Only when deserialized, it lives in m_bvh_buffer
+		void* m_bvh_buffer					= nullptr;
+	};
+}
@@ -25,6 +25,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/EventSystem.h"
 #include "../Rendering/Renderer.h"
 #include "../Resource/ResourceCache.h"
+#include "../Physics/Physics.h"
+#include "../Audio/Audio.h"
+#include "../Scripting/Scripting.h"
 //====================================
 
 //= NAMESPACES =====
@@ -51,6 +54,9 @@ namespace Spartan
 	{
 		m_resource_manager	= m_context->GetSubsystem<ResourceCache>().get();
 		m_renderer			= m_context->GetSubsystem<Renderer>().get();
+		m_physics			= m_context->GetSubsystem<Physics>().get();
+		m_audio				= m_context->GetSubsystem<Audio>().get();
+		m_scripting			= m_context->GetSubsystem<Scripting>().get();
 
 		// Get available memory
 		if (const DisplayAdapter* adapter = m_renderer->GetRhiDevice()->GetPrimaryAdapter())
@@ -250,7 +256,17 @@ namespace Spartan
 		const auto material_count	= m_resource_manager->GetResourceCount(Resource_Material);
 		const auto shader_count		= m_resource_manager->GetResourceCount(Resource_Shader);
 
-		static char buffer[1000]; // real usage is around 700
+		// Scripts, totals across script classes
+		Script_Update_Stats scripts;
+		for (const auto& stats : m_scripting->GetUpdateStats())
+		{
+			scripts.instances	+= stats.instances;
+			scripts.updates		+= stats.updates;
+			scripts.deferred	+= stats.deferred;
+			scripts.time_ms		+= stats.time_ms;
+		}
+
+		static char buffer[1100]; // real usage is around 900
 		sprintf_s
 		(
 			buffer,
@@ -268,6 +284,13 @@ namespace Spartan
 			"Textures:\t\t\t\t\t%d\n"
 			"Materials:\t\t\t\t\t%d\n"
 			"Shaders:\t\t\t\t\t\t%d\n"
+			// Physics
+			"Physics bodies:\t\t\t\t\t%d (%d active, %d presented)\n"
+			// Audio
+			"Audio voices:\t\t\t\t\t%d (%d real)\n"
+			"Audio bank:\t\t\t\t\t%d samples, %.1f MB\n"
+			// Scripting
+			"Scripts:\t\t\t\t\t\t%d (%d updated, %d deferred, %.2f ms)\n"
 			// RHI
 			"RHI Draw calls:\t\t\t\t%d\n"
 			"RHI Index buffer bindings:\t\t%d\n"
@@ -294,6 +317,13 @@ namespace Spartan
 			texture_count,
 			material_count,
 			shader_count,
+			// Physics
+			m_physics->GetBodyCount(), m_physics->GetBodyActiveCount(), m_physics->GetBodyPresentedCount(),
+			// Audio
+			m_audio->GetVoiceCount(), m_audio->GetVoiceRealCount(),
+			m_audio->GetBankSampleCount(), m_audio->GetBankSize() / 1048576.0,
+			// Scripting
+			scripts.instances, scripts.updates, scripts.deferred, scripts.time_ms,
 			// RHI
 			m_rhi_draw_calls,
 			m_rhi_bindings_buffer_index,
@@ -308,5 +338,12 @@ namespace Spartan
 		);
 
 		m_metrics = string(buffer);
+
+		// Scripts, per script class
+		for (const auto& stats : m_scripting->GetUpdateStats())
+		{
+			sprintf_s(buffer, "\n  %s:\t\t\t\t\t%d (%d updated, %d deferred, %.2f ms)", stats.name.c_str(), stats.instances, stats.updates, stats.deferred, stats.time_ms);
+			m_metrics += buffer;
+		}
 	}
 }
@@ -41,6 +41,9 @@ namespace Spartan
 	class Timer;
 	class ResourceCache;
 	class Renderer;
+	class Physics;
+	class Audio;
+	class Scripting;
     class Variant;
 
 	class SPARTAN_CLASS Profiler : public ISubsystem
@@ -162,5 +165,8 @@ namespace Spartan
 		// Dependencies
 		ResourceCache* m_resource_manager	= nullptr;
 		Renderer* m_renderer				= nullptr;
+		Physics* m_physics					= nullptr;
+		Audio* m_audio						= nullptr;
+		Scripting* m_scripting				= nullptr;
 	};
 }
@@ -24,14 +24,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifdef API_GRAPHICS_D3D11
 //================================
 
-//= INCLUDES =====================
+//= INCLUDES =======================================
 #include "../RHI_Texture2D.h"
 #include "../RHI_TextureCube.h"
 #include "../RHI_CommandList.h"
 #include "../../Math/MathHelper.h"
 #include "../../Math/Vector4.h"
 #include "../../Core/Settings.h"
-//================================
+#include "../../Resource/Import/TextureCompressor.h"
+//==================================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -86,10 +87,13 @@ namespace Spartan
 				return false;
 			}
 
+			// Block compressed formats are laid out in rows of 4x4 blocks
+			const auto row_pitch = TextureCompressor::IsCompressedFormat(format) ? TextureCompressor::GetBlockCountX(mip_width) * TextureCompressor::GetBlockSize(format) : mip_width * channels * (bpc / 8);
+
 			auto& subresource_data				= vec_subresource_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
-			subresource_data.pSysMem			= data[i].data();					// Data pointer		
-			subresource_data.SysMemPitch		= mip_width * channels * (bpc / 8);	// Line width in bytes
-			subresource_data.SysMemSlicePitch	= 0;								// This is only used for 3D textures
+			subresource_data.pSysMem			= data[i].data();	// Data pointer		
+			subresource_data.SysMemPitch		= row_pitch;		// Line width in bytes
+			subresource_data.SysMemSlicePitch	= 0;				// This is only used for 3D textures
 
 			// Compute size of next mip-map
 			mip_width	= Max(mip_width / 2, static_cast<uint32_t>(1));
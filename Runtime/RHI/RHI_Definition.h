@@ -51,6 +51,7 @@ namespace Spartan
 	struct RHI_Vertex_PosCol;
 	struct RHI_Vertex_PosUvCol;
 	struct RHI_Vertex_PosTexNorTan;
+	struct RHI_Vertex_PosTexNorTanBone;
 
 	enum RHI_Present_Mode : uint32_t
 	{
@@ -161,7 +162,19 @@ namespace Spartan
 		// RGBA
 		Format_R8G8B8A8_UNORM,
 		Format_R16G16B16A16_FLOAT,
-		Format_R32G32B32A32_FLOAT
+		Format_R32G32B32A32_FLOAT,
+		// Block compressed
+		Format_BC1_UNORM,
+		Format_BC3_UNORM,
+		Format_BC4_UNORM,
+		Format_BC5_UNORM,
+		Format_BC7_UNORM,
+		// Normalized integer (vertex attributes)
+		Format_R16G16_UNORM,
+		Format_R16G16_SNORM,
+		Format_R16G16B16A16_UNORM,
+		// Integer (vertex attributes)
+		Format_R8G8B8A8_UINT
 	};
 
 	enum RHI_Blend
@@ -75,7 +75,19 @@ static const DXGI_FORMAT d3d11_format[] =
     // RGBA
 	DXGI_FORMAT_R8G8B8A8_UNORM,
 	DXGI_FORMAT_R16G16B16A16_FLOAT,
-	DXGI_FORMAT_R32G32B32A32_FLOAT
+	DXGI_FORMAT_R32G32B32A32_FLOAT,
+    // Block compressed
+	DXGI_FORMAT_BC1_UNORM,
+	DXGI_FORMAT_BC3_UNORM,
+	DXGI_FORMAT_BC4_UNORM,
+	DXGI_FORMAT_BC5_UNORM,
+	DXGI_FORMAT_BC7_UNORM,
+    // Normalized integer (vertex attributes)
+	DXGI_FORMAT_R16G16_UNORM,
+	DXGI_FORMAT_R16G16_SNORM,
+	DXGI_FORMAT_R16G16B16A16_UNORM,
+    // Integer (vertex attributes)
+	DXGI_FORMAT_R8G8B8A8_UINT
 };
 
 static const D3D11_TEXTURE_ADDRESS_MODE d3d11_sampler_address_mode[] =
@@ -180,7 +192,19 @@ static const VkFormat vulkan_format[] =
     // RGBA
 	VK_FORMAT_R8G8B8A8_UNORM,
 	VK_FORMAT_R16G16B16A16_SFLOAT,
-	VK_FORMAT_R32G32B32A32_SFLOAT
+	VK_FORMAT_R32G32B32A32_SFLOAT,
+    // Block compressed
+	VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+	VK_FORMAT_BC3_UNORM_BLOCK,
+	VK_FORMAT_BC4_UNORM_BLOCK,
+	VK_FORMAT_BC5_UNORM_BLOCK,
+	VK_FORMAT_BC7_UNORM_BLOCK,
+    // Normalized integer (vertex attributes)
+	VK_FORMAT_R16G16_UNORM,
+	VK_FORMAT_R16G16_SNORM,
+	VK_FORMAT_R16G16B16A16_UNORM,
+    // Integer (vertex attributes)
+	VK_FORMAT_R8G8B8A8_UINT
 };
 
 static const VkSamplerAddressMode vulkan_sampler_address_mode[] =
@@ -62,7 +62,8 @@ namespace Spartan
 		template<typename T>
 		bool Create(void* vertex_shader_blob = nullptr)
 		{
-			uint32_t binding = 0;
+			uint32_t binding	= 0;
+			m_vertex_type		= RHI_Vertex_Type_To_Enum<T>();
 
 			if (RHI_Vertex_Type_To_Enum<T>() == RHI_Vertex_Type_Position)
 			{
@@ -111,6 +112,30 @@ namespace Spartan
 				};
 			}
 
+			if (RHI_Vertex_Type_To_Enum<T>() == RHI_Vertex_Type_PositionTextureNormalTangentQuantized)
+			{
+				m_vertex_attributes =
+				{
+					{ "POSITION",	0, binding, Format_R16G16B16A16_UNORM,	offsetof(RHI_Vertex_PosTexNorTan_Quantized, pos) },
+					{ "TEXCOORD",	1, binding, Format_R16G16_UNORM,		offsetof(RHI_Vertex_PosTexNorTan_Quantized, tex) },
+					{ "NORMAL",		2, binding, Format_R16G16_SNORM,		offsetof(RHI_Vertex_PosTexNorTan_Quantized, nor) },
+					{ "TANGENT",	3, binding, Format_R16G16_SNORM,		offsetof(RHI_Vertex_PosTexNorTan_Quantized, tan) }
+				};
+			}
+
+			if (RHI_Vertex_Type_To_Enum<T>() == RHI_Vertex_Type_PositionTextureNormalTangentBone)
+			{
+				m_vertex_attributes =
+				{
+					{ "POSITION",		0, binding, Format_R32G32B32_FLOAT,	offsetof(RHI_Vertex_PosTexNorTanBone, pos) },
+					{ "TEXCOORD",		1, binding, Format_R32G32_FLOAT,	offsetof(RHI_Vertex_PosTexNorTanBone, tex) },
+					{ "NORMAL",			2, binding, Format_R32G32B32_FLOAT,	offsetof(RHI_Vertex_PosTexNorTanBone, nor) },
+					{ "TANGENT",		3, binding, Format_R32G32B32_FLOAT,	offsetof(RHI_Vertex_PosTexNorTanBone, tan) },
+					{ "BLENDINDICES",	4, binding, Format_R8G8B8A8_UINT,	offsetof(RHI_Vertex_PosTexNorTanBone, bone_indices) },
+					{ "BLENDWEIGHT",	5, binding, Format_R8G8B8A8_UNORM,	offsetof(RHI_Vertex_PosTexNorTanBone, bone_weights) }
+				};
+			}
+
 			if (vertex_shader_blob && !m_vertex_attributes.empty())
 			{
 				return _CreateResource(vertex_shader_blob);
@@ -125,7 +150,7 @@ namespace Spartan
 		bool operator==(const RHI_InputLayout& rhs) const { return m_vertex_type == rhs.GetVertexType(); }
 
 	private:
-		RHI_Vertex_Type m_vertex_type;
+		RHI_Vertex_Type m_vertex_type = RHI_Vertex_Type_Unknown;
 
 		// API
 		bool _CreateResource(void* vertex_shader_blob);
@@ -142,6 +142,8 @@ namespace Spartan
 	template void RHI_Shader::CompileAsync<RHI_Vertex_PosCol>(Context*, const Shader_Type, const std::string&);
 	template void RHI_Shader::CompileAsync<RHI_Vertex_Pos2dTexCol8>(Context*, const Shader_Type, const std::string&);
 	template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan>(Context*, const Shader_Type, const std::string&);
+	template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan_Quantized>(Context*, const Shader_Type, const std::string&);
+	template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTanBone>(Context*, const Shader_Type, const std::string&);
 
 	template void* RHI_Shader::_Compile<RHI_Vertex_Undefined>(Shader_Type, const std::string&);
 	template void* RHI_Shader::_Compile<RHI_Vertex_Pos>(Shader_Type, const std::string&);
@@ -149,5 +151,7 @@ namespace Spartan
 	template void* RHI_Shader::_Compile<RHI_Vertex_PosCol>(Shader_Type, const std::string&);
 	template void* RHI_Shader::_Compile<RHI_Vertex_Pos2dTexCol8>(Shader_Type, const std::string&);
 	template void* RHI_Shader::_Compile<RHI_Vertex_PosTexNorTan>(Shader_Type, const std::string&);
+	template void* RHI_Shader::_Compile<RHI_Vertex_PosTexNorTan_Quantized>(Shader_Type, const std::string&);
+	template void* RHI_Shader::_Compile<RHI_Vertex_PosTexNorTanBone>(Shader_Type, const std::string&);
 	//===============================================================================================================
 }
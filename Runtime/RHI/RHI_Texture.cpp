@@ -31,6 +31,24 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace std;
 //==================
 
+namespace _RHI_Texture
+{
+	// Precedes the version, files without it predate the header and don't store their format
+	static const uint32_t file_magic	= 0x58455453; // "STEX"
+	static const uint32_t file_version	= 1;
+
+	// Returns the layout version of the file and leaves the stream at the byte count
+	uint32_t read_version(Spartan::FileStream* file)
+	{
+		if (file->ReadAs<uint32_t>() == file_magic)
+			return file->ReadAs<uint32_t>();
+
+		// No header, the first field is the byte count
+		file->Seek(0);
+		return 0;
+	}
+}
+
 namespace Spartan
 {
 	RHI_Texture::RHI_Texture(Context* context) : IResource(context, Resource_Texture)
@@ -46,53 +64,42 @@ namespace Spartan
 
 	bool RHI_Texture::SaveToFile(const string& file_path)
 	{
-		// Check to see if the file already exists (if so, get the byte count)
-		uint32_t byte_count = 0;
+		// If we hold no data, carry the bytes of the existing file over (files of an older layout are upgraded on the way)
+		if (m_data.empty() && FileSystem::FileExists(file_path))
 		{
-			if (FileSystem::FileExists(file_path))
+			auto file = make_unique<FileStream>(file_path, FileStream_Read);
+			if (file->IsOpen() && _RHI_Texture::read_version(file.get()) <= _RHI_Texture::file_version)
 			{
-				auto file = make_unique<FileStream>(file_path, FileStream_Read);
-				if (file->IsOpen())
+				file->Skip(sizeof(uint32_t)); // byte count
+				m_data.resize(file->ReadAs<uint32_t>());
+				for (auto& mip : m_data)
 				{
-					file->Read(&byte_count);
+					file->Read(&mip);
 				}
 			}
 		}
 
-		auto append = true;
-		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
+		auto file = make_unique<FileStream>(file_path, FileStream_Write);
 		if (!file->IsOpen())
 			return false;
 
-		// If the existing file has a byte count but we 
-		// hold no data, don't overwrite the file's bytes.
-		if (byte_count != 0 && m_data.empty())
+		// Write header
+		file->Write(_RHI_Texture::file_magic);
+		file->Write(_RHI_Texture::file_version);
+
+		// Write byte count
+		file->Write(GetByteCount());
+		// Write mipmap count
+		file->Write(static_cast<uint32_t>(m_data.size()));
+		// Write bytes
+		for (auto& mip : m_data)
 		{
-			file->Skip
-			(
-				sizeof(uint32_t) +	// byte count
-				sizeof(uint32_t) +	// mipmap count
-				byte_count			// bytes
-			);
+			file->Write(mip);
 		}
-		else
-		{
-			byte_count = GetByteCount();
-
-			// Write byte count
-			file->Write(byte_count);
-			// Write mipmap count
-			file->Write(static_cast<uint32_t>(m_data.size()));
-			// Write bytes
-			for (auto& mip : m_data)
-			{
-				file->Write(mip);
-			}
 
-			// The bytes have been saved, so we can now free some memory
-			m_data.clear();
-			m_data.shrink_to_fit();
-		}
+		// The bytes have been saved, so we can now free some memory
+		m_data.clear();
+		m_data.shrink_to_fit();
 
 		// Write properties
 		file->Write(m_bpp);
@@ -101,6 +108,7 @@ namespace Spartan
 		file->Write(m_channels);
 		file->Write(m_is_grayscale);
 		file->Write(m_is_transparent);
+		file->Write(static_cast<uint32_t>(m_format));
 		file->Write(GetId());
 		file->Write(GetResourceFilePath());
 
@@ -180,17 +188,19 @@ namespace Spartan
         else
         {
             auto file = make_unique<FileStream>(GetResourceFilePathNative(), FileStream_Read);
-            if (file->IsOpen())
+            if (file->IsOpen() && _RHI_Texture::read_version(file.get()) <= _RHI_Texture::file_version)
             {
                 auto byte_count = file->ReadAs<uint32_t>();
                 auto mip_count  = file->ReadAs<uint32_t>();
 
                 if (index < mip_count)
                 {
-                    for (uint32_t i = 0; i <= index; i++)
+                    // Skip the preceding mips without reading them
+                    for (uint32_t i = 0; i < index; i++)
                     {
-                        file->Read(&data);
+                        file->Skip(file->ReadAs<uint32_t>());
                     }
+                    file->Read(&data);
                 }
                 else
                 {
@@ -229,6 +239,13 @@ namespace Spartan
 		m_data.clear();
 		m_data.shrink_to_fit();
 
+		const auto version = _RHI_Texture::read_version(file.get());
+		if (version > _RHI_Texture::file_version)
+		{
+			LOGF_ERROR("\"%s\" was saved by a newer version of the engine", FileSystem::GetFileNameFromFilePath(file_path).c_str());
+			return false;
+		}
+
 		// Read byte and mipmap count
 		auto byte_count = file->ReadAs<uint32_t>();
         auto mip_count  = file->ReadAs<uint32_t>();
@@ -247,6 +264,10 @@ namespace Spartan
 		file->Read(&m_channels);
 		file->Read(&m_is_grayscale);
 		file->Read(&m_is_transparent);
+		if (version >= 1)
+		{
+			m_format = static_cast<RHI_Format>(file->ReadAs<uint32_t>());
+		}
 		SetId(file->ReadAs<uint32_t>());
 		SetResourceFilePath(file->ReadAs<string>());
 
@@ -271,6 +292,15 @@ namespace Spartan
 			case Format_R8G8B8A8_UNORM:		return 4;
 			case Format_R16G16B16A16_FLOAT:	return 4;
 			case Format_R32G32B32A32_FLOAT:	return 4;
+			case Format_BC1_UNORM:			return 4;
+			case Format_BC3_UNORM:			return 4;
+			case Format_BC4_UNORM:			return 1;
+			case Format_BC5_UNORM:			return 2;
+			case Format_BC7_UNORM:			return 4;
+			case Format_R16G16_UNORM:		return 2;
+			case Format_R16G16_SNORM:		return 2;
+			case Format_R16G16B16A16_UNORM:	return 4;
+			case Format_R8G8B8A8_UINT:		return 4;
 			default:						return 0;
 		}
 	}
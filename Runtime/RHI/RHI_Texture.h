@@ -37,6 +37,15 @@ namespace Spartan
 		RHI_Texture_DepthStencil	= 1 << 2,
 	};
 
+	// Tells the image importer what the texture holds, so it can pick a block compressed format
+	enum RHI_Texture_Usage : uint32_t
+	{
+		Texture_Usage_Generic,	// Stored uncompressed
+		Texture_Usage_Color,	// BC1, BC3 or BC7
+		Texture_Usage_Normal,	// BC5 (BC4 if the image turns out to be grayscale, e.g. a height map)
+		Texture_Usage_Mask		// BC4, single channel maps (roughness, metallic, occlusion etc)
+	};
+
 	class SPARTAN_CLASS RHI_Texture : public IResource
 	{
 	public:
@@ -72,6 +81,9 @@ namespace Spartan
 		auto GetFormat() const											{ return m_format; }
 		void SetFormat(const RHI_Format format)							{ m_format = format; }
 
+		auto GetUsage() const											{ return m_usage; }
+		void SetUsage(const RHI_Texture_Usage usage)					{ m_usage = usage; }
+
 		// Data
 		const auto& GetData() const										{ return m_data; }		
         void SetData(const std::vector<std::vector<std::byte>>& data)   { m_data = data; }
@@ -87,10 +99,11 @@ namespace Spartan
 		auto GetArraySize() const										{ return m_array_size; }
 		const auto& GetViewport() const									{ return m_viewport; }
 
+		static uint32_t GetChannelCountFromFormat(RHI_Format format);
+
 	protected:
 		bool LoadFromFile_NativeFormat(const std::string& file_path);
 		bool LoadFromFile_ForeignFormat(const std::string& file_path, bool generate_mipmaps);
-		static uint32_t GetChannelCountFromFormat(RHI_Format format);
 		virtual bool CreateResourceGpu() { return false; }
 
 		uint32_t m_bpp			= 0;
@@ -101,6 +114,7 @@ namespace Spartan
 		bool m_is_grayscale		= false;
 		bool m_is_transparent	= false;
 		RHI_Format m_format		= Format_R8G8B8A8_UNORM;
+		RHI_Texture_Usage m_usage	= Texture_Usage_Generic;
 		uint16_t m_bind_flags	= 0;
 		bool m_generate_mipmaps_when_loading = false;
 		RHI_Viewport m_viewport;
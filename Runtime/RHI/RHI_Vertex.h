@@ -127,11 +127,41 @@ namespace Spartan
 		float tan[3] = { 0 };
 	};
 
+	// Compact version of RHI_Vertex_PosTexNorTan (20 bytes instead of 44), see VertexQuantizer.
+	// Position and uv are unorm relative to the bounds of the mesh (w is padding), normal and tangent are snorm octahedral vectors.
+	struct RHI_Vertex_PosTexNorTan_Quantized
+	{
+		RHI_Vertex_PosTexNorTan_Quantized() = default;
+
+		uint16_t pos[4]	= { 0 };
+		uint16_t tex[2]	= { 0 };
+		int16_t nor[2]	= { 0 };
+		int16_t tan[2]	= { 0 };
+	};
+
+	// RHI_Vertex_PosTexNorTan plus up to four bone influences, what Skinning consumes (52 bytes).
+	// Weights are unorm and sum up to one, see Skinning.
+	struct RHI_Vertex_PosTexNorTanBone
+	{
+		RHI_Vertex_PosTexNorTanBone() = default;
+
+		float pos[3]				= { 0 };
+		float tex[2]				= { 0 };
+		float nor[3]				= { 0 };
+		float tan[3]				= { 0 };
+		uint8_t bone_indices[4]		= { 0 };
+		uint8_t bone_weights[4]		= { 0 };
+	};
+
 	static_assert(std::is_trivially_copyable<RHI_Vertex_Pos>::value,			"RHI_Vertex_Pos is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTex>::value,			"RHI_Vertex_PosTex is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosCol>::value,			"RHI_Vertex_PosCol is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_Pos2dTexCol8>::value,	"RHI_Vertex_Pos2dTexCol8 is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan>::value,	"RHI_Vertex_PosTexNorTan is not trivially copyable");
+	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan_Quantized>::value, "RHI_Vertex_PosTexNorTan_Quantized is not trivially copyable");
+	static_assert(sizeof(RHI_Vertex_PosTexNorTan_Quantized) == 20,				"RHI_Vertex_PosTexNorTan_Quantized has to be 20 bytes");
+	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTanBone>::value,	"RHI_Vertex_PosTexNorTanBone is not trivially copyable");
+	static_assert(sizeof(RHI_Vertex_PosTexNorTanBone) == 52,					"RHI_Vertex_PosTexNorTanBone has to be 52 bytes");
 
 	enum RHI_Vertex_Type
 	{
@@ -140,7 +170,9 @@ namespace Spartan
 		RHI_Vertex_Type_PositionColor,
 		RHI_Vertex_Type_PositionTexture,
 		RHI_Vertex_Type_PositionTextureNormalTangent,
-		RHI_Vertex_Type_Position2dTextureColor8
+		RHI_Vertex_Type_Position2dTextureColor8,
+		RHI_Vertex_Type_PositionTextureNormalTangentQuantized,
+		RHI_Vertex_Type_PositionTextureNormalTangentBone
 	};
 
 	template <typename T>
@@ -151,4 +183,6 @@ namespace Spartan
 	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosCol>()			{ return RHI_Vertex_Type_PositionColor; }
 	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_Pos2dTexCol8>()	{ return RHI_Vertex_Type_Position2dTextureColor8; }
 	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan>()	{ return RHI_Vertex_Type_PositionTextureNormalTangent; }
+	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan_Quantized>()	{ return RHI_Vertex_Type_PositionTextureNormalTangentQuantized; }
+	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTanBone>()		{ return RHI_Vertex_Type_PositionTextureNormalTangentBone; }
 }
@@ -24,12 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifdef API_GRAPHICS_VULKAN
 //================================
 
-//= INCLUDES =====================
+//= INCLUDES =======================================
 #include "../RHI_Device.h"
 #include "../RHI_Texture2D.h"
 #include "../RHI_TextureCube.h"
 #include "../../Math/MathHelper.h"
-//================================
+#include "../../Resource/Import/TextureCompressor.h"
+//==================================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -342,7 +343,14 @@ namespace Spartan
         // In case of a render target or a depth-stencil buffer, ensure the requested format is supported by the device
         VkFormat image_format       = vulkan_format[m_format];
         VkImageTiling image_tiling  = VK_IMAGE_TILING_LINEAR; // VK_IMAGE_TILING_OPTIMAL is not supported with VK_FORMAT_R32G32B32_SFLOAT
+        const bool compressed       = TextureCompressor::IsCompressedFormat(m_format);
         {
+            // Block compressed formats are only guaranteed to be sampleable with optimal tiling
+            if (compressed)
+            {
+                image_tiling = VK_IMAGE_TILING_OPTIMAL;
+            }
+
             if (m_bind_flags & RHI_Texture_RenderTarget)
             {
                 LOG_WARNING("Format is not supported as a render target, falling back to supported surface format");
@@ -363,7 +371,15 @@ namespace Spartan
 		VkDeviceMemory staging_buffer_memory = nullptr;
 		if (!m_data.empty())
 		{
-			VkDeviceSize buffer_size = static_cast<uint64_t>(m_width) * static_cast<uint64_t>(m_height) * static_cast<uint64_t>(m_channels);
+			// Only the top mip is uploaded, block compressed mips take a few bytes per 4x4 block instead of a few per texel
+			VkDeviceSize buffer_size = compressed ?
+				static_cast<uint64_t>(TextureCompressor::GetCompressedSize(m_width, m_height, m_format)) :
+				static_cast<uint64_t>(m_width) * static_cast<uint64_t>(m_height) * static_cast<uint64_t>(m_channels);
+			if (m_data.front().size() < buffer_size)
+			{
+				LOGF_ERROR("Mip 0 holds %d bytes, %d were expected", static_cast<uint32_t>(m_data.front().size()), static_cast<uint32_t>(buffer_size));
+				return false;
+			}
 
 			// Create buffer
 			if (!Vulkan_Common::buffer::create(m_rhi_device, staging_buffer, staging_buffer_memory, buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT))
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =====================
+#include <vector>
 #include "../Resource/IResource.h"
 #include "../Math/Matrix.h"
 //================================
@@ -75,6 +76,13 @@ namespace Spartan
 		void SetName(const std::string& name)   { m_name = name; }
 		void SetDuration(double duration)       { m_duration = duration; }
 		void SetTicksPerSec(double ticksPerSec) { m_ticksPerSec = ticksPerSec; }
+		const auto& GetName() const             { return m_name; }
+		auto GetDuration() const                { return m_duration; }	// In ticks
+		auto GetTicksPerSec() const             { return m_ticksPerSec; }
+
+		// Keys of a channel are sorted by time
+		void AddChannel(AnimationNode&& channel)    { m_channels.emplace_back(std::move(channel)); }
+		const auto& GetChannels() const             { return m_channels; }
 
 	private:
 		std::string m_name;
@@ -0,0 +1,540 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "AnimationClip.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "AnimationSampler.h"
+#include "../IO/FileStream.h"
+#include "../Logging/Log.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=============================
+
+namespace _AnimationClip
+{
+	// The three smallest components of a unit quaternion lie within +-1/sqrt(2)
+	static const float rotation_range		= 0.70710678f;
+	static const uint32_t cursor_max_steps	= 4;
+	static const uint32_t refine_attempts	= 8;
+
+	void pack_rotation(Quaternion rotation, uint16_t* packed)
+	{
+		rotation.Normalize();
+		const float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; i++)
+		{
+			largest = fabs(components[i]) > fabs(components[largest]) ? i : largest;
+		}
+
+		// q and -q are the same rotation, flip it so that the dropped component is positive and can be rebuilt
+		const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+		for (uint32_t i = 0, j = 0; i < 4; i++)
+		{
+			if (i == largest)
+				continue;
+
+			const float normalized = (components[i] * sign + rotation_range) / (2.0f * rotation_range);
+			packed[j++] = static_cast<uint16_t>(lround(clamp(normalized, 0.0f, 1.0f) * 32767.0f));
+		}
+
+		// 15 bits per component, the index of the dropped one goes in the top bits of the first two
+		packed[0] |= static_cast<uint16_t>((largest & 1) << 15);
+		packed[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+	}
+
+	Quaternion unpack_rotation(const uint16_t* packed)
+	{
+		const uint32_t largest = (packed[0] >> 15) | ((packed[1] >> 15) << 1);
+
+		float components[4];
+		float sum = 0.0f;
+		for (uint32_t i = 0, j = 0; i < 4; i++)
+		{
+			if (i == largest)
+				continue;
+
+			components[i] = (packed[j++] & 0x7FFF) / 32767.0f * 2.0f * rotation_range - rotation_range;
+			sum += components[i] * components[i];
+		}
+		components[largest] = sqrt(max(1.0f - sum, 0.0f));
+
+		return Quaternion(components[0], components[1], components[2], components[3]);
+	}
+
+	void pack_vector(const Vector3& value, const Vector3& min, const Vector3& extent, uint16_t* packed)
+	{
+		const float components[3]	= { value.x - min.x, value.y - min.y, value.z - min.z };
+		const float extents[3]		= { extent.x, extent.y, extent.z };
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			packed[i] = extents[i] > 0.0f ? static_cast<uint16_t>(lround(clamp(components[i] / extents[i], 0.0f, 1.0f) * 65535.0f)) : 0;
+		}
+	}
+
+	// Range of a track, over the frames which are kept
+	void compute_range(const vector<Vector3>& samples, const vector<uint32_t>& frames, Vector3* min, Vector3* extent)
+	{
+		auto max = samples[frames[0]];
+		*min = samples[frames[0]];
+		for (const auto frame : frames)
+		{
+			const auto& sample = samples[frame];
+			*min	= Vector3(std::min(min->x, sample.x), std::min(min->y, sample.y), std::min(min->z, sample.z));
+			max		= Vector3(std::max(max.x, sample.x), std::max(max.y, sample.y), std::max(max.z, sample.z));
+		}
+		*extent = max - *min;
+	}
+
+	Vector3 unpack_vector(const uint16_t* packed, const Vector3& min, const Vector3& extent)
+	{
+		return min + extent * Vector3(packed[0], packed[1], packed[2]) * (1.0f / 65535.0f);
+	}
+
+	// How far a bone's virtual vertices move because of a rotation or scale difference, reach is the distance to the farthest of them
+	float distance_position(const Vector3& a, const Vector3& b, float)			{ return Vector3::Distance(a, b); }
+	float distance_rotation(const Quaternion& a, const Quaternion& b, float reach)	{ const float dot = a.Dot(b); return 2.0f * reach * sqrt(max(1.0f - dot * dot, 0.0f)); }
+	float distance_scale(const Vector3& a, const Vector3& b, float reach)			{ const auto d = (a - b).Absolute(); return reach * max(d.x, max(d.y, d.z)); }
+
+	Vector3 interpolate(const Vector3& a, const Vector3& b, const float t)			{ return Lerp(a, b, t); }
+	Quaternion interpolate(const Quaternion& a, const Quaternion& b, const float t)	{ return Quaternion::Lerp(a, b, t); }
+
+	// Frames which have to be kept so that interpolating between them stays within tolerance of every sample
+	template<typename T, typename Distance>
+	vector<uint32_t> reduce(const vector<T>& samples, const float tolerance, const float reach, Distance distance)
+	{
+		vector<uint32_t> keys = { 0 };
+		const auto count = static_cast<uint32_t>(samples.size());
+
+		const auto constant = all_of(samples.begin(), samples.end(), [&](const T& sample) { return distance(sample, samples[0], reach) <= tolerance; });
+		if (constant)
+			return keys;
+
+		const auto fits = [&](const uint32_t first, const uint32_t last)
+		{
+			for (uint32_t i = first + 1; i < last; i++)
+			{
+				const auto t = static_cast<float>(i - first) / (last - first);
+				if (distance(interpolate(samples[first], samples[last], t), samples[i], reach) > tolerance)
+					return false;
+			}
+			return true;
+		};
+
+		// Greedy, every key reaches as far as it can
+		uint32_t first = 0;
+		while (first + 1 < count)
+		{
+			auto last = first + 1;
+			while (last + 1 < count && fits(first, last + 1))
+			{
+				last++;
+			}
+			keys.emplace_back(last);
+			first = last;
+		}
+
+		return keys;
+	}
+
+	// Index (relative to the track) of the last key at or before frame, and how far frame is towards the next one
+	template<typename Key>
+	uint32_t find_key(const Key* keys, const uint32_t count, const float frame, uint32_t* cursor, float* t)
+	{
+		const auto search = [keys, count, frame]()
+		{
+			const auto it = upper_bound(keys, keys + count, frame, [](const float f, const Key& key) { return f < key.frame; });
+			return it == keys ? 0 : static_cast<uint32_t>(distance(keys, it)) - 1;
+		};
+
+		// Playing forward only ever moves the cursor a key or two along
+		auto index = cursor ? *cursor : count;
+		if (index < count && keys[index].frame <= frame)
+		{
+			uint32_t steps = 0;
+			while (index + 1 < count && keys[index + 1].frame <= frame && steps++ < cursor_max_steps)
+			{
+				index++;
+			}
+
+			if (index + 1 < count && keys[index + 1].frame <= frame)
+			{
+				index = search();
+			}
+		}
+		else
+		{
+			index = search();
+		}
+
+		if (cursor)
+		{
+			*cursor = index;
+		}
+
+		*t = (index + 1 < count && frame > keys[index].frame) ? (frame - keys[index].frame) / (keys[index + 1].frame - keys[index].frame) : 0.0f;
+		return index;
+	}
+}
+
+namespace Spartan
+{
+	bool AnimationClip::Compress(const shared_ptr<Animation>& animation, const Skeleton& skeleton, const Animation_Compression_Settings& settings)
+	{
+		if (!animation || skeleton.GetBoneCount() == 0 || settings.sample_rate <= 0.0f || settings.error <= 0.0f)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		AnimationSampler sampler(animation, skeleton);
+		const auto duration		= sampler.GetDuration();
+		const auto frame_count	= static_cast<uint32_t>(ceil(duration * settings.sample_rate)) + 1;
+		if (frame_count > frame_count_max)
+		{
+			LOGF_ERROR("\"%s\" is too long, clips can have %d frames at most", animation->GetName().c_str(), frame_count_max);
+			return false;
+		}
+
+		m_name				= animation->GetName();
+		m_frame_count		= frame_count;
+		m_sample_rate		= duration > 0.0 ? static_cast<float>((frame_count - 1) / duration) : settings.sample_rate; // The last frame lands on the end
+		m_shell_distance	= settings.shell_distance;
+
+		// Resample, bone major
+		const auto bone_count	= skeleton.GetBoneCount();
+		const auto& bones		= skeleton.GetBones();
+		vector<vector<Vector3>> positions(bone_count, vector<Vector3>(frame_count));
+		vector<vector<Quaternion>> rotations(bone_count, vector<Quaternion>(frame_count));
+		vector<vector<Vector3>> scales(bone_count, vector<Vector3>(frame_count));
+		vector<Bone_Transform> pose;
+		for (uint32_t frame = 0; frame < frame_count; frame++)
+		{
+			skeleton.GetBindPose(&pose);
+			sampler.Sample(frame / static_cast<double>(m_sample_rate), false, &pose);
+
+			for (uint32_t bone = 0; bone < bone_count; bone++)
+			{
+				positions[bone][frame]	= pose[bone].position;
+				rotations[bone][frame]	= pose[bone].rotation;
+				scales[bone][frame]		= pose[bone].scale;
+			}
+		}
+
+		// Only bones which a channel drives get keys, the rest keep their pose
+		vector<bool> animated(bone_count, false);
+		for (const auto& channel : animation->GetChannels())
+		{
+			const auto bone = skeleton.FindBone(channel.name);
+			if (bone < bone_count)
+			{
+				animated[bone] = true;
+			}
+		}
+
+		// Distance from each bone to its farthest virtual vertex, including the ones of its descendants
+		vector<float> reach(bone_count, settings.shell_distance);
+		for (auto i = static_cast<int32_t>(bone_count) - 1; i >= 0; i--)
+		{
+			const auto parent = bones[i].parent;
+			if (parent >= 0)
+			{
+				reach[parent] = max(reach[parent], reach[i] + bones[i].bind.position.Length());
+			}
+		}
+
+		// Errors along a chain add up, so the tolerance of each track is tightened until the whole clip is within the error
+		auto tolerance = settings.error / 3.0f;
+		Animation_Compression_Error error;
+		float error_previous = numeric_limits<float>::max();
+		for (uint32_t attempt = 0; attempt < _AnimationClip::refine_attempts; attempt++)
+		{
+			m_tracks.assign(bone_count, Track());
+			m_positions.clear();
+			m_rotations.clear();
+			m_scales.clear();
+
+			for (uint32_t bone = 0; bone < bone_count; bone++)
+			{
+				if (!animated[bone])
+					continue;
+
+				auto& track = m_tracks[bone];
+
+				// Positions
+				const auto position_keys = _AnimationClip::reduce(positions[bone], tolerance, reach[bone], _AnimationClip::distance_position);
+				_AnimationClip::compute_range(positions[bone], position_keys, &track.position_min, &track.position_extent);
+				track.offset[0]	= static_cast<uint32_t>(m_positions.size());
+				track.count[0]	= static_cast<uint32_t>(position_keys.size());
+				for (const auto frame : position_keys)
+				{
+					Key key;
+					key.frame = static_cast<uint16_t>(frame);
+					_AnimationClip::pack_vector(positions[bone][frame], track.position_min, track.position_extent, key.value);
+					m_positions.emplace_back(key);
+				}
+
+				// Rotations
+				const auto rotation_keys = _AnimationClip::reduce(rotations[bone], tolerance, reach[bone], _AnimationClip::distance_rotation);
+				track.offset[1]	= static_cast<uint32_t>(m_rotations.size());
+				track.count[1]	= static_cast<uint32_t>(rotation_keys.size());
+				for (const auto frame : rotation_keys)
+				{
+					Key key;
+					key.frame = static_cast<uint16_t>(frame);
+					_AnimationClip::pack_rotation(rotations[bone][frame], key.value);
+					m_rotations.emplace_back(key);
+				}
+
+				// Scales
+				const auto scale_keys = _AnimationClip::reduce(scales[bone], tolerance, reach[bone], _AnimationClip::distance_scale);
+				_AnimationClip::compute_range(scales[bone], scale_keys, &track.scale_min, &track.scale_extent);
+				track.offset[2]	= static_cast<uint32_t>(m_scales.size());
+				track.count[2]	= static_cast<uint32_t>(scale_keys.size());
+				for (const auto frame : scale_keys)
+				{
+					Key key;
+					key.frame = static_cast<uint16_t>(frame);
+					_AnimationClip::pack_vector(scales[bone][frame], track.scale_min, track.scale_extent, key.value);
+					m_scales.emplace_back(key);
+				}
+			}
+
+			// Stop once quantization dominates, tighter tolerances would only add keys
+			error = MeasureError(animation, skeleton);
+			if (error.error_max <= settings.error || error.error_max >= error_previous * 0.95f)
+				break;
+
+			error_previous	= error.error_max;
+			tolerance		*= 0.5f;
+		}
+
+		// Uncompressed size, for comparison
+		uint64_t size_raw = 0;
+		for (const auto& channel : animation->GetChannels())
+		{
+			size_raw += channel.positionFrames.size() * sizeof(KeyVector) + channel.rotationFrames.size() * sizeof(KeyQuaternion) + channel.scaleFrames.size() * sizeof(KeyVector);
+		}
+
+		LOGF_INFO("\"%s\": %d keys, %.1f KB (%.1f KB uncompressed), error %f (max) %f (average)",
+			m_name.c_str(), GetKeyCount(), GetMemoryUsage() / 1024.0f, size_raw / 1024.0f, error.error_max, error.error_average
+		);
+
+		if (error.error_max > settings.error)
+		{
+			LOGF_WARNING("\"%s\" exceeds the error of %f at bone %d", m_name.c_str(), settings.error, error.bone);
+		}
+
+		return true;
+	}
+
+	void AnimationClip::Sample(double time, const bool loop, vector<Bone_Transform>* pose, AnimationClip_Cursor* cursor) const
+	{
+		if (!pose || pose->size() < m_tracks.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		const auto duration = GetDuration();
+		if (duration <= 0.0)
+		{
+			time = 0.0;
+		}
+		else if (loop)
+		{
+			time = fmod(time, duration);
+			time = time < 0.0 ? time + duration : time;
+		}
+		else
+		{
+			time = time < 0.0 ? 0.0 : (time > duration ? duration : time);
+		}
+
+		const auto frame = static_cast<float>(time * m_sample_rate);
+		if (cursor)
+		{
+			cursor->keys.resize(m_tracks.size() * 3, 0);
+		}
+
+		for (uint32_t i = 0; i < GetTrackCount(); i++)
+		{
+			const auto& track	= m_tracks[i];
+			auto& transform		= (*pose)[i];
+			auto cursors		= cursor ? &cursor->keys[i * 3] : nullptr;
+			float t				= 0.0f;
+
+			if (track.count[0] != 0)
+			{
+				const auto keys		= &m_positions[track.offset[0]];
+				const auto index	= _AnimationClip::find_key(keys, track.count[0], frame, cursors ? &cursors[0] : nullptr, &t);
+				const auto value	= _AnimationClip::unpack_vector(keys[index].value, track.position_min, track.position_extent);
+				transform.position	= t == 0.0f ? value : Lerp(value, _AnimationClip::unpack_vector(keys[index + 1].value, track.position_min, track.position_extent), t);
+			}
+
+			if (track.count[1] != 0)
+			{
+				const auto keys		= &m_rotations[track.offset[1]];
+				const auto index	= _AnimationClip::find_key(keys, track.count[1], frame, cursors ? &cursors[1] : nullptr, &t);
+				const auto value	= _AnimationClip::unpack_rotation(keys[index].value);
+				transform.rotation	= t == 0.0f ? value : Quaternion::Lerp(value, _AnimationClip::unpack_rotation(keys[index + 1].value), t);
+			}
+
+			if (track.count[2] != 0)
+			{
+				const auto keys		= &m_scales[track.offset[2]];
+				const auto index	= _AnimationClip::find_key(keys, track.count[2], frame, cursors ? &cursors[2] : nullptr, &t);
+				const auto value	= _AnimationClip::unpack_vector(keys[index].value, track.scale_min, track.scale_extent);
+				transform.scale		= t == 0.0f ? value : Lerp(value, _AnimationClip::unpack_vector(keys[index + 1].value, track.scale_min, track.scale_extent), t);
+			}
+		}
+	}
+
+	Animation_Compression_Error AnimationClip::MeasureError(const shared_ptr<Animation>& animation, const Skeleton& skeleton) const
+	{
+		Animation_Compression_Error error;
+		if (!animation || skeleton.GetBoneCount() != GetTrackCount())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return error;
+		}
+
+		// A bone and three virtual vertices around it
+		const Vector3 vertices[4] = { Vector3::Zero, Vector3(m_shell_distance, 0.0f, 0.0f), Vector3(0.0f, m_shell_distance, 0.0f), Vector3(0.0f, 0.0f, m_shell_distance) };
+
+		AnimationSampler sampler(animation, skeleton);
+		vector<Bone_Transform> pose_reference;
+		vector<Bone_Transform> pose_compressed;
+		vector<Matrix> model_reference;
+		vector<Matrix> model_compressed;
+		double error_sum = 0.0;
+		for (uint32_t frame = 0; frame < m_frame_count; frame++)
+		{
+			const auto time = frame / static_cast<double>(m_sample_rate);
+			skeleton.GetBindPose(&pose_reference);
+			skeleton.GetBindPose(&pose_compressed);
+			sampler.Sample(time, false, &pose_reference);
+			Sample(time, false, &pose_compressed);
+			skeleton.ComputeModelSpace(pose_reference, &model_reference);
+			skeleton.ComputeModelSpace(pose_compressed, &model_compressed);
+
+			for (uint32_t bone = 0; bone < skeleton.GetBoneCount(); bone++)
+			{
+				float bone_error = 0.0f;
+				for (const auto& vertex : vertices)
+				{
+					bone_error = max(bone_error, Vector3::Distance(vertex * model_reference[bone], vertex * model_compressed[bone]));
+				}
+
+				error_sum += bone_error;
+				if (bone_error > error.error_max)
+				{
+					error.error_max	= bone_error;
+					error.bone		= bone;
+					error.time		= time;
+				}
+			}
+		}
+		error.error_average = static_cast<float>(error_sum / (static_cast<double>(m_frame_count) * skeleton.GetBoneCount()));
+
+		return error;
+	}
+
+	void AnimationClip::Serialize(FileStream* stream) const
+	{
+		stream->Write(m_name);
+		stream->Write(m_frame_count);
+		stream->Write(m_sample_rate);
+		stream->Write(m_shell_distance);
+
+		stream->Write(GetTrackCount());
+		stream->WriteBytes(m_tracks.data(), m_tracks.size() * sizeof(Track));
+		for (const auto keys : { &m_positions, &m_rotations, &m_scales })
+		{
+			stream->Write(static_cast<uint32_t>(keys->size()));
+			stream->WriteBytes(keys->data(), keys->size() * sizeof(Key));
+		}
+	}
+
+	bool AnimationClip::Deserialize(FileStream* stream)
+	{
+		stream->Read(&m_name);
+		stream->Read(&m_frame_count);
+		stream->Read(&m_sample_rate);
+		stream->Read(&m_shell_distance);
+		if (m_frame_count > frame_count_max || !(m_sample_rate > 0.0f))
+		{
+			LOGF_ERROR("\"%s\" has an invalid frame count or sample rate, the file is corrupt", m_name.c_str());
+			return false;
+		}
+
+		// Counts come from the file, they can't claim more than what is left of it
+		const auto track_count = stream->ReadAs<uint32_t>();
+		if (track_count > stream->GetRemaining() / sizeof(Track))
+		{
+			LOGF_ERROR("\"%s\" claims more tracks than the data holds, the file is corrupt", m_name.c_str());
+			return false;
+		}
+		m_tracks.resize(track_count);
+		stream->ReadBytes(m_tracks.data(), m_tracks.size() * sizeof(Track));
+
+		for (const auto keys : { &m_positions, &m_rotations, &m_scales })
+		{
+			const auto key_count = stream->ReadAs<uint32_t>();
+			if (key_count > stream->GetRemaining() / sizeof(Key))
+			{
+				LOGF_ERROR("\"%s\" claims more keys than the data holds, the file is corrupt", m_name.c_str());
+				return false;
+			}
+			keys->resize(key_count);
+			stream->ReadBytes(keys->data(), keys->size() * sizeof(Key));
+		}
+
+		// Sampling indexes the keys with the tracks, which have to stay within them
+		const vector<Key>* keys[3] = { &m_positions, &m_rotations, &m_scales };
+		for (const auto& track : m_tracks)
+		{
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				if (static_cast<uint64_t>(track.offset[i]) + track.count[i] > keys[i]->size())
+				{
+					LOGF_ERROR("\"%s\" has a track outside of its keys, the file is corrupt", m_name.c_str());
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	uint64_t AnimationClip::GetMemoryUsage() const
+	{
+		return sizeof(AnimationClip) + m_tracks.size() * sizeof(Track) + (m_positions.size() + m_rotations.size() + m_scales.size()) * sizeof(Key);
+	}
+}
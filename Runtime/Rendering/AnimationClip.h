@@ -0,0 +1,116 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <vector>
+#include <memory>
+#include "Animation.h"
+#include "Skeleton.h"
+//=============================
+
+namespace Spartan
+{
+	class FileStream;
+
+	struct Animation_Compression_Settings
+	{
+		float sample_rate		= 30.0f;	// Keys are resampled at this many frames per second before they are reduced
+		float error				= 0.005f;	// Largest distance any bone or virtual vertex may drift from the original animation, in model units
+		float shell_distance	= 0.1f;		// Distance of the virtual vertices from their bone, roughly how far skin sits from it
+	};
+
+	// Model space deviation of a compressed clip from the animation it was built from, measured on the virtual vertices of every bone
+	struct Animation_Compression_Error
+	{
+		float error_max		= 0.0f;
+		float error_average	= 0.0f;
+		uint32_t bone		= 0;	// Where the largest error occurs
+		double time			= 0.0;	// When it occurs, in seconds
+	};
+
+	// Per instance sampling state. Many instances can share a clip while each one keeps finding its next keys in constant time.
+	struct AnimationClip_Cursor
+	{
+		std::vector<uint32_t> keys;
+	};
+
+	// A compressed animation, built for a skeleton. Keys are resampled at a fixed rate and only the ones that can't be interpolated
+	// within the error from their neighbours are kept. Rotations are stored in 48 bits (smallest three), positions and scales as 16 bit
+	// offsets within the range of their track, and every key carries a 16 bit frame. There is one track per bone, in bone order, and
+	// the keys of each track are contiguous, so a pose is sampled in a single forward sweep.
+	class SPARTAN_CLASS AnimationClip
+	{
+	public:
+		AnimationClip() = default;
+		~AnimationClip() = default;
+
+		bool Compress(const std::shared_ptr<Animation>& animation, const Skeleton& skeleton, const Animation_Compression_Settings& settings = Animation_Compression_Settings());
+
+		// Time is in seconds, it wraps around when looping and is clamped otherwise. Bones without
+		// a track keep the transform they have in the pose (e.g. the bind pose).
+		void Sample(double time, bool loop, std::vector<Bone_Transform>* pose, AnimationClip_Cursor* cursor = nullptr) const;
+
+		// Compares against the animation the clip was compressed from, frame by frame. Rotation quantization
+		// alone turns a bone by up to about 1e-4 radians, which sets a floor for the error of long chains.
+		Animation_Compression_Error MeasureError(const std::shared_ptr<Animation>& animation, const Skeleton& skeleton) const;
+
+		// Keys are written as they are, the source animation isn't needed to read them back
+		void Serialize(FileStream* stream) const;
+		bool Deserialize(FileStream* stream);
+
+		const auto& GetName() const		{ return m_name; }
+		double GetDuration() const		{ return m_frame_count > 1 ? (m_frame_count - 1) / static_cast<double>(m_sample_rate) : 0.0; }
+		auto GetTrackCount() const		{ return static_cast<uint32_t>(m_tracks.size()); }
+		uint32_t GetKeyCount() const	{ return static_cast<uint32_t>(m_positions.size() + m_rotations.size() + m_scales.size()); }
+		uint64_t GetMemoryUsage() const;
+
+		// 16 bit frames
+		static const uint32_t frame_count_max = 65536;
+
+	private:
+		struct Key
+		{
+			uint16_t frame;
+			uint16_t value[3];
+		};
+
+		struct Track
+		{
+			uint32_t offset[3]	= { 0, 0, 0 };	// Position, rotation and scale keys
+			uint32_t count[3]	= { 0, 0, 0 };
+			Math::Vector3 position_min;
+			Math::Vector3 position_extent;
+			Math::Vector3 scale_min;
+			Math::Vector3 scale_extent;
+		};
+
+		std::string m_name;
+		std::vector<Track> m_tracks;
+		std::vector<Key> m_positions;
+		std::vector<Key> m_rotations;
+		std::vector<Key> m_scales;
+		uint32_t m_frame_count	= 0;
+		float m_sample_rate		= 30.0f;
+		float m_shell_distance	= 0.1f;
+	};
+}
@@ -0,0 +1,168 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "AnimationSampler.h"
+#include <cmath>
+#include "../Logging/Log.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=============================
+
+namespace _AnimationSampler
+{
+	// Past this many keys since the last sample, a binary search is cheaper than walking
+	static const uint32_t cursor_max_steps = 4;
+
+	template<typename Key>
+	uint32_t find_key(const vector<Key>& keys, const double time, uint32_t* cursor)
+	{
+		auto index = *cursor;
+
+		// Playing forward only ever moves the cursor a key or two along
+		if (index < keys.size() && keys[index].time <= time)
+		{
+			uint32_t steps = 0;
+			while (index + 1 < keys.size() && keys[index + 1].time <= time && steps++ < cursor_max_steps)
+			{
+				index++;
+			}
+
+			if (index + 1 < keys.size() && keys[index + 1].time <= time)
+			{
+				index = AnimationSampler::FindKey(keys, time);
+			}
+		}
+		else
+		{
+			index = AnimationSampler::FindKey(keys, time);
+		}
+
+		*cursor = index;
+		return index;
+	}
+
+	// Returns the interpolation factor between the key at index and the next one
+	template<typename Key>
+	float key_factor(const vector<Key>& keys, const uint32_t index, const double time)
+	{
+		if (index + 1 >= keys.size() || time <= keys[index].time)
+			return 0.0f;
+
+		const auto span = keys[index + 1].time - keys[index].time;
+		return span > 0.0 ? static_cast<float>((time - keys[index].time) / span) : 0.0f;
+	}
+
+	Vector3 sample(const vector<KeyVector>& keys, const double time, uint32_t* cursor)
+	{
+		const auto index	= find_key(keys, time, cursor);
+		const auto t		= key_factor(keys, index, time);
+		return t == 0.0f ? keys[index].value : Lerp(keys[index].value, keys[index + 1].value, t);
+	}
+
+	Quaternion sample(const vector<KeyQuaternion>& keys, const double time, uint32_t* cursor)
+	{
+		const auto index	= find_key(keys, time, cursor);
+		const auto t		= key_factor(keys, index, time);
+		return t == 0.0f ? keys[index].value : Quaternion::Lerp(keys[index].value, keys[index + 1].value, t);
+	}
+}
+
+namespace Spartan
+{
+	AnimationSampler::AnimationSampler(const shared_ptr<Animation>& animation, const Skeleton& skeleton)
+	{
+		m_animation = animation;
+		if (!m_animation)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Channels which don't drive a bone of this skeleton are dropped
+		for (const auto& node : m_animation->GetChannels())
+		{
+			const auto bone = skeleton.FindBone(node.name);
+			if (bone == skeleton.GetBoneCount())
+				continue;
+
+			Channel channel;
+			channel.node = &node;
+			channel.bone = bone;
+			m_channels.emplace_back(channel);
+		}
+	}
+
+	void AnimationSampler::Sample(const double time, const bool loop, vector<Bone_Transform>* pose)
+	{
+		if (!m_animation || !pose)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Keys are in ticks
+		const auto duration	= m_animation->GetDuration();
+		auto ticks			= time * m_animation->GetTicksPerSec();
+		if (duration <= 0.0)
+		{
+			ticks = 0.0;
+		}
+		else if (loop)
+		{
+			ticks = fmod(ticks, duration);
+			ticks = ticks < 0.0 ? ticks + duration : ticks;
+		}
+		else
+		{
+			ticks = ticks < 0.0 ? 0.0 : (ticks > duration ? duration : ticks);
+		}
+
+		for (auto& channel : m_channels)
+		{
+			if (channel.bone >= pose->size())
+				continue;
+
+			auto& transform = (*pose)[channel.bone];
+			if (!channel.node->positionFrames.empty())
+			{
+				transform.position = _AnimationSampler::sample(channel.node->positionFrames, ticks, &channel.cursor_position);
+			}
+			if (!channel.node->rotationFrames.empty())
+			{
+				transform.rotation = _AnimationSampler::sample(channel.node->rotationFrames, ticks, &channel.cursor_rotation);
+			}
+			if (!channel.node->scaleFrames.empty())
+			{
+				transform.scale = _AnimationSampler::sample(channel.node->scaleFrames, ticks, &channel.cursor_scale);
+			}
+		}
+	}
+
+	double AnimationSampler::GetDuration() const
+	{
+		return (m_animation && m_animation->GetTicksPerSec() > 0.0) ? m_animation->GetDuration() / m_animation->GetTicksPerSec() : 0.0;
+	}
+}
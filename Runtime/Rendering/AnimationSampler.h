@@ -0,0 +1,71 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =================
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "Animation.h"
+#include "Skeleton.h"
+//============================
+
+namespace Spartan
+{
+	// Samples an animation into a skeleton pose. Channels are matched to bones by name once, and every channel remembers
+	// the keys it was last sampled at, so playback finds the next keys in constant time. Any other jump falls back to a binary search.
+	class SPARTAN_CLASS AnimationSampler
+	{
+	public:
+		AnimationSampler(const std::shared_ptr<Animation>& animation, const Skeleton& skeleton);
+		~AnimationSampler() = default;
+
+		// Time is in seconds, it wraps around when looping and is clamped otherwise. Bones
+		// without a channel keep the transform they have in the pose (e.g. the bind pose).
+		void Sample(double time, bool loop, std::vector<Bone_Transform>* pose);
+
+		// In seconds
+		double GetDuration() const;
+		auto GetChannelCount() const { return static_cast<uint32_t>(m_channels.size()); }
+
+		// Index of the last key at or before time (the first key if time precedes them all), keys have to be sorted by time
+		template<typename Key>
+		static uint32_t FindKey(const std::vector<Key>& keys, const double time)
+		{
+			const auto it = std::upper_bound(keys.begin(), keys.end(), time, [](const double t, const Key& key) { return t < key.time; });
+			return it == keys.begin() ? 0 : static_cast<uint32_t>(std::distance(keys.begin(), it)) - 1;
+		}
+
+	private:
+		struct Channel
+		{
+			const AnimationNode* node	= nullptr;
+			uint32_t bone				= 0;
+			uint32_t cursor_position	= 0;
+			uint32_t cursor_rotation	= 0;
+			uint32_t cursor_scale		= 0;
+		};
+
+		std::shared_ptr<Animation> m_animation;
+		std::vector<Channel> m_channels;
+	};
+}
@@ -235,12 +235,12 @@ namespace Spartan
 
 	shared_ptr<RHI_VertexBuffer> TransformHandle::GetVertexBuffer() const
 	{
-		return m_model->GetVertexBuffer();
+		return m_model->GetSubmesh(0)->vertex_buffer;
 	}
 
 	shared_ptr<RHI_IndexBuffer> TransformHandle::GetIndexBuffer() const
 	{
-		return m_model->GetIndexBuffer();
+		return m_model->GetSubmesh(0)->index_buffer;
 	}
 
 	void TransformHandle::SnapToTransform(const TransformHandle_Space space, const shared_ptr<Entity>& entity, Camera* camera, const float handle_size)
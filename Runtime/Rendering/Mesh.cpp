@@ -33,6 +33,15 @@ using namespace Spartan::Math;
 namespace Spartan
 {
 	void Mesh::Geometry_Clear()
+	{
+		Geometry_Release();
+		m_lods.clear();
+		m_clusters.clear();
+		m_collision.clear();
+		m_skin.clear();
+	}
+
+	void Mesh::Geometry_Release()
 	{
 		m_vertices.clear();
 		m_vertices.shrink_to_fit();
@@ -45,13 +54,14 @@ namespace Spartan
 		uint32_t size = 0;
 		size += uint32_t(m_vertices.size()	* sizeof(RHI_Vertex_PosTexNorTan));
 		size += uint32_t(m_indices.size()	* sizeof(uint32_t));
+		size += uint32_t(m_skin.size()		* sizeof(RHI_Vertex_PosTexNorTanBone));
 
 		return size;
 	}
 
 	void Mesh::Geometry_Get(uint32_t indexOffset, uint32_t indexCount, uint32_t vertexOffset, unsigned vertexCount, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices)
 	{
-		if (indexOffset == 0 || indexCount == 0 || vertexOffset == 0 || vertexCount == 0 || !vertices || !indices)
+		if (indexCount == 0 || vertexCount == 0 || indexOffset + indexCount > m_indices.size() || vertexOffset + vertexCount > m_vertices.size() || !vertices || !indices)
 		{
 			LOG_ERROR("Mesh::Geometry_Get: Invalid parameters");
 			return;
@@ -97,4 +107,48 @@ namespace Spartan
 
 		m_indices.insert(m_indices.end(), indices.begin(), indices.end());
 	}
+
+	void Mesh::Lod_Append(const uint32_t indexOffset, const vector<uint32_t>& indices, const float error)
+	{
+		Mesh_Lod lod;
+		lod.error = error;
+		Indices_Append(indices, &lod.index_offset);
+		lod.index_count = static_cast<uint32_t>(indices.size());
+
+		m_lods[indexOffset].emplace_back(lod);
+	}
+
+	const vector<Mesh_Lod>& Mesh::Lods_Get(const uint32_t indexOffset) const
+	{
+		static const vector<Mesh_Lod> empty;
+
+		const auto it = m_lods.find(indexOffset);
+		return it != m_lods.end() ? it->second : empty;
+	}
+
+	void Mesh::Clusters_Set(const uint32_t indexOffset, const vector<Mesh_Cluster>& clusters)
+	{
+		auto& destination = m_clusters[indexOffset];
+		destination = clusters;
+		for (auto& cluster : destination)
+		{
+			cluster.index_offset += indexOffset;
+		}
+	}
+
+	const vector<Mesh_Cluster>& Mesh::Clusters_Get(const uint32_t indexOffset) const
+	{
+		static const vector<Mesh_Cluster> empty;
+
+		const auto it = m_clusters.find(indexOffset);
+		return it != m_clusters.end() ? it->second : empty;
+	}
+
+	const Mesh_Collision& Mesh::Collision_Get(const uint32_t indexOffset) const
+	{
+		static const Mesh_Collision empty;
+
+		const auto it = m_collision.find(indexOffset);
+		return it != m_collision.end() ? it->second : empty;
+	}
 }
@@ -22,12 +22,41 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =====================
+#include <map>
 #include <vector>
+#include <cstddef>
 #include "../RHI/RHI_Definition.h"
+#include "../Math/Vector3.h"
 //================================
 
 namespace Spartan
 {
+	// A simplified version of some geometry, it indexes the same vertices
+	struct Mesh_Lod
+	{
+		uint32_t index_offset	= 0;
+		uint32_t index_count	= 0;
+		float error				= 0.0f; // Geometric error, relative to the extent of the geometry
+	};
+
+	// A small group of triangles, contiguous in the index buffer, that can be culled on its own
+	struct Mesh_Cluster
+	{
+		uint32_t index_offset		= 0;
+		uint32_t index_count		= 0;
+		Math::Vector3 center		= Math::Vector3::Zero;	// Bounding sphere
+		float radius				= 0.0f;
+		Math::Vector3 cone_axis		= Math::Vector3::Zero;	// Normal cone, the triangles are back facing to any view direction within it
+		float cone_cutoff			= 1.0f;					// Sine of the spread of the normals, one means never back facing
+	};
+
+	// Physics shapes of some geometry, cooked on import so that colliders don't have to build them
+	struct Mesh_Collision
+	{
+		std::vector<std::byte> bvh;							// Serialized bounding volume hierarchy of the triangles, specific to the platform that wrote it
+		std::vector<std::vector<Math::Vector3>> hulls;		// Convex decomposition
+	};
+
 	class Mesh
 	{
 	public:
@@ -36,6 +65,7 @@ namespace Spartan
 
 		// Geometry
 		void Geometry_Clear();
+		void Geometry_Release(); // Frees the vertices and indices but keeps the LODs, clusters and collision data, which don't need them
 		void Geometry_Get(
 			uint32_t indexOffset,
 			uint32_t indexCount,
@@ -59,6 +89,25 @@ namespace Spartan
 		void Indices_Set(const std::vector<uint32_t>& indices)	{ m_indices = indices; }
 		uint32_t Indices_Count() const							{ return static_cast<uint32_t>(m_indices.size()); }
 		void Indices_Append(const std::vector<uint32_t>& indices, uint32_t* indexOffset);
+
+		// LODs, keyed by the index offset of the geometry they simplify
+		void Lod_Append(uint32_t indexOffset, const std::vector<uint32_t>& indices, float error);
+		const std::vector<Mesh_Lod>& Lods_Get(uint32_t indexOffset) const;
+		std::map<uint32_t, std::vector<Mesh_Lod>>& Lods_Get() { return m_lods; }
+
+		// Clusters, keyed by the index offset of the geometry they partition (their index offsets are relative to it when set)
+		void Clusters_Set(uint32_t indexOffset, const std::vector<Mesh_Cluster>& clusters);
+		const std::vector<Mesh_Cluster>& Clusters_Get(uint32_t indexOffset) const;
+		std::map<uint32_t, std::vector<Mesh_Cluster>>& Clusters_Get() { return m_clusters; }
+
+		// Collision, keyed by the index offset of the geometry it was cooked from
+		void Collision_Set(uint32_t indexOffset, Mesh_Collision&& collision) { m_collision[indexOffset] = std::move(collision); }
+		const Mesh_Collision& Collision_Get(uint32_t indexOffset) const;
+		std::map<uint32_t, Mesh_Collision>& Collision_Get() { return m_collision; }
+
+		// Bone influences, one vertex per vertex of the geometry and in the same order, empty if it isn't skinned
+		void Skin_Set(std::vector<RHI_Vertex_PosTexNorTanBone>&& vertices)	{ m_skin = std::move(vertices); }
+		const std::vector<RHI_Vertex_PosTexNorTanBone>& Skin_Get() const	{ return m_skin; }
 	
 		// Misc
 		uint32_t GetTriangleCount() const { return Indices_Count() / 3; }	
@@ -66,5 +115,9 @@ namespace Spartan
 	private:
 		std::vector<RHI_Vertex_PosTexNorTan> m_vertices;
 		std::vector<uint32_t> m_indices;
+		std::map<uint32_t, std::vector<Mesh_Lod>> m_lods;
+		std::map<uint32_t, std::vector<Mesh_Cluster>> m_clusters;
+		std::map<uint32_t, Mesh_Collision> m_collision;
+		std::vector<RHI_Vertex_PosTexNorTanBone> m_skin;
 	};
 }
@@ -20,11 +20,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES ================================
+#include <cstring>
+#include <algorithm>
 #include "Model.h"
 #include "Mesh.h"
+#include "Skinning.h"
+#include "Skeleton.h"
+#include "AnimationClip.h"
 #include "Renderer.h"
 #include "../IO/FileStream.h"
 #include "../Core/Stopwatch.h"
+#include "../Threading/Threading.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/Import/ModelImporter.h"
 #include "../World/Entity.h"
@@ -32,6 +38,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Renderable.h"
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_IndexBuffer.h"
+#include "../RHI/RHI_ConstantBuffer.h"
 #include "../RHI/RHI_Texture2D.h"
 //===========================================
 
@@ -42,11 +49,255 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	namespace _Model
+	{
+		// Files written before the submesh table start with the length of a path, which is never this large
+		static const uint32_t file_magic	= 0x4C444F4D; // "MODL"
+		static const uint32_t file_version	= 5; // 2: submesh streaming flag, 3: collision, 4: skeleton, animation clips and skin, 5: quantized chunks
+
+		// Smallest size that an entry of each table can take in the file, see read_count()
+		static const uint64_t table_entry_size_min	= sizeof(uint32_t) * 2 + sizeof(BoundingBox) + sizeof(uint32_t) * 4 + sizeof(uint64_t) * 2 + sizeof(uint32_t) * 2; // name, material, aabb, offsets, counts, chunk, LOD and cluster counts
+		static const uint64_t chain_size_min		= sizeof(uint32_t) * 2;	// key and count
+		static const uint64_t lod_size				= sizeof(uint32_t) * 2 + sizeof(float);
+		static const uint64_t cluster_size			= sizeof(uint32_t) * 2 + sizeof(Vector3) * 2 + sizeof(float) * 2;
+		static const uint64_t collision_size_min	= sizeof(uint32_t) * 3;	// key, BVH size and hull count
+		static const uint64_t clip_size_min			= sizeof(uint32_t) * 6 + sizeof(float) * 2; // name, frame count, sample rate, shell distance, track and key counts
+
+		// Counts come from the file, so a corrupt one could claim billions of entries. Every entry takes
+		// at least entry_size_min bytes, which bounds the count by what is left of the file.
+		uint32_t read_count(FileStream* file, const uint64_t entry_size_min)
+		{
+			const auto count		= file->ReadAs<uint32_t>();
+			const auto count_max	= file->GetRemaining() / entry_size_min;
+			if (count > count_max)
+			{
+				LOGF_WARNING("Count of %d exceeds the %d entries that the data can hold, the file is corrupt", count, static_cast<uint32_t>(count_max));
+				return static_cast<uint32_t>(count_max);
+			}
+
+			return count;
+		}
+
+		// A chunk holds everything that a submesh drops when it unloads, and its bone influences (empty unless it's skinned).
+		// Quantized geometry is stored as the 20 byte vertices that the GPU gets, with the parameters that decode them, so a
+		// chunk reads back on its own even if the model's parameters change after it was written.
+		void write_chunk(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<RHI_Vertex_PosTexNorTanBone>& skin, const Vertex_Quantization* quantization, vector<std::byte>* chunk)
+		{
+			FileStream stream(chunk, FileStream_Write);
+			stream.Write(indices);
+			stream.Write(quantization != nullptr);
+			if (quantization)
+			{
+				vector<RHI_Vertex_PosTexNorTan_Quantized> vertices_quantized;
+				VertexQuantizer::Quantize(vertices, *quantization, &vertices_quantized);
+				stream.Write(quantization->position_offset);
+				stream.Write(quantization->position_scale);
+				stream.Write(quantization->uv_offset);
+				stream.Write(quantization->uv_scale);
+				stream.Write(vertices_quantized);
+			}
+			else
+			{
+				stream.Write(vertices);
+			}
+			stream.Write(skin);
+		}
+
+		// The skin is optional, chunks of files older than version 4 have none. Quantized vertices are decoded.
+		bool read_chunk(FileStream* file, const uint32_t version, const uint64_t chunk_file_offset, const Model_Submesh& submesh, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices, vector<RHI_Vertex_PosTexNorTanBone>* skin = nullptr)
+		{
+			vector<RHI_Vertex_PosTexNorTanBone> skin_unused;
+			skin = skin ? skin : &skin_unused;
+
+			const auto chunk_start = chunk_file_offset + submesh.chunk_offset;
+			file->Seek(chunk_start);
+			file->Read(indices);
+			if (version >= 5 && file->ReadAs<bool>())
+			{
+				Vertex_Quantization quantization;
+				file->Read(&quantization.position_offset);
+				file->Read(&quantization.position_scale);
+				file->Read(&quantization.uv_offset);
+				file->Read(&quantization.uv_scale);
+
+				vector<RHI_Vertex_PosTexNorTan_Quantized> vertices_quantized;
+				file->Read(&vertices_quantized);
+				VertexQuantizer::Dequantize(vertices_quantized, quantization, vertices);
+			}
+			else
+			{
+				file->Read(vertices);
+			}
+			skin->clear();
+			if (version >= 4)
+			{
+				file->Read(skin);
+			}
+
+			// Reading past the end of the file yields zeros, so a truncated chunk ends up with the wrong size
+			if (file->GetPosition() != chunk_start + submesh.chunk_size || vertices->empty() || (!skin->empty() && skin->size() != vertices->size()))
+			{
+				indices->clear();
+				indices->shrink_to_fit();
+				vertices->clear();
+				vertices->shrink_to_fit();
+				skin->clear();
+				skin->shrink_to_fit();
+				return false;
+			}
+
+			return true;
+		}
+
+		bool read_chunk(FileStream* file, const uint32_t version, const uint64_t chunk_file_offset, Model_Submesh* submesh)
+		{
+			vector<RHI_Vertex_PosTexNorTanBone> skin;
+			if (!read_chunk(file, version, chunk_file_offset, *submesh, &submesh->mesh->Indices_Get(), &submesh->mesh->Vertices_Get(), &skin))
+				return false;
+
+			if (!skin.empty())
+			{
+				submesh->mesh->Skin_Set(move(skin));
+			}
+
+			return true;
+		}
+
+		// The table keeps everything that's needed to decide whether to load a submesh
+		void write_table_entry(FileStream* file, const Model_Submesh& submesh, const uint64_t chunk_offset, const uint64_t chunk_size)
+		{
+			file->Write(submesh.name);
+			file->Write(submesh.material);
+			file->Write(submesh.aabb);
+			file->Write(submesh.index_offset);
+			file->Write(submesh.index_count);
+			file->Write(submesh.vertex_offset);
+			file->Write(submesh.vertex_count);
+			file->Write(chunk_offset);
+			file->Write(chunk_size);
+
+			// LODs
+			file->Write(static_cast<uint32_t>(submesh.mesh->Lods_Get().size()));
+			for (const auto& chain : submesh.mesh->Lods_Get())
+			{
+				file->Write(chain.first);
+				file->Write(static_cast<uint32_t>(chain.second.size()));
+				for (const auto& lod : chain.second)
+				{
+					file->Write(lod.index_offset);
+					file->Write(lod.index_count);
+					file->Write(lod.error);
+				}
+			}
+
+			// Clusters
+			file->Write(static_cast<uint32_t>(submesh.mesh->Clusters_Get().size()));
+			for (const auto& chain : submesh.mesh->Clusters_Get())
+			{
+				file->Write(chain.first);
+				file->Write(static_cast<uint32_t>(chain.second.size()));
+				for (const auto& cluster : chain.second)
+				{
+					file->Write(cluster.index_offset);
+					file->Write(cluster.index_count);
+					file->Write(cluster.center);
+					file->Write(cluster.radius);
+					file->Write(cluster.cone_axis);
+					file->Write(cluster.cone_cutoff);
+				}
+			}
+
+			// Collision
+			file->Write(static_cast<uint32_t>(submesh.mesh->Collision_Get().size()));
+			for (const auto& entry : submesh.mesh->Collision_Get())
+			{
+				file->Write(entry.first);
+				file->Write(entry.second.bvh);
+				file->Write(static_cast<uint32_t>(entry.second.hulls.size()));
+				for (const auto& hull : entry.second.hulls)
+				{
+					file->Write(static_cast<uint32_t>(hull.size()));
+					file->WriteBytes(hull.data(), hull.size() * sizeof(Vector3));
+				}
+			}
+		}
+
+		void read_lods(FileStream* file, Mesh* mesh)
+		{
+			const auto lod_chain_count = read_count(file, chain_size_min);
+			for (uint32_t i = 0; i < lod_chain_count; i++)
+			{
+				auto& lods = mesh->Lods_Get()[file->ReadAs<uint32_t>()];
+				lods.resize(read_count(file, lod_size));
+				for (auto& lod : lods)
+				{
+					file->Read(&lod.index_offset);
+					file->Read(&lod.index_count);
+					file->Read(&lod.error);
+				}
+			}
+		}
+
+		void read_clusters(FileStream* file, Mesh* mesh)
+		{
+			const auto cluster_chain_count = read_count(file, chain_size_min);
+			for (uint32_t i = 0; i < cluster_chain_count; i++)
+			{
+				auto& clusters = mesh->Clusters_Get()[file->ReadAs<uint32_t>()];
+				clusters.resize(read_count(file, cluster_size));
+				for (auto& cluster : clusters)
+				{
+					file->Read(&cluster.index_offset);
+					file->Read(&cluster.index_count);
+					file->Read(&cluster.center);
+					file->Read(&cluster.radius);
+					file->Read(&cluster.cone_axis);
+					file->Read(&cluster.cone_cutoff);
+				}
+			}
+		}
+
+		void read_collision(FileStream* file, Mesh* mesh)
+		{
+			const auto collision_count = read_count(file, collision_size_min);
+			for (uint32_t i = 0; i < collision_count; i++)
+			{
+				auto& collision = mesh->Collision_Get()[file->ReadAs<uint32_t>()];
+				file->Read(&collision.bvh);
+				collision.hulls.resize(read_count(file, sizeof(uint32_t)));
+				for (auto& hull : collision.hulls)
+				{
+					hull.resize(read_count(file, sizeof(Vector3)));
+					file->ReadBytes(hull.data(), hull.size() * sizeof(Vector3));
+				}
+			}
+		}
+
+		void read_table_entry(FileStream* file, const uint32_t version, Model_Submesh* submesh)
+		{
+			submesh->mesh = make_shared<Mesh>();
+			file->Read(&submesh->name);
+			file->Read(&submesh->material);
+			file->Read(&submesh->aabb);
+			file->Read(&submesh->index_offset);
+			file->Read(&submesh->index_count);
+			file->Read(&submesh->vertex_offset);
+			file->Read(&submesh->vertex_count);
+			file->Read(&submesh->chunk_offset);
+			file->Read(&submesh->chunk_size);
+			read_lods(file, submesh->mesh.get());
+			read_clusters(file, submesh->mesh.get());
+			if (version >= 3)
+			{
+				read_collision(file, submesh->mesh.get());
+			}
+		}
+	}
+
 	Model::Model(Context* context) : IResource(context, Resource_Model)
 	{
 		m_resource_manager	= m_context->GetSubsystem<ResourceCache>().get();
 		m_rhi_device		= m_context->GetSubsystem<Renderer>()->GetRhiDevice();
-		m_mesh				= make_unique<Mesh>();
 	}
 
 	Model::~Model()
@@ -57,12 +308,15 @@ namespace Spartan
     void Model::Clear()
     {
         m_root_entity.reset();
-        m_vertex_buffer.reset();
-        m_index_buffer.reset();
-        m_mesh->Geometry_Clear();
+        m_submeshes.clear();
+        m_chunk_file_path.clear();
+        m_chunk_file_offset = 0;
+        m_chunk_file_version = 0;
+        m_vertex_quantization_buffer.reset();
         m_aabb.Undefine();
         m_normalized_scale = 1.0f;
         m_is_animated = false;
+        m_vertex_quantized = false;
     }
 
 	bool Model::LoadFromFile(const string& file_path)
@@ -83,12 +337,86 @@ namespace Spartan
             if (!file->IsOpen())
                 return false;
 
-            SetResourceFilePath(file->ReadAs<string>());
-            file->Read(&m_normalized_scale);
-            file->Read(&m_mesh->Indices_Get());
-            file->Read(&m_mesh->Vertices_Get());
+            m_submeshes.clear();
+            if (file->ReadAs<uint32_t>() != _Model::file_magic)
+            {
+                file->Seek(0);
+                LoadFromFileLegacy(file.get());
+            }
+            else
+            {
+                const auto version = file->ReadAs<uint32_t>();
+                if (version > _Model::file_version)
+                {
+                    LOGF_ERROR("\"%s\" has an unsupported version (%d)", file_path.c_str(), static_cast<int>(version));
+                    return false;
+                }
+
+                SetResourceFilePath(file->ReadAs<string>());
+                file->Read(&m_normalized_scale);
+                file->Read(&m_vertex_quantized);
+                file->Read(&m_vertex_quantization.position_offset);
+                file->Read(&m_vertex_quantization.position_scale);
+                file->Read(&m_vertex_quantization.uv_offset);
+                file->Read(&m_vertex_quantization.uv_scale);
+                if (version >= 2)
+                {
+                    file->Read(&m_submesh_streaming);
+                }
+
+                // Skeleton and animation clips, the table follows them so they can't be skipped when corrupt
+                m_skeleton.reset();
+                m_animation_clips.clear();
+                if (version >= 4)
+                {
+                    if (file->ReadAs<bool>())
+                    {
+                        m_skeleton = make_shared<Skeleton>();
+                        if (!m_skeleton->Deserialize(file.get()))
+                        {
+                            LOGF_ERROR("Failed to read the skeleton of \"%s\"", file_path.c_str());
+                            return false;
+                        }
+                    }
+
+                    m_animation_clips.resize(_Model::read_count(file.get(), _Model::clip_size_min));
+                    for (auto& clip : m_animation_clips)
+                    {
+                        clip = make_shared<AnimationClip>();
+                        if (!clip->Deserialize(file.get()))
+                        {
+                            LOGF_ERROR("Failed to read the animation clips of \"%s\"", file_path.c_str());
+                            return false;
+                        }
+                    }
+                }
+
+                // Submesh table
+                m_submeshes.resize(_Model::read_count(file.get(), _Model::table_entry_size_min));
+                for (auto& submesh : m_submeshes)
+                {
+                    _Model::read_table_entry(file.get(), version, &submesh);
+                }
+                m_chunk_file_path       = file_path;
+                m_chunk_file_offset     = file->GetPosition();
+                m_chunk_file_version    = version;
 
-            UpdateGeometry();
+                // The table alone provides the bounds, the chunks are only read if the model isn't streamed
+                m_aabb = !m_submeshes.empty() ? m_submeshes.front().aabb : BoundingBox();
+                for (auto& submesh : m_submeshes)
+                {
+                    m_aabb.Merge(submesh.aabb);
+
+                    if (m_submesh_streaming)
+                        continue;
+
+                    if (!_Model::read_chunk(file.get(), m_chunk_file_version, m_chunk_file_offset, &submesh) || !GeometryCreateBuffers(&submesh))
+                    {
+                        LOGF_ERROR("Failed to load submesh \"%s\" of \"%s\"", submesh.name.c_str(), file_path.c_str());
+                    }
+                }
+                GeometryCreateQuantizationBuffer();
+            }
         }
         // Load foreign format
         else
@@ -114,23 +442,136 @@ namespace Spartan
 		return true;
 	}
 
+	void Model::LoadFromFileLegacy(FileStream* file)
+	{
+		// Path, scale, every index, every vertex, LOD chains, the quantization flag and cluster chains. Every offset
+		// is relative to the start of the model, so it all becomes one submesh which starts there.
+		Model_Submesh submesh;
+		submesh.mesh = make_shared<Mesh>();
+
+		SetResourceFilePath(file->ReadAs<string>());
+		file->Read(&m_normalized_scale);
+		file->Read(&submesh.mesh->Indices_Get());
+		file->Read(&submesh.mesh->Vertices_Get());
+		_Model::read_lods(file, submesh.mesh.get());
+		file->Read(&m_vertex_quantized);
+		_Model::read_clusters(file, submesh.mesh.get());
+
+		submesh.name			= GetResourceName();
+		submesh.aabb			= BoundingBox(submesh.mesh->Vertices_Get());
+		submesh.index_count		= submesh.mesh->Indices_Count();
+		submesh.vertex_count	= submesh.mesh->Vertices_Count();
+		m_submeshes.emplace_back(move(submesh));
+
+		// Vertices are stored dequantized, quantizing them again yields the same GPU data
+		UpdateGeometry();
+	}
+
 	bool Model::SaveToFile(const string& file_path)
 	{
+		// Chunks of unloaded submeshes are copied as they are, before the file they come from is possibly overwritten
+		vector<vector<std::byte>> chunks(m_submeshes.size());
+		const auto quantization = m_vertex_quantized ? &m_vertex_quantization : nullptr;
+		{
+			unique_ptr<FileStream> source;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(m_submeshes.size()); i++)
+			{
+				const auto& submesh = m_submeshes[i];
+				if (submesh.mesh->Vertices_Count() != 0)
+				{
+					_Model::write_chunk(submesh.mesh->Indices_Get(), submesh.mesh->Vertices_Get(), submesh.mesh->Skin_Get(), quantization, &chunks[i]);
+					continue;
+				}
+
+				if (!source)
+				{
+					source = make_unique<FileStream>(m_chunk_file_path, FileStream_Read);
+					if (!source->IsOpen())
+						return false;
+				}
+
+				// Chunks in the current layout are copied as they are, older ones are written again
+				if (m_chunk_file_version == _Model::file_version)
+				{
+					source->Seek(m_chunk_file_offset + submesh.chunk_offset);
+					chunks[i].resize(submesh.chunk_size);
+					source->ReadBytes(chunks[i].data(), submesh.chunk_size);
+					continue;
+				}
+
+				vector<uint32_t> indices;
+				vector<RHI_Vertex_PosTexNorTan> vertices;
+				vector<RHI_Vertex_PosTexNorTanBone> skin;
+				if (!_Model::read_chunk(source.get(), m_chunk_file_version, m_chunk_file_offset, submesh, &indices, &vertices, &skin))
+				{
+					LOGF_ERROR("Failed to read submesh \"%s\" from \"%s\"", submesh.name.c_str(), m_chunk_file_path.c_str());
+					return false;
+				}
+				_Model::write_chunk(indices, vertices, skin, quantization, &chunks[i]);
+			}
+		}
+
 		auto file = make_unique<FileStream>(file_path, FileStream_Write);
 		if (!file->IsOpen())
 			return false;
 
+		file->Write(_Model::file_magic);
+		file->Write(_Model::file_version);
 		file->Write(GetResourceFilePath());
 		file->Write(m_normalized_scale);
-		file->Write(m_mesh->Indices_Get());
-		file->Write(m_mesh->Vertices_Get());
+		file->Write(m_vertex_quantized);
+		file->Write(m_vertex_quantization.position_offset);
+		file->Write(m_vertex_quantization.position_scale);
+		file->Write(m_vertex_quantization.uv_offset);
+		file->Write(m_vertex_quantization.uv_scale);
+		file->Write(m_submesh_streaming);
+
+		// Skeleton and animation clips
+		file->Write(m_skeleton != nullptr);
+		if (m_skeleton)
+		{
+			m_skeleton->Serialize(file.get());
+		}
+		file->Write(static_cast<uint32_t>(m_animation_clips.size()));
+		for (const auto& clip : m_animation_clips)
+		{
+			clip->Serialize(file.get());
+		}
+
+		// Submesh table
+		vector<uint64_t> chunk_offsets(m_submeshes.size());
+		uint64_t chunk_offset = 0;
+		file->Write(static_cast<uint32_t>(m_submeshes.size()));
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_submeshes.size()); i++)
+		{
+			chunk_offsets[i] = chunk_offset;
+			_Model::write_table_entry(file.get(), m_submeshes[i], chunk_offset, chunks[i].size());
+			chunk_offset += chunks[i].size();
+		}
+
+		// Chunks
+		const auto chunk_file_offset = file->GetPosition();
+		for (const auto& chunk : chunks)
+		{
+			file->WriteBytes(chunk.data(), chunk.size());
+		}
 
         file->Close();
 
+		// Submeshes stream from the new file from now on
+		m_chunk_file_path		= file_path;
+		m_chunk_file_offset		= chunk_file_offset;
+		m_chunk_file_version	= _Model::file_version;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_submeshes.size()); i++)
+		{
+			m_submeshes[i].chunk_offset	= chunk_offsets[i];
+			m_submeshes[i].chunk_size	= chunks[i].size();
+		}
+
 		return true;
 	}
 
-	void Model::AppendGeometry(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* index_offset, uint32_t* vertex_offset) const
+	void Model::AppendGeometry(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* index_offset, uint32_t* vertex_offset, const string& name)
 	{
 		if (indices.empty() || vertices.empty())
 		{
@@ -138,96 +579,378 @@ namespace Spartan
 			return;
 		}
 
-		// Append indices and vertices to the main mesh
-		m_mesh->Indices_Append(indices, index_offset);
-		m_mesh->Vertices_Append(vertices, vertex_offset);
+		// Model wide offsets keep counting where the previous submesh ended, its LODs don't count as they live in its own buffer
+		Model_Submesh submesh;
+		submesh.name			= name;
+		submesh.aabb			= BoundingBox(vertices);
+		submesh.index_offset	= m_submeshes.empty() ? 0 : m_submeshes.back().index_offset + m_submeshes.back().index_count;
+		submesh.index_count		= static_cast<uint32_t>(indices.size());
+		submesh.vertex_offset	= m_submeshes.empty() ? 0 : m_submeshes.back().vertex_offset + m_submeshes.back().vertex_count;
+		submesh.vertex_count	= static_cast<uint32_t>(vertices.size());
+		submesh.mesh			= make_shared<Mesh>();
+		submesh.mesh->Indices_Append(indices, nullptr);
+		submesh.mesh->Vertices_Append(vertices, nullptr);
+
+		if (index_offset)	*index_offset	= submesh.index_offset;
+		if (vertex_offset)	*vertex_offset	= submesh.vertex_offset;
+
+		m_submeshes.emplace_back(move(submesh));
 	}
 
 	void Model::GetGeometry(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
 	{
-		m_mesh->Geometry_Get(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
+		const auto submesh = GetSubmesh(FindSubmesh(index_offset));
+		if (!submesh || submesh->mesh->Vertices_Count() == 0)
+		{
+			LOGF_ERROR("The geometry of \"%s\" at index offset %d isn't loaded", GetResourceName().c_str(), static_cast<int>(index_offset));
+			return;
+		}
+
+		submesh->mesh->Geometry_Get(index_offset - submesh->index_offset, index_count, vertex_offset - submesh->vertex_offset, vertex_count, indices, vertices);
 	}
 
-	void Model::UpdateGeometry()
+	void Model::AppendGeometryLod(const uint32_t index_offset, const vector<uint32_t>& indices, const float error)
 	{
-		if (m_mesh->Indices_Count() == 0 || m_mesh->Vertices_Count() == 0)
+		const auto index = FindSubmesh(index_offset);
+		if (indices.empty() || index == m_submeshes.size())
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
 
-		GeometryCreateBuffers();
-		m_normalized_scale	= GeometryComputeNormalizedScale();
-		m_aabb				= BoundingBox(m_mesh->Vertices_Get());
+		auto& submesh = m_submeshes[index];
+		submesh.mesh->Lod_Append(index_offset - submesh.index_offset, indices, error);
 	}
 
-	void Model::AddMaterial(shared_ptr<Material>& material, const shared_ptr<Entity>& entity)
+	const vector<Mesh_Lod>& Model::GetGeometryLods(const uint32_t index_offset) const
 	{
-		if (!material || !entity)
+		static const vector<Mesh_Lod> empty;
+
+		const auto submesh = GetSubmesh(FindSubmesh(index_offset));
+		return submesh ? submesh->mesh->Lods_Get(index_offset - submesh->index_offset) : empty;
+	}
+
+	void Model::SetGeometryClusters(const uint32_t index_offset, const vector<Mesh_Cluster>& clusters)
+	{
+		const auto index = FindSubmesh(index_offset);
+		if (clusters.empty() || index == m_submeshes.size())
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
 
-		// Create a file path for this material
-        string spartan_asset_path = FileSystem::GetDirectoryFromFilePath(GetResourceFilePathNative()) + material->GetResourceName() + EXTENSION_MATERIAL;
-		material->SetResourceFilePath(spartan_asset_path);
+		auto& submesh = m_submeshes[index];
+		submesh.mesh->Clusters_Set(index_offset - submesh.index_offset, clusters);
+	}
 
-		// Create a Renderable and pass the material to it
-        auto renderable = entity->AddComponent<Renderable>();
-        renderable->SetMaterial(material);
+	const vector<Mesh_Cluster>& Model::GetGeometryClusters(const uint32_t index_offset) const
+	{
+		static const vector<Mesh_Cluster> empty;
+
+		const auto submesh = GetSubmesh(FindSubmesh(index_offset));
+		return submesh ? submesh->mesh->Clusters_Get(index_offset - submesh->index_offset) : empty;
 	}
 
-	void Model::AddAnimation(shared_ptr<Animation>& animation)
+	void Model::SetGeometryCollision(const uint32_t index_offset, Mesh_Collision&& collision)
 	{
-		if (!animation)
+		const auto index = FindSubmesh(index_offset);
+		if (index == m_submeshes.size())
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
 
-		m_is_animated = true;
+		auto& submesh = m_submeshes[index];
+		submesh.mesh->Collision_Set(index_offset - submesh.index_offset, move(collision));
+	}
+
+	const Mesh_Collision& Model::GetGeometryCollision(const uint32_t index_offset) const
+	{
+		static const Mesh_Collision empty;
+
+		const auto submesh = GetSubmesh(FindSubmesh(index_offset));
+		return submesh ? submesh->mesh->Collision_Get(index_offset - submesh->index_offset) : empty;
 	}
 
-	void Model::AddTexture(shared_ptr<Material>& material, const TextureType texture_type, const string& file_path)
+	void Model::SetGeometrySkin(const uint32_t index_offset, vector<RHI_Vertex_PosTexNorTanBone>&& vertices)
 	{
-		if (!material || file_path.empty())
+		const auto index = FindSubmesh(index_offset);
+		if (index == m_submeshes.size() || vertices.size() != m_submeshes[index].vertex_count)
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
 
-		// Try to get the texture
-		const auto tex_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
-		if (auto texture = m_context->GetSubsystem<ResourceCache>()->GetByName<RHI_Texture2D>(tex_name))
+		m_submeshes[index].mesh->Skin_Set(move(vertices));
+	}
+
+	bool Model::SubmeshSkin(const uint32_t index, const vector<Matrix>& skinning)
+	{
+		if (index >= m_submeshes.size() || skinning.empty())
 		{
-			material->SetTextureSlot(texture_type, texture);
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
 		}
-		// If we didn't get a texture, it's not cached, hence we have to load it and cache it now
-		else
+
+		auto& submesh		= m_submeshes[index];
+		const auto& skin	= submesh.mesh->Skin_Get();
+		if (skin.empty() || !submesh.IsLoaded() || m_vertex_quantized)
+			return false;
+
+		// The static vertex buffer is swapped for a dynamic one the first time the submesh is skinned
+		if (!submesh.skinned)
 		{
-			// Load texture
-			auto generate_mipmaps = true;
-            texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
-			texture->LoadFromFile(file_path);
+			auto vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
+			if (!vertex_buffer->CreateDynamic<RHI_Vertex_PosTexNorTan>(static_cast<uint32_t>(skin.size())))
+			{
+				LOGF_ERROR("Failed to create skinned vertex buffer for \"%s\".", submesh.name.c_str());
+				return false;
+			}
+			submesh.vertex_buffer	= vertex_buffer;
+			submesh.skinned			= true;
+		}
+
+		vector<RHI_Vertex_PosTexNorTan> vertices;
+		Skinning::Skin(skin, skinning, &vertices, m_context->GetSubsystem<Threading>().get());
+
+		auto buffer = submesh.vertex_buffer->Map();
+		if (!buffer)
+			return false;
+
+		memcpy(buffer, vertices.data(), vertices.size() * sizeof(RHI_Vertex_PosTexNorTan));
+		return submesh.vertex_buffer->Unmap();
+	}
+
+	void Model::UpdateGeometry()
+	{
+		if (m_submeshes.empty())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Every submesh decodes with the same parameters, so they can only be recomputed while all the geometry is at hand
+		const auto all_loaded = all_of(m_submeshes.begin(), m_submeshes.end(), [](const Model_Submesh& submesh) { return submesh.mesh->Vertices_Count() != 0; });
+		if (m_vertex_quantized && all_loaded)
+		{
+			vector<RHI_Vertex_PosTexNorTan> vertices;
+			for (const auto& submesh : m_submeshes)
+			{
+				vertices.insert(vertices.end(), submesh.mesh->Vertices_Get().begin(), submesh.mesh->Vertices_Get().end());
+			}
+			m_vertex_quantization = VertexQuantizer::ComputeQuantization(vertices);
+		}
+
+		// Quantize first, so that the CPU vertices, the bounding boxes and the vertex buffers agree
+		Vertex_Quantization_Error error;
+		m_aabb = m_submeshes.front().aabb;
+		for (auto& submesh : m_submeshes)
+		{
+			if (submesh.mesh->Vertices_Count() != 0)
+			{
+				Vertex_Quantization_Error submesh_error;
+				GeometryCreateBuffers(&submesh, &submesh_error);
+				submesh.aabb = BoundingBox(submesh.mesh->Vertices_Get());
+
+				error.position	= Max(error.position, submesh_error.position);
+				error.uv		= Max(error.uv, submesh_error.uv);
+				error.normal	= Max(error.normal, submesh_error.normal);
+				error.tangent	= Max(error.tangent, submesh_error.tangent);
+			}
+			m_aabb.Merge(submesh.aabb);
+		}
+		GeometryCreateQuantizationBuffer();
+
+		if (m_vertex_quantized)
+		{
+			const auto bound = VertexQuantizer::GetErrorBound(m_vertex_quantization);
+			if (error.position > bound.position || error.uv > bound.uv || error.normal > bound.normal || error.tangent > bound.tangent)
+			{
+				LOGF_WARNING("\"%s\" vertex quantization error exceeds its bound, position: %f (%f), uv: %f (%f), normal: %f deg (%f deg), tangent: %f deg (%f deg)",
+					GetResourceName().c_str(), error.position, bound.position, error.uv, bound.uv, error.normal, bound.normal, error.tangent, bound.tangent);
+			}
+			else
+			{
+				LOGF_INFO("\"%s\" vertex quantization error, position: %f, uv: %f, normal: %f deg, tangent: %f deg", GetResourceName().c_str(), error.position, error.uv, error.normal, error.tangent);
+			}
+		}
+
+		m_normalized_scale = GeometryComputeNormalizedScale();
+	}
+
+	uint32_t Model::FindSubmesh(const uint32_t index_offset) const
+	{
+		// Submeshes are appended in order, so the last one which starts at or before the offset is the only candidate
+		const auto it = upper_bound(m_submeshes.begin(), m_submeshes.end(), index_offset, [](const uint32_t offset, const Model_Submesh& submesh)
+		{
+			return offset < submesh.index_offset;
+		});
+
+		if (it == m_submeshes.begin())
+			return static_cast<uint32_t>(m_submeshes.size());
+
+		const auto& submesh = *(it - 1);
+		return index_offset < submesh.index_offset + submesh.index_count ? static_cast<uint32_t>(distance(m_submeshes.begin(), it - 1)) : static_cast<uint32_t>(m_submeshes.size());
+	}
+
+	bool Model::SubmeshLoad(const uint32_t index)
+	{
+		if (index >= m_submeshes.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		auto& submesh = m_submeshes[index];
+		if (submesh.IsLoaded())
+			return true;
+
+		// Geometry which was never written to a chunk stays on the CPU when unloaded, only the buffers have to be created again
+		if (submesh.mesh->Vertices_Count() == 0)
+		{
+			auto file = make_unique<FileStream>(m_chunk_file_path, FileStream_Read);
+			if (!file->IsOpen() || !_Model::read_chunk(file.get(), m_chunk_file_version, m_chunk_file_offset, &submesh))
+			{
+				LOGF_ERROR("Failed to read submesh \"%s\" from \"%s\"", submesh.name.c_str(), m_chunk_file_path.c_str());
+				return false;
+			}
+		}
+
+		const auto result = GeometryCreateBuffers(&submesh);
+		m_size = GeometryComputeMemoryUsage();
+
+		return result;
+	}
+
+	bool Model::SubmeshLoad(const uint32_t index, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices)
+	{
+		if (index >= m_submeshes.size() || !indices || !vertices || vertices->empty())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		auto& submesh = m_submeshes[index];
+		if (submesh.IsLoaded())
+			return true;
+
+		submesh.mesh->Indices_Get()		= move(*indices);
+		submesh.mesh->Vertices_Get()	= move(*vertices);
+
+		return SubmeshLoad(index);
+	}
+
+	bool Model::SubmeshRead(const uint32_t index, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
+	{
+		if (index >= m_submeshes.size() || !indices || !vertices)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		const auto& submesh = m_submeshes[index];
+		if (submesh.chunk_size == 0)
+		{
+			LOGF_ERROR("Submesh \"%s\" hasn't been saved to a chunk yet", submesh.name.c_str());
+			return false;
+		}
+
+		auto file = make_unique<FileStream>(m_chunk_file_path, FileStream_Read);
+		if (!file->IsOpen() || !_Model::read_chunk(file.get(), m_chunk_file_version, m_chunk_file_offset, submesh, indices, vertices))
+		{
+			LOGF_ERROR("Failed to read submesh \"%s\" from \"%s\"", submesh.name.c_str(), m_chunk_file_path.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	void Model::SubmeshUnload(const uint32_t index)
+	{
+		if (index >= m_submeshes.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		auto& submesh = m_submeshes[index];
+		submesh.vertex_buffer.reset();
+		submesh.index_buffer.reset();
+		submesh.skinned = false;
+		if (submesh.chunk_size != 0)
+		{
+			submesh.mesh->Geometry_Release();
+		}
+
+		m_size = GeometryComputeMemoryUsage();
+	}
+
+	void Model::AddMaterial(shared_ptr<Material>& material, const shared_ptr<Entity>& entity)
+	{
+		if (!material || !entity)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Create a file path for this material
+        string spartan_asset_path = FileSystem::GetDirectoryFromFilePath(GetResourceFilePathNative()) + material->GetResourceName() + EXTENSION_MATERIAL;
+		material->SetResourceFilePath(spartan_asset_path);
+
+		// Create a Renderable and pass the material to it
+        auto renderable = entity->AddComponent<Renderable>();
+        renderable->SetMaterial(material);
 
-			// Set the texture to the provided material
-			material->SetTextureSlot(texture_type, texture);
+		// Reference it from the submesh table
+		if (renderable->GeometryModel().get() == this)
+		{
+			const auto index = FindSubmesh(renderable->GeometryIndexOffset());
+			if (index != m_submeshes.size())
+			{
+				m_submeshes[index].material = material->GetResourceName();
+			}
 		}
 	}
 
-	bool Model::GeometryCreateBuffers()
+	void Model::AddAnimation(shared_ptr<Animation>& animation)
+	{
+		if (!animation)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		m_animations.emplace_back(animation);
+		m_is_animated = true;
+	}
+
+	bool Model::GeometryCreateBuffers(Model_Submesh* submesh, Vertex_Quantization_Error* quantization_error)
 	{
 		auto success = true;
 
 		// Get geometry
-		const auto indices	= m_mesh->Indices_Get();
-		const auto vertices	= m_mesh->Vertices_Get();
+		const auto& indices	= submesh->mesh->Indices_Get();
+		auto& vertices		= submesh->mesh->Vertices_Get();
+
+		// Replace the CPU vertices with what the GPU will decode, so that picking, physics and saving see the same geometry
+		vector<RHI_Vertex_PosTexNorTan_Quantized> vertices_quantized;
+		if (m_vertex_quantized && !vertices.empty())
+		{
+			VertexQuantizer::Quantize(vertices, m_vertex_quantization, &vertices_quantized);
+
+			vector<RHI_Vertex_PosTexNorTan> vertices_dequantized;
+			VertexQuantizer::Dequantize(vertices_quantized, m_vertex_quantization, &vertices_dequantized);
+			if (quantization_error)
+			{
+				*quantization_error = VertexQuantizer::ComputeError(vertices, vertices_dequantized);
+			}
+			vertices = move(vertices_dequantized);
+		}
 
 		if (!indices.empty())
 		{
-			m_index_buffer = make_shared<RHI_IndexBuffer>(m_rhi_device);
-			if (!m_index_buffer->Create(indices))
+			submesh->index_buffer = make_shared<RHI_IndexBuffer>(m_rhi_device);
+			if (!submesh->index_buffer->Create(indices))
 			{
 				LOGF_ERROR("Failed to create index buffer for \"%s\".", GetResourceName().c_str());
 				success = false;
@@ -241,8 +964,8 @@ namespace Spartan
 
 		if (!vertices.empty())
 		{
-			m_vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
-			if (!m_vertex_buffer->Create(vertices))
+			submesh->vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
+			if (!(vertices_quantized.empty() ? submesh->vertex_buffer->Create(vertices) : submesh->vertex_buffer->Create(vertices_quantized)))
 			{
 				LOGF_ERROR("Failed to create vertex buffer for \"%s\".", GetResourceName().c_str());
 				success = false;
@@ -254,9 +977,44 @@ namespace Spartan
 			success = false;
 		}
 
+		// A submesh is either drawable or unloaded, and it's back to the bind pose until it's skinned again
+		submesh->skinned = false;
+		if (!success)
+		{
+			submesh->vertex_buffer.reset();
+			submesh->index_buffer.reset();
+		}
+
 		return success;
 	}
 
+	bool Model::GeometryCreateQuantizationBuffer()
+	{
+		if (!m_vertex_quantized)
+		{
+			m_vertex_quantization_buffer.reset();
+			return true;
+		}
+
+		// Decode parameters of the quantized vertices
+		m_vertex_quantization_buffer = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+		m_vertex_quantization_buffer->Create<VertexQuantizationBufferData>();
+		if (auto buffer = static_cast<VertexQuantizationBufferData*>(m_vertex_quantization_buffer->Map()))
+		{
+			buffer->position_offset	= m_vertex_quantization.position_offset;
+			buffer->padding			= 0.0f;
+			buffer->position_scale	= m_vertex_quantization.position_scale;
+			buffer->padding2		= 0.0f;
+			buffer->uv_offset		= m_vertex_quantization.uv_offset;
+			buffer->uv_scale		= m_vertex_quantization.uv_scale;
+			m_vertex_quantization_buffer->Unmap();
+			return true;
+		}
+
+		LOGF_ERROR("Failed to create vertex quantization buffer for \"%s\".", GetResourceName().c_str());
+		return false;
+	}
+
 	float Model::GeometryComputeNormalizedScale() const
 	{
 		// Compute scale offset
@@ -268,18 +1026,25 @@ namespace Spartan
 
 	uint32_t Model::GeometryComputeMemoryUsage() const
 	{
-        if (!m_vertex_buffer || !m_index_buffer)
+        if (m_submeshes.empty())
         {
             LOG_ERROR_INVALID_INTERNALS();
             return 0;
         }
 
-		// Vertices & Indices
-		auto size = !m_mesh ? 0 : m_mesh->Geometry_MemoryUsage();
+		uint32_t size = 0;
+		for (const auto& submesh : m_submeshes)
+		{
+			// Vertices & Indices
+			size += submesh.mesh->Geometry_MemoryUsage();
 
-		// Buffers
-		size += static_cast<uint32_t>(m_vertex_buffer->GetSize());
-		size += static_cast<uint32_t>(m_index_buffer->GetSize());
+			// Buffers
+			if (submesh.IsLoaded())
+			{
+				size += static_cast<uint32_t>(submesh.vertex_buffer->GetSize());
+				size += static_cast<uint32_t>(submesh.index_buffer->GetSize());
+			}
+		}
 
 		return size;
 	}
@@ -21,22 +21,51 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES =====================
+//= INCLUDES ==================================
 #include <memory>
 #include <vector>
+#include <string>
 #include "Material.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
-//================================
+#include "../Resource/Import/VertexQuantizer.h"
+//=============================================
 
 namespace Spartan
 {
 	class ResourceCache;
+	class FileStream;
 	class Entity;
 	class Mesh;
     class Animation;
-	namespace Math{ class BoundingBox; }
+    class Skeleton;
+    class AnimationClip;
+	struct Mesh_Lod;
+	struct Mesh_Cluster;
+	struct Mesh_Collision;
+	namespace Math{ class BoundingBox; class Matrix; }
+
+	// A part of a model which loads and unloads on its own, the model file stores its geometry in a chunk of its own.
+	// Renderables reference it with model wide offsets, its LODs, clusters and draws use offsets into its own buffers.
+	struct Model_Submesh
+	{
+		std::string name;
+		std::string material;		// Resource name of the material, empty if it has none
+		Math::BoundingBox aabb;
+		uint32_t index_offset	= 0;	// Model wide
+		uint32_t index_count	= 0;	// Full detail indices only, the LODs follow them in the buffer
+		uint32_t vertex_offset	= 0;	// Model wide
+		uint32_t vertex_count	= 0;
+		uint64_t chunk_offset	= 0;	// Relative to the first chunk of the model file
+		uint64_t chunk_size		= 0;	// Zero if the geometry isn't in a chunked model file yet
+		std::shared_ptr<Mesh> mesh;		// Keeps the LODs and clusters when unloaded, they are part of the table
+		std::shared_ptr<RHI_VertexBuffer> vertex_buffer;
+		std::shared_ptr<RHI_IndexBuffer> index_buffer;
+		bool skinned = false;			// The vertex buffer is dynamic and holds the last skinned pose
+
+		bool IsLoaded() const { return vertex_buffer && index_buffer; }
+	};
 
 	class SPARTAN_CLASS Model : public IResource, public std::enable_shared_from_this<Model>
 	{
@@ -51,13 +80,14 @@ namespace Spartan
 		bool SaveToFile(const std::string& file_path) override;
 		//=======================================================
 
-        // Geometry
+        // Geometry, every append adds a submesh
         void AppendGeometry(
             const std::vector<uint32_t>& indices,
             const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
-            uint32_t* index_offset  = nullptr,
-            uint32_t* vertex_offset = nullptr
-        ) const;
+            uint32_t* index_offset      = nullptr,
+            uint32_t* vertex_offset     = nullptr,
+            const std::string& name     = std::string()
+        );
         void GetGeometry(
             uint32_t index_offset,
             uint32_t index_count,
@@ -66,38 +96,97 @@ namespace Spartan
             std::vector<uint32_t>* indices,
             std::vector<RHI_Vertex_PosTexNorTan>* vertices
         ) const;
+        void AppendGeometryLod(uint32_t index_offset, const std::vector<uint32_t>& indices, float error);
+        const std::vector<Mesh_Lod>& GetGeometryLods(uint32_t index_offset) const;
+        void SetGeometryClusters(uint32_t index_offset, const std::vector<Mesh_Cluster>& clusters);
+        const std::vector<Mesh_Cluster>& GetGeometryClusters(uint32_t index_offset) const;
+        void SetGeometryCollision(uint32_t index_offset, Mesh_Collision&& collision);
+        const Mesh_Collision& GetGeometryCollision(uint32_t index_offset) const;
         void UpdateGeometry();
         const auto& GetAabb() const { return m_aabb; }
-        const auto& GetMesh() const { return m_mesh; }
+
+        // Submeshes
+        uint32_t FindSubmesh(uint32_t index_offset) const; // Returns the submesh count if no submesh holds the offset
+        const Model_Submesh* GetSubmesh(const uint32_t index) const { return index < m_submeshes.size() ? &m_submeshes[index] : nullptr; }
+        auto GetSubmeshCount() const                                { return static_cast<uint32_t>(m_submeshes.size()); }
+        bool SubmeshLoad(uint32_t index);
+        void SubmeshUnload(uint32_t index);
+        // Reads the geometry of a saved submesh without touching the model, so that it can run on a worker while the model is in use
+        bool SubmeshRead(uint32_t index, std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
+        // Loads a submesh with geometry from SubmeshRead(), it's moved into the submesh
+        bool SubmeshLoad(uint32_t index, std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices);
+        // Saved with the model, a streamed model only reads the submesh table when loaded and every submesh has to be loaded explicitly
+        void SetSubmeshStreaming(const bool streaming)              { m_submesh_streaming = streaming; }
+        auto GetSubmeshStreaming() const                            { return m_submesh_streaming; }
+
+        // Vertex quantization (takes effect on the next UpdateGeometry)
+        auto IsVertexQuantized() const                              { return m_vertex_quantized; }
+        void SetVertexQuantized(const bool quantized)               { m_vertex_quantized = quantized; }
+        const auto& GetVertexQuantization() const                   { return m_vertex_quantization; }
+        const auto& GetVertexQuantizationBuffer() const             { return m_vertex_quantization_buffer; }
 
 		// Add resources to the model
         void SetRootEntity(const std::shared_ptr<Entity>& entity) { m_root_entity = entity; }
+        auto GetRootEntity() const                                { return m_root_entity.lock(); }
 		void AddMaterial(std::shared_ptr<Material>& material, const std::shared_ptr<Entity>& entity);
 		void AddAnimation(std::shared_ptr<Animation>& animation);
-		void AddTexture(std::shared_ptr<Material>& material, TextureType texture_type, const std::string& file_path);
+		const auto& GetAnimations() const								{ return m_animations; }
+		void AddAnimationClip(const std::shared_ptr<AnimationClip>& clip)	{ m_animation_clips.emplace_back(clip); }
+		const auto& GetAnimationClips() const							{ return m_animation_clips; }
+
+        // Skeleton and compressed clips, saved with the model. The raw animations are only kept for models without a skeleton
+        // (nothing samples them), the clips replace them otherwise.
+        void SetSkeleton(const std::shared_ptr<Skeleton>& skeleton)     { m_skeleton = skeleton; }
+        const auto& GetSkeleton() const                                 { return m_skeleton; }
+
+        // Skinning, saved in the chunks of the submeshes. The bone vertices mirror the vertices of the geometry at the index offset.
+        // Skinned geometry is never quantized, SubmeshSkin() takes matrices from Skeleton::ComputeSkinningMatrices().
+        void SetGeometrySkin(uint32_t index_offset, std::vector<RHI_Vertex_PosTexNorTanBone>&& vertices);
+        bool SubmeshSkin(uint32_t index, const std::vector<Math::Matrix>& skinning);
 
         // Misc
 		auto IsAnimated() const						{ return m_is_animated; }
 		void SetAnimated(const bool is_animated)	{ m_is_animated = is_animated; }
-		const auto& GetIndexBuffer() const			{ return m_index_buffer; }
-		const auto& GetVertexBuffer() const			{ return m_vertex_buffer; }
 		auto GetSharedPtr()							{ return shared_from_this(); }
 
 	private:
 		// Geometry
-		bool GeometryCreateBuffers();
+		bool GeometryCreateBuffers(Model_Submesh* submesh, Vertex_Quantization_Error* quantization_error = nullptr);
+		bool GeometryCreateQuantizationBuffer();
 		float GeometryComputeNormalizedScale() const;
 		uint32_t GeometryComputeMemoryUsage() const;
 
+		// Files written before the submesh table, they load as a single submesh
+		void LoadFromFileLegacy(FileStream* file);
+
 		// Misc
 		std::weak_ptr<Entity> m_root_entity;
-		std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer;
-		std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
-		std::shared_ptr<Mesh> m_mesh;
+		std::vector<std::shared_ptr<Animation>> m_animations;
+		std::vector<std::shared_ptr<AnimationClip>> m_animation_clips;
+		std::shared_ptr<Skeleton> m_skeleton;
+		std::vector<Model_Submesh> m_submeshes;
+		std::string m_chunk_file_path;		// File the submesh chunks are read from
+		uint64_t m_chunk_file_offset = 0;	// Position of the first chunk in it
+		uint32_t m_chunk_file_version = 0;	// Version of that file, chunks of older versions have a different layout
+		bool m_submesh_streaming = false;
 		Math::BoundingBox m_aabb;
 		float m_normalized_scale	= 1.0f;
 		bool m_is_animated			= false;
 
+		// Vertex quantization
+		struct VertexQuantizationBufferData // Has to match Common_Vertex.hlsl
+		{
+			Math::Vector3 position_offset;
+			float padding;
+			Math::Vector3 position_scale;
+			float padding2;
+			Math::Vector2 uv_offset;
+			Math::Vector2 uv_scale;
+		};
+		bool m_vertex_quantized = false;
+		Vertex_Quantization m_vertex_quantization;
+		std::shared_ptr<RHI_ConstantBuffer> m_vertex_quantization_buffer;
+
         // Dependencies
 		ResourceCache* m_resource_manager;
 		std::shared_ptr<RHI_Device> m_rhi_device;	
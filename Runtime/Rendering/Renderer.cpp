@@ -243,6 +243,9 @@ namespace Spartan
 			m_view_projection_orthographic	= m_view_base * m_projection_orthographic;
 		}
 
+		RenderablesSelectLods();
+		RenderablesCullClusters();
+
 		m_is_rendering = true;
 		Pass_Main();
 		m_is_rendering = false;
@@ -437,6 +440,43 @@ namespace Spartan
 		});
 	}
 
+	void Renderer::RenderablesSelectLods()
+	{
+		// Pixels covered by a unit sized object at a distance of one unit
+		const auto projection_scale	= m_viewport.height / (2.0f * tan(m_camera->GetFovVerticalRad() * 0.5f));
+		const auto camera_position	= m_camera->GetTransform()->GetPosition();
+
+		for (const auto type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+		{
+			for (const auto& entity : m_entities[type])
+			{
+				if (auto renderable = entity->GetRenderable_PtrRaw())
+				{
+					renderable->LodSelect(camera_position, projection_scale, m_lod_error_threshold, m_lod_hysteresis);
+				}
+			}
+		}
+	}
+
+	void Renderer::RenderablesCullClusters()
+	{
+		if (!m_cluster_culling)
+			return;
+
+		for (const auto type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+		{
+			for (const auto& entity : m_entities[type])
+			{
+				if (auto renderable = entity->GetRenderable_PtrRaw())
+				{
+					// Cones can only cull what the rasterizer would cull anyway
+					const auto& material = renderable->GetMaterial();
+					renderable->ClustersCull(m_camera.get(), material && material->GetCullMode() == Cull_Back);
+				}
+			}
+		}
+	}
+
 	shared_ptr<RHI_RasterizerState>& Renderer::GetRasterizerState(const RHI_Cull_Mode cull_mode, const RHI_Fill_Mode fill_mode)
 	{
 		if (cull_mode == Cull_Back)		return (fill_mode == Fill_Solid) ? m_rasterizer_cull_back_solid		: m_rasterizer_cull_back_wireframe;
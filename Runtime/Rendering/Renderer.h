@@ -115,7 +115,9 @@ namespace Spartan
 	enum Renderer_Shader_Type
 	{
 		Shader_Gbuffer_V,
+		Shader_Gbuffer_Quantized_V,
 		Shader_Depth_V,
+		Shader_Depth_Quantized_V,
 		Shader_Quad_V,
 		Shader_Texture_P,
 		Shader_Fxaa_P,
@@ -279,6 +281,11 @@ namespace Spartan
         float m_sharpen_clamp           = 0.35f;	// Limits maximum amount of sharpening a pixel receives											- Algorithm's default: 0.035f
         // Motion Blur
         float m_motion_blur_intensity   = 0.025f;	// Strength of the motion blur
+        // LOD
+        float m_lod_error_threshold     = 1.0f;     // Largest error (in pixels) that a LOD is allowed to introduce on screen
+        float m_lod_hysteresis          = 0.25f;    // Fraction by which a coarser LOD has to beat the error threshold before it's picked
+        // Clusters
+        bool m_cluster_culling          = true;     // Draw only the clusters of large meshes which are in the frustum and not back facing
         //========================================================================================================================================================================
 
 	private:
@@ -328,6 +335,8 @@ namespace Spartan
         bool UpdateUberBuffer(uint32_t resolution_width, uint32_t resolution_height, const Math::Matrix& mMVP = Math::Matrix::Identity);
         void RenderablesAcquire(const Variant& renderables);
         void RenderablesSort(std::vector<Entity*>* renderables);
+        void RenderablesSelectLods();
+        void RenderablesCullClusters();
         std::shared_ptr<RHI_RasterizerState>& GetRasterizerState(RHI_Cull_Mode cull_mode, RHI_Fill_Mode fill_mode);
         void* GetEnvironmentTexture_GpuResource();
         void ClearEntities() { m_entities.clear(); }
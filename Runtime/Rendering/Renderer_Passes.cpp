@@ -84,8 +84,9 @@ namespace Spartan
 
 	void Renderer::Pass_LightDepth()
 	{
-		// Acquire shader
-		const auto& shader_depth = m_shaders[Shader_Depth_V];
+		// Acquire shaders
+		const auto& shader_depth			= m_shaders[Shader_Depth_V];
+		const auto& shader_depth_quantized	= m_shaders[Shader_Depth_Quantized_V];
 		if (!shader_depth->IsCompiled())
 			return;
 
@@ -131,6 +132,7 @@ namespace Spartan
 
 			// Tracking
 			uint32_t currently_bound_geometry   = 0;
+			uint32_t currently_bound_shader     = shader_depth->GetId();
 
 			for (uint32_t i = 0; i < light->GetShadowMap()->GetArraySize(); i++)
 			{
@@ -158,9 +160,10 @@ namespace Spartan
 					if (!material)
 						continue;
 
-					// Acquire geometry
-					const auto& model = renderable->GeometryModel();
-					if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+					// Acquire geometry, submeshes which are streamed out are skipped
+					const auto& model	= renderable->GeometryModel();
+					const auto submesh	= model ? model->GetSubmesh(renderable->GeometrySubmesh()) : nullptr;
+					if (!submesh || !submesh->IsLoaded())
 						continue;
 
 					// Skip meshes that don't cast shadows
@@ -171,12 +174,28 @@ namespace Spartan
 					if (material->GetColorAlbedo().w < 1.0f)
 						continue;
 
+					// Acquire the vertex shader that matches the vertex format
+					const auto& shader_vertex = model->IsVertexQuantized() ? shader_depth_quantized : shader_depth;
+					if (!shader_vertex->IsCompiled())
+						continue;
+
 					// Bind geometry
-					if (currently_bound_geometry != model->GetId())
+					if (currently_bound_geometry != submesh->vertex_buffer->GetId())
 					{
-						m_cmd_list->SetBufferIndex(model->GetIndexBuffer());
-						m_cmd_list->SetBufferVertex(model->GetVertexBuffer());
-						currently_bound_geometry = model->GetId();
+						if (currently_bound_shader != shader_vertex->GetId())
+						{
+							m_cmd_list->SetShaderVertex(shader_vertex);
+							m_cmd_list->SetInputLayout(shader_vertex->GetInputLayout());
+							currently_bound_shader = shader_vertex->GetId();
+						}
+
+						m_cmd_list->SetBufferIndex(submesh->index_buffer);
+						m_cmd_list->SetBufferVertex(submesh->vertex_buffer);
+						if (model->IsVertexQuantized())
+						{
+							m_cmd_list->SetConstantBuffer(3, Buffer_VertexShader, model->GetVertexQuantizationBuffer());
+						}
+						currently_bound_geometry = submesh->vertex_buffer->GetId();
 					}
 
 					// Update constant buffer
@@ -189,7 +208,7 @@ namespace Spartan
                             m_cmd_list->SetConstantBuffer(1, Buffer_VertexShader, buffer);
                         }
                     }
-					m_cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+					m_cmd_list->DrawIndexed(renderable->GeometryDrawIndexCount(), renderable->GeometryDrawIndexOffset(), renderable->GeometryDrawVertexOffset());
 				}
 				m_cmd_list->End(); // end of cascade
 			}
@@ -227,7 +246,8 @@ namespace Spartan
 			return;
 		}
 
-		const auto& shader_gbuffer = m_shaders[Shader_Gbuffer_V];
+		const auto& shader_gbuffer              = m_shaders[Shader_Gbuffer_V];
+		const auto& shader_gbuffer_quantized    = m_shaders[Shader_Gbuffer_Quantized_V];
         if (!shader_gbuffer->IsCompiled())
             return;
 
@@ -243,11 +263,12 @@ namespace Spartan
 		UpdateUberBuffer(static_cast<uint32_t>(m_resolution.x), static_cast<uint32_t>(m_resolution.y));
 	
 		// Variables that help reduce state changes
-		uint32_t currently_bound_geometry	= 0;
-		uint32_t currently_bound_shader		= 0;
-		uint32_t currently_bound_material	= 0;
+		uint32_t currently_bound_geometry		= 0;
+		uint32_t currently_bound_shader_vertex	= shader_gbuffer->GetId();
+		uint32_t currently_bound_shader			= 0;
+		uint32_t currently_bound_material		= 0;
 
-        auto draw_entity = [this, &currently_bound_geometry, &currently_bound_shader, &currently_bound_material](Entity* entity)
+        auto draw_entity = [this, &shader_gbuffer, &shader_gbuffer_quantized, &currently_bound_geometry, &currently_bound_shader_vertex, &currently_bound_shader, &currently_bound_material](Entity* entity)
         {
             // Get renderable
             const auto& renderable = entity->GetRenderable_PtrRaw();
@@ -267,23 +288,45 @@ namespace Spartan
             if (!shader || shader->GetCompilationState() != Shader_Compiled)
                 return;
 
-            // Validate geometry
-            if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+            // Validate geometry, submeshes which are streamed out are skipped
+            const auto submesh = model ? model->GetSubmesh(renderable->GeometrySubmesh()) : nullptr;
+            if (!submesh || !submesh->IsLoaded())
+                return;
+
+            // Validate the vertex shader that matches the vertex format
+            const auto& shader_vertex = model->IsVertexQuantized() ? shader_gbuffer_quantized : shader_gbuffer;
+            if (!shader_vertex->IsCompiled())
                 return;
 
             // Skip objects outside of the view frustum
             if (!m_camera->IsInViewFrustrum(renderable))
                 return;
 
+            // Skip objects whose clusters were all culled
+            const auto draw_clusters = m_cluster_culling && renderable->ClustersActive();
+            if (draw_clusters && renderable->ClustersVisible().empty())
+                return;
+
             // Set face culling (changes only if required)
             m_cmd_list->SetRasterizerState(GetRasterizerState(material->GetCullMode(), !IsFlagSet(Render_Debug_Wireframe) ? Fill_Solid : Fill_Wireframe));
 
             // Bind geometry
-            if (currently_bound_geometry != model->GetId())
+            if (currently_bound_geometry != submesh->vertex_buffer->GetId())
             {
-                m_cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                m_cmd_list->SetBufferVertex(model->GetVertexBuffer());
-                currently_bound_geometry = model->GetId();
+                if (currently_bound_shader_vertex != shader_vertex->GetId())
+                {
+                    m_cmd_list->SetShaderVertex(shader_vertex);
+                    m_cmd_list->SetInputLayout(shader_vertex->GetInputLayout());
+                    currently_bound_shader_vertex = shader_vertex->GetId();
+                }
+
+                m_cmd_list->SetBufferIndex(submesh->index_buffer);
+                m_cmd_list->SetBufferVertex(submesh->vertex_buffer);
+                if (model->IsVertexQuantized())
+                {
+                    m_cmd_list->SetConstantBuffer(3, Buffer_VertexShader, model->GetVertexQuantizationBuffer());
+                }
+                currently_bound_geometry = submesh->vertex_buffer->GetId();
             }
 
             // Bind shader
@@ -312,7 +355,17 @@ namespace Spartan
             m_cmd_list->SetConstantBuffer(2, Buffer_VertexShader, transform->GetConstantBuffer());
 
             // Render	
-            m_cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+            if (draw_clusters)
+            {
+                for (const auto& range : renderable->ClustersVisible())
+                {
+                    m_cmd_list->DrawIndexed(range.second, range.first, renderable->GeometryDrawVertexOffset());
+                }
+            }
+            else
+            {
+                m_cmd_list->DrawIndexed(renderable->GeometryDrawIndexCount(), renderable->GeometryDrawIndexOffset(), renderable->GeometryDrawVertexOffset());
+            }
             m_profiler->m_renderer_meshes_rendered++;
         };
 
@@ -151,10 +151,20 @@ namespace Spartan
         m_shaders[Shader_Depth_V] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Depth_V]->CompileAsync<RHI_Vertex_Pos>(m_context, Shader_Vertex, dir_shaders + "Depth.hlsl");
 
+        // Depth - Quantized vertices
+        m_shaders[Shader_Depth_Quantized_V] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_Depth_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+        m_shaders[Shader_Depth_Quantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Quantized>(m_context, Shader_Vertex, dir_shaders + "Depth.hlsl");
+
         // G-Buffer
         m_shaders[Shader_Gbuffer_V] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(m_context, Shader_Vertex, dir_shaders + "GBuffer.hlsl");
 
+        // G-Buffer - Quantized vertices
+        m_shaders[Shader_Gbuffer_Quantized_V] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_Gbuffer_Quantized_V]->AddDefine("VERTEX_QUANTIZED");
+        m_shaders[Shader_Gbuffer_Quantized_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Quantized>(m_context, Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+
         // BRDF - Specular Lut
         m_shaders[Shader_BrdfSpecularLut] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_BrdfSpecularLut]->AddDefine("BRDF_ENV_SPECULAR_LUT");
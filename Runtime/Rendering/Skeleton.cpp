@@ -0,0 +1,170 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "Skeleton.h"
+#include "../IO/FileStream.h"
+#include "../Logging/Log.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	uint32_t Skeleton::AddBone(const string& name, const int32_t parent, const Matrix& offset, const Bone_Transform& bind)
+	{
+		if (parent >= static_cast<int32_t>(m_bones.size()))
+		{
+			LOGF_ERROR("The parent of bone \"%s\" has to be added first", name.c_str());
+			return GetBoneCount();
+		}
+
+		Skeleton_Bone bone;
+		bone.name	= name;
+		bone.parent	= parent < 0 ? -1 : parent;
+		bone.offset	= offset;
+		bone.bind	= bind;
+		m_bones.emplace_back(move(bone));
+
+		return GetBoneCount() - 1;
+	}
+
+	uint32_t Skeleton::FindBone(const string& name) const
+	{
+		for (uint32_t i = 0; i < GetBoneCount(); i++)
+		{
+			if (m_bones[i].name == name)
+				return i;
+		}
+
+		return GetBoneCount();
+	}
+
+	void Skeleton::GetBindPose(vector<Bone_Transform>* pose) const
+	{
+		pose->resize(m_bones.size());
+		for (uint32_t i = 0; i < GetBoneCount(); i++)
+		{
+			(*pose)[i] = m_bones[i].bind;
+		}
+	}
+
+	void Skeleton::ComputeModelSpace(const vector<Bone_Transform>& pose, vector<Matrix>* model_space) const
+	{
+		if (pose.size() != m_bones.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Same convention as Transform, a child is its local matrix followed by the one of its parent
+		model_space->resize(m_bones.size());
+		for (uint32_t i = 0; i < GetBoneCount(); i++)
+		{
+			const auto local	= Matrix(pose[i].position, pose[i].rotation, pose[i].scale);
+			const auto parent	= m_bones[i].parent;
+			(*model_space)[i]	= parent < 0 ? local : local * (*model_space)[parent];
+		}
+	}
+
+	void Skeleton::ComputeSkinningMatrices(const vector<Matrix>& model_space, vector<Matrix>* skinning) const
+	{
+		if (model_space.size() != m_bones.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		skinning->resize(m_bones.size());
+		for (uint32_t i = 0; i < GetBoneCount(); i++)
+		{
+			(*skinning)[i] = m_bones[i].offset * model_space[i];
+		}
+	}
+
+	void Skeleton::BlendPoses(const vector<Bone_Transform>& a, const vector<Bone_Transform>& b, const float weight, vector<Bone_Transform>* output)
+	{
+		if (a.size() != b.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		output->resize(a.size());
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			auto& blended		= (*output)[i];
+			blended.position	= Lerp(a[i].position, b[i].position, weight);
+			blended.rotation	= Quaternion::Lerp(a[i].rotation, b[i].rotation, weight);
+			blended.scale		= Lerp(a[i].scale, b[i].scale, weight);
+		}
+	}
+
+	void Skeleton::Serialize(FileStream* stream) const
+	{
+		stream->Write(GetBoneCount());
+		for (const auto& bone : m_bones)
+		{
+			stream->Write(bone.name);
+			stream->Write(bone.parent);
+			stream->WriteBytes(&bone.offset, sizeof(Matrix));
+			stream->Write(bone.bind.position);
+			stream->Write(bone.bind.rotation);
+			stream->Write(bone.bind.scale);
+		}
+	}
+
+	bool Skeleton::Deserialize(FileStream* stream)
+	{
+		// The count comes from the file, every bone takes at least this much of it
+		static const uint64_t bone_size_min = sizeof(uint32_t) + sizeof(int32_t) + sizeof(Matrix) + sizeof(Vector3) * 2 + sizeof(Quaternion);
+
+		m_bones.clear();
+		const auto bone_count = stream->ReadAs<uint32_t>();
+		if (bone_count > stream->GetRemaining() / bone_size_min)
+		{
+			LOGF_ERROR("Count of %d bones exceeds what the data can hold, the file is corrupt", bone_count);
+			return false;
+		}
+
+		for (uint32_t i = 0; i < bone_count; i++)
+		{
+			Skeleton_Bone bone;
+			stream->Read(&bone.name);
+			stream->Read(&bone.parent);
+			stream->ReadBytes(&bone.offset, sizeof(Matrix));
+			stream->Read(&bone.bind.position);
+			stream->Read(&bone.bind.rotation);
+			stream->Read(&bone.bind.scale);
+
+			if (AddBone(bone.name, bone.parent, bone.offset, bone.bind) != i)
+			{
+				m_bones.clear();
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
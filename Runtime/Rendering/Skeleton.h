@@ -0,0 +1,82 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include <string>
+#include "../Core/EngineDefs.h"
+#include "../Math/Matrix.h"
+//================================
+
+namespace Spartan
+{
+	class FileStream;
+
+	// Transform of a bone relative to its parent
+	struct Bone_Transform
+	{
+		Math::Vector3 position		= Math::Vector3::Zero;
+		Math::Quaternion rotation	= Math::Quaternion::Identity;
+		Math::Vector3 scale			= Math::Vector3::One;
+	};
+
+	struct Skeleton_Bone
+	{
+		std::string name;
+		int32_t parent	= -1;	// Index of the parent bone, -1 for roots
+		Math::Matrix offset;	// Takes model space to the space of the bone in the bind pose (the inverse bind matrix)
+		Bone_Transform bind;	// Relative to the parent, in the bind pose
+	};
+
+	// A bone hierarchy, parents always precede their children so that it can be evaluated in a single pass.
+	// Poses are arrays of Bone_Transform, one per bone and in the same order as the bones.
+	class SPARTAN_CLASS Skeleton
+	{
+	public:
+		// The parent has to be added first, returns the index of the bone
+		uint32_t AddBone(const std::string& name, int32_t parent, const Math::Matrix& offset, const Bone_Transform& bind);
+
+		// Returns the bone count if there is no bone with that name
+		uint32_t FindBone(const std::string& name) const;
+
+		const auto& GetBones() const	{ return m_bones; }
+		auto GetBoneCount() const		{ return static_cast<uint32_t>(m_bones.size()); }
+
+		void GetBindPose(std::vector<Bone_Transform>* pose) const;
+
+		// Transforms of every bone relative to the model
+		void ComputeModelSpace(const std::vector<Bone_Transform>& pose, std::vector<Math::Matrix>* model_space) const;
+
+		// Transforms which take bind pose vertices to the pose, what skinning consumes
+		void ComputeSkinningMatrices(const std::vector<Math::Matrix>& model_space, std::vector<Math::Matrix>* skinning) const;
+
+		// Blends from pose a (weight 0) to pose b (weight 1), rotations take the shortest path
+		static void BlendPoses(const std::vector<Bone_Transform>& a, const std::vector<Bone_Transform>& b, float weight, std::vector<Bone_Transform>* output);
+
+		void Serialize(FileStream* stream) const;
+		bool Deserialize(FileStream* stream);
+
+	private:
+		std::vector<Skeleton_Bone> m_bones;
+	};
+}
@@ -0,0 +1,226 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Skinning.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+#include "../Threading/Threading.h"
+#include "../Logging/Log.h"
+//=================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=============================
+
+namespace _Skinning
+{
+	// Out of range indices would read past the matrices
+	inline uint32_t bone_index(const uint8_t index, const uint32_t bone_count)
+	{
+		return index < bone_count ? index : bone_count - 1;
+	}
+
+	inline void store_xyz(float* destination, const __m128 value)
+	{
+		float result[4];
+		_mm_storeu_ps(result, value);
+		memcpy(destination, result, 3 * sizeof(float));
+	}
+
+	inline __m128 normalize_xyz(const __m128 value)
+	{
+		float v[4];
+		_mm_storeu_ps(v, value);
+		const auto length_squared = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+		return length_squared > 0.0f ? _mm_mul_ps(value, _mm_set1_ps(1.0f / sqrt(length_squared))) : value;
+	}
+
+	inline bool has_influences(const RHI_Vertex_PosTexNorTanBone& vertex)
+	{
+		return (vertex.bone_weights[0] | vertex.bone_weights[1] | vertex.bone_weights[2] | vertex.bone_weights[3]) != 0;
+	}
+
+	void skin_range(const RHI_Vertex_PosTexNorTanBone* vertices, RHI_Vertex_PosTexNorTan* output, const __m128* rows, const uint32_t bone_count, const uint32_t start, const uint32_t end)
+	{
+		const __m128 weight_scale = _mm_set1_ps(1.0f / 255.0f);
+
+		for (uint32_t i = start; i < end; i++)
+		{
+			const auto& vertex	= vertices[i];
+			auto& result		= output[i];
+
+			// Weights that sum up to zero would collapse the vertex to the origin, it keeps its bind pose instead
+			if (!has_influences(vertex))
+			{
+				memcpy(result.pos, vertex.pos, sizeof(result.pos));
+				memcpy(result.tex, vertex.tex, sizeof(result.tex));
+				memcpy(result.nor, vertex.nor, sizeof(result.nor));
+				memcpy(result.tan, vertex.tan, sizeof(result.tan));
+				continue;
+			}
+
+			// Blend the rows of the four bone matrices
+			__m128 row0 = _mm_setzero_ps();
+			__m128 row1 = _mm_setzero_ps();
+			__m128 row2 = _mm_setzero_ps();
+			__m128 row3 = _mm_setzero_ps();
+			for (uint32_t k = 0; k < 4; k++)
+			{
+				if (vertex.bone_weights[k] == 0)
+					continue;
+
+				const __m128 weight	= _mm_mul_ps(_mm_set1_ps(static_cast<float>(vertex.bone_weights[k])), weight_scale);
+				const __m128* bone	= &rows[bone_index(vertex.bone_indices[k], bone_count) * 4];
+				row0 = _mm_add_ps(row0, _mm_mul_ps(bone[0], weight));
+				row1 = _mm_add_ps(row1, _mm_mul_ps(bone[1], weight));
+				row2 = _mm_add_ps(row2, _mm_mul_ps(bone[2], weight));
+				row3 = _mm_add_ps(row3, _mm_mul_ps(bone[3], weight));
+			}
+
+			// Row vectors, v * M
+			const auto transform = [&row0, &row1, &row2](const float* v)
+			{
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), row0), _mm_mul_ps(_mm_set1_ps(v[1]), row1)), _mm_mul_ps(_mm_set1_ps(v[2]), row2));
+			};
+
+			store_xyz(result.pos, _mm_add_ps(transform(vertex.pos), row3));
+			store_xyz(result.nor, normalize_xyz(transform(vertex.nor)));
+			store_xyz(result.tan, normalize_xyz(transform(vertex.tan)));
+			result.tex[0] = vertex.tex[0];
+			result.tex[1] = vertex.tex[1];
+		}
+	}
+}
+
+namespace Spartan
+{
+	void Skinning::Skin(const vector<RHI_Vertex_PosTexNorTanBone>& vertices, const vector<Matrix>& skinning, vector<RHI_Vertex_PosTexNorTan>* output, Threading* threading)
+	{
+		if (!output || skinning.empty() || skinning.size() > max_bones)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Convert the matrices once, four rows per bone
+		vector<__m128> rows(skinning.size() * 4);
+		for (size_t i = 0; i < skinning.size(); i++)
+		{
+			const auto& m = skinning[i];
+			rows[i * 4 + 0] = _mm_set_ps(m.m03, m.m02, m.m01, m.m00);
+			rows[i * 4 + 1] = _mm_set_ps(m.m13, m.m12, m.m11, m.m10);
+			rows[i * 4 + 2] = _mm_set_ps(m.m23, m.m22, m.m21, m.m20);
+			rows[i * 4 + 3] = _mm_set_ps(m.m33, m.m32, m.m31, m.m30);
+		}
+
+		output->resize(vertices.size());
+		const auto bone_count	= static_cast<uint32_t>(skinning.size());
+		const auto vertex_count	= static_cast<uint32_t>(vertices.size());
+		const auto skin = [&vertices, &output, &rows, bone_count](const uint32_t start, const uint32_t end)
+		{
+			_Skinning::skin_range(vertices.data(), output->data(), rows.data(), bone_count, start, end);
+		};
+
+		if (threading)
+		{
+			threading->Loop(skin, vertex_count);
+		}
+		else
+		{
+			skin(0, vertex_count);
+		}
+	}
+
+	RHI_Vertex_PosTexNorTan Skinning::SkinVertex(const RHI_Vertex_PosTexNorTanBone& vertex, const vector<Matrix>& skinning)
+	{
+		const Vector4 position	= Vector4(vertex.pos[0], vertex.pos[1], vertex.pos[2], 1.0f);
+		const Vector4 normal	= Vector4(vertex.nor[0], vertex.nor[1], vertex.nor[2], 0.0f);
+		const Vector4 tangent	= Vector4(vertex.tan[0], vertex.tan[1], vertex.tan[2], 0.0f);
+
+		// Same as Skin(), a vertex without influences keeps its bind pose
+		if (!_Skinning::has_influences(vertex))
+			return RHI_Vertex_PosTexNorTan(Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]), Vector2(vertex.tex[0], vertex.tex[1]), Vector3(vertex.nor[0], vertex.nor[1], vertex.nor[2]), Vector3(vertex.tan[0], vertex.tan[1], vertex.tan[2]));
+
+		// Transforming by every bone and blending the results equals transforming by the blended matrix
+		Vector3 skinned_position	= Vector3::Zero;
+		Vector3 skinned_normal		= Vector3::Zero;
+		Vector3 skinned_tangent		= Vector3::Zero;
+		for (uint32_t k = 0; k < 4 && !skinning.empty(); k++)
+		{
+			if (vertex.bone_weights[k] == 0)
+				continue;
+
+			const auto& matrix	= skinning[_Skinning::bone_index(vertex.bone_indices[k], static_cast<uint32_t>(skinning.size()))];
+			const auto weight	= vertex.bone_weights[k] / 255.0f;
+			const auto p		= position * matrix;
+			const auto n		= normal * matrix;
+			const auto t		= tangent * matrix;
+			skinned_position	+= Vector3(p.x, p.y, p.z) * weight;
+			skinned_normal		+= Vector3(n.x, n.y, n.z) * weight;
+			skinned_tangent		+= Vector3(t.x, t.y, t.z) * weight;
+		}
+		skinned_normal.Normalize();
+		skinned_tangent.Normalize();
+
+		return RHI_Vertex_PosTexNorTan(skinned_position, Vector2(vertex.tex[0], vertex.tex[1]), skinned_normal, skinned_tangent);
+	}
+
+	void Skinning::SetInfluences(RHI_Vertex_PosTexNorTanBone* vertex, const uint32_t* bones, const float* weights, const uint32_t count)
+	{
+		if (!vertex || (count != 0 && (!bones || !weights)))
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Strongest first
+		vector<uint32_t> order(count);
+		for (uint32_t i = 0; i < count; i++) { order[i] = i; }
+		sort(order.begin(), order.end(), [weights](const uint32_t a, const uint32_t b) { return weights[a] > weights[b]; });
+		const auto kept = min(count, 4u);
+
+		float total = 0.0f;
+		for (uint32_t k = 0; k < kept; k++)
+		{
+			total += max(weights[order[k]], 0.0f);
+		}
+
+		uint32_t sum = 0;
+		for (uint32_t k = 0; k < 4; k++)
+		{
+			const bool used = k < kept && total > 0.0f;
+			vertex->bone_indices[k] = used ? static_cast<uint8_t>(min(bones[order[k]], max_bones - 1)) : 0;
+			vertex->bone_weights[k] = used ? static_cast<uint8_t>(lround(max(weights[order[k]], 0.0f) / total * 255.0f)) : 0;
+			sum += vertex->bone_weights[k];
+		}
+
+		// Rounding can miss 255 by a little, the strongest influence absorbs the difference
+		if (sum != 0)
+		{
+			vertex->bone_weights[0] = static_cast<uint8_t>(static_cast<int32_t>(vertex->bone_weights[0]) + 255 - static_cast<int32_t>(sum));
+		}
+	}
+}
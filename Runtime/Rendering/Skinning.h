@@ -0,0 +1,57 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include <cstdint>
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../Math/Matrix.h"
+//==============================
+
+namespace Spartan
+{
+	class Threading;
+
+	// Linear blend skinning on the CPU, the Animator writes its output to the vertex buffers of skinned submeshes. It consumes the
+	// matrices Skeleton::ComputeSkinningMatrices() produces. Vertices without influences aren't deformed, they keep their bind pose.
+	class SPARTAN_CLASS Skinning
+	{
+	public:
+		// Blends up to four bone matrices per vertex with SSE, the vertices are split across the threads when threading is given
+		static void Skin(
+			const std::vector<RHI_Vertex_PosTexNorTanBone>& vertices,
+			const std::vector<Math::Matrix>& skinning,
+			std::vector<RHI_Vertex_PosTexNorTan>* output,
+			Threading* threading = nullptr
+		);
+
+		// One vertex at a time, using the math library
+		static RHI_Vertex_PosTexNorTan SkinVertex(const RHI_Vertex_PosTexNorTanBone& vertex, const std::vector<Math::Matrix>& skinning);
+
+		// Keeps the four strongest of count influences and quantizes their weights so that they sum to exactly 255
+		static void SetInfluences(RHI_Vertex_PosTexNorTanBone* vertex, const uint32_t* bones, const float* weights, uint32_t count);
+
+		static const uint32_t max_bones = 256; // Bone indices are 8 bit
+	};
+}
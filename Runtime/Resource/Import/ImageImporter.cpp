@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Threading/Threading.h"
 #include "../../Core/Settings.h"
 #include "../../Math/MathHelper.h"
+#include "../../Core/Stopwatch.h"
 #include "../../RHI/RHI_Texture2D.h"
 //====================================
 
@@ -37,24 +38,8 @@ using namespace std;
 
 namespace _ImagImporter
 {
-	static FREE_IMAGE_FILTER rescale_filter = FILTER_LANCZOS3;
-
-	// A struct that rescaling threads will work with
-	struct RescaleJob
-	{
-		uint32_t width		    = 0;
-		uint32_t height		    = 0;
-		uint32_t channels	    = 0;
-		vector<std::byte>* data	= nullptr;
-		bool done			    = false;
-
-		RescaleJob(const uint32_t width, const uint32_t height, const uint32_t channels)
-		{
-			this->width		= width;
-			this->height	= height;
-			this->channels	= channels;
-		}
-	};
+	static FREE_IMAGE_FILTER rescale_filter	= FILTER_LANCZOS3;
+	static float alpha_test_reference		= 0.6f; // matches the alpha test threshold in GBuffer.hlsl
 }
 
 namespace Spartan
@@ -139,23 +124,34 @@ namespace Spartan
 		const auto mip = texture->AddMipmap();
 		GetBitsFromFibitmap(mip, bitmap, image_width, image_height, image_channels);
 
+		// Free memory 
+		FreeImage_Unload(bitmap);
+
 		// If the texture supports mipmaps, generate them
 		if (generate_mipmaps)
 		{
-			GenerateMipmaps(bitmap, texture, image_width, image_height, image_channels);
+			GenerateMipmaps(texture, image_width, image_height, image_channels, image_bytes_per_channel / 8, image_is_transparent, image_is_grayscale);
 		}
 
-		// Free memory 
-		FreeImage_Unload(bitmap);
+		// Block compress (if the texture's usage calls for it)
+		auto texture_format = image_format;
+		if (image_format == Format_R8G8B8A8_UNORM)
+		{
+			const RHI_Format compressed_format = ComputeCompressedFormat(texture->GetUsage(), image_is_transparent, image_is_grayscale);
+			if (compressed_format != image_format && CompressMipmaps(texture, image_width, image_height, compressed_format))
+			{
+				texture_format = compressed_format;
+			}
+		}
 
 		// Fill RHI_Texture with image properties
 		texture->SetBpp(image_bpp);
 		texture->SetBpc(image_bytes_per_channel);
 		texture->SetWidth(image_width);
 		texture->SetHeight(image_height);
-		texture->SetChannels(image_channels);
+		texture->SetChannels(texture_format == image_format ? image_channels : RHI_Texture::GetChannelCountFromFormat(texture_format));
 		texture->SetTransparency(image_is_transparent);
-		texture->SetFormat(image_format);
+		texture->SetFormat(texture_format);
 		texture->SetGrayscale(image_is_grayscale);
 
 		return true;
@@ -185,65 +181,133 @@ namespace Spartan
 		return true;
 	}
 
-	void ImageImporter::GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels)
+	void ImageImporter::GenerateMipmaps(RHI_Texture* texture, uint32_t width, uint32_t height, const uint32_t channels, const uint32_t bytes_per_channel, const bool is_transparent, const bool is_grayscale)
 	{
-		if (!texture)
+		if (!texture || !texture->HasMipmaps())
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
-	
-		// Create a RescaleJob for every mip that we need
-		vector<_ImagImporter::RescaleJob> jobs;
+
+		Stopwatch timer;
+
+		// Deduce how the texels should be filtered
+		auto content = Mipmap_Content_Data;
+		content = (texture->GetUsage() == Texture_Usage_Color) ? Mipmap_Content_Color : content;
+		content = (texture->GetUsage() == Texture_Usage_Normal && !is_grayscale) ? Mipmap_Content_Normal : content;
+
+		// Alpha tested textures lose coverage as they get smaller (foliage thins out), so it's measured on the top mip and preserved
+		const auto preserve_coverage	= is_transparent && content == Mipmap_Content_Color && bytes_per_channel == 1;
+		const auto alpha_coverage		= preserve_coverage ? TextureDownsampler::ComputeAlphaCoverage(*texture->GetData(0), _ImagImporter::alpha_test_reference) : 0.0f;
+
+		// Every mip is built from the previous one, and each mip is split across threads in rows
+		auto threading = m_context->GetSubsystem<Threading>();
+		uint32_t mip_index = 0;
 		while (width > 1 || height > 1)
 		{
-			width	= Math::Max(width / 2, static_cast<uint32_t>(1));
-			height	= Math::Max(height / 2, static_cast<uint32_t>(1));
-			jobs.emplace_back(width, height, channels);
-			
-			// Resize the RHI_Texture vector accordingly
-			const auto size = width * height * channels;
-			auto mip		= texture->AddMipmap();
-			mip->reserve(size);
-			mip->resize(size);
+			const uint32_t mip_width	= TextureDownsampler::GetMipSize(width);
+			const uint32_t mip_height	= TextureDownsampler::GetMipSize(height);
+			texture->AddMipmap()->resize(static_cast<size_t>(mip_width) * mip_height * channels * bytes_per_channel);
+
+			// Acquire pointers after adding the mip, as adding it can move the mip vectors around
+			const std::byte* source	= texture->GetData(mip_index)->data();
+			vector<std::byte>* mip	= texture->GetData(mip_index + 1);
+
+			const auto downsample = [&](const uint32_t start, const uint32_t end)
+			{
+				TextureDownsampler::DownsampleRows(source, width, height, mip->data(), start, end, channels, bytes_per_channel, m_mipmap_filter, content);
+			};
+
+			if (mip_height >= threading->GetThreadCount())
+			{
+				threading->Loop(downsample, mip_height);
+			}
+			else
+			{
+				downsample(0, mip_height);
+			}
+
+			if (preserve_coverage)
+			{
+				TextureDownsampler::ScaleAlphaToCoverage(mip, _ImagImporter::alpha_test_reference, alpha_coverage);
+			}
+
+			width	= mip_width;
+			height	= mip_height;
+			mip_index++;
 		}
 
-		// Pass data pointers (now that the RHI_Texture mip vector has been constructed)
-		for (uint32_t i = 0; i < jobs.size(); i++)
+		LOGF_INFO("Generated %d mips in %.2f ms", mip_index, static_cast<float>(timer.GetElapsedTimeMs()));
+	}
+
+	bool ImageImporter::CompressMipmaps(RHI_Texture* texture, const uint32_t width, const uint32_t height, const RHI_Format format)
+	{
+		// D3D11 requires the top mip of a block compressed texture to be a multiple of the block size
+		if (width % 4 != 0 || height % 4 != 0)
 		{
-			// reminder: i + 1 because the 0 mip is the default image size
-			jobs[i].data = texture->GetData(i + 1);
+			LOGF_WARNING("Texture dimensions (%dx%d) are not a multiple of 4, it will be stored uncompressed.", width, height);
+			return false;
 		}
 
-		// Parallelize mipmap generation using multiple threads (because FreeImage_Rescale() using FILTER_LANCZOS3 is expensive)
-		auto threading = m_context->GetSubsystem<Threading>();
-		for (auto& job : jobs)
+		auto threading			= m_context->GetSubsystem<Threading>();
+		uint32_t mip_width		= width;
+		uint32_t mip_height		= height;
+		double psnr				= 0.0;
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(texture->GetData().size()); i++)
 		{
-			threading->AddTask([this, &job, &bitmap]()
+			vector<std::byte>* mip = texture->GetData(i);
+			vector<std::byte> compressed(TextureCompressor::GetCompressedSize(mip_width, mip_height, format));
+
+			// Split the work across threads in rows of blocks, small mips aren't worth the dispatch
+			const uint32_t block_rows = TextureCompressor::GetBlockCountY(mip_height);
+			const auto compress = [&](const uint32_t start, const uint32_t end)
 			{
-				const auto bitmap_scaled = FreeImage_Rescale(bitmap, job.width, job.height, _ImagImporter::rescale_filter);
-				if (!GetBitsFromFibitmap(job.data, bitmap_scaled, job.width, job.height, job.channels))
-				{
-					LOGF_ERROR("Failed to create mip level %dx%d", job.width, job.height);
-				}
-				FreeImage_Unload(bitmap_scaled);
-				job.done = true;
-			});
-		}
+				TextureCompressor::CompressBlockRows(mip->data(), mip_width, mip_height, format, m_compression_quality, start, end, compressed.data());
+			};
 
-		// Wait until all mipmaps have been generated
-		auto ready = false;
-		while (!ready)
-		{
-			ready = true;
-			for (const auto& job : jobs)
+			if (block_rows >= threading->GetThreadCount())
+			{
+				threading->Loop(compress, block_rows);
+			}
+			else
+			{
+				compress(0, block_rows);
+			}
+
+			// Measure the quality of the top mip
+			if (i == 0)
 			{
-				if (!job.done)
-				{
-					ready = false;
-				}
+				psnr = TextureCompressor::ComputePsnr(*mip, compressed, mip_width, mip_height, format);
 			}
+
+			*mip = move(compressed);
+
+			mip_width	= Math::Max(mip_width / 2, static_cast<uint32_t>(1));
+			mip_height	= Math::Max(mip_height / 2, static_cast<uint32_t>(1));
 		}
+
+		LOGF_INFO("Block compressed %dx%d texture, PSNR: %.2f dB", width, height, psnr);
+		return true;
+	}
+
+	RHI_Format ImageImporter::ComputeCompressedFormat(const RHI_Texture_Usage usage, const bool is_transparent, const bool is_grayscale) const
+	{
+		if (usage == Texture_Usage_Color)
+		{
+			if (m_compression_quality == Compression_Fast)
+				return is_transparent ? Format_BC3_UNORM : Format_BC1_UNORM;
+
+			return Format_BC7_UNORM;
+		}
+
+		if (usage == Texture_Usage_Normal)
+			return is_grayscale ? Format_BC4_UNORM : Format_BC5_UNORM;
+
+		if (usage == Texture_Usage_Mask)
+			return Format_BC4_UNORM;
+
+		return Format_R8G8B8A8_UNORM;
 	}
 
 	uint32_t ImageImporter::ComputeChannelCount(FIBITMAP* bitmap) const
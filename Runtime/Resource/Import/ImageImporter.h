@@ -24,8 +24,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include <vector>
 #include <string>
+#include "TextureCompressor.h"
+#include "TextureDownsampler.h"
 #include "../../Core/EngineDefs.h"
 #include "../../RHI/RHI_Definition.h"
+#include "../../RHI/RHI_Texture.h"
 //===================================
 
 struct FIBITMAP;
@@ -42,17 +45,29 @@ namespace Spartan
 
 		bool Load(const std::string& file_path, RHI_Texture* texture, bool generate_mipmaps = true);
 
+		// Block compression
+		auto GetCompressionQuality() const									{ return m_compression_quality; }
+		void SetCompressionQuality(const Texture_Compression_Quality quality)	{ m_compression_quality = quality; }
+
+		// Mipmap generation
+		auto GetMipmapFilter() const					{ return m_mipmap_filter; }
+		void SetMipmapFilter(const Mipmap_Filter filter)	{ m_mipmap_filter = filter; }
+
 	private:	
 		bool GetBitsFromFibitmap(std::vector<std::byte>* data, FIBITMAP* bitmap, uint32_t width, uint32_t height, uint32_t channels);
-		void GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels);
+		void GenerateMipmaps(RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels, uint32_t bytes_per_channel, bool is_transparent, bool is_grayscale);
+		bool CompressMipmaps(RHI_Texture* texture, uint32_t width, uint32_t height, RHI_Format format);
 
 		uint32_t ComputeChannelCount(FIBITMAP* bitmap) const;
 		uint32_t ComputeBitsPerChannel(FIBITMAP* bitmap) const;
 		RHI_Format ComputeTextureFormat(uint32_t bytes_per_channel, uint32_t channels) const;
+		RHI_Format ComputeCompressedFormat(RHI_Texture_Usage usage, bool is_transparent, bool is_grayscale) const;
 		FIBITMAP* ApplyBitmapCorrections(FIBITMAP* bitmap) const;
 		FIBITMAP* _FreeImage_ConvertTo32Bits(FIBITMAP* bitmap) const;
 		FIBITMAP* _FreeImage_Rescale(FIBITMAP* bitmap, uint32_t width, uint32_t height) const;
 
 		Context* m_context;
+		Texture_Compression_Quality m_compression_quality = Compression_Normal;
+		Mipmap_Filter m_mipmap_filter = Mipmap_Filter_Kaiser;
 	};
 }
@@ -0,0 +1,272 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "MeshClusterizer.h"
+#include <cmath>
+#include "../../RHI/RHI_Vertex.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=============================
+
+namespace _MeshClusterizer
+{
+	static const uint32_t invalid = 0xFFFFFFFF;
+
+	// Below this, the normals of a cluster spread too far for the cone to ever cull it
+	static const float cone_min_dot = 0.1f;
+
+	// Area weighted normal of a triangle (the cross product of two of its edges)
+	inline void triangle_normal(const float* p0, const float* p1, const float* p2, float* normal)
+	{
+		const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	void compute_bounds(const uint32_t* indices, const uint32_t index_count, const vector<RHI_Vertex_PosTexNorTan>& vertices, Mesh_Cluster* cluster)
+	{
+		// Bounding sphere, centered on the bounding box
+		float box_min[3] = { INFINITY, INFINITY, INFINITY };
+		float box_max[3] = { -INFINITY, -INFINITY, -INFINITY };
+		for (uint32_t i = 0; i < index_count; i++)
+		{
+			const auto position = vertices[indices[i]].pos;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				box_min[k] = min(box_min[k], position[k]);
+				box_max[k] = max(box_max[k], position[k]);
+			}
+		}
+
+		const float center[3] = { (box_min[0] + box_max[0]) * 0.5f, (box_min[1] + box_max[1]) * 0.5f, (box_min[2] + box_max[2]) * 0.5f };
+		auto radius_squared = 0.0f;
+		for (uint32_t i = 0; i < index_count; i++)
+		{
+			const auto position = vertices[indices[i]].pos;
+			const float d[3] = { position[0] - center[0], position[1] - center[1], position[2] - center[2] };
+			radius_squared = max(radius_squared, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+		}
+		cluster->center = Vector3(center[0], center[1], center[2]);
+		cluster->radius = sqrtf(radius_squared);
+
+		// Normal cone, the axis averages the unit normals and the spread is given by the normal furthest from it
+		vector<float> normals;
+		normals.reserve(index_count);
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		for (uint32_t i = 0; i < index_count; i += 3)
+		{
+			float normal[3];
+			triangle_normal(vertices[indices[i]].pos, vertices[indices[i + 1]].pos, vertices[indices[i + 2]].pos, normal);
+			const auto length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length <= 0.0f)
+				continue;
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				normals.emplace_back(normal[k] / length);
+				axis[k] += normal[k] / length;
+			}
+		}
+
+		cluster->cone_axis		= Vector3::Zero;
+		cluster->cone_cutoff	= 1.0f;
+		const auto axis_length	= sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if (normals.empty() || axis_length <= 0.0f)
+			return;
+
+		for (auto& value : axis)
+		{
+			value /= axis_length;
+		}
+
+		auto min_dot = 1.0f;
+		for (size_t i = 0; i < normals.size(); i += 3)
+		{
+			min_dot = min(min_dot, normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]);
+		}
+
+		if (min_dot <= cone_min_dot)
+			return;
+
+		// A view direction within 90 - acos(min_dot) degrees of the axis sees every triangle from behind
+		cluster->cone_axis		= Vector3(axis[0], axis[1], axis[2]);
+		cluster->cone_cutoff	= sqrtf(1.0f - min_dot * min_dot);
+	}
+}
+
+void MeshClusterizer::Build(vector<uint32_t>* indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, vector<Mesh_Cluster>* clusters, const uint32_t max_vertices, const uint32_t max_triangles)
+{
+	clusters->clear();
+
+	const auto triangle_count	= static_cast<uint32_t>(indices->size() / 3);
+	const auto vertex_count		= static_cast<uint32_t>(vertices.size());
+	if (triangle_count == 0 || max_vertices < 3 || max_triangles == 0)
+		return;
+
+	const auto& source = *indices;
+
+	// Vertex to triangle adjacency
+	vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+	for (const auto index : source)
+	{
+		adjacency_offsets[index + 1]++;
+	}
+	for (uint32_t v = 0; v < vertex_count; v++)
+	{
+		adjacency_offsets[v + 1] += adjacency_offsets[v];
+	}
+	vector<uint32_t> adjacency(source.size());
+	{
+		auto fill = adjacency_offsets;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(source.size()); i++)
+		{
+			adjacency[fill[source[i]]++] = i / 3;
+		}
+	}
+
+	// Triangle centroids, for the spatial tie break
+	vector<float> centroids(triangle_count * 3);
+	for (uint32_t t = 0; t < triangle_count; t++)
+	{
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			centroids[t * 3 + k] = (vertices[source[t * 3]].pos[k] + vertices[source[t * 3 + 1]].pos[k] + vertices[source[t * 3 + 2]].pos[k]) / 3.0f;
+		}
+	}
+
+	vector<bool> emitted(triangle_count, false);
+	vector<uint32_t> vertex_cluster(vertex_count, _MeshClusterizer::invalid);
+	vector<uint32_t> cluster_vertices;
+	cluster_vertices.reserve(max_vertices);
+	vector<uint32_t> output;
+	output.reserve(source.size());
+
+	auto new_vertices = [&source, &vertex_cluster](const uint32_t triangle, const uint32_t cluster_id)
+	{
+		return
+			static_cast<uint32_t>(vertex_cluster[source[triangle * 3 + 0]] != cluster_id) +
+			static_cast<uint32_t>(vertex_cluster[source[triangle * 3 + 1]] != cluster_id) +
+			static_cast<uint32_t>(vertex_cluster[source[triangle * 3 + 2]] != cluster_id);
+	};
+
+	uint32_t scan = 0;
+	while (true)
+	{
+		// Seed each cluster with the first remaining triangle of the given order (which is cache optimized and spatially coherent)
+		while (scan < triangle_count && emitted[scan])
+		{
+			scan++;
+		}
+		if (scan == triangle_count)
+			break;
+
+		const auto cluster_id = static_cast<uint32_t>(clusters->size());
+		Mesh_Cluster cluster;
+		cluster.index_offset = static_cast<uint32_t>(output.size());
+		cluster_vertices.clear();
+		float center_sum[3]			= { 0.0f, 0.0f, 0.0f };
+		uint32_t cluster_triangles	= 0;
+
+		auto triangle = scan;
+		while (triangle != _MeshClusterizer::invalid)
+		{
+			emitted[triangle] = true;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const auto vertex = source[triangle * 3 + k];
+				if (vertex_cluster[vertex] != cluster_id)
+				{
+					vertex_cluster[vertex] = cluster_id;
+					cluster_vertices.emplace_back(vertex);
+				}
+				output.emplace_back(vertex);
+			}
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				center_sum[k] += centroids[triangle * 3 + k];
+			}
+			cluster_triangles++;
+
+			if (cluster_triangles == max_triangles)
+				break;
+
+			// Grow over shared vertices, preferring the triangle that adds the fewest vertices and then the one closest to the center
+			const float center[3] = { center_sum[0] / cluster_triangles, center_sum[1] / cluster_triangles, center_sum[2] / cluster_triangles };
+			auto best_new_vertices	= 4u;
+			auto best_distance		= INFINITY;
+			triangle				= _MeshClusterizer::invalid;
+			for (const auto vertex : cluster_vertices)
+			{
+				for (auto i = adjacency_offsets[vertex]; i < adjacency_offsets[vertex + 1]; i++)
+				{
+					const auto candidate = adjacency[i];
+					if (emitted[candidate])
+						continue;
+
+					const auto added = new_vertices(candidate, cluster_id);
+					if (cluster_vertices.size() + added > max_vertices || added > best_new_vertices)
+						continue;
+
+					const float d[3]		= { centroids[candidate * 3] - center[0], centroids[candidate * 3 + 1] - center[1], centroids[candidate * 3 + 2] - center[2] };
+					const auto distance		= d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+					if (added < best_new_vertices || distance < best_distance)
+					{
+						best_new_vertices	= added;
+						best_distance		= distance;
+						triangle			= candidate;
+					}
+				}
+			}
+
+			// Disconnected geometry (e.g. foliage cards) continues with the next triangle in order, if it fits
+			if (triangle == _MeshClusterizer::invalid)
+			{
+				while (scan < triangle_count && emitted[scan])
+				{
+					scan++;
+				}
+				if (scan < triangle_count && cluster_vertices.size() + new_vertices(scan, cluster_id) <= max_vertices)
+				{
+					triangle = scan;
+				}
+			}
+		}
+
+		cluster.index_count = static_cast<uint32_t>(output.size()) - cluster.index_offset;
+		_MeshClusterizer::compute_bounds(&output[cluster.index_offset], cluster.index_count, vertices, &cluster);
+		clusters->emplace_back(cluster);
+	}
+
+	*indices = move(output);
+}
+
+bool MeshClusterizer::IsBackFacing(const Mesh_Cluster& cluster, const Vector3& camera_position)
+{
+	const auto direction = cluster.center - camera_position;
+	return Vector3::Dot(direction, cluster.cone_axis) >= cluster.cone_cutoff * direction.Length() + cluster.radius;
+}
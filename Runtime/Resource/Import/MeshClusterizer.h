@@ -0,0 +1,52 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==========================
+#include <vector>
+#include <cstdint>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+#include "../../Rendering/Mesh.h"
+//=====================================
+
+namespace Spartan
+{
+	// Splits a mesh into clusters (meshlets) of spatially coherent triangles, each with a bounding sphere and a normal cone
+	class SPARTAN_CLASS MeshClusterizer
+	{
+	public:
+		// Reorders the triangles of indices so that each cluster is contiguous, the index offsets of the clusters are relative to indices.
+		// Clusters grow from their first triangle over shared vertices and stop at max_vertices unique vertices or max_triangles triangles.
+		static void Build(
+			std::vector<uint32_t>* indices,
+			const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+			std::vector<Mesh_Cluster>* clusters,
+			uint32_t max_vertices	= 64,
+			uint32_t max_triangles	= 124
+		);
+
+		// True when all the triangles of the cluster face away from camera_position (given in the space of the mesh, where
+		// the test is exact for any transform that doesn't mirror).
+		static bool IsBackFacing(const Mesh_Cluster& cluster, const Math::Vector3& camera_position);
+	};
+}
@@ -0,0 +1,442 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================================================
+#include "MeshDecomposer.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Math/BoundingBox.h"
+#pragma warning(push, 0) // Hide warnings which belong to Bullet
+#include <LinearMath/btConvexHullComputer.h>
+#pragma warning(pop)
+//==============================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=============================
+
+namespace _MeshDecomposer
+{
+	static const uint32_t split_candidates	= 15;	// Planes tried along each axis, evenly spread over the corners of a part
+	static const size_t surface_samples		= 256;	// Points of a hull's surface which are checked for being in a gap of the mesh
+	static const size_t corner_samples		= 4096;	// Corners of a part which are checked for being in a dent of its hull
+	static const size_t split_samples		= 2048;	// Corners of each side of a candidate plane whose hull is measured
+	static const btVector3 ray_directions[3] =
+	{
+		btVector3(1.0f, 0.0137f, 0.0291f).normalized(),
+		btVector3(0.0173f, 1.0f, 0.0233f).normalized(),
+		btVector3(0.0251f, 0.0119f, 1.0f).normalized()
+	};
+
+	// Triangles as three corners each, parts are cut out of the mesh so their corners aren't shared
+	typedef vector<btVector3> triangles;
+
+	struct part
+	{
+		triangles geometry;
+		vector<Vector3> hull;
+		float concavity = 0.0f;
+	};
+
+	// A point_max other than zero computes the hull of every n-th corner only, good enough for comparing volumes
+	void compute_hull(const triangles& geometry, btConvexHullComputer* hull, const size_t point_max = 0)
+	{
+		const auto step = point_max ? max<size_t>(1, geometry.size() / point_max) : 1;
+		hull->compute(geometry[0].m_floats, static_cast<int>(sizeof(btVector3) * step), static_cast<int>(geometry.size() / step), 0.0f, 0.0f);
+	}
+
+	// Keeps what's below the plane (axis < position) or above it, triangles which cross it are cut (Sutherland-Hodgman) and triangulated
+	// again. Triangles which lie in the plane bound the side they face away from.
+	void clip(const triangles& geometry, const int axis, const float position, const bool below, triangles* output)
+	{
+		output->clear();
+		btVector3 polygon[4];
+		for (size_t i = 0; i < geometry.size(); i += 3)
+		{
+			if (geometry[i][axis] == position && geometry[i + 1][axis] == position && geometry[i + 2][axis] == position)
+			{
+				const auto normal = (geometry[i + 1] - geometry[i]).cross(geometry[i + 2] - geometry[i]);
+				if ((normal[axis] > 0.0f) == below)
+				{
+					output->insert(output->end(), geometry.begin() + i, geometry.begin() + i + 3);
+				}
+				continue;
+			}
+
+			auto count = 0;
+			for (auto j = 0; j < 3; j++)
+			{
+				const auto& a		= geometry[i + j];
+				const auto& b		= geometry[i + (j + 1) % 3];
+				const auto a_side	= (a[axis] < position) == below;
+				const auto b_side	= (b[axis] < position) == below;
+
+				if (a_side)
+				{
+					polygon[count++] = a;
+				}
+
+				if (a_side != b_side)
+				{
+					polygon[count++] = a.lerp(b, (position - a[axis]) / (b[axis] - a[axis]));
+				}
+			}
+
+			// Triangles which only touch the plane leave slivers behind
+			for (auto j = 2; j < count; j++)
+			{
+				if ((polygon[j - 1] - polygon[0]).cross(polygon[j] - polygon[0]).length2() <= FLT_MIN)
+					continue;
+
+				output->emplace_back(polygon[0]);
+				output->emplace_back(polygon[j - 1]);
+				output->emplace_back(polygon[j]);
+			}
+		}
+	}
+
+	// Calls function(a, b, c) for a fan of every face, counter-clockwise seen from outside
+	template <typename Function>
+	void for_each_triangle(const btConvexHullComputer& hull, Function&& function)
+	{
+		for (auto i = 0; i < hull.faces.size(); i++)
+		{
+			const auto first	= &hull.edges[hull.faces[i]];
+			const auto& a		= hull.vertices[first->getSourceVertex()];
+			for (auto edge = first->getNextEdgeOfFace(); edge->getTargetVertex() != first->getSourceVertex(); edge = edge->getNextEdgeOfFace())
+			{
+				function(a, hull.vertices[edge->getSourceVertex()], hull.vertices[edge->getTargetVertex()]);
+			}
+		}
+	}
+
+	float hull_volume(const btConvexHullComputer& hull)
+	{
+		btScalar volume = 0.0f;
+		for_each_triangle(hull, [&volume](const btVector3& a, const btVector3& b, const btVector3& c) { volume += a.dot(b.cross(c)); });
+		return abs(volume) / 6.0f;
+	}
+
+	// Closest point on a triangle (Ericson, Real-Time Collision Detection 5.1.5)
+	btVector3 closest_point(const btVector3& p, const btVector3& a, const btVector3& b, const btVector3& c)
+	{
+		const auto ab = b - a;
+		const auto ac = c - a;
+		const auto ap = p - a;
+		const auto d1 = ab.dot(ap);
+		const auto d2 = ac.dot(ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+		const auto bp = p - b;
+		const auto d3 = ab.dot(bp);
+		const auto d4 = ac.dot(bp);
+		if (d3 >= 0.0f && d4 <= d3) return b;
+
+		const auto vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+		const auto cp = p - c;
+		const auto d5 = ab.dot(cp);
+		const auto d6 = ac.dot(cp);
+		if (d6 >= 0.0f && d5 <= d6) return c;
+
+		const auto vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+		const auto va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const auto denominator = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+
+	// Whether the ray from p crosses the triangle (Moller-Trumbore), one if it leaves through the front, minus one if it enters it
+	int ray_crossing(const btVector3& p, const btVector3& direction, const btVector3& a, const btVector3& b, const btVector3& c)
+	{
+		const auto ab		= b - a;
+		const auto ac		= c - a;
+		const auto h		= direction.cross(ac);
+		const auto det		= ab.dot(h);
+		if (abs(det) <= FLT_EPSILON)
+			return 0;
+
+		const auto ap	= p - a;
+		const auto u	= ap.dot(h) / det;
+		if (u < 0.0f || u > 1.0f)
+			return 0;
+
+		const auto q	= ap.cross(ab);
+		const auto v	= direction.dot(q) / det;
+		if (v < 0.0f || u + v > 1.0f)
+			return 0;
+
+		if (ac.dot(q) / det <= 0.0f)
+			return 0;
+
+		return det < 0.0f ? 1 : -1;
+	}
+
+	// How far a part is from its hull. The deepest vertex inside the hull catches dents (the inside of a cup), the hull surface
+	// furthest away from the mesh catches gaps (between the legs of a chair) which leave every vertex on the hull. Hull surface
+	// which lies inside the mesh doesn't count, that's where a part was cut off from the rest. Inside is a winding number other than
+	// zero (so that shells may overlap) along three rays, the majority wins.
+	// The rays are slightly off the axes, cuts are axis aligned and rays along them would graze the edges they leave behind.
+	float hull_concavity(const triangles& mesh, const triangles& geometry, const btConvexHullComputer& hull, const float tolerance)
+	{
+		auto concavity = 0.0f;
+
+		// A plane per face, facing out
+		vector<btVector4> planes;
+		planes.reserve(hull.faces.size());
+		for (auto i = 0; i < hull.faces.size(); i++)
+		{
+			const auto first	= &hull.edges[hull.faces[i]];
+			const auto second	= first->getNextEdgeOfFace();
+			const auto& a		= hull.vertices[first->getSourceVertex()];
+			const auto& b		= hull.vertices[second->getSourceVertex()];
+			const auto& c		= hull.vertices[second->getTargetVertex()];
+			auto normal			= (b - a).cross(c - a);
+			if (normal.length2() <= FLT_MIN)
+				continue;
+
+			normal.normalize();
+			planes.emplace_back(normal.x(), normal.y(), normal.z(), normal.dot(a));
+		}
+
+		// Dents, unless it's flat
+		if (planes.size() >= 4)
+		{
+			const auto corner_step = max<size_t>(1, geometry.size() / corner_samples);
+			for (size_t i = 0; i < geometry.size(); i += corner_step)
+			{
+				const auto& p = geometry[i];
+				auto depth = FLT_MAX;
+				for (const auto& plane : planes)
+				{
+					depth = min(depth, plane.w() - (plane.x() * p.x() + plane.y() * p.y() + plane.z() * p.z()));
+				}
+				concavity = max(concavity, depth);
+			}
+		}
+
+		// Gaps, samples which are closer to the mesh than what was found so far (most of them) don't need the inside test
+		vector<btVector3> samples;
+		for_each_triangle(hull, [&samples](const btVector3& a, const btVector3& b, const btVector3& c) { samples.emplace_back((a + b + c) / 3.0f); });
+		const auto sample_step = max<size_t>(1, samples.size() / surface_samples);
+		for (size_t i = 0; i < samples.size(); i += sample_step)
+		{
+			const auto& p			= samples[i];
+			const auto threshold	= max(concavity, tolerance);
+			auto distance			= FLT_MAX;
+			for (size_t j = 0; j < mesh.size() && distance > threshold * threshold; j += 3)
+			{
+				distance = min(distance, (closest_point(p, mesh[j], mesh[j + 1], mesh[j + 2]) - p).length2());
+			}
+
+			if (distance <= threshold * threshold)
+				continue;
+
+			int winding[3] = { 0, 0, 0 };
+			for (size_t j = 0; j < mesh.size(); j += 3)
+			{
+				for (auto ray = 0; ray < 3; ray++)
+				{
+					winding[ray] += ray_crossing(p, ray_directions[ray], mesh[j], mesh[j + 1], mesh[j + 2]);
+				}
+			}
+
+			const auto inside = (winding[0] != 0) + (winding[1] != 0) + (winding[2] != 0) >= 2;
+			if (!inside)
+			{
+				concavity = sqrt(distance);
+			}
+		}
+
+		return concavity;
+	}
+
+	// Hull points, the support points of evenly spread (Fibonacci sphere) directions if there are too many
+	void hull_points(const btConvexHullComputer& hull, const uint32_t vertex_max, vector<Vector3>* points)
+	{
+		const auto count = static_cast<uint32_t>(hull.vertices.size());
+		points->clear();
+
+		if (count <= vertex_max)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				points->emplace_back(hull.vertices[i].x(), hull.vertices[i].y(), hull.vertices[i].z());
+			}
+			return;
+		}
+
+		vector<bool> picked(count, false);
+		const auto golden_angle = 2.39996323f;
+		for (uint32_t i = 0; i < vertex_max; i++)
+		{
+			const auto y		= 1.0f - 2.0f * (i + 0.5f) / vertex_max;
+			const auto radius	= sqrt(max(0.0f, 1.0f - y * y));
+			const auto angle	= golden_angle * i;
+			const btVector3 direction(cos(angle) * radius, y, sin(angle) * radius);
+
+			uint32_t best	= 0;
+			auto best_dot	= -FLT_MAX;
+			for (uint32_t j = 0; j < count; j++)
+			{
+				const auto dot = direction.dot(hull.vertices[j]);
+				if (dot > best_dot)
+				{
+					best_dot	= dot;
+					best		= j;
+				}
+			}
+
+			if (!picked[best])
+			{
+				picked[best] = true;
+				points->emplace_back(hull.vertices[best].x(), hull.vertices[best].y(), hull.vertices[best].z());
+			}
+		}
+	}
+
+	void evaluate(const triangles& mesh, const uint32_t hull_vertex_max, const float tolerance, part* part)
+	{
+		btConvexHullComputer hull;
+		compute_hull(part->geometry, &hull);
+		part->concavity = hull_concavity(mesh, part->geometry, hull, tolerance);
+		hull_points(hull, hull_vertex_max, &part->hull);
+	}
+
+	// Cuts along the plane whose two sides have the smallest hulls, false if no plane leaves geometry on both sides
+	bool split(const part& source, part* left, part* right)
+	{
+		auto best_cost	= FLT_MAX;
+		auto best_axis	= 0;
+		auto best_plane	= 0.0f;
+		triangles side[2];
+		vector<float> planes;
+		btConvexHullComputer hull;
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			// Planes go through corners, so that they line up with the edges of hard surface geometry
+			planes.clear();
+			for (const auto& corner : source.geometry)
+			{
+				planes.emplace_back(corner[axis]);
+			}
+			sort(planes.begin(), planes.end());
+			planes.erase(unique(planes.begin(), planes.end()), planes.end());
+			if (planes.size() < 3)
+				continue;
+
+			const auto inner = static_cast<uint32_t>(planes.size() - 2); // The extremes leave nothing on one side
+			for (uint32_t candidate = 0; candidate < min(inner, split_candidates); candidate++)
+			{
+				const auto plane = planes[1 + (inner <= split_candidates ? candidate : candidate * inner / split_candidates)];
+				clip(source.geometry, axis, plane, true, &side[0]);
+				clip(source.geometry, axis, plane, false, &side[1]);
+				if (side[0].empty() || side[1].empty())
+					continue;
+
+				auto cost = 0.0f;
+				for (const auto& geometry : side)
+				{
+					compute_hull(geometry, &hull, split_samples);
+					cost += hull_volume(hull);
+				}
+
+				if (cost < best_cost)
+				{
+					best_cost	= cost;
+					best_axis	= axis;
+					best_plane	= plane;
+				}
+			}
+		}
+
+		if (best_cost == FLT_MAX)
+			return false;
+
+		clip(source.geometry, best_axis, best_plane, true, &left->geometry);
+		clip(source.geometry, best_axis, best_plane, false, &right->geometry);
+		return true;
+	}
+}
+
+namespace Spartan
+{
+	void MeshDecomposer::Decompose(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, vector<vector<Vector3>>* hulls, const uint32_t hull_count_max, const float concavity, const uint32_t hull_vertex_max)
+	{
+		if (!hulls)
+			return;
+
+		hulls->clear();
+		const auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+		if (triangle_count == 0 || vertices.empty())
+			return;
+
+		_MeshDecomposer::triangles mesh(triangle_count * 3);
+		for (uint32_t i = 0; i < triangle_count * 3; i++)
+		{
+			const auto& vertex	= vertices[indices[i]];
+			mesh[i]				= btVector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+		}
+		const auto extent		= BoundingBox(vertices).GetSize();
+		const auto tolerance	= concavity * max(extent.x, max(extent.y, extent.z));
+
+		vector<_MeshDecomposer::part> parts(1);
+		parts[0].geometry = mesh;
+		_MeshDecomposer::evaluate(mesh, hull_vertex_max, tolerance, &parts[0]);
+
+		// Split the most concave part until they are all convex enough or there are no hulls left
+		while (parts.size() < max(hull_count_max, 1u))
+		{
+			const auto worst = max_element(parts.begin(), parts.end(), [](const _MeshDecomposer::part& a, const _MeshDecomposer::part& b) { return a.concavity < b.concavity; });
+			if (worst->concavity <= tolerance)
+				break;
+
+			_MeshDecomposer::part left;
+			_MeshDecomposer::part right;
+			if (!_MeshDecomposer::split(*worst, &left, &right))
+			{
+				worst->concavity = 0.0f; // Nothing left to split, keep it as it is
+				continue;
+			}
+
+			_MeshDecomposer::evaluate(mesh, hull_vertex_max, tolerance, &left);
+			_MeshDecomposer::evaluate(mesh, hull_vertex_max, tolerance, &right);
+			*worst = move(left);
+			parts.emplace_back(move(right));
+		}
+
+		for (auto& part : parts)
+		{
+			if (part.hull.size() >= 4)
+			{
+				hulls->emplace_back(move(part.hull));
+			}
+		}
+	}
+}
@@ -0,0 +1,52 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include <cstdint>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+#include "../../Math/Vector3.h"
+//===================================
+
+namespace Spartan
+{
+	// Approximate convex decomposition, for dynamic bodies which a single convex hull would fill in (cups, arches, chairs).
+	// Parts are cut in two along the axis aligned plane which minimizes the volume of their hulls, the most concave part first.
+	// Triangles which cross the plane are cut as well, so neighbouring hulls meet at it.
+	class SPARTAN_CLASS MeshDecomposer
+	{
+	public:
+		// Splits until every part lies within concavity of its convex hull or until there are hull_count_max parts. Concavity is the
+		// distance between a part and its hull, relative to the extent of the mesh (the largest side of its bounding box).
+		// Hulls with more than hull_vertex_max points keep the ones which are furthest along evenly spread directions.
+		static void Decompose(
+			const std::vector<uint32_t>& indices,
+			const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+			std::vector<std::vector<Math::Vector3>>* hulls,
+			uint32_t hull_count_max		= 16,
+			float concavity				= 0.02f,
+			uint32_t hull_vertex_max	= 64
+		);
+	};
+}
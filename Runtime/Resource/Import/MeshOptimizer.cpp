@@ -0,0 +1,396 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Logging/Log.h"
+//===============================
+
+//= NAMESPACES =========
+using namespace std;
+using namespace Spartan;
+//======================
+
+namespace _MeshOptimizer
+{
+	static const uint32_t invalid = 0xFFFFFFFF;
+
+	// FIFO post-transform cache, a vertex is cached if fewer than cache_size misses happened since it was last transformed
+	struct vertex_cache
+	{
+		vector<uint32_t> timestamps;
+		uint32_t time = MeshOptimizer::cache_size + 1;
+
+		explicit vertex_cache(const uint32_t vertex_count) : timestamps(vertex_count, 0) {}
+
+		bool access(const uint32_t vertex)
+		{
+			if (time - timestamps[vertex] <= MeshOptimizer::cache_size)
+				return false;
+
+			timestamps[vertex] = time++;
+			return true;
+		}
+
+		uint32_t access_triangle(const uint32_t* triangle) { return access(triangle[0]) + access(triangle[1]) + access(triangle[2]); }
+
+		void flush() { time += MeshOptimizer::cache_size + 1; }
+	};
+
+	// Area weighted normal of a triangle (the cross product of two of its edges)
+	inline void triangle_normal(const float* p0, const float* p1, const float* p2, float* normal)
+	{
+		const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+}
+
+void MeshOptimizer::OptimizeVertexCache(vector<uint32_t>* indices, const uint32_t vertex_count)
+{
+	using namespace _MeshOptimizer;
+
+	if (!indices || indices->size() % 3 != 0)
+	{
+		LOG_ERROR_INVALID_PARAMETER();
+		return;
+	}
+
+	const auto& input			= *indices;
+	const auto triangle_count	= static_cast<uint32_t>(input.size() / 3);
+	if (triangle_count == 0)
+		return;
+
+	// Triangles around each vertex, live counts the ones not emitted yet
+	vector<uint32_t> live(vertex_count, 0);
+	vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+	vector<uint32_t> adjacency(input.size());
+	{
+		for (const auto index : input)
+		{
+			live[index]++;
+		}
+
+		partial_sum(live.begin(), live.end(), adjacency_offsets.begin() + 1);
+
+		vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+		for (uint32_t i = 0; i < static_cast<uint32_t>(input.size()); i++)
+		{
+			adjacency[cursor[input[i]]++] = i / 3;
+		}
+	}
+
+	vector<uint32_t> output;
+	output.reserve(input.size());
+	vector<uint32_t> timestamps(vertex_count, 0);
+	vector<uint8_t> emitted(triangle_count, 0);
+	vector<uint32_t> dead_ends;
+	dead_ends.reserve(input.size());
+	vector<uint32_t> candidates;
+	uint32_t time	= cache_size + 1;
+	uint32_t cursor	= 0;
+
+	// When the fan runs out of candidates, resume from a recently used vertex, or from the next vertex in input order
+	auto skip_dead_end = [&]()
+	{
+		while (!dead_ends.empty())
+		{
+			const auto vertex = dead_ends.back();
+			dead_ends.pop_back();
+			if (live[vertex] > 0)
+				return vertex;
+		}
+
+		for (; cursor < vertex_count; cursor++)
+		{
+			if (live[cursor] > 0)
+				return cursor;
+		}
+
+		return invalid;
+	};
+
+	auto fanning = skip_dead_end();
+	while (fanning != invalid)
+	{
+		// Emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (auto i = adjacency_offsets[fanning]; i < adjacency_offsets[fanning + 1]; i++)
+		{
+			const auto triangle = adjacency[i];
+			if (emitted[triangle])
+				continue;
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const auto vertex = input[triangle * 3 + k];
+				output.emplace_back(vertex);
+				dead_ends.emplace_back(vertex);
+				candidates.emplace_back(vertex);
+				live[vertex]--;
+
+				if (time - timestamps[vertex] > cache_size)
+				{
+					timestamps[vertex] = time++;
+				}
+			}
+
+			emitted[triangle] = 1;
+		}
+
+		// Fan around the candidate which will still be in the cache once its remaining triangles are emitted, the oldest one wins
+		auto next_fanning	= invalid;
+		auto best_priority	= -1;
+		for (const auto vertex : candidates)
+		{
+			if (live[vertex] == 0)
+				continue;
+
+			auto priority = 0;
+			if (time - timestamps[vertex] + 2 * live[vertex] <= cache_size)
+			{
+				priority = static_cast<int>(time - timestamps[vertex]);
+			}
+
+			if (priority > best_priority)
+			{
+				best_priority	= priority;
+				next_fanning	= vertex;
+			}
+		}
+
+		fanning = next_fanning != invalid ? next_fanning : skip_dead_end();
+	}
+
+	*indices = move(output);
+}
+
+void MeshOptimizer::OptimizeOverdraw(vector<uint32_t>* indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const float threshold)
+{
+	using namespace _MeshOptimizer;
+
+	if (!indices || indices->size() % 3 != 0)
+	{
+		LOG_ERROR_INVALID_PARAMETER();
+		return;
+	}
+
+	const auto& input			= *indices;
+	const auto triangle_count	= static_cast<uint32_t>(input.size() / 3);
+	const auto vertex_count		= static_cast<uint32_t>(vertices.size());
+	if (triangle_count == 0)
+		return;
+
+	// Hard boundaries, a triangle whose vertices all miss the cache starts a new strip of fans
+	vector<uint32_t> clusters;
+	{
+		vertex_cache cache(vertex_count);
+		for (uint32_t i = 0; i < triangle_count; i++)
+		{
+			const auto misses = cache.access_triangle(&input[i * 3]);
+			if (i == 0 || misses == 3)
+			{
+				clusters.emplace_back(i);
+			}
+		}
+	}
+
+	// Soft boundaries, split clusters further where the cache efficiency of a piece is close to that of the whole cluster
+	{
+		vector<uint32_t> soft_clusters;
+		vertex_cache cache(vertex_count);
+		for (uint32_t c = 0; c < static_cast<uint32_t>(clusters.size()); c++)
+		{
+			const auto start	= clusters[c];
+			const auto end		= c + 1 < clusters.size() ? clusters[c + 1] : triangle_count;
+
+			uint32_t cluster_misses = 0;
+			cache.flush();
+			for (auto i = start; i < end; i++)
+			{
+				cluster_misses += cache.access_triangle(&input[i * 3]);
+			}
+			const auto acmr_limit = threshold * cluster_misses / (end - start);
+
+			soft_clusters.emplace_back(start);
+			uint32_t misses		= 0;
+			uint32_t triangles	= 0;
+			cache.flush();
+			for (auto i = start; i < end; i++)
+			{
+				misses += cache.access_triangle(&input[i * 3]);
+				triangles++;
+
+				if (i + 1 < end && misses <= acmr_limit * triangles)
+				{
+					soft_clusters.emplace_back(i + 1);
+					misses		= 0;
+					triangles	= 0;
+					cache.flush();
+				}
+			}
+		}
+		clusters = move(soft_clusters);
+	}
+
+	// Sort clusters by how much they face away from the center of the mesh, those facing outwards occlude the rest from most views
+	const auto cluster_count = static_cast<uint32_t>(clusters.size());
+	vector<float> sort_keys(cluster_count);
+	{
+		float mesh_centroid[3]	= { 0.0f, 0.0f, 0.0f };
+		float mesh_area			= 0.0f;
+		vector<float> centroids(cluster_count * 3, 0.0f);
+		vector<float> normals(cluster_count * 3, 0.0f);
+
+		for (uint32_t c = 0; c < cluster_count; c++)
+		{
+			const auto start	= clusters[c];
+			const auto end		= c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+
+			float cluster_area = 0.0f;
+			for (auto i = start; i < end; i++)
+			{
+				const auto p0 = vertices[input[i * 3 + 0]].pos;
+				const auto p1 = vertices[input[i * 3 + 1]].pos;
+				const auto p2 = vertices[input[i * 3 + 2]].pos;
+
+				float normal[3];
+				triangle_normal(p0, p1, p2, normal);
+				const auto area = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					const auto centroid = (p0[k] + p1[k] + p2[k]) / 3.0f;
+					centroids[c * 3 + k]	+= centroid * area;
+					normals[c * 3 + k]		+= normal[k];
+					mesh_centroid[k]		+= centroid * area;
+				}
+				cluster_area	+= area;
+				mesh_area		+= area;
+			}
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				centroids[c * 3 + k] = cluster_area > 0.0f ? centroids[c * 3 + k] / cluster_area : 0.0f;
+			}
+		}
+
+		for (auto& value : mesh_centroid)
+		{
+			value = mesh_area > 0.0f ? value / mesh_area : 0.0f;
+		}
+
+		for (uint32_t c = 0; c < cluster_count; c++)
+		{
+			const auto normal	= &normals[c * 3];
+			const auto length	= sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			const auto scale	= length > 0.0f ? 1.0f / length : 0.0f;
+
+			sort_keys[c] = 0.0f;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				sort_keys[c] += (centroids[c * 3 + k] - mesh_centroid[k]) * normal[k] * scale;
+			}
+		}
+	}
+
+	vector<uint32_t> order(cluster_count);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), [&sort_keys](const uint32_t a, const uint32_t b) { return sort_keys[a] > sort_keys[b]; });
+
+	vector<uint32_t> output;
+	output.reserve(input.size());
+	for (const auto c : order)
+	{
+		const auto start	= clusters[c];
+		const auto end		= c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+		output.insert(output.end(), input.begin() + start * 3, input.begin() + end * 3);
+	}
+
+	*indices = move(output);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(vector<RHI_Vertex_PosTexNorTan>* vertices, const vector<vector<uint32_t>*>& index_lists, vector<uint32_t>* remap_out /*= nullptr*/)
+{
+	using namespace _MeshOptimizer;
+
+	if (!vertices)
+	{
+		LOG_ERROR_INVALID_PARAMETER();
+		return;
+	}
+
+	vector<uint32_t> remap(vertices->size(), invalid);
+	uint32_t vertex_count = 0;
+	for (const auto indices : index_lists)
+	{
+		for (auto& index : *indices)
+		{
+			if (remap[index] == invalid)
+			{
+				remap[index] = vertex_count++;
+			}
+			index = remap[index];
+		}
+	}
+
+	vector<RHI_Vertex_PosTexNorTan> output(vertex_count);
+	for (uint32_t i = 0; i < static_cast<uint32_t>(vertices->size()); i++)
+	{
+		if (remap[i] != invalid)
+		{
+			output[remap[i]] = (*vertices)[i];
+		}
+	}
+
+	*vertices = move(output);
+	if (remap_out)
+	{
+		*remap_out = move(remap);
+	}
+}
+
+Vertex_Cache_Statistics MeshOptimizer::AnalyzeVertexCache(const vector<uint32_t>& indices, const uint32_t vertex_count)
+{
+	Vertex_Cache_Statistics statistics;
+	statistics.triangle_count = static_cast<uint32_t>(indices.size() / 3);
+
+	_MeshOptimizer::vertex_cache cache(vertex_count);
+	vector<uint8_t> referenced(vertex_count, 0);
+	for (const auto index : indices)
+	{
+		statistics.vertices_transformed += cache.access(index);
+
+		if (!referenced[index])
+		{
+			referenced[index] = 1;
+			statistics.vertex_count++;
+		}
+	}
+
+	return statistics;
+}
@@ -0,0 +1,72 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include <cstdint>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+namespace Spartan
+{
+	// Result of running an index buffer through a simulated FIFO post-transform cache
+	struct Vertex_Cache_Statistics
+	{
+		uint32_t vertices_transformed	= 0;
+		uint32_t triangle_count			= 0;
+		uint32_t vertex_count			= 0; // Unique vertices referenced
+
+		// Average cache miss ratio, vertices transformed per triangle (3 is the worst, about 0.5 is the best a regular grid can do)
+		float GetAcmr() const { return triangle_count ? static_cast<float>(vertices_transformed) / triangle_count : 0.0f; }
+		// Average transformed vertex ratio, times each vertex is transformed (1 is ideal)
+		float GetAtvr() const { return vertex_count ? static_cast<float>(vertices_transformed) / vertex_count : 0.0f; }
+
+		void Add(const Vertex_Cache_Statistics& other)
+		{
+			vertices_transformed	+= other.vertices_transformed;
+			triangle_count			+= other.triangle_count;
+			vertex_count			+= other.vertex_count;
+		}
+	};
+
+	// Reorders mesh data for the GPU, none of these change what gets rendered
+	class SPARTAN_CLASS MeshOptimizer
+	{
+	public:
+		// Reorders triangles for post-transform cache hits (Tipsify, Sander et al. 2007)
+		static void OptimizeVertexCache(std::vector<uint32_t>* indices, uint32_t vertex_count);
+
+		// Splits cache optimized triangles into clusters and draws the outward facing ones first, so that the depth test rejects more
+		// of what follows. Clusters are only split as long as their ACMR stays within threshold (e.g. 1.05) of the original ordering.
+		static void OptimizeOverdraw(std::vector<uint32_t>* indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, float threshold);
+
+		// Reorders vertices by first use across the index lists (in the order given) and drops unreferenced ones, the index lists are remapped.
+		// The remap takes every old vertex index to its new one (or to 0xFFFFFFFF if it was dropped), so that per vertex data can follow.
+		static void OptimizeVertexFetch(std::vector<RHI_Vertex_PosTexNorTan>* vertices, const std::vector<std::vector<uint32_t>*>& index_lists, std::vector<uint32_t>* remap = nullptr);
+
+		static Vertex_Cache_Statistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertex_count);
+
+		static const uint32_t cache_size = 16;
+	};
+}
@@ -0,0 +1,518 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ====================
+#include "MeshSimplifier.h"
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Logging/Log.h"
+//===============================
+
+//= NAMESPACES =========
+using namespace std;
+using namespace Spartan;
+//======================
+
+namespace _MeshSimplifier
+{
+	static const uint32_t invalid		= 0xFFFFFFFF;
+	static const float border_weight	= 10.0f;
+
+	enum vertex_kind : uint8_t
+	{
+		kind_manifold,	// Interior vertex, collapses in any direction
+		kind_border,	// Sits on an open edge, collapses along it
+		kind_locked		// Non manifold vertex or a border corner, never collapses
+	};
+
+	struct float3
+	{
+		float x, y, z;
+	};
+
+	// Sum of squared distances to a set of planes, stored as the symmetric 4x4 matrix of the plane equations
+	struct quadric
+	{
+		double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+		double a01 = 0.0, a02 = 0.0, a12 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double w = 0.0;
+	};
+
+	struct collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		float cost;
+	};
+
+	inline float3 sub(const float3& a, const float3& b)		{ return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline float3 cross(const float3& a, const float3& b)	{ return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline float dot(const float3& a, const float3& b)		{ return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline float length(const float3& a)					{ return sqrt(dot(a, a)); }
+
+	// Edges are keyed by their end points, in the order given
+	inline uint64_t edge_key(const uint32_t a, const uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+
+	inline void quadric_add_plane(quadric& q, const float3& n, const float d, const float w)
+	{
+		q.a00 += w * n.x * n.x; q.a11 += w * n.y * n.y; q.a22 += w * n.z * n.z;
+		q.a01 += w * n.x * n.y; q.a02 += w * n.x * n.z; q.a12 += w * n.y * n.z;
+		q.b0 += w * n.x * d; q.b1 += w * n.y * d; q.b2 += w * n.z * d;
+		q.c += w * d * d;
+		q.w += w;
+	}
+
+	inline void quadric_add(quadric& q, const quadric& r)
+	{
+		q.a00 += r.a00; q.a11 += r.a11; q.a22 += r.a22;
+		q.a01 += r.a01; q.a02 += r.a02; q.a12 += r.a12;
+		q.b0 += r.b0; q.b1 += r.b1; q.b2 += r.b2;
+		q.c += r.c;
+		q.w += r.w;
+	}
+
+	// Weighted mean of the squared distances from p to the planes
+	inline float quadric_error(const quadric& q, const float3& p)
+	{
+		const double x = p.x, y = p.y, z = p.z;
+		const double e =
+			q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+			2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+			2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) +
+			q.c;
+
+		return q.w > 0.0 ? static_cast<float>(fabs(e) / q.w) : 0.0f;
+	}
+
+	inline bool has_edge(const vector<uint64_t>& edges, const uint32_t a, const uint32_t b)
+	{
+		return binary_search(edges.begin(), edges.end(), edge_key(min(a, b), max(a, b)));
+	}
+
+	// The wedge of position "to" which shares an edge with wedge w, there has to be exactly one for w to collapse into it
+	inline uint32_t wedge_target(const vector<uint32_t>& wedge, const vector<uint64_t>& wedge_edges, const uint32_t w, const uint32_t to)
+	{
+		uint32_t target	= invalid;
+		uint32_t t		= to;
+		do
+		{
+			if (has_edge(wedge_edges, w, t))
+			{
+				if (target != invalid)
+					return invalid;
+
+				target = t;
+			}
+			t = wedge[t];
+		} while (t != to);
+
+		return target;
+	}
+}
+
+float MeshSimplifier::Simplify(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t target_index_count, const float target_error, vector<uint32_t>* output)
+{
+	using namespace _MeshSimplifier;
+
+	if (!output || indices.size() % 3 != 0)
+	{
+		LOG_ERROR_INVALID_PARAMETER();
+		return 0.0f;
+	}
+
+	auto& result = *output;
+	result = indices;
+
+	target_index_count -= target_index_count % 3;
+	if (result.size() <= target_index_count || vertices.empty())
+		return 0.0f;
+
+	const auto vertex_count = static_cast<uint32_t>(vertices.size());
+	auto index_count		= static_cast<uint32_t>(result.size());
+
+	// Positions, normalized so that errors are relative to the mesh extent
+	vector<float3> positions(vertex_count);
+	{
+		float3 min = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		float3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (const auto& vertex : vertices)
+		{
+			min = { std::min(min.x, vertex.pos[0]), std::min(min.y, vertex.pos[1]), std::min(min.z, vertex.pos[2]) };
+			max = { std::max(max.x, vertex.pos[0]), std::max(max.y, vertex.pos[1]), std::max(max.z, vertex.pos[2]) };
+		}
+
+		const auto extent	= std::max(max.x - min.x, std::max(max.y - min.y, max.z - min.z));
+		const auto scale	= extent > 0.0f ? 1.0f / extent : 0.0f;
+		for (uint32_t i = 0; i < vertex_count; i++)
+		{
+			positions[i] = { (vertices[i].pos[0] - min.x) * scale, (vertices[i].pos[1] - min.y) * scale, (vertices[i].pos[2] - min.z) * scale };
+		}
+	}
+
+	// Vertices which share a position are simplified as one, remap points to the first of them and wedge links them in a circular list
+	vector<uint32_t> remap(vertex_count);
+	vector<uint32_t> wedge(vertex_count);
+	{
+		auto position_less = [&vertices](const uint32_t a, const uint32_t b)
+		{
+			const auto& pa = vertices[a].pos;
+			const auto& pb = vertices[b].pos;
+			if (pa[0] != pb[0]) return pa[0] < pb[0];
+			if (pa[1] != pb[1]) return pa[1] < pb[1];
+			if (pa[2] != pb[2]) return pa[2] < pb[2];
+			return a < b;
+		};
+
+		vector<uint32_t> order(vertex_count);
+		iota(order.begin(), order.end(), 0);
+		sort(order.begin(), order.end(), position_less);
+
+		for (uint32_t i = 0; i < vertex_count;)
+		{
+			const auto& p = vertices[order[i]].pos;
+
+			auto last = i;
+			while (last + 1 < vertex_count && memcmp(vertices[order[last + 1]].pos, p, sizeof(float) * 3) == 0)
+			{
+				last++;
+			}
+
+			for (auto k = i; k <= last; k++)
+			{
+				remap[order[k]] = order[i];
+				wedge[order[k]] = order[k == last ? i : k + 1];
+			}
+
+			i = last + 1;
+		}
+	}
+
+	// Classify positions by their open edges, a border vertex has exactly one edge going out and one coming in
+	vector<vertex_kind> kind(vertex_count, kind_manifold);
+	vector<uint32_t> border_next(vertex_count, invalid);
+	vector<uint32_t> border_prev(vertex_count, invalid);
+	{
+		vector<uint64_t> half_edges;
+		half_edges.reserve(index_count);
+		for (uint32_t i = 0; i < index_count; i += 3)
+		{
+			for (uint32_t e = 0; e < 3; e++)
+			{
+				const auto a = remap[result[i + e]];
+				const auto b = remap[result[i + (e + 1) % 3]];
+				if (a != b)
+				{
+					half_edges.emplace_back(edge_key(a, b));
+				}
+			}
+		}
+		sort(half_edges.begin(), half_edges.end());
+
+		vector<uint32_t> open_out(vertex_count, 0);
+		vector<uint32_t> open_in(vertex_count, 0);
+		for (size_t i = 0; i < half_edges.size(); i++)
+		{
+			const auto a = static_cast<uint32_t>(half_edges[i] >> 32);
+			const auto b = static_cast<uint32_t>(half_edges[i] & 0xFFFFFFFF);
+
+			// The same half edge twice means that more than two triangles meet at the edge
+			if (i > 0 && half_edges[i - 1] == half_edges[i])
+			{
+				kind[a] = kind_locked;
+				kind[b] = kind_locked;
+				continue;
+			}
+
+			if (!binary_search(half_edges.begin(), half_edges.end(), edge_key(b, a)))
+			{
+				open_out[a]++;
+				open_in[b]++;
+				border_next[a] = b;
+				border_prev[b] = a;
+			}
+		}
+
+		for (uint32_t i = 0; i < vertex_count; i++)
+		{
+			if (kind[i] == kind_locked || (open_out[i] == 0 && open_in[i] == 0))
+				continue;
+
+			kind[i] = (open_out[i] == 1 && open_in[i] == 1) ? kind_border : kind_locked;
+		}
+	}
+
+	// Quadrics of the triangle planes (weighted by area), borders add planes perpendicular to them so that they keep their shape
+	vector<quadric> quadrics(vertex_count);
+	for (uint32_t i = 0; i < index_count; i += 3)
+	{
+		const uint32_t corners[3]	= { remap[result[i]], remap[result[i + 1]], remap[result[i + 2]] };
+		auto normal					= cross(sub(positions[corners[1]], positions[corners[0]]), sub(positions[corners[2]], positions[corners[0]]));
+		const auto normal_length	= length(normal);
+		if (normal_length == 0.0f)
+			continue;
+
+		normal = { normal.x / normal_length, normal.y / normal_length, normal.z / normal_length };
+		const auto distance = -dot(normal, positions[corners[0]]);
+		for (const auto corner : corners)
+		{
+			quadric_add_plane(quadrics[corner], normal, distance, normal_length * 0.5f);
+		}
+
+		for (uint32_t e = 0; e < 3; e++)
+		{
+			const auto a = corners[e];
+			const auto b = corners[(e + 1) % 3];
+			if (kind[a] == kind_manifold || border_next[a] != b)
+				continue;
+
+			const auto edge				= sub(positions[b], positions[a]);
+			const auto edge_length		= length(edge);
+			auto border_normal			= cross(edge, normal);
+			const auto border_length	= length(border_normal);
+			if (border_length == 0.0f)
+				continue;
+
+			border_normal = { border_normal.x / border_length, border_normal.y / border_length, border_normal.z / border_length };
+			const auto border_distance	= -dot(border_normal, positions[a]);
+			const auto weight			= edge_length * edge_length * border_weight;
+			quadric_add_plane(quadrics[a], border_normal, border_distance, weight);
+			quadric_add_plane(quadrics[b], border_normal, border_distance, weight);
+		}
+	}
+
+	const auto error_limit	= target_error * target_error;
+	auto error				= 0.0f;
+
+	vector<uint64_t> edges;
+	vector<uint64_t> wedge_edges;
+	vector<uint32_t> adjacency_offsets(vertex_count + 1);
+	vector<uint32_t> adjacency;
+	vector<collapse> collapses;
+	vector<uint32_t> collapse_remap(vertex_count);
+	vector<uint8_t> locked(vertex_count);
+
+	// Each pass collapses a batch of independent edges, cheapest first
+	while (index_count > target_index_count)
+	{
+		// Edges of the current topology, between positions and between wedges
+		edges.clear();
+		wedge_edges.clear();
+		for (uint32_t i = 0; i < index_count; i += 3)
+		{
+			for (uint32_t e = 0; e < 3; e++)
+			{
+				const auto a = result[i + e];
+				const auto b = result[i + (e + 1) % 3];
+				if (remap[a] == remap[b])
+					continue;
+
+				edges.emplace_back(edge_key(min(remap[a], remap[b]), max(remap[a], remap[b])));
+				wedge_edges.emplace_back(edge_key(min(a, b), max(a, b)));
+			}
+		}
+		sort(edges.begin(), edges.end());
+		edges.erase(unique(edges.begin(), edges.end()), edges.end());
+		sort(wedge_edges.begin(), wedge_edges.end());
+		wedge_edges.erase(unique(wedge_edges.begin(), wedge_edges.end()), wedge_edges.end());
+
+		// Triangles around each position
+		fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+		for (uint32_t i = 0; i < index_count; i++)
+		{
+			adjacency_offsets[remap[result[i]] + 1]++;
+		}
+		for (uint32_t i = 0; i < vertex_count; i++)
+		{
+			adjacency_offsets[i + 1] += adjacency_offsets[i];
+		}
+		adjacency.resize(index_count);
+		{
+			vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for (uint32_t i = 0; i < index_count; i++)
+			{
+				adjacency[cursor[remap[result[i]]]++] = i / 3;
+			}
+		}
+
+		auto can_collapse = [&](const uint32_t from, const uint32_t to)
+		{
+			if (kind[from] == kind_locked)
+				return false;
+
+			if (kind[from] == kind_border && border_next[from] != to && border_prev[from] != to)
+				return false;
+
+			// Without seams on either side there is nothing to match
+			if (wedge[from] == from && wedge[to] == to)
+				return true;
+
+			// Every wedge in use has to land on exactly one wedge of the target, otherwise attributes would bleed across a seam
+			for (auto i = adjacency_offsets[from]; i < adjacency_offsets[from + 1]; i++)
+			{
+				const auto triangle = adjacency[i] * 3;
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					const auto w = result[triangle + k];
+					if (remap[w] == from && wedge_target(wedge, wedge_edges, w, to) == invalid)
+						return false;
+				}
+			}
+
+			return true;
+		};
+
+		// Moving "from" onto "to" must not flip any of the triangles that survive the collapse
+		auto flips = [&](const uint32_t from, const uint32_t to)
+		{
+			for (auto i = adjacency_offsets[from]; i < adjacency_offsets[from + 1]; i++)
+			{
+				const auto triangle = adjacency[i] * 3;
+				uint32_t corners[3] = { remap[result[triangle]], remap[result[triangle + 1]], remap[result[triangle + 2]] };
+				if (corners[0] == to || corners[1] == to || corners[2] == to)
+					continue;
+
+				const auto normal_before = cross(sub(positions[corners[1]], positions[corners[0]]), sub(positions[corners[2]], positions[corners[0]]));
+				for (auto& corner : corners)
+				{
+					corner = corner == from ? to : corner;
+				}
+				const auto normal_after = cross(sub(positions[corners[1]], positions[corners[0]]), sub(positions[corners[2]], positions[corners[0]]));
+
+				if (dot(normal_before, normal_after) <= 0.0f)
+					return true;
+			}
+
+			return false;
+		};
+
+		// Pick the cheapest valid direction of each edge
+		collapses.clear();
+		for (const auto key : edges)
+		{
+			const auto a	= static_cast<uint32_t>(key >> 32);
+			const auto b	= static_cast<uint32_t>(key & 0xFFFFFFFF);
+			collapse best	= { invalid, invalid, FLT_MAX };
+
+			const uint32_t directions[2][2] = { { a, b }, { b, a } };
+			for (const auto& direction : directions)
+			{
+				auto q = quadrics[direction[0]];
+				quadric_add(q, quadrics[direction[1]]);
+				const auto cost = quadric_error(q, positions[direction[1]]);
+				if (cost < best.cost && cost <= error_limit && can_collapse(direction[0], direction[1]))
+				{
+					best = { direction[0], direction[1], cost };
+				}
+			}
+
+			if (best.from != invalid)
+			{
+				collapses.emplace_back(best);
+			}
+		}
+
+		if (collapses.empty())
+			break;
+
+		sort(collapses.begin(), collapses.end(), [](const collapse& a, const collapse& b) { return a.cost < b.cost; });
+
+		// Apply collapses whose neighbourhoods don't overlap, until enough triangles are gone
+		iota(collapse_remap.begin(), collapse_remap.end(), 0);
+		fill(locked.begin(), locked.end(), 0);
+		const auto triangles_to_remove	= (index_count - target_index_count) / 3;
+		uint32_t triangles_removed		= 0;
+		uint32_t collapse_count			= 0;
+		for (const auto& c : collapses)
+		{
+			if (locked[c.from] || locked[c.to] || flips(c.from, c.to))
+				continue;
+
+			for (auto i = adjacency_offsets[c.from]; i < adjacency_offsets[c.from + 1]; i++)
+			{
+				const auto triangle = adjacency[i] * 3;
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					const auto w = result[triangle + k];
+					if (remap[w] == c.from)
+					{
+						collapse_remap[w] = wedge_target(wedge, wedge_edges, w, c.to);
+					}
+					locked[remap[w]] = 1;
+				}
+			}
+
+			quadric_add(quadrics[c.to], quadrics[c.from]);
+
+			// Keep the border loop intact
+			if (kind[c.from] == kind_border)
+			{
+				if (border_next[c.from] == c.to)
+				{
+					const auto prev		= border_prev[c.from];
+					border_prev[c.to]	= prev;
+					if (prev != invalid) border_next[prev] = c.to;
+				}
+				else
+				{
+					const auto next		= border_next[c.from];
+					border_next[c.to]	= next;
+					if (next != invalid) border_prev[next] = c.to;
+				}
+			}
+
+			error				= max(error, c.cost);
+			triangles_removed	+= kind[c.from] == kind_border ? 1 : 2;
+			collapse_count++;
+
+			if (triangles_removed >= triangles_to_remove)
+				break;
+		}
+
+		if (collapse_count == 0)
+			break;
+
+		// Rewrite the indices, dropping the triangles which became degenerate
+		uint32_t write = 0;
+		for (uint32_t i = 0; i < index_count; i += 3)
+		{
+			const auto a = collapse_remap[result[i]];
+			const auto b = collapse_remap[result[i + 1]];
+			const auto c = collapse_remap[result[i + 2]];
+			if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c])
+				continue;
+
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		index_count = write;
+	}
+
+	result.resize(index_count);
+
+	return sqrt(error);
+}
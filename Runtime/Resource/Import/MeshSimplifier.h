@@ -0,0 +1,50 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include <cstdint>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+namespace Spartan
+{
+	// Quadric error mesh simplification. Edges collapse into one of their existing end points, so the output
+	// indexes the input vertices and a simplified mesh can share the vertex buffer of the original one.
+	// Vertices which share a position (UV or normal seams) only collapse along their seam, open borders only collapse
+	// along the border and non manifold vertices never move.
+	class SPARTAN_CLASS MeshSimplifier
+	{
+	public:
+		// Collapses edges until the index count drops to target_index_count or until the next collapse would exceed target_error.
+		// Errors are relative to the extent of the mesh (the largest side of its bounding box), the return value is the error reached.
+		static float Simplify(
+			const std::vector<uint32_t>& indices,
+			const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+			uint32_t target_index_count,
+			float target_error,
+			std::vector<uint32_t>* output
+		);
+	};
+}
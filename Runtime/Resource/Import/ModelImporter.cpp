@@ -21,18 +21,34 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =================================
 #include "ModelImporter.h"
+#include <map>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/version.h>
 #include "AssimpHelper.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshClusterizer.h"
+#include "MeshDecomposer.h"
 #include "../ProgressReport.h"
-#include "../../RHI/RHI_Texture.h"
+#include "../ResourceCache.h"
+#include "../../RHI/RHI_Texture2D.h"
 #include "../../Core/Settings.h"
+#include "../../Core/Stopwatch.h"
+#include "../../Threading/Threading.h"
+#include "../../Physics/PhysicsTriangleMesh.h"
 #include "../../Rendering/Model.h"
 #include "../../Rendering/Animation.h"
+#include "../../Rendering/Skeleton.h"
+#include "../../Rendering/AnimationClip.h"
+#include "../../Rendering/Skinning.h"
 #include "../../Rendering/Material.h"
 #include "../../World/World.h"
 #include "../../World/Components/Renderable.h"
+#include "../../World/Components/Animator.h"
 //============================================
 
 //= NAMESPACES ================
@@ -47,7 +63,54 @@ namespace Spartan
 	{
 		static float max_normal_smoothing_angle		= 80.0f;	// Normals exceeding this limit are not smoothed.
 		static float max_tangent_smoothing_angle	= 80.0f;	// Tangents exceeding this limit are not smoothed. Default is 45, max is 175
-		std::string m_model_path;
+		static uint32_t cluster_min_triangles		= 1024;		// Smaller meshes are culled as a whole, splitting them would cost more than it saves
+		static uint32_t decomposition_vertex_max	= 20000;	// Larger meshes are rarely meant to move, decomposing them takes seconds
+
+		struct mesh_import
+		{
+			std::shared_ptr<Renderable> renderable;
+			std::string name;
+			std::vector<uint32_t> indices;
+			std::vector<RHI_Vertex_PosTexNorTan> vertices;
+			std::vector<RHI_Vertex_PosTexNorTanBone> skin; // Empty unless the mesh has bones, otherwise it mirrors the vertices
+			BoundingBox aabb;
+			std::vector<std::vector<uint32_t>> lods;
+			std::vector<float> lod_errors;
+			std::vector<Mesh_Cluster> clusters;
+			Mesh_Collision collision;
+			Vertex_Cache_Statistics cache_before;
+			Vertex_Cache_Statistics cache_after;
+		};
+
+		struct texture_import
+		{
+			std::string file_path;
+			RHI_Texture_Usage usage;
+			std::shared_ptr<RHI_Texture2D> texture;
+		};
+
+		struct texture_binding
+		{
+			std::shared_ptr<Material> material;
+			TextureType type;
+			uint32_t texture_index;
+		};
+
+		struct material_binding
+		{
+			std::shared_ptr<Material> material;
+			std::shared_ptr<Entity> entity;
+		};
+
+		// Lets the image importer know what the texture holds, so it can pick a suitable block compressed format
+		static RHI_Texture_Usage texture_usage(const TextureType type)
+		{
+			auto usage = Texture_Usage_Mask;
+			usage = (type == TextureType_Albedo) ? Texture_Usage_Color : usage;
+			usage = (type == TextureType_Mask) ? Texture_Usage_Generic : usage; // the shader tests all three channels of a mask, BC4 would keep only red
+			usage = (type == TextureType_Normal || type == TextureType_Height) ? Texture_Usage_Normal : usage; // normal and height maps are often mislabeled, the importer tells them apart
+			return usage;
+		}
 
 		// Things for Assimp to do
 		static auto flags =
@@ -55,7 +118,6 @@ namespace Spartan
 			aiProcess_GenSmoothNormals |
 			aiProcess_JoinIdenticalVertices |
 			aiProcess_OptimizeMeshes |
-			aiProcess_ImproveCacheLocality |
 			aiProcess_LimitBoneWeights |
 			aiProcess_SplitLargeMeshes |
 			aiProcess_Triangulate |
@@ -69,6 +131,22 @@ namespace Spartan
 			aiProcess_ConvertToLeftHanded;
 	}
 
+	// What a single import gathers on its way, every import has its own so that models can be imported concurrently
+	struct ModelImporter::_import
+	{
+		std::string model_path;
+
+		// Meshes are gathered while reading the hierarchy, their LODs are generated in parallel before they are added to the model
+		std::vector<_ModelImporter::mesh_import> meshes;
+
+		// Textures are gathered while reading the hierarchy and imported in one go afterwards
+		std::vector<_ModelImporter::texture_import> textures;
+		std::unordered_map<std::string, uint32_t> texture_indices; // file path to index in textures, detects duplicate references across meshes
+		std::vector<_ModelImporter::texture_binding> texture_bindings;
+		std::unordered_map<const aiMaterial*, std::shared_ptr<Material>> materials;
+		std::vector<_ModelImporter::material_binding> material_bindings;
+	};
+
 	ModelImporter::ModelImporter(Context* context)
 	{
 		m_context	= context;
@@ -92,7 +170,8 @@ namespace Spartan
 			return false;
 		}
 
-		_ModelImporter::m_model_path = file_path;
+		_import import;
+		import.model_path = file_path;
 
 		// Set up an Assimp importer
 		Importer importer;	
@@ -115,13 +194,25 @@ namespace Spartan
 		DefaultLogger::set(new AssimpHelper::AssimpLogger());
 
 		// Read the 3D model file from disk
-		const auto scene = importer.ReadFile(_ModelImporter::m_model_path, _ModelImporter::flags);
+		const auto scene = importer.ReadFile(import.model_path, _ModelImporter::flags);
 		const auto result = scene != nullptr;
 		if (result)
 		{
 			FIRE_EVENT(Event_World_Stop);
-			ReadNodeHierarchy(scene, scene->mRootNode, model);
+			ReadSkeleton(scene, model); // meshes look their bones up in it
+			ReadNodeHierarchy(import, scene, scene->mRootNode, model);
+			ImportMeshes(import, model);
 			ReadAnimations(scene, model);
+			if (model->GetSkeleton() && !model->GetAnimationClips().empty())
+			{
+				// Entities only tick while active, and like every node without meshes the root is created inactive
+				const auto root = model->GetRootEntity();
+				root->AddComponent<Animator>();
+				root->SetActive(true);
+			}
+			ImportTextures(import);
+			ImportMaterials(import, model);
+			model->SetVertexQuantized(m_vertex_quantization && !model->GetSkeleton()); // skinned vertices are written as they are
 			model->UpdateGeometry();
 			FIRE_EVENT(Event_World_Start);
 		}
@@ -135,7 +226,7 @@ namespace Spartan
 		return result;
 	}
 
-	void ModelImporter::ReadNodeHierarchy(const aiScene* assimp_scene, aiNode* assimp_node, Model* model, Entity* parent_node, Entity* new_entity)
+	void ModelImporter::ReadNodeHierarchy(_import& import, const aiScene* assimp_scene, aiNode* assimp_node, Model* model, Entity* parent_node, Entity* new_entity)
 	{
         bool is_new_entity_active = false;
 
@@ -153,7 +244,7 @@ namespace Spartan
 		//= GET NODE NAME =================================================================================================================================
 		// In case this is the root node, aiNode.mName will be "RootNode". 
 		// To get a more descriptive name we instead get the name from the file path.
-		const auto name = assimp_node->mParent ? assimp_node->mName.C_Str() : FileSystem::GetFileNameNoExtensionFromFilePath(_ModelImporter::m_model_path);
+		const auto name = assimp_node->mParent ? assimp_node->mName.C_Str() : FileSystem::GetFileNameNoExtensionFromFilePath(import.model_path);
 		new_entity->SetName(name);
 		ProgressReport::Get().SetStatus(g_progress_model_importer, "Creating entity for " + name);
 		//=================================================================================================================================================
@@ -184,7 +275,7 @@ namespace Spartan
 			entity->SetName(_name);
 
 			// Process mesh
-			LoadMesh(assimp_scene, assimp_mesh, model, entity);
+			LoadMesh(import, assimp_scene, assimp_mesh, model, entity);
             entity->SetActive(true);
 		}
 
@@ -192,12 +283,76 @@ namespace Spartan
 		for (uint32_t i = 0; i < assimp_node->mNumChildren; i++)
 		{
 			auto child = m_world->EntityCreate();
-			ReadNodeHierarchy(assimp_scene, assimp_node->mChildren[i], model, new_entity, child.get());
+			ReadNodeHierarchy(import, assimp_scene, assimp_node->mChildren[i], model, new_entity, child.get());
 		}
 
 		ProgressReport::Get().IncrementJobsDone(g_progress_model_importer);
 	}
 
+	void ModelImporter::ReadSkeleton(const aiScene* scene, Model* model)
+	{
+		// Inverse bind matrices of every bone a mesh references
+		map<string, Matrix> offsets;
+		for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+		{
+			const auto assimp_mesh = scene->mMeshes[i];
+			for (uint32_t j = 0; j < assimp_mesh->mNumBones; j++)
+			{
+				const auto assimp_bone = assimp_mesh->mBones[j];
+				offsets[assimp_bone->mName.C_Str()] = AssimpHelper::ai_matrix4_x4_to_matrix(assimp_bone->mOffsetMatrix);
+			}
+		}
+
+		if (offsets.empty())
+			return;
+
+		// Nodes which aren't bones but have bones below them (the armature, the pivots FBX inserts etc.) are kept as bones, with an
+		// identity offset as no vertex is bound to them. Their transforms then apply to the bones below them, as they do to the meshes,
+		// and they can be animated like any other bone. The root node is left out, it's the root entity and the skeleton is relative to it.
+		unordered_map<const aiNode*, bool> has_bones;
+		function<bool(const aiNode*)> find_bones = [&offsets, &has_bones, &find_bones](const aiNode* node)
+		{
+			auto result = offsets.find(node->mName.C_Str()) != offsets.end();
+			for (uint32_t i = 0; i < node->mNumChildren; i++)
+			{
+				result = find_bones(node->mChildren[i]) || result;
+			}
+			has_bones[node] = result;
+			return result;
+		};
+		find_bones(scene->mRootNode);
+
+		// Depth first so that parents precede their children
+		auto skeleton = make_shared<Skeleton>();
+		function<void(const aiNode*, int32_t)> add_node = [&scene, &offsets, &has_bones, &skeleton, &add_node](const aiNode* node, int32_t parent)
+		{
+			if (!has_bones[node])
+				return;
+
+			const auto it = offsets.find(node->mName.C_Str());
+			if (node != scene->mRootNode || it != offsets.end())
+			{
+				Bone_Transform bind;
+				auto transform = AssimpHelper::ai_matrix4_x4_to_matrix(node->mTransformation);
+				transform.Decompose(bind.scale, bind.rotation, bind.position);
+				parent = static_cast<int32_t>(skeleton->AddBone(node->mName.C_Str(), parent, it != offsets.end() ? it->second : Matrix::Identity, bind));
+			}
+
+			for (uint32_t i = 0; i < node->mNumChildren; i++)
+			{
+				add_node(node->mChildren[i], parent);
+			}
+		};
+		add_node(scene->mRootNode, -1);
+
+		if (skeleton->GetBoneCount() > Skinning::max_bones)
+		{
+			LOGF_WARNING("%d bones exceed the %d that can be skinned", skeleton->GetBoneCount(), Skinning::max_bones);
+		}
+
+		model->SetSkeleton(skeleton);
+	}
+
 	void ModelImporter::ReadAnimations(const aiScene* scene, Model* model)
 	{
 		for (uint32_t i = 0; i < scene->mNumAnimations; i++)
@@ -230,7 +385,7 @@ namespace Spartan
 				// Rotation keys
 				for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumRotationKeys); k++)
 				{
-					const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+					const auto time = assimp_node_anim->mRotationKeys[k].mTime;
 					const auto value = AssimpHelper::to_quaternion(assimp_node_anim->mRotationKeys[k].mValue);
 
 					animation_node.rotationFrames.emplace_back(KeyQuaternion{ time, value });
@@ -239,18 +394,32 @@ namespace Spartan
 				// Scaling keys
 				for (uint32_t k = 0; k < static_cast<uint32_t>(assimp_node_anim->mNumScalingKeys); k++)
 				{
-					const auto time = assimp_node_anim->mPositionKeys[k].mTime;
+					const auto time = assimp_node_anim->mScalingKeys[k].mTime;
 					const auto value = AssimpHelper::to_vector3(assimp_node_anim->mScalingKeys[k].mValue);
 
 					animation_node.scaleFrames.emplace_back(KeyVector{ time, value });
 				}
+
+				animation->AddChannel(move(animation_node));
+			}
+
+			// With a skeleton, only the compressed clip is kept. It's what the Animator samples and what the model file stores.
+			const auto& skeleton = model->GetSkeleton();
+			if (!skeleton)
+			{
+				model->AddAnimation(animation);
+				continue;
 			}
 
-			model->AddAnimation(animation);
+			auto clip = make_shared<AnimationClip>();
+			if (clip->Compress(animation, *skeleton))
+			{
+				model->AddAnimationClip(clip);
+			}
 		}
 	}
 
-	void ModelImporter::LoadMesh(const aiScene* assimp_scene, aiMesh* assimp_mesh, Model* model, Entity* entity_parent)
+	void ModelImporter::LoadMesh(_import& import, const aiScene* assimp_scene, aiMesh* assimp_mesh, Model* model, Entity* entity_parent)
 	{
 		if (!model || !assimp_mesh || !assimp_scene || !entity_parent)
 		{
@@ -318,45 +487,78 @@ namespace Spartan
 			}
 		}
 
-		// Compute AABB (before doing move operation on vertices)
-		const auto aabb = BoundingBox(vertices);
+		// Bone influences, by index into the skeleton
+		vector<RHI_Vertex_PosTexNorTanBone> skin;
+		const auto& skeleton = model->GetSkeleton();
+		if (skeleton && assimp_mesh->HasBones())
+		{
+			// aiProcess_LimitBoneWeights leaves at most four per vertex
+			const uint32_t influences_max = 4;
+			vector<uint32_t> bones(vertex_count * influences_max, 0);
+			vector<float> weights(vertex_count * influences_max, 0.0f);
+			vector<uint32_t> counts(vertex_count, 0);
+			for (uint32_t i = 0; i < assimp_mesh->mNumBones; i++)
+			{
+				const auto assimp_bone	= assimp_mesh->mBones[i];
+				const auto bone			= skeleton->FindBone(assimp_bone->mName.C_Str());
+				if (bone >= skeleton->GetBoneCount() || bone >= Skinning::max_bones)
+					continue;
 
-		// Add the mesh to the model
-		uint32_t index_offset;
-		uint32_t vertex_offset;
-		model->AppendGeometry(move(indices), move(vertices), &index_offset, &vertex_offset);
+				for (uint32_t j = 0; j < assimp_bone->mNumWeights; j++)
+				{
+					const auto& weight = assimp_bone->mWeights[j];
+					if (weight.mVertexId < vertex_count && counts[weight.mVertexId] < influences_max)
+					{
+						const auto k	= weight.mVertexId * influences_max + counts[weight.mVertexId]++;
+						bones[k]		= bone;
+						weights[k]		= weight.mWeight;
+					}
+				}
+			}
 
-		// Add a renderable component to this entity
-		auto renderable	= entity_parent->AddComponent<Renderable>();
+			skin.resize(vertex_count);
+			for (uint32_t i = 0; i < vertex_count; i++)
+			{
+				memcpy(skin[i].pos, vertices[i].pos, sizeof(skin[i].pos));
+				memcpy(skin[i].tex, vertices[i].tex, sizeof(skin[i].tex));
+				memcpy(skin[i].nor, vertices[i].nor, sizeof(skin[i].nor));
+				memcpy(skin[i].tan, vertices[i].tan, sizeof(skin[i].tan));
+				Skinning::SetInfluences(&skin[i], &bones[i * influences_max], &weights[i * influences_max], counts[i]);
+			}
+		}
 
-		// Set the geometry
-		renderable->GeometrySet(
-			entity_parent->GetName(),
-			index_offset,
-			static_cast<uint32_t>(indices.size()),
-			vertex_offset,
-			static_cast<uint32_t>(vertices.size()),
-			aabb,
-			model
-		);
+		// Add a renderable component to this entity, its geometry is set once the mesh has been added to the model
+		_ModelImporter::mesh_import mesh;
+		mesh.renderable	= entity_parent->AddComponent<Renderable>();
+		mesh.name		= entity_parent->GetName();
+		mesh.aabb		= BoundingBox(vertices);
+		mesh.indices	= move(indices);
+		mesh.vertices	= move(vertices);
+		mesh.skin		= move(skin);
+		import.meshes.emplace_back(move(mesh));
 
 		// Material
 		if (assimp_scene->HasMaterials())
 		{
 			// Get aiMaterial
 			const auto assimp_material = assimp_scene->mMaterials[assimp_mesh->mMaterialIndex];
-			// Convert it and add it to the model
-			model->AddMaterial(AiMaterialToMaterial(assimp_material, model), entity_parent->GetPtrShared());
-		}
 
-		// Bones
-		//for (uint32_t boneIndex = 0; boneIndex < assimpMesh->mNumBones; boneIndex++)
-		//{
-			//aiBone* bone = assimpMesh->mBones[boneIndex];
-		//}
+			// Convert it once, meshes which share an aiMaterial share the material
+			auto& material = import.materials[assimp_material];
+			if (!material)
+			{
+				material = AiMaterialToMaterial(import, assimp_material, model);
+			}
+
+			// It's added to the model once its textures have been imported
+			if (material)
+			{
+				import.material_bindings.push_back({ material, entity_parent->GetPtrShared() });
+			}
+		}
 	}
 
-	shared_ptr<Material> ModelImporter::AiMaterialToMaterial(aiMaterial* assimp_material, Model* model)
+	shared_ptr<Material> ModelImporter::AiMaterialToMaterial(_import& import, aiMaterial* assimp_material, Model* model)
 	{
 		if (!model || !assimp_material)
 		{
@@ -370,7 +572,7 @@ namespace Spartan
 		aiString name;
 		aiGetMaterialString(assimp_material, AI_MATKEY_NAME, &name);
         // Set a resource file path so it can be used by the resource cache
-		material->SetResourceFilePath(FileSystem::GetDirectoryFromFilePath(_ModelImporter::m_model_path) + string(name.C_Str()) + EXTENSION_MATERIAL);
+		material->SetResourceFilePath(FileSystem::GetDirectoryFromFilePath(import.model_path) + string(name.C_Str()) + EXTENSION_MATERIAL);
 
 		// CULL MODE
 		// Specifies whether meshes using this material must be rendered 
@@ -396,45 +598,41 @@ namespace Spartan
 		material->SetColorAlbedo(Vector4(color_diffuse.r, color_diffuse.g, color_diffuse.b, opacity.r));
 
 		// TEXTURES
-		const auto load_mat_tex = [&model, &assimp_material, &material](const aiTextureType type_assimp, const TextureType type_spartan)
+		const auto load_mat_tex = [&import, &assimp_material, &material](const aiTextureType type_assimp, const TextureType type_spartan)
 		{
 			aiString texture_path;
 			if (assimp_material->GetTextureCount(type_assimp) > 0)
 			{
 				if (AI_SUCCESS == assimp_material->GetTexture(type_assimp, 0, &texture_path))
 				{
-					const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, _ModelImporter::m_model_path);
+					const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, import.model_path);
 					if (FileSystem::IsSupportedImageFile(deduced_path))
 					{
-						model->AddTexture(material, type_spartan, AssimpHelper::texture_validate_path(texture_path.data, _ModelImporter::m_model_path));
+						// Queue the texture for import, unless another material (or slot) already references it
+						auto usage	= _ModelImporter::texture_usage(type_spartan);
+						auto it		= import.texture_indices.find(deduced_path);
+						if (it == import.texture_indices.end())
+						{
+							it = import.texture_indices.emplace(deduced_path, static_cast<uint32_t>(import.textures.size())).first;
+							import.textures.push_back({ deduced_path, usage, nullptr });
+						}
+						else
+						{
+							// Color wins, it's the only usage which is filtered and compressed as sRGB.
+							// Otherwise a slot which needs every channel wins over a single channel one.
+							auto& usage_existing = import.textures[it->second].usage;
+							if (usage == Texture_Usage_Color || (usage == Texture_Usage_Generic && usage_existing == Texture_Usage_Mask))
+							{
+								usage_existing = usage;
+							}
+						}
+						import.texture_bindings.push_back({ material, type_spartan, it->second });
 
 						if (type_assimp == aiTextureType_DIFFUSE)
 						{
 							// FIX: materials that have a diffuse texture should not be tinted black/gray
 							material->SetColorAlbedo(Vector4::One);
 						}
-
-						// Some models (or Assimp) pass a normal map as a height map
-						// auto textureType others pass a height map as a normal map, we try to fix that.
-						if (type_spartan == TextureType_Normal || type_spartan == TextureType_Height)
-						{
-                            if (const auto texture = material->GetTexture(type_spartan))
-                            {
-                                auto proper_type = type_spartan;
-                                proper_type = (proper_type == TextureType_Normal && texture->GetGrayscale()) ? TextureType_Height : proper_type;
-                                proper_type = (proper_type == TextureType_Height && !texture->GetGrayscale()) ? TextureType_Normal : proper_type;
-
-                                if (proper_type != type_spartan)
-                                {
-                                    material->SetTextureSlot(type_spartan, shared_ptr<RHI_Texture>());
-                                    material->SetTextureSlot(proper_type, texture);
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("Failed to get texture");
-                            }
-						}
 					}
 				}
 			}
@@ -452,4 +650,237 @@ namespace Spartan
 
 		return material;
 	}
+
+	void ModelImporter::ImportMeshes(_import& import, Model* model) const
+	{
+		auto& meshes = import.meshes;
+		if (meshes.empty())
+			return;
+
+		Stopwatch timer;
+		ProgressReport::Get().SetStatus(g_progress_model_importer, "Simplifying, optimizing and cooking collision for " + to_string(meshes.size()) + " meshes...");
+
+		// Every LOD simplifies the previous one and indexes the same vertices. Simplification time grows with the
+		// triangle count, so like textures, every task pulls the next mesh once it's done with its current one.
+		// Afterwards every level is reordered for the post-transform cache and for overdraw, then the vertices are
+		// reordered by first use so that vertex fetch walks the vertex buffer mostly linearly. Large meshes are split
+		// into clusters instead of being ordered for overdraw, as the renderer draws the clusters which survive culling.
+		const auto overdraw_threshold = 1.05f; // ACMR that overdraw ordering is allowed to give up
+		atomic<uint32_t> next_mesh = 0;
+		m_context->GetSubsystem<Threading>()->Loop([this, &meshes, &next_mesh, overdraw_threshold](uint32_t, uint32_t)
+		{
+			for (uint32_t i = next_mesh++; i < static_cast<uint32_t>(meshes.size()); i = next_mesh++)
+			{
+				auto& mesh	= meshes[i];
+				auto error	= 0.0f;
+				for (uint32_t lod = 1; lod < m_lod_count; lod++)
+				{
+					const auto& previous = mesh.lods.empty() ? mesh.indices : mesh.lods.back();
+
+					vector<uint32_t> indices;
+					error += MeshSimplifier::Simplify(previous, mesh.vertices, static_cast<uint32_t>(previous.size() / 2), m_lod_error - error, &indices);
+
+					// Stop once the error budget no longer allows for a meaningful reduction
+					if (indices.empty() || indices.size() > previous.size() * 3 / 4)
+						break;
+
+					mesh.lods.emplace_back(move(indices));
+					mesh.lod_errors.emplace_back(error);
+				}
+
+				const auto vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+				mesh.cache_before		= MeshOptimizer::AnalyzeVertexCache(mesh.indices, vertex_count);
+
+				vector<vector<uint32_t>*> levels = { &mesh.indices };
+				for (auto& lod : mesh.lods)
+				{
+					levels.emplace_back(&lod);
+				}
+
+				for (const auto level : levels)
+				{
+					MeshOptimizer::OptimizeVertexCache(level, vertex_count);
+					if (level == &mesh.indices && mesh.indices.size() / 3 >= _ModelImporter::cluster_min_triangles)
+					{
+						MeshClusterizer::Build(level, mesh.vertices, &mesh.clusters);
+					}
+					else
+					{
+						MeshOptimizer::OptimizeOverdraw(level, mesh.vertices, overdraw_threshold);
+					}
+				}
+				// The bone influences follow the vertices
+				vector<uint32_t> remap;
+				MeshOptimizer::OptimizeVertexFetch(&mesh.vertices, levels, mesh.skin.empty() ? nullptr : &remap);
+				if (!mesh.skin.empty())
+				{
+					vector<RHI_Vertex_PosTexNorTanBone> skin(mesh.vertices.size());
+					for (size_t j = 0; j < remap.size(); j++)
+					{
+						if (remap[j] != 0xFFFFFFFF)
+						{
+							skin[remap[j]] = mesh.skin[j];
+						}
+					}
+					mesh.skin = move(skin);
+				}
+
+				mesh.cache_after = MeshOptimizer::AnalyzeVertexCache(mesh.indices, static_cast<uint32_t>(mesh.vertices.size()));
+
+				// Collision is cooked from the final vertex order, as that's what a collider gets from the model
+				if (m_collision_cooking)
+				{
+					vector<Vector3> positions(mesh.vertices.size());
+					for (size_t j = 0; j < mesh.vertices.size(); j++)
+					{
+						positions[j] = Vector3(mesh.vertices[j].pos[0], mesh.vertices[j].pos[1], mesh.vertices[j].pos[2]);
+					}
+					PhysicsTriangleMesh(vector<uint32_t>(mesh.indices), move(positions)).SerializeBvh(&mesh.collision.bvh);
+
+					if (mesh.vertices.size() <= _ModelImporter::decomposition_vertex_max)
+					{
+						MeshDecomposer::Decompose(mesh.indices, mesh.vertices, &mesh.collision.hulls);
+					}
+				}
+			}
+		}, static_cast<uint32_t>(meshes.size()));
+
+		// Add the meshes to the model, in the order they were read
+		uint32_t lod_count		= 0;
+		uint32_t cluster_count	= 0;
+		uint32_t hull_count		= 0;
+		Vertex_Cache_Statistics cache_before;
+		Vertex_Cache_Statistics cache_after;
+		for (auto& mesh : meshes)
+		{
+			cache_before.Add(mesh.cache_before);
+			cache_after.Add(mesh.cache_after);
+
+			uint32_t index_offset;
+			uint32_t vertex_offset;
+			model->AppendGeometry(mesh.indices, mesh.vertices, &index_offset, &vertex_offset, mesh.name);
+
+			for (uint32_t lod = 0; lod < static_cast<uint32_t>(mesh.lods.size()); lod++)
+			{
+				model->AppendGeometryLod(index_offset, mesh.lods[lod], mesh.lod_errors[lod]);
+			}
+			lod_count += static_cast<uint32_t>(mesh.lods.size());
+
+			if (!mesh.clusters.empty())
+			{
+				model->SetGeometryClusters(index_offset, mesh.clusters);
+			}
+			cluster_count += static_cast<uint32_t>(mesh.clusters.size());
+
+			hull_count += static_cast<uint32_t>(mesh.collision.hulls.size());
+			if (!mesh.collision.bvh.empty() || !mesh.collision.hulls.empty())
+			{
+				model->SetGeometryCollision(index_offset, move(mesh.collision));
+			}
+
+			if (!mesh.skin.empty())
+			{
+				model->SetGeometrySkin(index_offset, move(mesh.skin));
+			}
+
+			mesh.renderable->GeometrySet(
+				mesh.name,
+				index_offset,
+				static_cast<uint32_t>(mesh.indices.size()),
+				vertex_offset,
+				static_cast<uint32_t>(mesh.vertices.size()),
+				mesh.aabb,
+				model
+			);
+		}
+
+		LOGF_INFO("Generated %d LODs, %d clusters and %d convex hulls for %d meshes in %.2f ms", static_cast<int>(lod_count), static_cast<int>(cluster_count), static_cast<int>(hull_count), static_cast<int>(meshes.size()), static_cast<float>(timer.GetElapsedTimeMs()));
+		LOGF_INFO("Vertex cache (%d entries), ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f", static_cast<int>(MeshOptimizer::cache_size), cache_before.GetAcmr(), cache_after.GetAcmr(), cache_before.GetAtvr(), cache_after.GetAtvr());
+	}
+
+	void ModelImporter::ImportTextures(_import& import) const
+	{
+		auto& textures = import.textures;
+		if (textures.empty())
+			return;
+
+		Stopwatch timer;
+		auto resource_cache	= m_context->GetSubsystem<ResourceCache>();
+		auto threading		= m_context->GetSubsystem<Threading>();
+
+		// Textures which are already cached (e.g. shared with a previously imported model) are simply reused
+		vector<uint32_t> pending;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(textures.size()); i++)
+		{
+			const auto name = FileSystem::GetFileNameNoExtensionFromFilePath(textures[i].file_path);
+			if (auto texture = resource_cache->GetByName<RHI_Texture2D>(name))
+			{
+				textures[i].texture = texture;
+			}
+			else
+			{
+				pending.push_back(i);
+			}
+		}
+
+		ProgressReport::Get().SetStatus(g_progress_model_importer, "Importing " + to_string(pending.size()) + " textures...");
+		ProgressReport::Get().SetJobCount(g_progress_model_importer, static_cast<int>(pending.size()));
+		ProgressReport::Get().SetJobsDone(g_progress_model_importer, 0);
+
+		// Decode, mip, compress and save the textures on the job system. Instead of splitting the range up front, every task
+		// pulls the next texture once it's done with its current one. This balances small and large textures and it bounds memory,
+		// as a texture's bytes are freed as soon as it's saved, so there are never more textures in memory than there are tasks.
+		atomic<uint32_t> next_texture = 0;
+		mutex mutex_progress;
+		threading->Loop([this, &textures, &pending, &next_texture, &mutex_progress](uint32_t, uint32_t)
+		{
+			for (uint32_t i = next_texture++; i < static_cast<uint32_t>(pending.size()); i = next_texture++)
+			{
+				auto& import = textures[pending[i]];
+
+				auto generate_mipmaps	= true;
+				auto texture			= make_shared<RHI_Texture2D>(m_context, generate_mipmaps);
+				texture->SetUsage(import.usage);
+				if (texture->LoadFromFile(import.file_path))
+				{
+					// Saving frees the bytes, caching the texture later on will only have to rewrite its properties
+					texture->SaveToFile(texture->GetResourceFilePathNative());
+					import.texture = texture;
+				}
+				else
+				{
+					LOGF_ERROR("Failed to import \"%s\"", import.file_path.c_str());
+				}
+
+				lock_guard<mutex> lock(mutex_progress);
+				ProgressReport::Get().IncrementJobsDone(g_progress_model_importer);
+			}
+		}, static_cast<uint32_t>(pending.size()));
+
+		// Wire up the materials
+		for (const auto& binding : import.texture_bindings)
+		{
+			const auto& texture = textures[binding.texture_index].texture;
+			if (!texture)
+				continue;
+
+			// Some models (or Assimp) pass a normal map as a height map
+			// and others pass a height map as a normal map, we try to fix that.
+			auto type = binding.type;
+			type = (type == TextureType_Normal && texture->GetGrayscale()) ? TextureType_Height : type;
+			type = (type == TextureType_Height && !texture->GetGrayscale()) ? TextureType_Normal : type;
+
+			binding.material->SetTextureSlot(type, texture);
+		}
+
+		LOGF_INFO("Imported %d textures (%d references) in %.2f ms", static_cast<int>(pending.size()), static_cast<int>(import.texture_bindings.size()), static_cast<float>(timer.GetElapsedTimeMs()));
+	}
+
+	void ModelImporter::ImportMaterials(_import& import, Model* model) const
+	{
+		for (auto& binding : import.material_bindings)
+		{
+			model->AddMaterial(binding.material, binding.entity);
+		}
+	}
 }
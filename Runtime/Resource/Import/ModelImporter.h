@@ -48,14 +48,38 @@ namespace Spartan
 
 		bool Load(Model* model, const std::string& file_path);
 
+		// LOD generation
+		auto GetLodCount() const					{ return m_lod_count; }
+		void SetLodCount(const uint32_t lod_count)	{ m_lod_count = lod_count; }
+		auto GetLodError() const					{ return m_lod_error; }
+		void SetLodError(const float lod_error)		{ m_lod_error = lod_error; }
+
+		// Vertex quantization, see VertexQuantizer
+		auto GetVertexQuantization() const						{ return m_vertex_quantization; }
+		void SetVertexQuantization(const bool quantization)		{ m_vertex_quantization = quantization; }
+
+		// Collision cooking, a serialized triangle BVH and a convex decomposition per mesh (see Collider)
+		auto GetCollisionCooking() const				{ return m_collision_cooking; }
+		void SetCollisionCooking(const bool cooking)	{ m_collision_cooking = cooking; }
+
 	private:
+		struct _import;
+
 		// PROCESSING
-		void ReadNodeHierarchy(const aiScene* assimp_scene, aiNode* assimp_node, Model* model, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
+		void ReadNodeHierarchy(_import& import, const aiScene* assimp_scene, aiNode* assimp_node, Model* model, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
+		void ReadSkeleton(const aiScene* scene, Model* model);
 		void ReadAnimations(const aiScene* scene, Model* model);
-		void LoadMesh(const aiScene* assimp_scene, aiMesh* assimp_mesh, Model* model, Entity* entity_parent);
-		std::shared_ptr<Material> AiMaterialToMaterial(aiMaterial* assimp_material, Model* model);
+		void LoadMesh(_import& import, const aiScene* assimp_scene, aiMesh* assimp_mesh, Model* model, Entity* entity_parent);
+		std::shared_ptr<Material> AiMaterialToMaterial(_import& import, aiMaterial* assimp_material, Model* model);
+		void ImportMeshes(_import& import, Model* model) const;
+		void ImportTextures(_import& import) const;
+		void ImportMaterials(_import& import, Model* model) const;
 
 		Context* m_context;
 		World* m_world;
+		uint32_t m_lod_count			= 4;		// Including the full detail geometry
+		float m_lod_error				= 0.02f;	// Largest error of the coarsest LOD, relative to the extent of a mesh
+		bool m_vertex_quantization		= false;	// 20 byte vertices instead of 44 byte ones
+		bool m_collision_cooking		= true;
 	};
 }
\ No newline at end of file
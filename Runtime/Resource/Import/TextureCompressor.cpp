@@ -0,0 +1,830 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =================
+#include "TextureCompressor.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "../../Logging/Log.h"
+//============================
+
+//= NAMESPACES =========
+using namespace std;
+using namespace Spartan;
+//======================
+
+namespace _TextureCompressor
+{
+	// A 4x4 block of RGBA pixels, stored as floats in the [0, 255] range
+	struct Block
+	{
+		float pixels[16][4];
+	};
+
+	// Bit writer/reader over a 128-bit block (BC7)
+	struct Bits128
+	{
+		uint64_t lo = 0;
+		uint64_t hi = 0;
+		uint32_t position = 0;
+
+		void Write(uint64_t value, const uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++, position++)
+			{
+				const uint64_t bit = (value >> i) & 1;
+				if (position < 64)	lo |= bit << position;
+				else				hi |= bit << (position - 64);
+			}
+		}
+
+		uint32_t Read(const uint32_t count)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; i++, position++)
+			{
+				const uint64_t bit = position < 64 ? (lo >> position) & 1 : (hi >> (position - 64)) & 1;
+				value |= static_cast<uint32_t>(bit) << i;
+			}
+			return value;
+		}
+	};
+
+	static const float bc1_weights[4]	= { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };	// weight of endpoint 1, per index
+	static const uint32_t bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	inline float clamp_255(const float value)		{ return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value); }
+	inline float clamp_01(const float value)		{ return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value); }
+	inline uint32_t round_to_uint(const float value) { return static_cast<uint32_t>(value + 0.5f); }
+
+	inline void fetch_block(const std::byte* rgba, const uint32_t width, const uint32_t height, const uint32_t block_x, const uint32_t block_y, Block& block)
+	{
+		// Pixels outside of the image (mips smaller than 4x4) replicate the edge
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			const uint32_t py = min(block_y * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				const uint32_t px		= min(block_x * 4 + x, width - 1);
+				const std::byte* pixel	= rgba + (static_cast<size_t>(py) * width + px) * 4;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					block.pixels[y * 4 + x][c] = static_cast<float>(pixel[c]);
+				}
+			}
+		}
+	}
+
+	// Finds the endpoints of the line that best fits the block's pixels over the first channel_count channels
+	inline void compute_endpoints(const Block& block, const uint32_t channel_count, const Texture_Compression_Quality quality, float* endpoint_0, float* endpoint_1)
+	{
+		float min_value[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float max_value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float mean[4]		= { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (const auto& pixel : block.pixels)
+		{
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				min_value[c] = min(min_value[c], pixel[c]);
+				max_value[c] = max(max_value[c], pixel[c]);
+				mean[c] += pixel[c] / 16.0f;
+			}
+		}
+
+		if (quality == Compression_Fast)
+		{
+			// Inset the bounding box slightly, this reduces the error of the interpolated colors
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				const float inset = (max_value[c] - min_value[c]) / 16.0f;
+				endpoint_0[c] = min_value[c] + inset;
+				endpoint_1[c] = max_value[c] - inset;
+			}
+			return;
+		}
+
+		// Covariance matrix
+		float covariance[4][4] = {};
+		for (const auto& pixel : block.pixels)
+		{
+			for (uint32_t i = 0; i < channel_count; i++)
+			{
+				for (uint32_t j = 0; j < channel_count; j++)
+				{
+					covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+				}
+			}
+		}
+
+		// Principal axis through power iteration, starting from the bounding box diagonal
+		float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (uint32_t c = 0; c < channel_count; c++)
+		{
+			axis[c] = max_value[c] - min_value[c];
+		}
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float result[4]	= { 0.0f, 0.0f, 0.0f, 0.0f };
+			float length	= 0.0f;
+			for (uint32_t i = 0; i < channel_count; i++)
+			{
+				for (uint32_t j = 0; j < channel_count; j++)
+				{
+					result[i] += covariance[i][j] * axis[j];
+				}
+				length = max(length, fabsf(result[i]));
+			}
+
+			if (length == 0.0f)
+				break;
+
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				axis[c] = result[c] / length;
+			}
+		}
+
+		// Project the pixels onto the axis and take the extremes
+		float axis_length_squared = 0.0f;
+		for (uint32_t c = 0; c < channel_count; c++)
+		{
+			axis_length_squared += axis[c] * axis[c];
+		}
+
+		if (axis_length_squared == 0.0f)
+		{
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				endpoint_0[c] = mean[c];
+				endpoint_1[c] = mean[c];
+			}
+			return;
+		}
+
+		float t_min = numeric_limits<float>::max();
+		float t_max = -numeric_limits<float>::max();
+		for (const auto& pixel : block.pixels)
+		{
+			float t = 0.0f;
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				t += (pixel[c] - mean[c]) * axis[c];
+			}
+			t /= axis_length_squared;
+			t_min = min(t_min, t);
+			t_max = max(t_max, t);
+		}
+
+		for (uint32_t c = 0; c < channel_count; c++)
+		{
+			endpoint_0[c] = clamp_255(mean[c] + axis[c] * t_min);
+			endpoint_1[c] = clamp_255(mean[c] + axis[c] * t_max);
+		}
+	}
+
+	// Solves for the endpoints that minimize the squared error given per pixel interpolation weights (of endpoint 1)
+	inline bool refine_endpoints(const Block& block, const float* weights, const uint32_t channel_count, float* endpoint_0, float* endpoint_1)
+	{
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			const float beta	= weights[i];
+			const float alpha	= 1.0f - beta;
+			aa += alpha * alpha;
+			bb += beta * beta;
+			ab += alpha * beta;
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				ax[c] += alpha * block.pixels[i][c];
+				bx[c] += beta * block.pixels[i][c];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (fabsf(determinant) < 1e-6f)
+			return false;
+
+		for (uint32_t c = 0; c < channel_count; c++)
+		{
+			endpoint_0[c] = clamp_255((ax[c] * bb - bx[c] * ab) / determinant);
+			endpoint_1[c] = clamp_255((bx[c] * aa - ax[c] * ab) / determinant);
+		}
+
+		return true;
+	}
+
+	//= BC1 ================================================================================================
+	inline uint16_t pack_565(const float* color)
+	{
+		const uint32_t r = round_to_uint(clamp_255(color[0]) * 31.0f / 255.0f);
+		const uint32_t g = round_to_uint(clamp_255(color[1]) * 63.0f / 255.0f);
+		const uint32_t b = round_to_uint(clamp_255(color[2]) * 31.0f / 255.0f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	inline void unpack_565(const uint16_t value, float* color)
+	{
+		const uint32_t r = (value >> 11) & 31;
+		const uint32_t g = (value >> 5) & 63;
+		const uint32_t b = value & 31;
+		color[0] = static_cast<float>((r << 3) | (r >> 2));
+		color[1] = static_cast<float>((g << 2) | (g >> 4));
+		color[2] = static_cast<float>((b << 3) | (b >> 2));
+	}
+
+	// Picks the 4-color mode indices for a pair of quantized endpoints, returns the squared error
+	inline float bc1_select_indices(const Block& block, const uint16_t c0, const uint16_t c1, uint32_t* indices)
+	{
+		float palette[4][3];
+		unpack_565(c0, palette[0]);
+		unpack_565(c1, palette[1]);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+
+		float error = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float best_distance = numeric_limits<float>::max();
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				float distance = 0.0f;
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					const float delta = block.pixels[i][c] - palette[p][c];
+					distance += delta * delta;
+				}
+
+				if (distance < best_distance)
+				{
+					best_distance	= distance;
+					indices[i]		= p;
+				}
+			}
+			error += best_distance;
+		}
+
+		return error;
+	}
+
+	inline float bc1_quantize(const Block& block, const float* endpoint_0, const float* endpoint_1, uint16_t& c0, uint16_t& c1, uint32_t* indices)
+	{
+		c0 = pack_565(endpoint_1);
+		c1 = pack_565(endpoint_0);
+
+		// The 4-color mode requires c0 > c1
+		if (c0 < c1)
+		{
+			swap(c0, c1);
+		}
+
+		if (c0 == c1)
+		{
+			fill(indices, indices + 16, 0);
+			float color[3];
+			unpack_565(c0, color);
+			float error = 0.0f;
+			for (const auto& pixel : block.pixels)
+			{
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					error += (pixel[c] - color[c]) * (pixel[c] - color[c]);
+				}
+			}
+			return error;
+		}
+
+		return bc1_select_indices(block, c0, c1, indices);
+	}
+
+	inline void encode_bc1(const Block& block, const Texture_Compression_Quality quality, std::byte* output)
+	{
+		float endpoint_0[4];
+		float endpoint_1[4];
+		compute_endpoints(block, 3, quality, endpoint_0, endpoint_1);
+
+		uint16_t c0 = 0, c1 = 0;
+		uint32_t indices[16];
+		float error = bc1_quantize(block, endpoint_0, endpoint_1, c0, c1, indices);
+
+		// Least squares refinement, keep whatever improves the error
+		if (quality == Compression_Best)
+		{
+			for (uint32_t iteration = 0; iteration < 2 && c0 != c1; iteration++)
+			{
+				// Weight of the second endpoint (c1) for every pixel, the endpoint order is restored by bc1_quantize()
+				float weights[16];
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					weights[i] = bc1_weights[indices[i]];
+				}
+
+				float refined_0[4];
+				float refined_1[4];
+				if (!refine_endpoints(block, weights, 3, refined_0, refined_1))
+					break;
+
+				uint16_t refined_c0 = 0, refined_c1 = 0;
+				uint32_t refined_indices[16];
+				const float refined_error = bc1_quantize(block, refined_0, refined_1, refined_c0, refined_c1, refined_indices);
+				if (refined_error >= error)
+					break;
+
+				error	= refined_error;
+				c0		= refined_c0;
+				c1		= refined_c1;
+				memcpy(indices, refined_indices, sizeof(indices));
+			}
+		}
+
+		uint32_t index_bits = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			index_bits |= indices[i] << (i * 2);
+		}
+
+		memcpy(output + 0, &c0, 2);
+		memcpy(output + 2, &c1, 2);
+		memcpy(output + 4, &index_bits, 4);
+	}
+
+	inline void decode_bc1(const std::byte* input, uint8_t pixels[16][4], const bool force_four_color)
+	{
+		uint16_t c0 = 0, c1 = 0;
+		uint32_t index_bits = 0;
+		memcpy(&c0, input + 0, 2);
+		memcpy(&c1, input + 2, 2);
+		memcpy(&index_bits, input + 4, 4);
+
+		float palette[4][4];
+		unpack_565(c0, palette[0]);
+		unpack_565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255.0f;
+		if (c0 > c1 || force_four_color)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+				palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+			}
+		}
+		else
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+				palette[3][c] = 0.0f;
+			}
+			palette[3][3] = 0.0f;
+		}
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			const uint32_t index = (index_bits >> (i * 2)) & 3;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				pixels[i][c] = static_cast<uint8_t>(round_to_uint(palette[index][c]));
+			}
+		}
+	}
+	//======================================================================================================
+
+	//= BC4 ================================================================================================
+	inline void encode_bc4(const Block& block, const uint32_t channel, std::byte* output)
+	{
+		float min_value = 255.0f;
+		float max_value = 0.0f;
+		for (const auto& pixel : block.pixels)
+		{
+			min_value = min(min_value, pixel[channel]);
+			max_value = max(max_value, pixel[channel]);
+		}
+
+		// 8 value mode (a0 > a1), where index 0 is a0, index 1 is a1 and the rest interpolates between them
+		const uint32_t a0 = round_to_uint(max_value);
+		const uint32_t a1 = round_to_uint(min_value);
+
+		uint64_t index_bits = 0;
+		if (a0 != a1)
+		{
+			const float range = static_cast<float>(a0 - a1);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				// Position along the line, 0 is a0 and 7 is a1
+				const uint32_t step		= round_to_uint((static_cast<float>(a0) - block.pixels[i][channel]) / range * 7.0f);
+				const uint32_t index	= step == 0 ? 0 : (step == 7 ? 1 : step + 1);
+				index_bits |= static_cast<uint64_t>(index) << (i * 3);
+			}
+		}
+
+		output[0] = static_cast<std::byte>(a0);
+		output[1] = static_cast<std::byte>(a1);
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			output[2 + i] = static_cast<std::byte>((index_bits >> (i * 8)) & 0xFF);
+		}
+	}
+
+	inline void decode_bc4(const std::byte* input, uint8_t pixels[16][4], const uint32_t channel)
+	{
+		const uint32_t a0 = static_cast<uint32_t>(input[0]);
+		const uint32_t a1 = static_cast<uint32_t>(input[1]);
+
+		uint32_t palette[8] = { a0, a1 };
+		if (a0 > a1)
+		{
+			for (uint32_t i = 2; i < 8; i++)
+			{
+				palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (uint32_t i = 2; i < 6; i++)
+			{
+				palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t index_bits = 0;
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			index_bits |= static_cast<uint64_t>(input[2 + i]) << (i * 8);
+		}
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			pixels[i][channel] = static_cast<uint8_t>(palette[(index_bits >> (i * 3)) & 7]);
+		}
+	}
+	//======================================================================================================
+
+	//= BC7 (MODE 6) =======================================================================================
+	// Mode 6 is a single subset with 7-bit RGBA endpoints, a p-bit per endpoint and 4-bit indices
+	inline float bc7_mode6_select_indices(const Block& block, const uint32_t* endpoint_0, const uint32_t* endpoint_1, uint32_t* indices)
+	{
+		float palette[16][4];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				palette[i][c] = static_cast<float>(((64 - bc7_weights[i]) * endpoint_0[c] + bc7_weights[i] * endpoint_1[c] + 32) >> 6);
+			}
+		}
+
+		float axis[4];
+		float axis_length_squared = 0.0f;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			axis[c] = static_cast<float>(endpoint_1[c]) - static_cast<float>(endpoint_0[c]);
+			axis_length_squared += axis[c] * axis[c];
+		}
+
+		float error = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			// Project onto the endpoint line to get a first guess, then check the neighbouring indices
+			uint32_t guess = 0;
+			if (axis_length_squared > 0.0f)
+			{
+				float t = 0.0f;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					t += (block.pixels[i][c] - static_cast<float>(endpoint_0[c])) * axis[c];
+				}
+				guess = round_to_uint(clamp_01(t / axis_length_squared) * 15.0f);
+			}
+
+			float best_distance = numeric_limits<float>::max();
+			const uint32_t first	= guess == 0 ? 0 : guess - 1;
+			const uint32_t last		= guess == 15 ? 15 : guess + 1;
+			for (uint32_t p = first; p <= last; p++)
+			{
+				float distance = 0.0f;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const float delta = block.pixels[i][c] - palette[p][c];
+					distance += delta * delta;
+				}
+
+				if (distance < best_distance)
+				{
+					best_distance	= distance;
+					indices[i]		= p;
+				}
+			}
+			error += best_distance;
+		}
+
+		return error;
+	}
+
+	struct Bc7Mode6Result
+	{
+		uint32_t endpoint_0[4]	= {};	// 7-bit
+		uint32_t endpoint_1[4]	= {};	// 7-bit
+		uint32_t p_bit_0		= 0;
+		uint32_t p_bit_1		= 0;
+		uint32_t indices[16]	= {};
+		float error				= numeric_limits<float>::max();
+	};
+
+	// Tries all p-bit combinations for a pair of endpoints and keeps the best one
+	inline void bc7_mode6_quantize(const Block& block, const float* endpoint_0, const float* endpoint_1, Bc7Mode6Result& result)
+	{
+		for (uint32_t p_bit_0 = 0; p_bit_0 < 2; p_bit_0++)
+		{
+			for (uint32_t p_bit_1 = 0; p_bit_1 < 2; p_bit_1++)
+			{
+				Bc7Mode6Result candidate;
+				candidate.p_bit_0 = p_bit_0;
+				candidate.p_bit_1 = p_bit_1;
+
+				uint32_t expanded_0[4];
+				uint32_t expanded_1[4];
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					candidate.endpoint_0[c] = min(round_to_uint(max((endpoint_0[c] - p_bit_0) / 2.0f, 0.0f)), 127u);
+					candidate.endpoint_1[c] = min(round_to_uint(max((endpoint_1[c] - p_bit_1) / 2.0f, 0.0f)), 127u);
+					expanded_0[c] = (candidate.endpoint_0[c] << 1) | p_bit_0;
+					expanded_1[c] = (candidate.endpoint_1[c] << 1) | p_bit_1;
+				}
+
+				candidate.error = bc7_mode6_select_indices(block, expanded_0, expanded_1, candidate.indices);
+				if (candidate.error < result.error)
+				{
+					result = candidate;
+				}
+			}
+		}
+	}
+
+	inline void encode_bc7(const Block& block, const Texture_Compression_Quality quality, std::byte* output)
+	{
+		float endpoint_0[4];
+		float endpoint_1[4];
+		compute_endpoints(block, 4, quality, endpoint_0, endpoint_1);
+
+		Bc7Mode6Result result;
+		bc7_mode6_quantize(block, endpoint_0, endpoint_1, result);
+
+		if (quality == Compression_Best)
+		{
+			for (uint32_t iteration = 0; iteration < 2; iteration++)
+			{
+				float weights[16];
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					weights[i] = bc7_weights[result.indices[i]] / 64.0f;
+				}
+
+				if (!refine_endpoints(block, weights, 4, endpoint_0, endpoint_1))
+					break;
+
+				Bc7Mode6Result refined;
+				bc7_mode6_quantize(block, endpoint_0, endpoint_1, refined);
+				if (refined.error >= result.error)
+					break;
+
+				result = refined;
+			}
+		}
+
+		// The anchor (first) index is stored with an implicit zero msb, so flip the line if needed
+		if (result.indices[0] & 8)
+		{
+			swap(result.endpoint_0, result.endpoint_1);
+			swap(result.p_bit_0, result.p_bit_1);
+			for (auto& index : result.indices)
+			{
+				index = 15 - index;
+			}
+		}
+
+		Bits128 bits;
+		bits.Write(1 << 6, 7); // mode 6
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			bits.Write(result.endpoint_0[c], 7);
+			bits.Write(result.endpoint_1[c], 7);
+		}
+		bits.Write(result.p_bit_0, 1);
+		bits.Write(result.p_bit_1, 1);
+		bits.Write(result.indices[0], 3);
+		for (uint32_t i = 1; i < 16; i++)
+		{
+			bits.Write(result.indices[i], 4);
+		}
+
+		memcpy(output + 0, &bits.lo, 8);
+		memcpy(output + 8, &bits.hi, 8);
+	}
+
+	inline bool decode_bc7(const std::byte* input, uint8_t pixels[16][4])
+	{
+		Bits128 bits;
+		memcpy(&bits.lo, input + 0, 8);
+		memcpy(&bits.hi, input + 8, 8);
+
+		// Only mode 6 is decoded, since it's the only mode that the encoder emits
+		if (bits.Read(7) != (1 << 6))
+			return false;
+
+		uint32_t endpoint_0[4];
+		uint32_t endpoint_1[4];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoint_0[c] = bits.Read(7) << 1;
+			endpoint_1[c] = bits.Read(7) << 1;
+		}
+		const uint32_t p_bit_0 = bits.Read(1);
+		const uint32_t p_bit_1 = bits.Read(1);
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoint_0[c] |= p_bit_0;
+			endpoint_1[c] |= p_bit_1;
+		}
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			const uint32_t index = bits.Read(i == 0 ? 3 : 4);
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				pixels[i][c] = static_cast<uint8_t>(((64 - bc7_weights[index]) * endpoint_0[c] + bc7_weights[index] * endpoint_1[c] + 32) >> 6);
+			}
+		}
+
+		return true;
+	}
+	//======================================================================================================
+}
+
+namespace Spartan
+{
+	void TextureCompressor::CompressBlockRows(const std::byte* rgba, const uint32_t width, const uint32_t height, const RHI_Format format, const Texture_Compression_Quality quality, const uint32_t block_row_start, const uint32_t block_row_end, std::byte* output)
+	{
+		const uint32_t block_count_x	= GetBlockCountX(width);
+		const uint32_t block_size		= GetBlockSize(format);
+
+		_TextureCompressor::Block block;
+		for (uint32_t block_y = block_row_start; block_y < block_row_end; block_y++)
+		{
+			for (uint32_t block_x = 0; block_x < block_count_x; block_x++)
+			{
+				_TextureCompressor::fetch_block(rgba, width, height, block_x, block_y, block);
+				std::byte* destination = output + (static_cast<size_t>(block_y) * block_count_x + block_x) * block_size;
+
+				switch (format)
+				{
+					case Format_BC1_UNORM:	_TextureCompressor::encode_bc1(block, quality, destination);	break;
+					case Format_BC3_UNORM:	_TextureCompressor::encode_bc4(block, 3, destination);			_TextureCompressor::encode_bc1(block, quality, destination + 8); break;
+					case Format_BC4_UNORM:	_TextureCompressor::encode_bc4(block, 0, destination);			break;
+					case Format_BC5_UNORM:	_TextureCompressor::encode_bc4(block, 0, destination);			_TextureCompressor::encode_bc4(block, 1, destination + 8); break;
+					case Format_BC7_UNORM:	_TextureCompressor::encode_bc7(block, quality, destination);	break;
+					default: break;
+				}
+			}
+		}
+	}
+
+	bool TextureCompressor::Compress(const vector<std::byte>& rgba, const uint32_t width, const uint32_t height, const RHI_Format format, const Texture_Compression_Quality quality, vector<std::byte>* output)
+	{
+		if (!output || width == 0 || height == 0 || !IsCompressedFormat(format) || rgba.size() < static_cast<size_t>(width) * height * 4)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		output->resize(GetCompressedSize(width, height, format));
+		CompressBlockRows(rgba.data(), width, height, format, quality, 0, GetBlockCountY(height), output->data());
+
+		return true;
+	}
+
+	bool TextureCompressor::Decompress(const vector<std::byte>& blocks, const uint32_t width, const uint32_t height, const RHI_Format format, vector<std::byte>* rgba)
+	{
+		if (!rgba || width == 0 || height == 0 || !IsCompressedFormat(format) || blocks.size() < GetCompressedSize(width, height, format))
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		rgba->assign(static_cast<size_t>(width) * height * 4, std::byte{ 0 });
+
+		const uint32_t block_count_x	= GetBlockCountX(width);
+		const uint32_t block_count_y	= GetBlockCountY(height);
+		const uint32_t block_size		= GetBlockSize(format);
+		auto result						= true;
+
+		for (uint32_t block_y = 0; block_y < block_count_y; block_y++)
+		{
+			for (uint32_t block_x = 0; block_x < block_count_x; block_x++)
+			{
+				const std::byte* source = blocks.data() + (static_cast<size_t>(block_y) * block_count_x + block_x) * block_size;
+
+				uint8_t pixels[16][4] = {};
+				switch (format)
+				{
+					case Format_BC1_UNORM:	_TextureCompressor::decode_bc1(source, pixels, false);	break;
+					case Format_BC3_UNORM:	_TextureCompressor::decode_bc1(source + 8, pixels, true);	_TextureCompressor::decode_bc4(source, pixels, 3); break;
+					case Format_BC4_UNORM:	_TextureCompressor::decode_bc4(source, pixels, 0);		break;
+					case Format_BC5_UNORM:	_TextureCompressor::decode_bc4(source, pixels, 0);		_TextureCompressor::decode_bc4(source + 8, pixels, 1); break;
+					case Format_BC7_UNORM:	result = _TextureCompressor::decode_bc7(source, pixels) && result; break;
+					default: break;
+				}
+
+				for (uint32_t y = 0; y < 4; y++)
+				{
+					for (uint32_t x = 0; x < 4; x++)
+					{
+						const uint32_t px = block_x * 4 + x;
+						const uint32_t py = block_y * 4 + y;
+						if (px >= width || py >= height)
+							continue;
+
+						memcpy(rgba->data() + (static_cast<size_t>(py) * width + px) * 4, pixels[y * 4 + x], 4);
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+	double TextureCompressor::ComputePsnr(const vector<std::byte>& rgba, const vector<std::byte>& blocks, const uint32_t width, const uint32_t height, const RHI_Format format)
+	{
+		vector<std::byte> decompressed;
+		if (!Decompress(blocks, width, height, format, &decompressed))
+			return 0.0;
+
+		uint32_t channel_count = 4;
+		if (format == Format_BC1_UNORM) channel_count = 3;
+		if (format == Format_BC4_UNORM) channel_count = 1;
+		if (format == Format_BC5_UNORM) channel_count = 2;
+
+		double squared_error = 0.0;
+		const size_t pixel_count = static_cast<size_t>(width) * height;
+		for (size_t i = 0; i < pixel_count; i++)
+		{
+			for (uint32_t c = 0; c < channel_count; c++)
+			{
+				const double delta = static_cast<double>(rgba[i * 4 + c]) - static_cast<double>(decompressed[i * 4 + c]);
+				squared_error += delta * delta;
+			}
+		}
+
+		const double mean_squared_error = squared_error / static_cast<double>(pixel_count * channel_count);
+		if (mean_squared_error == 0.0)
+			return numeric_limits<double>::infinity();
+
+		return 10.0 * log10((255.0 * 255.0) / mean_squared_error);
+	}
+
+	bool TextureCompressor::IsCompressedFormat(const RHI_Format format)
+	{
+		return
+			format == Format_BC1_UNORM ||
+			format == Format_BC3_UNORM ||
+			format == Format_BC4_UNORM ||
+			format == Format_BC5_UNORM ||
+			format == Format_BC7_UNORM;
+	}
+
+	uint32_t TextureCompressor::GetBlockSize(const RHI_Format format)
+	{
+		switch (format)
+		{
+			case Format_BC1_UNORM: return 8;
+			case Format_BC4_UNORM: return 8;
+			case Format_BC3_UNORM: return 16;
+			case Format_BC5_UNORM: return 16;
+			case Format_BC7_UNORM: return 16;
+			default: return 0;
+		}
+	}
+}
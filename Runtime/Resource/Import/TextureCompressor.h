@@ -0,0 +1,59 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include <cstdint>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Definition.h"
+//===================================
+
+namespace Spartan
+{
+	enum Texture_Compression_Quality : uint32_t
+	{
+		Compression_Fast,	// Bounding box endpoints
+		Compression_Normal,	// Principal axis endpoints
+		Compression_Best	// Principal axis endpoints plus least squares refinement
+	};
+
+	// CPU block compressor for the BC1, BC3, BC4, BC5 and BC7 (mode 6) formats.
+	// Input is always tightly packed RGBA8, output is a row major array of 4x4 blocks.
+	class SPARTAN_CLASS TextureCompressor
+	{
+	public:
+		// Compresses the block rows [block_row_start, block_row_end) of an image, this allows callers to split the work across threads
+		static void CompressBlockRows(const std::byte* rgba, uint32_t width, uint32_t height, RHI_Format format, Texture_Compression_Quality quality, uint32_t block_row_start, uint32_t block_row_end, std::byte* output);
+		static bool Compress(const std::vector<std::byte>& rgba, uint32_t width, uint32_t height, RHI_Format format, Texture_Compression_Quality quality, std::vector<std::byte>* output);
+		static bool Decompress(const std::vector<std::byte>& blocks, uint32_t width, uint32_t height, RHI_Format format, std::vector<std::byte>* rgba);
+
+		// Peak signal to noise ratio (in dB) between the source image and its compressed version, only the channels that the format stores are compared
+		static double ComputePsnr(const std::vector<std::byte>& rgba, const std::vector<std::byte>& blocks, uint32_t width, uint32_t height, RHI_Format format);
+
+		static bool IsCompressedFormat(RHI_Format format);
+		static uint32_t GetBlockSize(RHI_Format format);
+		static uint32_t GetBlockCountX(const uint32_t width)	{ return (width + 3) / 4; }
+		static uint32_t GetBlockCountY(const uint32_t height)	{ return (height + 3) / 4; }
+		static uint32_t GetCompressedSize(const uint32_t width, const uint32_t height, const RHI_Format format) { return GetBlockCountX(width) * GetBlockCountY(height) * GetBlockSize(format); }
+	};
+}
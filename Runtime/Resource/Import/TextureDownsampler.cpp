@@ -0,0 +1,386 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "TextureDownsampler.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+//==============================
+
+//= NAMESPACES =====
+using namespace std;
+using namespace Spartan;
+//==================
+
+namespace _TextureDownsampler
+{
+	static const uint32_t kaiser_taps = 6;
+
+	// Modified Bessel function of the first kind (order 0), used by the Kaiser window
+	inline float bessel_i0(const float x)
+	{
+		float sum	= 1.0f;
+		float term	= 1.0f;
+		for (uint32_t k = 1; k < 16; k++)
+		{
+			term *= (x / (2.0f * k)) * (x / (2.0f * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	// Weights of a 2x downsample, the taps sit at -2.5, -1.5, -0.5, 0.5, 1.5 and 2.5 source pixels from the destination pixel's center
+	struct KaiserWeights
+	{
+		float weights[kaiser_taps];
+
+		KaiserWeights()
+		{
+			const float pi		= 3.14159265359f;
+			const float beta	= 4.0f;
+			const float radius	= 3.0f;
+
+			float sum = 0.0f;
+			for (uint32_t i = 0; i < kaiser_taps; i++)
+			{
+				const float distance	= static_cast<float>(i) - 2.5f;
+				const float x			= distance * 0.5f;	// sinc scaled for a 2x reduction
+				const float sinc		= sinf(pi * x) / (pi * x);
+				const float ratio		= distance / radius;
+				const float window		= bessel_i0(beta * sqrtf(max(0.0f, 1.0f - ratio * ratio))) / bessel_i0(beta);
+				weights[i]				= sinc * window;
+				sum += weights[i];
+			}
+
+			for (auto& weight : weights)
+			{
+				weight /= sum;
+			}
+		}
+	};
+	static const KaiserWeights kaiser;
+
+	// sRGB to linear, one entry per 8-bit value
+	struct SrgbToLinear
+	{
+		float values[256];
+
+		SrgbToLinear()
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				const float srgb	= i / 255.0f;
+				values[i]			= srgb <= 0.04045f ? srgb / 12.92f : powf((srgb + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+	};
+	static const SrgbToLinear srgb_to_linear;
+
+	// Linear to sRGB, sampled with linear interpolation (much cheaper than evaluating the curve per texel)
+	struct LinearToSrgb
+	{
+		static const uint32_t resolution = 4096;
+		float values[resolution + 1];
+
+		LinearToSrgb()
+		{
+			for (uint32_t i = 0; i <= resolution; i++)
+			{
+				const float linear	= static_cast<float>(i) / resolution;
+				values[i]			= linear <= 0.0031308f ? linear * 12.92f : 1.055f * powf(linear, 1.0f / 2.4f) - 0.055f;
+			}
+		}
+
+		float Get(const float linear) const
+		{
+			const float position	= min(max(linear, 0.0f), 1.0f) * resolution;
+			const uint32_t index	= min(static_cast<uint32_t>(position), resolution - 1);
+			const float fraction	= position - static_cast<float>(index);
+			return values[index] + (values[index + 1] - values[index]) * fraction;
+		}
+	};
+	static const LinearToSrgb linear_to_srgb;
+
+	inline __m128 load_pixel(const std::byte* source, const uint32_t index, const uint32_t channels, const uint32_t bytes_per_channel, const Mipmap_Content content)
+	{
+		if (bytes_per_channel == 4)
+		{
+			const float* pixel = reinterpret_cast<const float*>(source) + static_cast<size_t>(index) * channels;
+			return channels == 4 ? _mm_loadu_ps(pixel) : _mm_set_ps(0.0f, pixel[2], pixel[1], pixel[0]);
+		}
+
+		const std::byte* pixel = source + static_cast<size_t>(index) * 4;
+		if (content == Mipmap_Content_Color)
+		{
+			return _mm_set_ps
+			(
+				static_cast<float>(pixel[3]) / 255.0f,
+				srgb_to_linear.values[static_cast<uint8_t>(pixel[2])],
+				srgb_to_linear.values[static_cast<uint8_t>(pixel[1])],
+				srgb_to_linear.values[static_cast<uint8_t>(pixel[0])]
+			);
+		}
+
+		// Widen the 4 bytes to 4 floats
+		int32_t packed;
+		memcpy(&packed, pixel, 4);
+		const __m128i zero		= _mm_setzero_si128();
+		const __m128i widened	= _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+		__m128 value			= _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(1.0f / 255.0f));
+
+		// Normals are unpacked to [-1, 1] so that they can be renormalized after filtering
+		if (content == Mipmap_Content_Normal)
+		{
+			const __m128 unpacked	= _mm_sub_ps(_mm_mul_ps(value, _mm_set1_ps(2.0f)), _mm_set1_ps(1.0f));
+			const __m128 mask_xyz	= _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+			value = _mm_or_ps(_mm_and_ps(mask_xyz, unpacked), _mm_andnot_ps(mask_xyz, value)); // alpha stays as is
+		}
+
+		return value;
+	}
+
+	inline uint32_t clamp_index(const int32_t index, const uint32_t size)
+	{
+		return static_cast<uint32_t>(min(max(index, 0), static_cast<int32_t>(size) - 1));
+	}
+
+	// Source rows that have been converted to floats and filtered horizontally
+	class RowCache
+	{
+	public:
+		const __m128* Get(const uint32_t row, const std::byte* source, const uint32_t source_width, const uint32_t destination_width, const uint32_t channels, const uint32_t bytes_per_channel, const Mipmap_Content content)
+		{
+			for (auto& entry : m_entries)
+			{
+				if (entry.row == static_cast<int64_t>(row))
+					return entry.filtered.data();
+			}
+
+			// Rows are requested in increasing order, so the lowest one is no longer needed
+			auto* entry = &m_entries[0];
+			for (auto& candidate : m_entries)
+			{
+				entry = candidate.row < entry->row ? &candidate : entry;
+			}
+			entry->row = row;
+
+			// Convert the row once
+			m_converted.resize(source_width);
+			for (uint32_t x = 0; x < source_width; x++)
+			{
+				m_converted[x] = load_pixel(source, row * source_width + x, channels, bytes_per_channel, content);
+			}
+
+			// Filter it horizontally
+			entry->filtered.resize(destination_width);
+			for (uint32_t x = 0; x < destination_width; x++)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (uint32_t i = 0; i < kaiser_taps; i++)
+				{
+					const uint32_t sx = clamp_index(static_cast<int32_t>(x * 2 + i) - 2, source_width);
+					sum = _mm_add_ps(sum, _mm_mul_ps(m_converted[sx], _mm_set1_ps(kaiser.weights[i])));
+				}
+				entry->filtered[x] = sum;
+			}
+
+			return entry->filtered.data();
+		}
+
+	private:
+		struct Entry
+		{
+			int64_t row = -1;
+			std::vector<__m128> filtered;
+		};
+		Entry m_entries[kaiser_taps];
+		std::vector<__m128> m_converted;
+	};
+
+	inline void store_pixel(std::byte* destination, const uint32_t index, __m128 value, const uint32_t channels, const uint32_t bytes_per_channel, const Mipmap_Content content)
+	{
+		if (bytes_per_channel == 4)
+		{
+			float result[4];
+			_mm_storeu_ps(result, value);
+			memcpy(reinterpret_cast<float*>(destination) + static_cast<size_t>(index) * channels, result, channels * sizeof(float));
+			return;
+		}
+
+		float result[4];
+		_mm_storeu_ps(result, value);
+
+		if (content == Mipmap_Content_Color)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				result[c] = linear_to_srgb.Get(result[c]);
+			}
+		}
+		else if (content == Mipmap_Content_Normal)
+		{
+			// Filtering shortens the normals, restore their unit length and pack them back to [0, 1]
+			const float length = sqrtf(result[0] * result[0] + result[1] * result[1] + result[2] * result[2]);
+			const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				result[c] = result[c] * scale * 0.5f + 0.5f;
+			}
+		}
+
+		// Back to 8 bits
+		__m128 scaled		= _mm_loadu_ps(result);
+		scaled				= _mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		scaled				= _mm_add_ps(_mm_mul_ps(scaled, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+		const __m128i words	= _mm_packs_epi32(_mm_cvttps_epi32(scaled), _mm_setzero_si128());
+		const int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, _mm_setzero_si128()));
+		memcpy(destination + static_cast<size_t>(index) * 4, &packed, 4);
+	}
+}
+
+namespace Spartan
+{
+	void TextureDownsampler::DownsampleRows(
+		const std::byte* source,
+		const uint32_t source_width,
+		const uint32_t source_height,
+		std::byte* destination,
+		const uint32_t row_start,
+		const uint32_t row_end,
+		const uint32_t channels,
+		const uint32_t bytes_per_channel,
+		const Mipmap_Filter filter,
+		const Mipmap_Content content
+	)
+	{
+		const uint32_t destination_width = GetMipSize(source_width);
+
+		// The Kaiser filter is separable, so every source row is filtered horizontally once and cached while the destination rows that need it are written
+		_TextureDownsampler::RowCache rows;
+
+		for (uint32_t y = row_start; y < row_end; y++)
+		{
+			for (uint32_t x = 0; x < destination_width; x++)
+			{
+				__m128 sum = _mm_setzero_ps();
+
+				if (filter == Mipmap_Filter_Box)
+				{
+					// Odd dimensions clamp to the edge
+					const uint32_t x0 = min(x * 2, source_width - 1);
+					const uint32_t x1 = min(x * 2 + 1, source_width - 1);
+					const uint32_t y0 = min(y * 2, source_height - 1);
+					const uint32_t y1 = min(y * 2 + 1, source_height - 1);
+
+					sum = _mm_add_ps(sum, _TextureDownsampler::load_pixel(source, y0 * source_width + x0, channels, bytes_per_channel, content));
+					sum = _mm_add_ps(sum, _TextureDownsampler::load_pixel(source, y0 * source_width + x1, channels, bytes_per_channel, content));
+					sum = _mm_add_ps(sum, _TextureDownsampler::load_pixel(source, y1 * source_width + x0, channels, bytes_per_channel, content));
+					sum = _mm_add_ps(sum, _TextureDownsampler::load_pixel(source, y1 * source_width + x1, channels, bytes_per_channel, content));
+					sum = _mm_mul_ps(sum, _mm_set1_ps(0.25f));
+				}
+				else
+				{
+					// Combine the horizontally filtered rows
+					for (uint32_t j = 0; j < _TextureDownsampler::kaiser_taps; j++)
+					{
+						const uint32_t sy = _TextureDownsampler::clamp_index(static_cast<int32_t>(y * 2 + j) - 2, source_height);
+						const __m128 filtered = rows.Get(sy, source, source_width, destination_width, channels, bytes_per_channel, content)[x];
+						sum = _mm_add_ps(sum, _mm_mul_ps(filtered, _mm_set1_ps(_TextureDownsampler::kaiser.weights[j])));
+					}
+				}
+
+				_TextureDownsampler::store_pixel(destination, y * destination_width + x, sum, channels, bytes_per_channel, content);
+			}
+		}
+	}
+
+	float TextureDownsampler::ComputeAlphaCoverage(const vector<std::byte>& rgba, const float alpha_reference)
+	{
+		const size_t pixel_count = rgba.size() / 4;
+		if (pixel_count == 0)
+			return 0.0f;
+
+		const uint32_t threshold = static_cast<uint32_t>(alpha_reference * 255.0f);
+		size_t passed = 0;
+		for (size_t i = 0; i < pixel_count; i++)
+		{
+			passed += static_cast<uint32_t>(rgba[i * 4 + 3]) > threshold ? 1 : 0;
+		}
+
+		return static_cast<float>(passed) / static_cast<float>(pixel_count);
+	}
+
+	void TextureDownsampler::ScaleAlphaToCoverage(vector<std::byte>* rgba, const float alpha_reference, const float coverage)
+	{
+		const size_t pixel_count = rgba->size() / 4;
+		if (pixel_count == 0)
+			return;
+
+		// An alpha histogram lets the search below evaluate the coverage of a scale without touching the pixels
+		uint32_t histogram[256] = {};
+		for (size_t i = 0; i < pixel_count; i++)
+		{
+			histogram[static_cast<uint8_t>((*rgba)[i * 4 + 3])]++;
+		}
+
+		const float threshold = alpha_reference * 255.0f;
+		const auto coverage_at = [&histogram, &threshold, &pixel_count](const float scale)
+		{
+			size_t passed = 0;
+			for (uint32_t alpha = 0; alpha < 256; alpha++)
+			{
+				const float scaled = min(static_cast<float>(alpha) * scale + 0.5f, 255.0f);
+				passed += static_cast<uint32_t>(scaled) > static_cast<uint32_t>(threshold) ? histogram[alpha] : 0;
+			}
+			return static_cast<float>(passed) / static_cast<float>(pixel_count);
+		};
+
+		// Binary search for the scale, coverage grows with it
+		float scale_min = 0.0f;
+		float scale_max = 4.0f;
+		float scale		= 1.0f;
+		for (uint32_t iteration = 0; iteration < 10; iteration++)
+		{
+			const float current = coverage_at(scale);
+			if (current < coverage)
+			{
+				scale_min = scale;
+			}
+			else if (current > coverage)
+			{
+				scale_max = scale;
+			}
+			else
+			{
+				break;
+			}
+			scale = (scale_min + scale_max) * 0.5f;
+		}
+
+		for (size_t i = 0; i < pixel_count; i++)
+		{
+			const float alpha = static_cast<float>((*rgba)[i * 4 + 3]) * scale;
+			(*rgba)[i * 4 + 3] = static_cast<std::byte>(static_cast<uint8_t>(min(alpha + 0.5f, 255.0f)));
+		}
+	}
+}
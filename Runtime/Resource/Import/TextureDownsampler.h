@@ -0,0 +1,71 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =================
+#include <vector>
+#include <cstdint>
+#include "../../Core/EngineDefs.h"
+//============================
+
+namespace Spartan
+{
+	enum Mipmap_Filter : uint32_t
+	{
+		Mipmap_Filter_Box,		// 2x2 average
+		Mipmap_Filter_Kaiser	// 6x6 Kaiser windowed sinc, sharper
+	};
+
+	enum Mipmap_Content : uint32_t
+	{
+		Mipmap_Content_Data,	// Filtered as is
+		Mipmap_Content_Color,	// sRGB, filtered in linear space
+		Mipmap_Content_Normal	// Tangent space normals, renormalized after filtering
+	};
+
+	// Builds a mip level from the previous one. Supports RGBA8 and 32-bit float images (3 or 4 channels).
+	class SPARTAN_CLASS TextureDownsampler
+	{
+	public:
+		// Writes the destination rows [row_start, row_end), this allows callers to split the work across threads
+		static void DownsampleRows(
+			const std::byte* source,
+			uint32_t source_width,
+			uint32_t source_height,
+			std::byte* destination,
+			uint32_t row_start,
+			uint32_t row_end,
+			uint32_t channels,
+			uint32_t bytes_per_channel,
+			Mipmap_Filter filter,
+			Mipmap_Content content
+		);
+
+		// Fraction of RGBA8 pixels that pass an alpha test against alpha_reference (in the [0, 1] range)
+		static float ComputeAlphaCoverage(const std::vector<std::byte>& rgba, float alpha_reference);
+
+		// Scales the alpha of RGBA8 pixels so that the alpha test coverage matches the given one (usually that of the top mip)
+		static void ScaleAlphaToCoverage(std::vector<std::byte>* rgba, float alpha_reference, float coverage);
+
+		static uint32_t GetMipSize(const uint32_t size) { return size > 1 ? size / 2 : 1; }
+	};
+}
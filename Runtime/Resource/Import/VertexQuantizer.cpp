@@ -0,0 +1,279 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "VertexQuantizer.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+//=========================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan;
+using namespace Spartan::Math;
+//=============================
+
+namespace _VertexQuantizer
+{
+	static const float unorm_max = 65535.0f;
+	static const float snorm_max = 32767.0f;
+	static const float octahedral_error_bound = 0.003f; // Degrees, the precise 16-bit octahedral encoding measures about 0.0025
+
+	// The scale of a flat axis is kept at one, so that all its vertices quantize to zero and decode to the offset exactly
+	float safe_scale(const float extent) { return extent > 1e-12f ? extent : 1.0f; }
+
+	uint16_t unorm_encode(const float value, const float offset, const float scale)
+	{
+		const auto normalized = min(max((value - offset) / scale, 0.0f), 1.0f);
+		return static_cast<uint16_t>(lround(normalized * unorm_max));
+	}
+
+	// Matches the hardware R16_UNORM conversion
+	float unorm_decode(const uint16_t value, const float offset, const float scale) { return offset + (static_cast<float>(value) / unorm_max) * scale; }
+
+	// Matches the hardware R16_SNORM conversion
+	float snorm_decode(const int16_t value) { return max(static_cast<float>(value) / snorm_max, -1.0f); }
+
+	float sign_not_zero(const float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+	// Octahedral mapping - http://jcgt.org/published/0003/02/01/
+	void octahedral_wrap(float* x, float* y, const float z)
+	{
+		if (z >= 0.0f)
+			return;
+
+		const auto wrapped_x = (1.0f - fabsf(*y)) * sign_not_zero(*x);
+		const auto wrapped_y = (1.0f - fabsf(*x)) * sign_not_zero(*y);
+		*x = wrapped_x;
+		*y = wrapped_y;
+	}
+
+	void octahedral_decode(const int16_t* encoded, float* vector)
+	{
+		auto x = snorm_decode(encoded[0]);
+		auto y = snorm_decode(encoded[1]);
+		const auto z = 1.0f - fabsf(x) - fabsf(y);
+		octahedral_wrap(&x, &y, z);
+
+		const auto length = sqrtf(x * x + y * y + z * z);
+		vector[0] = x / length;
+		vector[1] = y / length;
+		vector[2] = z / length;
+	}
+
+	// Picks the best of the four surrounding snorm values instead of the rounded one, this halves the worst case error
+	void octahedral_encode(const float* vector, int16_t* encoded)
+	{
+		const auto l1 = fabsf(vector[0]) + fabsf(vector[1]) + fabsf(vector[2]);
+		if (l1 <= 1e-12f)
+		{
+			encoded[0] = 0;
+			encoded[1] = 0;
+			return;
+		}
+
+		auto x = vector[0] / l1;
+		auto y = vector[1] / l1;
+		octahedral_wrap(&x, &y, vector[2]);
+
+		// Candidates are ranked by distance, a dot product can't resolve angles this small in float precision
+		const auto length		= sqrtf(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+		const float target[3]	= { vector[0] / length, vector[1] / length, vector[2] / length };
+		const auto base_x		= floorf(x * snorm_max);
+		const auto base_y		= floorf(y * snorm_max);
+		auto best_distance		= INFINITY;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			const int16_t candidate[2] =
+			{
+				static_cast<int16_t>(min(max(base_x + static_cast<float>(i & 1), -snorm_max), snorm_max)),
+				static_cast<int16_t>(min(max(base_y + static_cast<float>(i >> 1), -snorm_max), snorm_max))
+			};
+
+			float decoded[3];
+			octahedral_decode(candidate, decoded);
+			const auto dx		= decoded[0] - target[0];
+			const auto dy		= decoded[1] - target[1];
+			const auto dz		= decoded[2] - target[2];
+			const auto distance	= dx * dx + dy * dy + dz * dz;
+			if (distance < best_distance)
+			{
+				best_distance	= distance;
+				encoded[0]		= candidate[0];
+				encoded[1]		= candidate[1];
+			}
+		}
+	}
+
+	float angle_degrees(const float* a, const float* b)
+	{
+		const auto length_a = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+		const auto length_b = sqrtf(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+		if (length_a <= 1e-6f || length_b <= 1e-6f)
+			return 0.0f;
+
+		// atan2 keeps its precision for the tiny angles that quantization produces, unlike acos
+		const float cross[3] =
+		{
+			a[1] * b[2] - a[2] * b[1],
+			a[2] * b[0] - a[0] * b[2],
+			a[0] * b[1] - a[1] * b[0]
+		};
+		const auto sine		= sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+		const auto cosine	= a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		return RadiansToDegrees(atan2f(sine, cosine));
+	}
+}
+
+Vertex_Quantization VertexQuantizer::ComputeQuantization(const vector<RHI_Vertex_PosTexNorTan>& vertices)
+{
+	Vertex_Quantization quantization;
+	if (vertices.empty())
+		return quantization;
+
+	float position_min[3]	= { INFINITY, INFINITY, INFINITY };
+	float position_max[3]	= { -INFINITY, -INFINITY, -INFINITY };
+	float uv_min[2]			= { INFINITY, INFINITY };
+	float uv_max[2]			= { -INFINITY, -INFINITY };
+	for (const auto& vertex : vertices)
+	{
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			position_min[i] = min(position_min[i], vertex.pos[i]);
+			position_max[i] = max(position_max[i], vertex.pos[i]);
+		}
+
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			uv_min[i] = min(uv_min[i], vertex.tex[i]);
+			uv_max[i] = max(uv_max[i], vertex.tex[i]);
+		}
+	}
+
+	quantization.position_offset	= Vector3(position_min[0], position_min[1], position_min[2]);
+	quantization.position_scale		= Vector3
+	(
+		_VertexQuantizer::safe_scale(position_max[0] - position_min[0]),
+		_VertexQuantizer::safe_scale(position_max[1] - position_min[1]),
+		_VertexQuantizer::safe_scale(position_max[2] - position_min[2])
+	);
+	quantization.uv_offset	= Vector2(uv_min[0], uv_min[1]);
+	quantization.uv_scale	= Vector2(_VertexQuantizer::safe_scale(uv_max[0] - uv_min[0]), _VertexQuantizer::safe_scale(uv_max[1] - uv_min[1]));
+
+	return quantization;
+}
+
+void VertexQuantizer::Quantize(const vector<RHI_Vertex_PosTexNorTan>& vertices, const Vertex_Quantization& quantization, vector<RHI_Vertex_PosTexNorTan_Quantized>* output)
+{
+	const float position_offset[3]	= { quantization.position_offset.x, quantization.position_offset.y, quantization.position_offset.z };
+	const float position_scale[3]	= { quantization.position_scale.x, quantization.position_scale.y, quantization.position_scale.z };
+	const float uv_offset[2]		= { quantization.uv_offset.x, quantization.uv_offset.y };
+	const float uv_scale[2]			= { quantization.uv_scale.x, quantization.uv_scale.y };
+
+	output->resize(vertices.size());
+	for (size_t v = 0; v < vertices.size(); v++)
+	{
+		const auto& vertex	= vertices[v];
+		auto& quantized		= (*output)[v];
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			quantized.pos[i] = _VertexQuantizer::unorm_encode(vertex.pos[i], position_offset[i], position_scale[i]);
+		}
+		quantized.pos[3] = static_cast<uint16_t>(_VertexQuantizer::unorm_max);
+
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			quantized.tex[i] = _VertexQuantizer::unorm_encode(vertex.tex[i], uv_offset[i], uv_scale[i]);
+		}
+
+		_VertexQuantizer::octahedral_encode(vertex.nor, quantized.nor);
+		_VertexQuantizer::octahedral_encode(vertex.tan, quantized.tan);
+	}
+}
+
+void VertexQuantizer::Dequantize(const vector<RHI_Vertex_PosTexNorTan_Quantized>& vertices, const Vertex_Quantization& quantization, vector<RHI_Vertex_PosTexNorTan>* output)
+{
+	const float position_offset[3]	= { quantization.position_offset.x, quantization.position_offset.y, quantization.position_offset.z };
+	const float position_scale[3]	= { quantization.position_scale.x, quantization.position_scale.y, quantization.position_scale.z };
+	const float uv_offset[2]		= { quantization.uv_offset.x, quantization.uv_offset.y };
+	const float uv_scale[2]			= { quantization.uv_scale.x, quantization.uv_scale.y };
+
+	output->resize(vertices.size());
+	for (size_t v = 0; v < vertices.size(); v++)
+	{
+		const auto& quantized	= vertices[v];
+		auto& vertex			= (*output)[v];
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			vertex.pos[i] = _VertexQuantizer::unorm_decode(quantized.pos[i], position_offset[i], position_scale[i]);
+		}
+
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			vertex.tex[i] = _VertexQuantizer::unorm_decode(quantized.tex[i], uv_offset[i], uv_scale[i]);
+		}
+
+		_VertexQuantizer::octahedral_decode(quantized.nor, vertex.nor);
+		_VertexQuantizer::octahedral_decode(quantized.tan, vertex.tan);
+	}
+}
+
+Vertex_Quantization_Error VertexQuantizer::ComputeError(const vector<RHI_Vertex_PosTexNorTan>& vertices, const vector<RHI_Vertex_PosTexNorTan>& vertices_dequantized)
+{
+	Vertex_Quantization_Error error;
+
+	const auto count = min(vertices.size(), vertices_dequantized.size());
+	for (size_t v = 0; v < count; v++)
+	{
+		const auto& a = vertices[v];
+		const auto& b = vertices_dequantized[v];
+
+		const auto dx = a.pos[0] - b.pos[0];
+		const auto dy = a.pos[1] - b.pos[1];
+		const auto dz = a.pos[2] - b.pos[2];
+		error.position	= max(error.position, sqrtf(dx * dx + dy * dy + dz * dz));
+		error.uv		= max(error.uv, max(fabsf(a.tex[0] - b.tex[0]), fabsf(a.tex[1] - b.tex[1])));
+		error.normal	= max(error.normal, _VertexQuantizer::angle_degrees(a.nor, b.nor));
+		error.tangent	= max(error.tangent, _VertexQuantizer::angle_degrees(a.tan, b.tan));
+	}
+
+	return error;
+}
+
+Vertex_Quantization_Error VertexQuantizer::GetErrorBound(const Vertex_Quantization& quantization)
+{
+	// Half a step per component, plus the float rounding of the decode (relative to the magnitude of the decoded values)
+	const auto half_step		= 0.5f / _VertexQuantizer::unorm_max;
+	const auto float_rounding	= 4.0f * numeric_limits<float>::epsilon();
+	const auto position_range	= (quantization.position_offset.Absolute() + quantization.position_scale).Length();
+	const auto uv_range			= max(fabsf(quantization.uv_offset.x) + quantization.uv_scale.x, fabsf(quantization.uv_offset.y) + quantization.uv_scale.y);
+
+	Vertex_Quantization_Error bound;
+	bound.position	= quantization.position_scale.Length() * half_step + position_range * float_rounding;
+	bound.uv		= max(quantization.uv_scale.x, quantization.uv_scale.y) * half_step + uv_range * float_rounding;
+	bound.normal	= _VertexQuantizer::octahedral_error_bound;
+	bound.tangent	= _VertexQuantizer::octahedral_error_bound;
+
+	return bound;
+}
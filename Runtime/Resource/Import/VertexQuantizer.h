@@ -0,0 +1,64 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Vertex.h"
+//=================================
+
+namespace Spartan
+{
+	// Decode parameters of a quantized vertex buffer, they map the unorm range to the bounds of the source vertices
+	struct Vertex_Quantization
+	{
+		Math::Vector3 position_offset	= Math::Vector3::Zero;
+		Math::Vector3 position_scale	= Math::Vector3::One;
+		Math::Vector2 uv_offset			= Math::Vector2::Zero;
+		Math::Vector2 uv_scale			= Math::Vector2::One;
+	};
+
+	struct Vertex_Quantization_Error
+	{
+		float position	= 0.0f;	// Largest distance, in model units
+		float uv		= 0.0f;	// Largest per component difference
+		float normal	= 0.0f;	// Largest angle, in degrees
+		float tangent	= 0.0f;	// Largest angle, in degrees
+	};
+
+	// Converts RHI_Vertex_PosTexNorTan (44 bytes) to RHI_Vertex_PosTexNorTan_Quantized (20 bytes) and back.
+	// Positions and uvs are stored as 16-bit unorm relative to their bounds, normals and tangents as 16-bit snorm octahedral vectors.
+	class SPARTAN_CLASS VertexQuantizer
+	{
+	public:
+		static Vertex_Quantization ComputeQuantization(const std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+		static void Quantize(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, const Vertex_Quantization& quantization, std::vector<RHI_Vertex_PosTexNorTan_Quantized>* output);
+		static void Dequantize(const std::vector<RHI_Vertex_PosTexNorTan_Quantized>& vertices, const Vertex_Quantization& quantization, std::vector<RHI_Vertex_PosTexNorTan>* output);
+
+		// Largest difference between the source vertices and their dequantized version, zero length normals and tangents are skipped
+		static Vertex_Quantization_Error ComputeError(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices_dequantized);
+
+		// Largest error the encoding can introduce, a measured error above it means the quantization is broken
+		static Vertex_Quantization_Error GetErrorBound(const Vertex_Quantization& quantization);
+	};
+}
@@ -25,12 +25,46 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Scripting.h"
 #include "../Logging/Log.h"
 #include "../FileSystem/FileSystem.h"
+#include "../IO/FileStream.h"
 //========================================
 
 //= NAMESPACES =====
 using namespace std;
 //==================
 
+namespace _Module
+{
+	// Bumped whenever the layout of the cache file changes
+	static const uint32_t bytecode_version = 1;
+
+	// Streams bytecode to and from a cache file
+	class bytecode_stream : public asIBinaryStream
+	{
+	public:
+		bytecode_stream(Spartan::FileStream* stream) { m_stream = stream; }
+
+		int Read(void* ptr, const asUINT size) override
+		{
+			// A truncated file fails the load instead of handing zeros to AngelScript
+			const auto data = m_stream->ReadSpan(size);
+			if (!data)
+				return -1;
+
+			memcpy(ptr, data, size);
+			return 0;
+		}
+
+		int Write(const void* ptr, const asUINT size) override
+		{
+			m_stream->WriteBytes(ptr, size);
+			return 0;
+		}
+
+	private:
+		Spartan::FileStream* m_stream;
+	};
+}
+
 namespace Spartan
 {
 	Module::Module(const string& moduleName, weak_ptr<Scripting> scriptEngine)
@@ -56,6 +90,10 @@ namespace Spartan
 			return false;
 		}
 
+		// Taken before reading, so that an edit made while compiling is still picked up
+		m_filePath		= filePath;
+		m_lastWriteTime	= FileSystem::GetLastWriteTime(filePath);
+
 		// start new module
 		m_scriptBuilder = make_unique<CScriptBuilder>();
 		int result = m_scriptBuilder->StartNewModule(scriptEngine->GetAsIScriptEngine(), m_moduleName.c_str());
@@ -65,25 +103,98 @@ namespace Spartan
 			return false;
 		}
 
-		// load the script
-		result = m_scriptBuilder->AddSectionFromFile(filePath.c_str());
-		if (result < 0)
+		// Skip compilation if the script and its includes haven't changed since they were last compiled
+		const auto bytecodeHash = scriptEngine->GetBytecodeHash(filePath);
+		const auto bytecodePath = scriptEngine->GetBytecodePath(filePath);
+		if (!LoadBytecode(bytecodePath, bytecodeHash))
+		{
+			// load the script
+			result = m_scriptBuilder->AddSectionFromFile(filePath.c_str());
+			if (result < 0)
+			{
+				LOGF_ERROR("Failed to load script \"%s\".", filePath.c_str());
+				return false;
+			}
+
+			// build the script
+			result = m_scriptBuilder->BuildModule();
+			if (result < 0)
+			{
+				LOGF_ERROR("Failed to compile script \"%s\". Correct any errors and try again.", FileSystem::GetFileNameFromFilePath(filePath).c_str());
+				return false;
+			}
+
+			SaveBytecode(bytecodePath, bytecodeHash);
+		}
+
+		// Get type
+		const auto className	= FileSystem::GetFileNameNoExtensionFromFilePath(filePath);
+		const auto typeId		= GetAsIScriptModule()->GetTypeIdByDecl(className.c_str());
+		m_type					= scriptEngine->GetAsIScriptEngine()->GetTypeInfoById(typeId);
+		if (!m_type)
 		{
-			LOGF_ERROR("Failed to load script \"%s\".", filePath);
+			LOG_ERROR("Couldn't find the type '" + className + "'");
 			return false;
 		}
 
-		// build the script
-		result = m_scriptBuilder->BuildModule();
-		if (result < 0)
+		// Get functions in the script
+		const auto factoryDeclaration	= className + " @" + className + "(Entity @)";
+		m_startFunction					= m_type->GetMethodByDecl("void Start()"); // Get the Start function from the script
+		m_updateFunction				= m_type->GetMethodByDecl("void Update(float delta_time)"); // Get the Update function from the script
+		m_factory						= m_type->GetFactoryByDecl(factoryDeclaration.c_str()); // Get the constructor function from the script
+		if (!m_factory)
+		{
+			LOG_ERROR("Couldn't find the appropriate factory for the type '" + className + "'");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Module::LoadBytecode(const string& filePath, const uint64_t hash)
+	{
+		if (!FileSystem::FileExists(filePath))
+			return false;
+
+		auto file = make_unique<FileStream>(filePath, FileStream_Read);
+		if (!file->IsOpen())
+			return false;
+
+		// Stale
+		if (file->ReadAs<uint32_t>() != _Module::bytecode_version || file->ReadAs<unsigned long long>() != hash)
+			return false;
+
+		_Module::bytecode_stream stream(file.get());
+		if (GetAsIScriptModule()->LoadByteCode(&stream) < 0)
 		{
-			LOGF_ERROR("Failed to compile script \"%s\". Correct any errors and try again.", FileSystem::GetFileNameFromFilePath(filePath));
+			// Start over with a clean module, it gets compiled instead
+			LOGF_WARNING("Failed to load cached bytecode for \"%s\", compiling instead", FileSystem::GetFileNameFromFilePath(m_filePath).c_str());
+			m_scriptBuilder->StartNewModule(GetAsIScriptModule()->GetEngine(), m_moduleName.c_str());
 			return false;
 		}
 
 		return true;
 	}
 
+	void Module::SaveBytecode(const string& filePath, const uint64_t hash)
+	{
+		auto file = make_unique<FileStream>(filePath, FileStream_Write);
+		if (!file->IsOpen())
+			return;
+
+		file->Write(_Module::bytecode_version);
+		file->Write(static_cast<unsigned long long>(hash));
+
+		// Debug info is kept, exceptions report line numbers
+		_Module::bytecode_stream stream(file.get());
+		if (GetAsIScriptModule()->SaveByteCode(&stream) < 0)
+		{
+			LOGF_WARNING("Failed to cache bytecode for \"%s\"", FileSystem::GetFileNameFromFilePath(m_filePath).c_str());
+		}
+
+		file->Close();
+	}
+
 	asIScriptModule* Module::GetAsIScriptModule()
 	{
 		if (!m_scriptBuilder)
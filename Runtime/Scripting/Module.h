@@ -21,19 +21,23 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ====
+//= INCLUDES =====
 #include <string>
 #include <memory>
-//===============
+#include <cstdint>
+//================
 
 class asIScriptModule;
 class CScriptBuilder;
 class asIScriptEngine;
+class asITypeInfo;
+class asIScriptFunction;
 
 namespace Spartan
 {
 	class Scripting;
 
+	// A compiled script file, shared by every instance of its class
 	class Module
 	{
 	public:
@@ -43,9 +47,27 @@ namespace Spartan
 		bool LoadScript(const std::string& filePath);
 		asIScriptModule* GetAsIScriptModule();
 
+		// The class named after the script file and its methods, resolved once when the script is loaded
+		asITypeInfo* GetType() const					{ return m_type; }
+		asIScriptFunction* GetFactory() const			{ return m_factory; }
+		asIScriptFunction* GetStartFunction() const		{ return m_startFunction; }
+		asIScriptFunction* GetUpdateFunction() const	{ return m_updateFunction; }
+
+		const auto& GetFilePath() const	{ return m_filePath; }
+		auto GetLastWriteTime() const	{ return m_lastWriteTime; }
+
 	private:
+		bool LoadBytecode(const std::string& filePath, uint64_t hash);
+		void SaveBytecode(const std::string& filePath, uint64_t hash);
+
 		std::string m_moduleName;
+		std::string m_filePath;
+		uint64_t m_lastWriteTime				= 0;
+		asITypeInfo* m_type						= nullptr;
+		asIScriptFunction* m_factory			= nullptr;
+		asIScriptFunction* m_startFunction		= nullptr;
+		asIScriptFunction* m_updateFunction		= nullptr;
 		std::unique_ptr<CScriptBuilder> m_scriptBuilder;
 		std::weak_ptr<Scripting> m_scriptEngine;
 	};
-}
\ No newline at end of file
+}
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ========================
 #include "ScriptInstance.h"
 #include <angelscript.h>
+#include <cstring>
 #include "Module.h"
 #include "../FileSystem/FileSystem.h"
 #include "../Logging/Log.h"
@@ -32,6 +33,48 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace std;
 //==================
 
+namespace _ScriptInstance
+{
+	// Copies the properties that exist in both objects with the same name and type. Types declared by the
+	// script are new types in a rebuilt module, so those properties are left to the constructor.
+	void migrate(asIScriptEngine* engine, asIScriptObject* from, asIScriptObject* to)
+	{
+		for (asUINT i = 0; i < from->GetPropertyCount(); i++)
+		{
+			const auto typeId = from->GetPropertyTypeId(i);
+			if (typeId & asTYPEID_SCRIPTOBJECT)
+				continue;
+
+			for (asUINT j = 0; j < to->GetPropertyCount(); j++)
+			{
+				if (to->GetPropertyTypeId(j) != typeId || strcmp(to->GetPropertyName(j), from->GetPropertyName(i)) != 0)
+					continue;
+
+				void* source		= from->GetAddressOfProperty(i);
+				void* destination	= to->GetAddressOfProperty(j);
+				if (typeId & asTYPEID_OBJHANDLE)
+				{
+					auto type		= engine->GetTypeInfoById(typeId);
+					auto handle		= *static_cast<void**>(source);
+					auto previous	= *static_cast<void**>(destination);
+					if (handle)		engine->AddRefScriptObject(handle, type);
+					if (previous)	engine->ReleaseScriptObject(previous, type);
+					*static_cast<void**>(destination) = handle;
+				}
+				else if (typeId & asTYPEID_MASK_OBJECT)
+				{
+					engine->AssignScriptObject(destination, source, engine->GetTypeInfoById(typeId));
+				}
+				else
+				{
+					memcpy(destination, source, engine->GetSizeOfPrimitiveType(typeId));
+				}
+				break;
+			}
+		}
+	}
+}
+
 namespace Spartan
 {
 	ScriptInstance::ScriptInstance()
@@ -41,13 +84,17 @@ namespace Spartan
 
 	ScriptInstance::~ScriptInstance()
 	{
+		if (m_scriptEngine && m_isInstantiated)
+		{
+			m_scriptEngine->Instance_Remove(this);
+		}
+
 		if (m_scriptObject)
 		{
 			m_scriptObject->Release();
 			m_scriptObject = nullptr;
 		}
 
-		m_constructorFunction	= nullptr;
 		m_startFunction			= nullptr;
 		m_updateFunction		= nullptr;
 		m_scriptEngine			= nullptr;
@@ -61,15 +108,21 @@ namespace Spartan
 
 		m_scriptEngine = scriptEngine;
 
-		// Extract properties from path
-		m_scriptPath				= path;
-		m_entity					= entity;
-		m_className					= FileSystem::GetFileNameNoExtensionFromFilePath(m_scriptPath);
-		m_moduleName				= m_className + to_string(m_entity.lock()->GetId());
-		m_constructorDeclaration	= m_className + " @" + m_className + "(Entity @)";
+		m_scriptPath	= path;
+		m_entity		= entity;
+		m_entityPtr		= entity.lock().get();
+
+		// Compiled once, shared with every other instance of this script
+		m_module = m_scriptEngine->GetModule(m_scriptPath);
+		if (!m_module)
+			return false;
 
 		// Instantiate the script
 		m_isInstantiated = CreateScriptObject();
+		if (m_isInstantiated)
+		{
+			m_scriptEngine->Instance_Add(this);
+		}
 
 		return m_isInstantiated;
 	}
@@ -82,59 +135,62 @@ namespace Spartan
 			return;
 		}
 
+		// Start() is optional
+		if (!m_startFunction)
+			return;
+
 		m_scriptEngine->ExecuteCall(m_startFunction, m_scriptObject);
 	}
 
-	void ScriptInstance::ExecuteUpdate(float delta_time)
+	bool ScriptInstance::Reload(const shared_ptr<Module>& module)
 	{
-		if (!m_scriptEngine)
+		const auto module_previous	= m_module;
+		const auto object_previous	= m_scriptObject;
+
+		m_module		= module;
+		m_scriptObject	= nullptr;
+		if (!CreateScriptObject())
 		{
-			LOG_ERROR_INVALID_INTERNALS();
-			return;
+			// Keep running the previous build
+			m_module		= module_previous;
+			m_scriptObject	= object_previous;
+			m_startFunction		= m_module->GetStartFunction();
+			m_updateFunction	= m_module->GetUpdateFunction();
+			return false;
 		}
 
-		m_scriptEngine->ExecuteCall(m_updateFunction, m_scriptObject, delta_time);
+		_ScriptInstance::migrate(m_scriptEngine->GetAsIScriptEngine(), object_previous, m_scriptObject);
+		object_previous->Release();
+
+		return true;
 	}
 
 	bool ScriptInstance::CreateScriptObject()
 	{
-		if (!m_scriptEngine)
+		if (!m_scriptEngine || !m_module)
 		{
 			LOG_ERROR_INVALID_INTERNALS();
 			return false;
 		}
 
-		// Create module
-		m_module	= make_shared<Module>(m_moduleName, m_scriptEngine);
-		bool result = m_module->LoadScript(m_scriptPath);
-		if (!result)
-			return false;
-
-		// Get type
-		auto type_id		= m_module->GetAsIScriptModule()->GetTypeIdByDecl(m_className.c_str());
-		asITypeInfo* type	= m_scriptEngine->GetAsIScriptEngine()->GetTypeInfoById(type_id);
-		if (!type)
-			return false;
-
 		// Get functions in the script
-		m_startFunction			= type->GetMethodByDecl("void Start()"); // Get the Start function from the script
-		m_updateFunction		= type->GetMethodByDecl("void Update(float delta_time)"); // Get the Update function from the script
-		m_constructorFunction	= type->GetFactoryByDecl(m_constructorDeclaration.c_str()); // Get the constructor function from the script
-		if (!m_constructorFunction)
-		{
-			LOG_ERROR("Couldn't find the appropriate factory for the type '" + m_className + "'");
-			return false;
-		}
+		m_startFunction		= m_module->GetStartFunction();
+		m_updateFunction	= m_module->GetUpdateFunction();
 
 		asIScriptContext* context = m_scriptEngine->RequestContext(); // request a context
-		int r = context->Prepare(m_constructorFunction); // prepare the context to call the factory function
+		int r = context->Prepare(m_module->GetFactory()); // prepare the context to call the factory function
 		if (r < 0) return false;
 
 		r = context->SetArgObject(0, m_entity.lock().get()); // Pass the entity as the constructor's parameter
 		if (r < 0) return false;
 
 		r = context->Execute(); // execute the call
-		if (r < 0) return false;
+		if (r != asEXECUTION_FINISHED)
+		{
+			// The constructor threw (or was suspended), there is no object
+			m_scriptEngine->ReturnContext(context);
+			return false;
+		}
 
 		// get the object that was created
 		m_scriptObject = *static_cast<asIScriptObject**>(context->GetAddressOfReturnValue());
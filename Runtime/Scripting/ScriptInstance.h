@@ -33,6 +33,12 @@ namespace Spartan
 {
 	class Entity;
 
+	enum ScriptPriority
+	{
+		Priority_Normal,	// Updated every frame
+		Priority_Low		// Updated with what is left of the frame's script budget, receives the time accumulated since its last update
+	};
+
 	// Allows creation of a script instance and execution of it's class functions.
 	class ScriptInstance
 	{
@@ -45,22 +51,31 @@ namespace Spartan
 		const auto& GetScriptPath() { return m_scriptPath; }
 
 		void ExecuteStart();
-		void ExecuteUpdate(float delta_time);
+
+		// Update() is dispatched by Scripting, batched with every other instance of the same script
+		ScriptPriority GetPriority() const				{ return m_priority; }
+		void SetPriority(const ScriptPriority priority)	{ m_priority = priority; }
+
+		// Switches to a rebuilt module, properties that kept their name and type carry over
+		bool Reload(const std::shared_ptr<Module>& module);
 
 	private:
+		friend class Scripting;
 		bool CreateScriptObject();
 
 		std::string m_scriptPath;
-		std::string m_className;
-		std::string m_constructorDeclaration;
-		std::string m_moduleName;
 		std::weak_ptr<Entity> m_entity;
+		Entity* m_entityPtr							= nullptr; // owns this instance, through its script component
 		std::shared_ptr<Module> m_module;
 		asIScriptObject* m_scriptObject				= nullptr;
-		asIScriptFunction* m_constructorFunction	= nullptr;
 		asIScriptFunction* m_startFunction			= nullptr;
 		asIScriptFunction* m_updateFunction			= nullptr;
 		std::shared_ptr<Scripting> m_scriptEngine	= nullptr;
 		bool m_isInstantiated						= false;
+
+		// Update dispatch
+		ScriptPriority m_priority					= Priority_Normal;
+		float m_deltaPending						= 0.0f;	// low priority, time since the last update
+		uint32_t m_batchIndex						= 0;	// in the instances of its module
 	};
 }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <angelscript.h>
 #include "../Rendering/Material.h"
 #include "../Input/Input.h"
+#include "../Physics/Physics.h"
 #include "../World/Entity.h"
 #include "../World/Components/RigidBody.h"
 #include "../World/Components/Camera.h"
@@ -53,6 +54,7 @@ namespace Spartan
 		RegisterTransform();
 		RegisterMaterial();
 		RegisterRigidBody();
+		RegisterPhysics();
 		RegisterEntity();
 		RegisterLog();
 	}
@@ -129,6 +131,8 @@ namespace Spartan
 		m_scriptEngine->RegisterObjectType("Material", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("Camera", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("RigidBody", 0, asOBJ_REF | asOBJ_NOCOUNT);
+		m_scriptEngine->RegisterObjectType("Physics", 0, asOBJ_REF | asOBJ_NOCOUNT);
+		m_scriptEngine->RegisterObjectType("PhysicsHit", sizeof(Physics_Hit), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_C);
 		m_scriptEngine->RegisterObjectType("MathHelper", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("Vector2", sizeof(Vector2), asOBJ_VALUE | asOBJ_APP_CLASS | asOBJ_APP_CLASS_CONSTRUCTOR | asOBJ_APP_CLASS_COPY_CONSTRUCTOR | asOBJ_APP_CLASS_DESTRUCTOR);
 		m_scriptEngine->RegisterObjectType("Vector3", sizeof(Vector3), asOBJ_VALUE | asOBJ_APP_CLASS | asOBJ_APP_CLASS_CONSTRUCTOR | asOBJ_APP_CLASS_COPY_CONSTRUCTOR | asOBJ_APP_CLASS_DESTRUCTOR);
@@ -214,6 +218,36 @@ namespace Spartan
 		m_scriptEngine->RegisterObjectMethod("RigidBody", "void ApplyForceAtPosition(Vector3, Vector3, ForceMode)", asMETHOD(RigidBody, ApplyForceAtPosition), asCALL_THISCALL);
 		m_scriptEngine->RegisterObjectMethod("RigidBody", "void ApplyTorque(Vector3, ForceMode)", asMETHOD(RigidBody, ApplyTorque), asCALL_THISCALL);
 		m_scriptEngine->RegisterObjectMethod("RigidBody", "void SetRotation(Quaternion)", asMETHOD(RigidBody, SetRotation), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("RigidBody", "uint GetCollisionLayer()", asMETHOD(RigidBody, GetCollisionLayer), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("RigidBody", "void SetCollisionLayer(uint)", asMETHOD(RigidBody, SetCollisionLayer), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("RigidBody", "uint GetCollisionMask()", asMETHOD(RigidBody, GetCollisionMask), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("RigidBody", "void SetCollisionMask(uint)", asMETHOD(RigidBody, SetCollisionMask), asCALL_THISCALL);
+	}
+
+	/*------------------------------------------------------------------------------
+									[PHYSICS]
+	------------------------------------------------------------------------------*/
+	void ConstructorPhysicsHit(Physics_Hit* self)
+	{
+		new(self) Physics_Hit();
+	}
+
+	void ScriptInterface::RegisterPhysics()
+	{
+		auto r = 0;
+
+		r = m_scriptEngine->RegisterObjectBehaviour("PhysicsHit", asBEHAVE_CONSTRUCT, "void f()", asFUNCTION(ConstructorPhysicsHit), asCALL_CDECL_OBJLAST);	SPARTAN_ASSERT(r >= 0);
+		r = m_scriptEngine->RegisterObjectProperty("PhysicsHit", "bool hit", asOFFSET(Physics_Hit, hit));					SPARTAN_ASSERT(r >= 0);
+		r = m_scriptEngine->RegisterObjectProperty("PhysicsHit", "Entity@ entity", asOFFSET(Physics_Hit, entity));			SPARTAN_ASSERT(r >= 0);
+		r = m_scriptEngine->RegisterObjectProperty("PhysicsHit", "Vector3 position", asOFFSET(Physics_Hit, position));		SPARTAN_ASSERT(r >= 0);
+		r = m_scriptEngine->RegisterObjectProperty("PhysicsHit", "Vector3 normal", asOFFSET(Physics_Hit, normal));			SPARTAN_ASSERT(r >= 0);
+		r = m_scriptEngine->RegisterObjectProperty("PhysicsHit", "float fraction", asOFFSET(Physics_Hit, fraction));		SPARTAN_ASSERT(r >= 0);
+
+		// The hit is an out reference, which is the pointer the methods take
+		m_scriptEngine->RegisterGlobalProperty("Physics physics", m_context->GetSubsystem<Physics>().get());
+		m_scriptEngine->RegisterObjectMethod("Physics", "bool Raycast(const Vector3 &in, const Vector3 &in, PhysicsHit &out, uint layers = 0xFFFFFFFF)", asMETHOD(Physics, Raycast), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Physics", "bool SweepSphere(const Vector3 &in, const Vector3 &in, float, PhysicsHit &out, uint layers = 0xFFFFFFFF)", asMETHOD(Physics, SweepSphere), asCALL_THISCALL);
+		m_scriptEngine->RegisterObjectMethod("Physics", "bool SweepBox(const Vector3 &in, const Vector3 &in, const Vector3 &in, const Quaternion &in, PhysicsHit &out, uint layers = 0xFFFFFFFF)", asMETHOD(Physics, SweepBox), asCALL_THISCALL);
 	}
 
 	/*------------------------------------------------------------------------------
@@ -23,13 +23,102 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Scripting.h"
 #include <scriptstdstring/scriptstdstring.cpp>
 #include "ScriptInterface.h"
+#include "ScriptInstance.h"
+#include "Module.h"
 #include "../Logging/Log.h"
 #include "../FileSystem/FileSystem.h"
 #include "../Core/EventSystem.h"
 #include "../Core/Settings.h"
 #include "../Core/Context.h"
+#include "../World/Entity.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ProgressReport.h"
+#include "../Profiling/Profiler.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
 //===========================================
 
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace _Scripting
+{
+	// How often (seconds) script files are checked for changes
+	static const float module_watch_interval = 1.0f;
+
+	// FNV-1a, stable across runs and builds unlike std::hash
+	static const uint64_t hash_seed = 14695981039346656037ull;
+	uint64_t hash(const void* data, const size_t size, uint64_t seed = hash_seed)
+	{
+		const auto bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			seed ^= bytes[i];
+			seed *= 1099511628211ull;
+		}
+		return seed;
+	}
+
+	uint64_t hash(const string& value, const uint64_t seed)
+	{
+		return hash(value.data(), value.size(), seed);
+	}
+
+	uint64_t hash_interface(asIScriptEngine* engine)
+	{
+		auto result = hash(to_string(ANGELSCRIPT_VERSION) + asGetLibraryOptions(), hash_seed);
+
+		for (asUINT i = 0; i < engine->GetGlobalFunctionCount(); i++)
+		{
+			result = hash(engine->GetGlobalFunctionByIndex(i)->GetDeclaration(true, true), result);
+		}
+
+		for (asUINT i = 0; i < engine->GetGlobalPropertyCount(); i++)
+		{
+			const char* name	= nullptr;
+			auto type_id		= 0;
+			engine->GetGlobalPropertyByIndex(i, &name, nullptr, &type_id);
+			result = hash(string(name) + to_string(type_id), result);
+		}
+
+		for (asUINT i = 0; i < engine->GetObjectTypeCount(); i++)
+		{
+			const auto type = engine->GetObjectTypeByIndex(i);
+			result = hash(string(type->GetName()) + to_string(type->GetSize()), result);
+
+			for (asUINT j = 0; j < type->GetFactoryCount(); j++)
+			{
+				result = hash(type->GetFactoryByIndex(j)->GetDeclaration(), result);
+			}
+
+			for (asUINT j = 0; j < type->GetMethodCount(); j++)
+			{
+				result = hash(type->GetMethodByIndex(j)->GetDeclaration(), result);
+			}
+
+			for (asUINT j = 0; j < type->GetPropertyCount(); j++)
+			{
+				result = hash(type->GetPropertyDeclaration(j), result);
+			}
+		}
+
+		for (asUINT i = 0; i < engine->GetEnumCount(); i++)
+		{
+			const auto type = engine->GetEnumByIndex(i);
+			for (asUINT j = 0; j < type->GetEnumValueCount(); j++)
+			{
+				auto value = 0;
+				const string name = type->GetEnumValueByIndex(j, &value);
+				result = hash(string(type->GetName()) + name + to_string(value), result);
+			}
+		}
+
+		return result;
+	}
+}
+
 namespace Spartan
 {
 	Scripting::Scripting(Context* context) : ISubsystem(context)
@@ -70,6 +159,11 @@ namespace Spartan
 
         m_scriptEngine->SetEngineProperty(asEP_BUILD_WITHOUT_LINE_CUES, true);
 
+        // Fingerprint the registered interface, cached bytecode compiled against another one is rebuilt
+        m_interfaceHash = _Scripting::hash_interface(m_scriptEngine);
+
+        m_profiler = m_context->GetSubsystem<Profiler>().get();
+
         // Get version
         string major = to_string(ANGELSCRIPT_VERSION).erase(1, 4);
         string minor = to_string(ANGELSCRIPT_VERSION).erase(0, 1).erase(2, 2);
@@ -79,8 +173,47 @@ namespace Spartan
         return true;
     }
 
+    void Scripting::Tick(float delta_time)
+    {
+        // The world loads on another thread and instantiates scripts as it goes, leave the modules alone until it's done
+        if (ProgressReport::Get().GetIsLoading(g_progress_world))
+            return;
+
+        // Hot reload, rebuild the modules whose file changed
+        m_moduleWatchTimer += delta_time;
+        if (m_moduleWatchTimer < _Scripting::module_watch_interval)
+            return;
+        m_moduleWatchTimer = 0.0f;
+
+        lock_guard<recursive_mutex> lock(m_modulesMutex);
+
+        // Collected first, script constructors running during a reload can add modules
+        vector<string> changed;
+        for (const auto& it : m_modules)
+        {
+            const auto lastWriteTime = FileSystem::GetLastWriteTime(it.first);
+            if (lastWriteTime != 0 && lastWriteTime != it.second.lastWriteTime)
+            {
+                changed.emplace_back(it.first);
+            }
+        }
+
+        for (const auto& filePath : changed)
+        {
+            ReloadModule(filePath);
+        }
+    }
+
     void Scripting::Clear()
 	{
+		lock_guard<recursive_mutex> lock(m_modulesMutex);
+
+		// Instances keep the modules they use alive
+		m_modules.clear();
+		m_batches.clear();
+		m_updateStats.clear();
+		m_deferredBatch = 0;
+
 		for (auto& context : m_contexts)
 		{
 			context->Release();
@@ -156,9 +289,234 @@ namespace Spartan
 		return true;
 	}
 
+	void Scripting::ExecuteUpdates(const float delta_time)
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
+		lock_guard<recursive_mutex> lock(m_modulesMutex);
+
+		// Pointers to the entries stay valid when an update instantiates other scripts, iterators don't
+		m_batches.clear();
+		for (auto& it : m_modules)
+		{
+			auto& entry				= it.second;
+			entry.stats.updates		= 0;
+			entry.stats.deferred	= 0;
+			entry.stats.time_ms		= 0.0f;
+			if (entry.stats.name.empty())
+			{
+				entry.stats.name = FileSystem::GetFileNameNoExtensionFromFilePath(it.first);
+			}
+
+			// Scripts without an Update() opt out of dispatch altogether
+			if (entry.module && entry.module->GetUpdateFunction() && !entry.instances.empty())
+			{
+				m_batches.emplace_back(&entry);
+			}
+		}
+
+		const auto time_start = chrono::high_resolution_clock::now();
+		const auto elapsed_ms = [](const chrono::high_resolution_clock::time_point& since)
+		{
+			return chrono::duration<float, milli>(chrono::high_resolution_clock::now() - since).count();
+		};
+
+		// One context for everything, preparing it again for the same function is cheap
+		auto context = RequestContext();
+
+		// Normal priority, every frame
+		for (const auto& batch : m_batches)
+		{
+			const auto time_batch = chrono::high_resolution_clock::now();
+
+			// Indexed since updates can add or remove instances, an instance moved in from the end may miss this frame
+			for (uint32_t i = 0; i < batch->instances.size(); i++)
+			{
+				auto instance = batch->instances[i];
+				if (!instance->m_entityPtr->IsActive())
+					continue;
+
+				if (instance->m_priority == Priority_Low)
+				{
+					instance->m_deltaPending += delta_time;
+					batch->stats.deferred++;
+					continue;
+				}
+
+				ExecuteUpdate(context, instance, delta_time);
+				batch->stats.updates++;
+			}
+
+			batch->stats.time_ms += elapsed_ms(time_batch);
+		}
+
+		// Low priority, round robin over what is left of the budget. At least one goes per frame so that they can't starve.
+		auto updated_deferred	= 0;
+		auto out_of_budget		= false;
+		for (uint32_t i = 0; i < m_batches.size() && !out_of_budget; i++)
+		{
+			const auto index	= (m_deferredBatch + i) % static_cast<uint32_t>(m_batches.size());
+			auto batch			= m_batches[index];
+
+			for (uint32_t visited = 0; visited < batch->instances.size() && batch->stats.deferred != 0; visited++)
+			{
+				if (updated_deferred != 0 && elapsed_ms(time_start) >= m_updateBudget)
+				{
+					m_deferredBatch	= index;
+					out_of_budget	= true;
+					break;
+				}
+
+				if (batch->deferredCursor >= batch->instances.size())
+				{
+					batch->deferredCursor = 0;
+				}
+
+				auto instance = batch->instances[batch->deferredCursor++];
+				if (instance->m_priority != Priority_Low || instance->m_deltaPending == 0.0f || !instance->m_entityPtr->IsActive())
+					continue;
+
+				const auto time_update = chrono::high_resolution_clock::now();
+				ExecuteUpdate(context, instance, instance->m_deltaPending);
+				batch->stats.time_ms += elapsed_ms(time_update);
+
+				instance->m_deltaPending = 0.0f;
+				batch->stats.updates++;
+				batch->stats.deferred--;
+				updated_deferred++;
+			}
+		}
+
+		ReturnContext(context);
+
+		// Stats, every script class with instances
+		m_updateStats.clear();
+		for (const auto& it : m_modules)
+		{
+			if (!it.second.instances.empty())
+			{
+				m_updateStats.emplace_back(it.second.stats);
+				m_updateStats.back().instances = static_cast<uint32_t>(it.second.instances.size());
+			}
+		}
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
 	/*------------------------------------------------------------------------------
 										[MODULE]
 	------------------------------------------------------------------------------*/
+	shared_ptr<Module> Scripting::GetModule(const string& filePath)
+	{
+		lock_guard<recursive_mutex> lock(m_modulesMutex);
+
+		auto& entry = m_modules[filePath];
+		if (entry.module)
+			return entry.module;
+
+		// It failed to build and hasn't changed since
+		if (entry.lastWriteTime != 0 && entry.lastWriteTime == FileSystem::GetLastWriteTime(filePath))
+			return nullptr;
+
+		// Names are unique per build, a reloaded module is built while the old one is still in use
+		auto module = make_shared<Module>(filePath + "#" + to_string(m_moduleGeneration++), m_context->GetSubsystem<Scripting>());
+		const auto result = module->LoadScript(filePath);
+		entry.lastWriteTime = module->GetLastWriteTime();
+		if (!result)
+			return nullptr;
+
+		entry.module = module;
+		return module;
+	}
+
+	bool Scripting::ReloadModule(const string& filePath)
+	{
+		lock_guard<recursive_mutex> lock(m_modulesMutex);
+
+		auto it = m_modules.find(filePath);
+		if (it == m_modules.end())
+			return false;
+		auto& entry = it->second;
+
+		auto module = make_shared<Module>(filePath + "#" + to_string(m_moduleGeneration++), m_context->GetSubsystem<Scripting>());
+		const auto result = module->LoadScript(filePath);
+		entry.lastWriteTime = module->GetLastWriteTime();
+		if (!result)
+		{
+			// Instances keep running the previous build
+			LOGF_WARNING("Failed to reload \"%s\"", FileSystem::GetFileNameFromFilePath(filePath).c_str());
+			return false;
+		}
+
+		// Move every instance over, the previous build is discarded once the last one lets go of it.
+		// They are copied since script constructors can create instances of their own.
+		entry.module = module;
+		const vector<ScriptInstance*> instances(entry.instances.begin(), entry.instances.end());
+		for (const auto& instance : instances)
+		{
+			instance->Reload(module);
+		}
+
+		LOGF_INFO("Reloaded \"%s\", %d instances", FileSystem::GetFileNameFromFilePath(filePath).c_str(), static_cast<int>(instances.size()));
+
+		return true;
+	}
+
+	uint64_t Scripting::GetBytecodeHash(const string& filePath) const
+	{
+		auto result = m_interfaceHash;
+
+		// The script and everything it includes
+		auto filePaths = FileSystem::GetIncludedFiles(filePath);
+		filePaths.insert(filePaths.begin(), filePath);
+		for (const auto& path : filePaths)
+		{
+			ifstream in(path, ios::binary);
+			stringstream buffer;
+			buffer << in.rdbuf();
+			result = _Scripting::hash(path, result);
+			result = _Scripting::hash(buffer.str(), result);
+		}
+
+		return result;
+	}
+
+	string Scripting::GetBytecodePath(const string& filePath) const
+	{
+		const auto directory = m_context->GetSubsystem<ResourceCache>()->GetProjectDirectory() + "cache//";
+		if (!FileSystem::DirectoryExists(directory))
+		{
+			FileSystem::CreateDirectory_(directory);
+		}
+
+		// Named after the script, and its path so that scripts with the same name don't share a file
+		return directory + FileSystem::GetFileNameNoExtensionFromFilePath(filePath) + "_" + to_string(_Scripting::hash(filePath, _Scripting::hash_seed)) + ".bytecode";
+	}
+
+	void Scripting::Instance_Add(ScriptInstance* instance)
+	{
+		lock_guard<recursive_mutex> lock(m_modulesMutex);
+		auto& instances			= m_modules[instance->GetScriptPath()].instances;
+		instance->m_batchIndex	= static_cast<uint32_t>(instances.size());
+		instances.emplace_back(instance);
+	}
+
+	void Scripting::Instance_Remove(ScriptInstance* instance)
+	{
+		lock_guard<recursive_mutex> lock(m_modulesMutex);
+		const auto it = m_modules.find(instance->GetScriptPath());
+		if (it == m_modules.end())
+			return;
+
+		// Swap with the last one, order doesn't matter
+		auto& instances = it->second.instances;
+		if (instance->m_batchIndex >= instances.size() || instances[instance->m_batchIndex] != instance)
+			return;
+
+		instances[instance->m_batchIndex]				= instances.back();
+		instances[instance->m_batchIndex]->m_batchIndex	= instance->m_batchIndex;
+		instances.pop_back();
+	}
+
 	void Scripting::DiscardModule(string moduleName)
 	{
 		m_scriptEngine->DiscardModule(moduleName.c_str());
@@ -167,6 +525,24 @@ namespace Spartan
 	/*------------------------------------------------------------------------------
 									[PRIVATE]
 	------------------------------------------------------------------------------*/
+	bool Scripting::ExecuteUpdate(asIScriptContext* ctx, ScriptInstance* instance, const float delta_time)
+	{
+		// An instance which is still on a previous build (its reload failed) has its own function
+		if (!instance->m_updateFunction || ctx->Prepare(instance->m_updateFunction) < 0)
+			return false;
+
+		ctx->SetObject(instance->m_scriptObject);
+		ctx->SetArgFloat(0, delta_time);
+
+		if (ctx->Execute() == asEXECUTION_EXCEPTION)
+		{
+			LogExceptionInfo(ctx);
+			return false;
+		}
+
+		return true;
+	}
+
 	// This is used for script exception messages
 	void Scripting::LogExceptionInfo(asIScriptContext* ctx)
 	{
@@ -24,6 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==================
 #include <vector>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "../Core/ISubsystem.h"
 //=============================
 
@@ -41,6 +44,18 @@ struct asSMessageInfo;
 namespace Spartan
 {
 	class Module;
+	class ScriptInstance;
+	class Profiler;
+
+	// Update() dispatch of a script class, over the last frame
+	struct Script_Update_Stats
+	{
+		std::string name;
+		uint32_t instances	= 0;
+		uint32_t updates	= 0;
+		uint32_t deferred	= 0; // low priority instances still waiting for their turn
+		float time_ms		= 0.0f;
+	};
 
 	class Scripting : public ISubsystem
 	{
@@ -50,6 +65,7 @@ namespace Spartan
 
         //= Subsystem =============
         bool Initialize() override;
+        void Tick(float delta_time) override;
         //=========================
 
 		void Clear();
@@ -62,13 +78,53 @@ namespace Spartan
 		// Calls
 		bool ExecuteCall(asIScriptFunction* scriptFunc, asIScriptObject* obj, float delta_time = -1.0f);
 
-		// Modules
+		// Updates, every instance of a script class is updated in one batch, through one context. Scripts without an Update()
+		// are skipped. Low priority instances share whatever is left of the budget (ms) once the rest has been updated.
+		void ExecuteUpdates(float delta_time);
+		auto GetUpdateBudget() const					{ return m_updateBudget; }
+		void SetUpdateBudget(const float budget_ms)		{ m_updateBudget = budget_ms; }
+		const auto& GetUpdateStats() const				{ return m_updateStats; }
+
+		// Modules, compiled once per script file and shared by all of its instances
+		std::shared_ptr<Module> GetModule(const std::string& filePath);
+		bool ReloadModule(const std::string& filePath);
 		void DiscardModule(std::string moduleName);
+		uint32_t GetModuleCount() const { std::lock_guard<std::recursive_mutex> lock(m_modulesMutex); return static_cast<uint32_t>(m_modules.size()); }
+
+		// Bytecode cache, a cached build is valid as long as its hash matches
+		uint64_t GetBytecodeHash(const std::string& filePath) const;
+		std::string GetBytecodePath(const std::string& filePath) const;
+
+		// Instances, tracked so that a reloaded module can migrate them
+		void Instance_Add(ScriptInstance* instance);
+		void Instance_Remove(ScriptInstance* instance);
 
 	private:
+		struct _module
+		{
+			std::shared_ptr<Module> module;
+			std::vector<ScriptInstance*> instances;	// ScriptInstance::m_batchIndex is the position in here
+			uint64_t lastWriteTime	= 0;			// of the last build attempt, failed ones included
+			uint32_t deferredCursor	= 0;			// where the low priority updates resume
+			Script_Update_Stats stats;
+		};
+		std::unordered_map<std::string, _module> m_modules;
+		mutable std::recursive_mutex m_modulesMutex; // the world loads on another thread and instantiates scripts as it goes, scripts can instantiate scripts
+		uint32_t m_moduleGeneration	= 0;
+		float m_moduleWatchTimer	= 0.0f;
+		uint64_t m_interfaceHash	= 0; // what the engine exposes to scripts, bytecode is only valid against it
+
+		// Update dispatch
+		std::vector<_module*> m_batches;
+		std::vector<Script_Update_Stats> m_updateStats;
+		uint32_t m_deferredBatch	= 0; // where the low priority updates resume
+		float m_updateBudget		= 2.0f;
+		Profiler* m_profiler		= nullptr;
+
         asIScriptEngine* m_scriptEngine = nullptr;
 		std::vector<asIScriptContext*> m_contexts;
 
+		bool ExecuteUpdate(asIScriptContext* ctx, ScriptInstance* instance, float delta_time);
 		void LogExceptionInfo(asIScriptContext* ctx);
 		void message_callback(const asSMessageInfo& msg);
 	};
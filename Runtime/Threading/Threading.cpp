@@ -30,6 +30,37 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace _Threading
+    {
+        // The chunks of a loop, taken one at a time by whichever thread gets to them first
+        struct loop
+        {
+            atomic<uint32_t> next   = 0;
+            atomic<uint32_t> done   = 0;
+            uint32_t range          = 0;
+            uint32_t count          = 0;
+            const function<void(uint32_t, uint32_t)>* function = nullptr; // Only called while a chunk is left, the caller is still waiting then
+            mutex mutex_done;
+            condition_variable condition_done;
+
+            void run()
+            {
+                for (auto chunk = next++; chunk < count; chunk = next++)
+                {
+                    const auto start    = static_cast<uint32_t>(static_cast<uint64_t>(range) * chunk / count);
+                    const auto end      = static_cast<uint32_t>(static_cast<uint64_t>(range) * (chunk + 1) / count);
+                    (*function)(start, end);
+
+                    if (++done == count)
+                    {
+                        lock_guard<mutex> lock(mutex_done);
+                        condition_done.notify_one();
+                    }
+                }
+            }
+        };
+    }
+
 	Threading::Threading(Context* context) : ISubsystem(context)
 	{
 		m_stopping	    = false;
@@ -93,18 +124,37 @@ namespace Spartan
 			lock.unlock();
 
 			// Execute the task.
+            m_threads_busy++;
 			task->Execute();
+            m_threads_busy--;
 		}
 	}
 
-    uint32_t Threading::GetThreadsAvailable()
+    void Threading::LoopChunks(const function<void(uint32_t, uint32_t)>& function, const uint32_t range, const uint32_t chunk_count, const uint32_t task_count)
     {
-        uint32_t available_threads = 0;
-        for (const auto& task : m_tasks)
+        // Tasks which start once every chunk has been taken (the pool may be busy with other work) return right away,
+        // so the calling thread only waits for chunks which are running. The loop outlives it for such late tasks.
+        auto loop       = make_shared<_Threading::loop>();
+        loop->range     = range;
+        loop->count     = chunk_count;
+        loop->function  = &function;
+
+        for (uint32_t i = 0; i < task_count; i++)
         {
-            available_threads += task->IsExecuting() ? 1 : 0;
+            AddTask([loop]() { loop->run(); });
         }
 
-        return m_thread_count - available_threads;
+        // The calling thread takes chunks too, but never any other queued task, those may wait on it (e.g. a world load waiting on the main thread)
+        loop->run();
+
+        unique_lock<mutex> lock(loop->mutex_done);
+        loop->condition_done.wait(lock, [&loop] { return loop->done == loop->count; });
+    }
+
+    uint32_t Threading::GetThreadsAvailable()
+    {
+        // Tasks are removed from the queue before they execute, so count the threads that are busy instead
+        const uint32_t threads_busy = m_threads_busy;
+        return threads_busy < m_thread_count ? m_thread_count - threads_busy : 0;
     }
 }
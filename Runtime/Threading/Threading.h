@@ -27,6 +27,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <mutex>
 #include <deque>
 #include <functional>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <algorithm>
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
 //=============================
@@ -80,37 +84,14 @@ namespace Spartan
 			m_condition_var.notify_one();
 		}
 
+        // Splits [0, range) into a chunk per available thread (thread_count_max at most, the calling thread included) and waits for them
         template <typename Function>
-        void Loop(Function&& function, uint32_t range)
+        void Loop(Function&& function, uint32_t range, uint32_t thread_count_max = std::numeric_limits<uint32_t>::max())
         {
-            uint32_t available_threads  = GetThreadsAvailable();
-            vector<bool> tasks_done     = vector<bool>(available_threads, false);
-            uint32_t task_count         = available_threads + 1; // plus one for the current thread
-
-            uint32_t start  = 0;
-            uint32_t end    = 0;
-            for (uint32_t i = 0; i < available_threads; i++)
-            {
-                start   = (range / task_count) * i;
-                end     = start + (range / task_count);
-
-                // Kick off task
-                AddTask([&function, &tasks_done, i, start, end] { function(start, end); tasks_done[i] = true; });
-            }
-
-            // Do last task in the current thread
-            function(end, range);
-
-            // Wait till the threads are done
-            uint32_t tasks = 0;
-            while (tasks != tasks_done.size())
-            {
-                tasks = 0;
-                for (const bool job_done : tasks_done)
-                {
-                    tasks += job_done ? 1 : 0;
-                }
-            }
+            uint32_t available_threads  = std::min(GetThreadsAvailable(), std::max(thread_count_max, 1u) - 1);
+            uint32_t chunk_count        = available_threads + 1; // plus one for the current thread
+
+            LoopChunks([&function](uint32_t start, uint32_t end) { function(start, end); }, range, chunk_count, available_threads);
         }
 
         uint32_t GetThreadCount()       { return m_thread_count; }
@@ -118,12 +99,16 @@ namespace Spartan
         uint32_t GetThreadsAvailable();
 
 	private:
+        // Runs the chunks of a loop on the calling thread and task_count tasks, only ever the chunks of this loop
+        void LoopChunks(const std::function<void(uint32_t, uint32_t)>& function, uint32_t range, uint32_t chunk_count, uint32_t task_count);
+
 		uint32_t m_thread_count = 0;
         uint32_t m_thread_max   = 0;
 		std::vector<std::thread> m_threads;
 		std::deque<std::shared_ptr<Task>> m_tasks;
 		std::mutex m_mutex_tasks;
 		std::condition_variable m_condition_var;
+        std::atomic<uint32_t> m_threads_busy = 0;
 		bool m_stopping;
 	};
 }
@@ -0,0 +1,144 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =====================
+#include "Animator.h"
+#include "Transform.h"
+#include "Renderable.h"
+#include "../Entity.h"
+#include "../../Core/Engine.h"
+#include "../../Core/Context.h"
+#include "../../IO/FileStream.h"
+#include "../../Rendering/Model.h"
+//================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+	Animator::Animator(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id)
+	{
+		REGISTER_ATTRIBUTE_GET_SET(GetAnimation, SetAnimation, uint32_t);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_loop, bool);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_speed, float);
+	}
+
+	Animator::~Animator() = default;
+
+	void Animator::OnStart()
+	{
+		m_time			= 0.0;
+		m_pose_stale	= true;
+	}
+
+	void Animator::OnStop()
+	{
+		m_time			= 0.0;
+		m_pose_stale	= true;
+	}
+
+	void Animator::OnTick(const float delta_time)
+	{
+		const auto playing = m_context->m_engine->EngineMode_IsSet(Engine_Game);
+		if (!playing && !m_pose_stale)
+			return;
+
+		// The skinned meshes are the renderables of the entity, or below it, which reference a model with a skeleton
+		vector<Transform*> descendants = { GetTransform() };
+		GetTransform()->GetDescendants(&descendants);
+
+		shared_ptr<Model> model;
+		for (const auto transform : descendants)
+		{
+			const auto renderable = transform->GetEntity_PtrRaw()->GetRenderable_PtrRaw();
+			if (renderable && renderable->GeometryModel() && renderable->GeometryModel()->GetSkeleton())
+			{
+				model = renderable->GeometryModel();
+				break;
+			}
+		}
+
+		if (!model || m_animation >= model->GetAnimationClips().size())
+			return;
+
+		// Sample, clips have a track per bone of the skeleton they were compressed for
+		const auto& skeleton	= *model->GetSkeleton();
+		const auto& clip		= model->GetAnimationClips()[m_animation];
+		if (clip->GetTrackCount() != skeleton.GetBoneCount())
+			return;
+
+		if (clip != m_sampled)
+		{
+			m_cursor	= AnimationClip_Cursor();
+			m_sampled	= clip;
+		}
+		m_time += playing ? static_cast<double>(delta_time) * m_speed : 0.0;
+		skeleton.GetBindPose(&m_pose);
+		clip->Sample(m_time, m_loop, &m_pose, &m_cursor);
+		skeleton.ComputeModelSpace(m_pose, &m_model_space);
+		skeleton.ComputeSkinningMatrices(m_model_space, &m_skinning);
+
+		// Skin, the skeleton is relative to this entity while the vertices are relative to the entity of their mesh
+		for (const auto transform : descendants)
+		{
+			const auto renderable = transform->GetEntity_PtrRaw()->GetRenderable_PtrRaw();
+			if (!renderable || renderable->GeometryModel() != model)
+				continue;
+
+			const auto to_mesh = GetTransform()->GetMatrix() * transform->GetMatrix().Inverted();
+			m_skinning_mesh.resize(m_skinning.size());
+			for (size_t i = 0; i < m_skinning.size(); i++)
+			{
+				m_skinning_mesh[i] = m_skinning[i] * to_mesh;
+			}
+			model->SubmeshSkin(renderable->GeometrySubmesh(), m_skinning_mesh);
+		}
+
+		m_pose_stale = false;
+	}
+
+	void Animator::Serialize(FileStream* stream)
+	{
+		stream->Write(m_animation);
+		stream->Write(m_loop);
+		stream->Write(m_speed);
+	}
+
+	void Animator::Deserialize(FileStream* stream)
+	{
+		stream->Read(&m_animation);
+		stream->Read(&m_loop);
+		stream->Read(&m_speed);
+	}
+
+	void Animator::SetAnimation(const uint32_t index)
+	{
+		if (m_animation == index)
+			return;
+
+		m_animation		= index;
+		m_time			= 0.0;
+		m_pose_stale	= true;
+	}
+}
@@ -0,0 +1,77 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =============================
+#include <vector>
+#include <memory>
+#include "IComponent.h"
+#include "../../Math/Matrix.h"
+#include "../../Rendering/AnimationClip.h"
+//========================================
+
+namespace Spartan
+{
+	class Model;
+
+	// Plays an animation of the model whose root the entity is. While the simulation runs, the skeleton is sampled every
+	// frame and the skinned meshes below the entity are skinned on the CPU and written to the vertex buffers of their submeshes.
+	class SPARTAN_CLASS Animator : public IComponent
+	{
+	public:
+		Animator(Context* context, Entity* entity, uint32_t id = 0);
+		~Animator();
+
+		//= ICOMPONENT ===============================
+		void OnStart() override;
+		void OnStop() override;
+		void OnTick(float delta_time) override;
+		void Serialize(FileStream* stream) override;
+		void Deserialize(FileStream* stream) override;
+		//============================================
+
+		// Index into the animation clips of the model
+		auto GetAnimation() const			{ return m_animation; }
+		void SetAnimation(uint32_t index);
+
+		auto GetLoop() const				{ return m_loop; }
+		void SetLoop(const bool loop)		{ m_loop = loop; }
+
+		auto GetSpeed() const				{ return m_speed; }
+		void SetSpeed(const float speed)	{ m_speed = speed; }
+
+	private:
+		uint32_t m_animation	= 0;
+		bool m_loop				= true;
+		float m_speed			= 1.0f;
+		double m_time			= 0.0;
+		bool m_pose_stale		= true; // The vertex buffers don't show the pose at m_time
+
+		// Sampling
+		std::shared_ptr<AnimationClip> m_sampled;
+		AnimationClip_Cursor m_cursor;
+		std::vector<Bone_Transform> m_pose;
+		std::vector<Math::Matrix> m_model_space;
+		std::vector<Math::Matrix> m_skinning;
+		std::vector<Math::Matrix> m_skinning_mesh;
+	};
+}
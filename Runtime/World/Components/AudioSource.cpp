@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ============================
 #include "AudioSource.h"
 #include "../../Audio/AudioClip.h"
+#include "../../Audio/Audio.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 //=======================================
@@ -31,10 +32,25 @@ using namespace std;
 using namespace Spartan::Math;
 //============================
 
+namespace _AudioSource
+{
+	// Every source plays its own instance of a cached clip, so that each gets its own channel, in-memory
+	// clips still decode only once since instances share their samples through the audio bank
+	shared_ptr<Spartan::AudioClip> instance(Spartan::Context* context, const shared_ptr<Spartan::AudioClip>& clip)
+	{
+		if (!clip)
+			return nullptr;
+
+		auto instance = make_shared<Spartan::AudioClip>(context);
+		return instance->LoadFromFile(clip->GetResourceFilePathNative()) ? instance : nullptr;
+	}
+}
+
 namespace Spartan
 {
 	AudioSource::AudioSource(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id)
 	{
+		m_audio				= context->GetSubsystem<Audio>().get();
 		m_mute				= false;
 		m_play_on_start		= true;
 		m_loop				= false;
@@ -69,18 +85,7 @@ namespace Spartan
 	
 	void AudioSource::OnRemove()
 	{
-		if (!m_audio_clip)
-			return;
-	
-		m_audio_clip->Stop();
-	}
-	
-	void AudioSource::OnTick(float delta_time)
-	{
-		if (!m_audio_clip)
-			return;
-	
-		m_audio_clip->Update();
+		Stop();
 	}
 	
 	void AudioSource::Serialize(FileStream* stream)
@@ -113,18 +118,22 @@ namespace Spartan
 
         if (stream->ReadAs<bool>())
         {
-            m_audio_clip = m_context->GetSubsystem<ResourceCache>()->GetByName<AudioClip>(stream->ReadAs<string>());
+            m_audio_clip = _AudioSource::instance(m_context, m_context->GetSubsystem<ResourceCache>()->GetByName<AudioClip>(stream->ReadAs<string>()));
         }
 	}
 
     void AudioSource::SetAudioClip(const string& file_path)
     {
+        // The voice belongs to the previous clip
+        Stop();
+
         // Create and load the audio clip
         auto audio_clip = make_shared<AudioClip>(m_context);
         if (audio_clip->LoadFromFile(file_path))
         {
             // In order for the component to guarantee serialization/deserialization, we cache the audio clip
-            m_audio_clip = m_context->GetSubsystem<ResourceCache>()->Cache(audio_clip);
+            const auto cached = m_context->GetSubsystem<ResourceCache>()->Cache(audio_clip);
+            m_audio_clip = cached == audio_clip ? audio_clip : _AudioSource::instance(m_context, cached);
         }
     }
 
@@ -138,12 +147,8 @@ namespace Spartan
 		if (!m_audio_clip)
 			return false;
 	
-		m_audio_clip->Play();
-		m_audio_clip->SetMute(m_mute);
-		m_audio_clip->SetVolume(m_volume);
-		m_audio_clip->SetLoop(m_loop);
-		m_audio_clip->SetPriority(m_priority);
-		m_audio_clip->SetPan(m_pan);
+		// Audio will give it a channel if it's audible and important enough
+		m_audio->Voice_Play(this);
 	
 		return true;
 	}
@@ -153,7 +158,9 @@ namespace Spartan
 		if (!m_audio_clip)
 			return false;
 	
-		return m_audio_clip->Stop();
+		m_audio->Voice_Stop(this);
+
+		return true;
 	}
 	
 	void AudioSource::SetMute(bool mute)
@@ -203,4 +210,27 @@ namespace Spartan
 		m_pan = Clamp(pan, -1.0f, 1.0f);
 		m_audio_clip->SetPan(m_pan);
 	}
+
+	bool AudioSource::Channel_Start(const float position)
+	{
+		// Start paused so that nothing is heard before the properties and the 3D attributes are set
+		m_audio_clip->SetLoop(m_loop);
+		if (!m_audio_clip->Play(true))
+			return false;
+
+		m_audio_clip->SetPosition(position);
+		m_audio_clip->SetMute(m_mute);
+		m_audio_clip->SetVolume(m_volume);
+		m_audio_clip->SetPriority(m_priority);
+		m_audio_clip->SetPitch(m_pitch);
+		m_audio_clip->SetPan(m_pan);
+		m_audio_clip->Update();
+
+		return m_audio_clip->SetPaused(false);
+	}
+
+	void AudioSource::Channel_Stop()
+	{
+		m_audio_clip->Stop();
+	}
 }
@@ -30,6 +30,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {
 	class AudioClip;
+	class Audio;
 
 	class SPARTAN_CLASS AudioSource : public IComponent
 	{
@@ -42,13 +43,13 @@ namespace Spartan
 		void OnStart() override;
 		void OnStop() override;
 		void OnRemove() override;
-		void OnTick(float delta_time) override;
 		void Serialize(FileStream* stream) override;
 		void Deserialize(FileStream* stream) override;
 		//============================================
 
 		//= PROPERTIES ===================================================================
         void SetAudioClip(const std::string& file_path);
+		const auto& GetAudioClip() const { return m_audio_clip; }
 		std::string GetAudioClipName();
 
 		bool Play();
@@ -77,6 +78,12 @@ namespace Spartan
 		//================================================================================
 
 	private:
+		// Audio decides when a playing source gets a channel
+		friend class Audio;
+		bool Channel_Start(float position);
+		void Channel_Stop();
+
+		Audio* m_audio;
 		std::shared_ptr<AudioClip> m_audio_clip;
 		bool m_mute;
 		bool m_play_on_start;
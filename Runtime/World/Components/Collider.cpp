@@ -19,7 +19,8 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ==================================================
+//= INCLUDES ============================================================
+#include <algorithm>
 #include "Collider.h"
 #include "Transform.h"
 #include "RigidBody.h"
@@ -27,6 +28,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Entity.h"
 #include "../../IO/FileStream.h"
 #include "../../Physics/BulletPhysicsHelper.h"
+#include "../../Physics/PhysicsTriangleMesh.h"
+#include "../../Rendering/Model.h"
+#include "../../Rendering/Mesh.h"
+#include "../../Resource/Import/MeshDecomposer.h"
 #include "../../Logging/Log.h"
 #pragma warning(push, 0) // Hide warnings which belong to Bullet
 #include <BulletCollision/CollisionShapes/btSphereShape.h>
@@ -35,8 +40,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <BulletCollision/CollisionShapes/btStaticPlaneShape.h>
 #include <BulletCollision/CollisionShapes/btConeShape.h>
 #include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btCompoundShape.h>
 #pragma warning(pop)
-//=============================================================
+//=======================================================================
 
 //= NAMESPACES ================
 using namespace Spartan::Math;
@@ -45,6 +54,17 @@ using namespace std;
 
 namespace Spartan
 {
+	namespace _Collider
+	{
+		// The collision data which was cooked for the renderable's geometry on import, if any
+		const Mesh_Collision& collision(const Renderable* renderable)
+		{
+			static const Mesh_Collision empty;
+			const auto& model = renderable->GeometryModel();
+			return model ? model->GetGeometryCollision(renderable->GeometryIndexOffset()) : empty;
+		}
+	}
+
 	Collider::Collider(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id)
 	{
 		m_shapeType = ColliderShape_Box;
@@ -137,6 +157,23 @@ namespace Spartan
 		Shape_Update();
 	}
 
+	void Collider::SetHeightfield(vector<float>&& heights, const uint32_t width, const uint32_t length)
+	{
+		if (width < 2 || length < 2 || heights.size() != static_cast<size_t>(width) * length)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// The shape points to the heights, so they are only replaced once it's gone
+		Shape_Release();
+		m_heightfield			= move(heights);
+		m_heightfield_width		= width;
+		m_heightfield_length	= length;
+		m_shapeType				= ColliderShape_Heightfield;
+		Shape_Update();
+	}
+
 	void Collider::Shape_Update()
 	{
 		Shape_Release();
@@ -174,6 +211,7 @@ namespace Spartan
 			break;
 
 		case ColliderShape_Mesh:
+		{
 			// Get Renderable
 			Renderable* renderable = GetEntity_PtrRaw()->GetComponent<Renderable>().get();
 			if (!renderable)
@@ -219,6 +257,122 @@ namespace Spartan
 			break;
 		}
 
+		case ColliderShape_Heightfield:
+		{
+			// Set by the owner of the heights, once they are known (e.g. when a terrain chunk streams in)
+			if (m_heightfield.empty())
+				return;
+
+			const auto range = minmax_element(m_heightfield.begin(), m_heightfield.end());
+			const auto shape = new btHeightfieldTerrainShape(
+				static_cast<int>(m_heightfield_width),
+				static_cast<int>(m_heightfield_length),
+				m_heightfield.data(),
+				1.0f,			// height scale, unused for float data
+				*range.first,
+				*range.second,
+				1,				// up axis
+				PHY_FLOAT,
+				true			// flip quad edges, to split quads the way the terrain does
+			);
+			shape->setLocalScaling(ToBtVector3(worldScale));
+			m_shape = shape;
+			break;
+		}
+
+		case ColliderShape_TriangleMesh:
+		{
+			Renderable* renderable = GetEntity_PtrRaw()->GetComponent<Renderable>().get();
+			if (!renderable)
+			{
+				LOG_WARNING("Can't construct triangle mesh shape, there is no Renderable component attached");
+				return;
+			}
+
+			vector<uint32_t> indices;
+			vector<RHI_Vertex_PosTexNorTan> vertices;
+			renderable->GeometryGet(&indices, &vertices);
+			if (indices.empty() || vertices.empty() || *max_element(indices.begin(), indices.end()) >= vertices.size())
+			{
+				LOG_WARNING("Can't construct triangle mesh shape, the geometry isn't loaded or isn't valid");
+				return;
+			}
+
+			// Bullet collides triangle meshes with static bodies only, moving ones would need a convex decomposition
+			if (const auto& rigid_body = m_entity->GetComponent<RigidBody>())
+			{
+				if (rigid_body->GetMass() > 0.0f)
+				{
+					LOG_WARNING("Triangle mesh shapes are meant for bodies without mass, use a convex decomposition for dynamic ones");
+				}
+			}
+
+			vector<Vector3> positions(vertices.size());
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				positions[i] = Vector3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+			}
+
+			// Scaling the wrapper instead of the mesh keeps the hierarchy, which would have to be rebuilt otherwise
+			m_triangle_mesh	= make_unique<PhysicsTriangleMesh>(move(indices), move(positions), _Collider::collision(renderable).bvh);
+			m_shape			= new btScaledBvhTriangleMeshShape(m_triangle_mesh->GetShape(), ToBtVector3(worldScale));
+			break;
+		}
+
+		case ColliderShape_ConvexDecomposition:
+		{
+			Renderable* renderable = GetEntity_PtrRaw()->GetComponent<Renderable>().get();
+			if (!renderable)
+			{
+				LOG_WARNING("Can't construct convex decomposition shape, there is no Renderable component attached");
+				return;
+			}
+
+			// Decomposing is slow, so it's done on import and only falls back to doing it here for geometry which wasn't
+			auto hulls = &_Collider::collision(renderable).hulls;
+			vector<vector<Vector3>> decomposition;
+			if (hulls->empty())
+			{
+				if (renderable->GeometryVertexCount() >= m_vertexLimit)
+				{
+					LOGF_WARNING("Can't decompose \"%s\", it has more than %d vertices", renderable->GeometryName().c_str(), static_cast<int>(m_vertexLimit));
+					return;
+				}
+
+				LOGF_WARNING("\"%s\" wasn't decomposed on import, decomposing it now", renderable->GeometryName().c_str());
+				vector<uint32_t> indices;
+				vector<RHI_Vertex_PosTexNorTan> vertices;
+				renderable->GeometryGet(&indices, &vertices);
+				MeshDecomposer::Decompose(indices, vertices, &decomposition);
+				hulls = &decomposition;
+			}
+
+			if (hulls->empty())
+			{
+				LOG_WARNING("Can't construct convex decomposition shape, there are no hulls");
+				return;
+			}
+
+			const auto compound = new btCompoundShape(true, static_cast<int>(hulls->size()));
+			for (const auto& hull : *hulls)
+			{
+				compound->addChildShape(btTransform::getIdentity(), new btConvexHullShape(&hull[0].x, static_cast<int>(hull.size()), static_cast<int>(sizeof(Vector3))));
+			}
+
+			// Scaling has to be done before (potential) optimization
+			compound->setLocalScaling(ToBtVector3(worldScale));
+			if (m_optimize)
+			{
+				for (auto i = 0; i < compound->getNumChildShapes(); i++)
+				{
+					static_cast<btConvexHullShape*>(compound->getChildShape(i))->initializePolyhedralFeatures();
+				}
+			}
+			m_shape = compound;
+			break;
+		}
+		}
+
 		m_shape->setUserPointer(this);
 
 		RigidBody_SetShape(m_shape);
@@ -228,7 +382,21 @@ namespace Spartan
 	void Collider::Shape_Release()
 	{
 		RigidBody_SetShape(nullptr);
+
+		// A compound shape doesn't own its children
+		if (m_shape && m_shape->isCompound())
+		{
+			const auto compound = static_cast<btCompoundShape*>(m_shape);
+			for (auto i = compound->getNumChildShapes() - 1; i >= 0; i--)
+			{
+				const auto child = compound->getChildShape(i);
+				compound->removeChildShapeByIndex(i);
+				delete child;
+			}
+		}
+
 		safe_delete(m_shape);
+		m_triangle_mesh.reset(); // After the shape which wraps it
 	}
 
 	void Collider::RigidBody_SetShape(btCollisionShape* shape)
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==================
 #include "IComponent.h"
 #include <memory>
+#include <vector>
 #include "../../Math/Vector3.h"
 //=============================
 
@@ -32,6 +33,7 @@ class btCollisionShape;
 namespace Spartan
 {
 	class Mesh;
+	class PhysicsTriangleMesh;
 
 	enum ColliderShape
 	{
@@ -42,6 +44,9 @@ namespace Spartan
 		ColliderShape_Capsule,
 		ColliderShape_Cone,
 		ColliderShape_Mesh,
+		ColliderShape_Heightfield,
+		ColliderShape_TriangleMesh,			// Static geometry only, the exact triangles
+		ColliderShape_ConvexDecomposition,	// Convex hulls which approximate concave geometry, for dynamic bodies
 	};
 
 	class SPARTAN_CLASS Collider : public IComponent
@@ -75,6 +80,10 @@ namespace Spartan
 		bool GetOptimize() { return m_optimize; }
 		void SetOptimize(bool optimize);
 
+		// Heights of a width x length grid with a spacing of one, row by row (along x first). The grid is centered on the collider's
+		// center, vertically halfway between its lowest and highest height. It isn't serialized, whoever sets it keeps it up to date.
+		void SetHeightfield(std::vector<float>&& heights, uint32_t width, uint32_t length);
+
 	private:
 		void Shape_Update();
 		void Shape_Release();
@@ -87,5 +96,9 @@ namespace Spartan
 		Math::Vector3 m_center;
 		uint32_t m_vertexLimit = 100000;
 		bool m_optimize = true;
+		std::vector<float> m_heightfield;
+		uint32_t m_heightfield_width	= 0;
+		uint32_t m_heightfield_length	= 0;
+		std::unique_ptr<PhysicsTriangleMesh> m_triangle_mesh;
 	};
 }
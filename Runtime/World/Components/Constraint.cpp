@@ -214,6 +214,7 @@ namespace Spartan
 			if (rigid_body_own)	rigid_body_own->RemoveConstraint(this);
 			if (rigid_body_other) rigid_body_other->RemoveConstraint(this);
 
+			m_physics->StepWait();
 			m_physics->GetWorld()->removeConstraint(m_constraint);
 			delete m_constraint;
 			m_constraint = nullptr;
@@ -360,6 +361,7 @@ namespace Spartan
 			}
 
 		    ApplyLimits();
+		    m_physics->StepWait();
 		    m_physics->GetWorld()->addConstraint(m_constraint, !m_collisionWithLinkedBody);
 		}
 	}
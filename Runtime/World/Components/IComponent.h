@@ -52,6 +52,7 @@ namespace Spartan
 		ComponentType_Environment,
 		ComponentType_Transform,
         ComponentType_Terrain,
+		ComponentType_Animator,
 		ComponentType_Unknown
 	};
 
@@ -19,14 +19,16 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ==================================
+//= INCLUDES =====================================
 #include "Renderable.h"
 #include "Transform.h"
+#include "Camera.h"
 #include "../../Rendering/Model.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Rendering/Utilities/Geometry.h"
-//=============================================
+#include "../../Resource/Import/MeshClusterizer.h"
+//================================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -145,6 +147,7 @@ namespace Spartan
 		string model_name;
 		stream->Read(&model_name);
 		m_model = m_context->GetSubsystem<ResourceCache>()->GetByName<Model>(model_name);
+		GeometryResolve();
 
 		// If it was a default mesh, we have to reconstruct it
 		if (m_geometry_type != Geometry_Custom) 
@@ -177,6 +180,7 @@ namespace Spartan
 		m_geometryVertexCount	= vertex_count;
 		m_bounding_box			= bounding_box;
 		m_model					= model ? model->GetSharedPtr() : nullptr;
+		GeometryResolve();
 	}
 
 	void Renderable::GeometrySet(const Geometry_Type type)
@@ -205,6 +209,21 @@ namespace Spartan
 		m_model->GetGeometry(m_geometryIndexOffset, m_geometryIndexCount, m_geometryVertexOffset, m_geometryVertexCount, indices, vertices);
 	}
 
+	void Renderable::GeometryResolve()
+	{
+		// Models are split into submeshes with buffers of their own, draws address those
+		m_geometry_submesh				= m_model ? m_model->FindSubmesh(m_geometryIndexOffset) : 0;
+		const auto submesh				= m_model ? m_model->GetSubmesh(m_geometry_submesh) : nullptr;
+		m_geometry_index_offset_local	= submesh ? m_geometryIndexOffset - submesh->index_offset : 0;
+		m_geometry_vertex_offset_local	= submesh ? m_geometryVertexOffset - submesh->vertex_offset : 0;
+
+		// LODs and clusters are in the submesh table, so they are available even if the submesh isn't loaded
+		m_lods		= m_model ? m_model->GetGeometryLods(m_geometryIndexOffset) : vector<Mesh_Lod>();
+		m_lod_index	= 0;
+		m_clusters	= m_model ? m_model->GetGeometryClusters(m_geometryIndexOffset) : vector<Mesh_Cluster>();
+		m_clusters_visible.clear();
+	}
+
     const BoundingBox& Renderable::GetAabb()
 	{
         if (m_last_transform != GetTransform()->GetMatrix())
@@ -221,6 +240,75 @@ namespace Spartan
 		return m_aabb;
 	}
 
+	void Renderable::LodSelect(const Vector3& camera_position, const float projection_scale, const float error_threshold, const float hysteresis)
+	{
+		if (m_lods.empty())
+			return;
+
+		// LOD errors are relative to the extent of the geometry
+		const auto& aabb		= GetAabb();
+		const auto extents		= aabb.GetExtents();
+		const auto size			= Max3(extents.x, extents.y, extents.z) * 2.0f;
+		const auto distance		= Max(Vector3::Distance(camera_position, aabb.GetCenter()) - extents.Length(), M_EPSILON);
+		const auto to_pixels	= size * projection_scale / distance;
+
+		auto projected_error = [this, to_pixels](const uint32_t lod)
+		{
+			return lod == 0 ? 0.0f : m_lods[lod - 1].error * to_pixels;
+		};
+
+		// Going coarser needs some margin so that objects near a threshold don't flicker between two LODs
+		auto lod = Min(m_lod_index, LodCount() - 1);
+		while (lod + 1 < LodCount() && projected_error(lod + 1) < error_threshold * (1.0f - hysteresis))
+		{
+			lod++;
+		}
+		while (lod > 0 && projected_error(lod) > error_threshold)
+		{
+			lod--;
+		}
+
+		m_lod_index = lod;
+	}
+
+	void Renderable::ClustersCull(Camera* camera, const bool cull_back_faces)
+	{
+		m_clusters_visible.clear();
+		if (!ClustersActive() || !camera || !camera->IsInViewFrustrum(this))
+			return;
+
+		const auto& transform	= GetTransform()->GetMatrix();
+		const auto scale		= transform.GetScale();
+		const auto radius_scale	= Max3(scale.x, scale.y, scale.z);
+
+		// Cones are tested in object space, where the test is exact as long as the transform doesn't mirror
+		const auto determinant		= transform.m00 * (transform.m11 * transform.m22 - transform.m12 * transform.m21) -
+									  transform.m01 * (transform.m10 * transform.m22 - transform.m12 * transform.m20) +
+									  transform.m02 * (transform.m10 * transform.m21 - transform.m11 * transform.m20);
+		const auto test_cones		= cull_back_faces && determinant > 0.0f;
+		const auto camera_position	= camera->GetTransform()->GetPosition() * transform.Inverted();
+
+		for (const auto& cluster : m_clusters)
+		{
+			if (test_cones && MeshClusterizer::IsBackFacing(cluster, camera_position))
+				continue;
+
+			const auto radius = cluster.radius * radius_scale;
+			if (!camera->IsInViewFrustrum(cluster.center * transform, Vector3(radius, radius, radius)))
+				continue;
+
+			// Clusters are contiguous in the index buffer, so neighbouring visible ones can be drawn as one range
+			if (!m_clusters_visible.empty() && m_clusters_visible.back().first + m_clusters_visible.back().second == cluster.index_offset)
+			{
+				m_clusters_visible.back().second += cluster.index_count;
+			}
+			else
+			{
+				m_clusters_visible.emplace_back(cluster.index_offset, cluster.index_count);
+			}
+		}
+	}
+
 	// All functions (set/load) resolve to this
 	void Renderable::SetMaterial(const shared_ptr<Material>& material)
 	{
@@ -26,13 +26,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include "../../Math/BoundingBox.h"
 #include "../../Math/Matrix.h"
+#include "../../Rendering/Mesh.h"
 //=================================
 
 namespace Spartan
 {
 	class Model;
-	class Mesh;
 	class Light;
+	class Camera;
 	class Material;
 	namespace Math
 	{
@@ -80,9 +81,30 @@ namespace Spartan
 		auto GeometryType()			const { return m_geometry_type; }
 		const auto& GeometryName()	const { return m_geometryName; }
 		const auto& GeometryModel() const { return m_model; }
+		auto GeometrySubmesh()		const { return m_geometry_submesh; }
+		// Offsets into the buffers of the submesh (for the selected LOD), which is what draws use
+		auto GeometryDrawIndexOffset()	const { return m_lod_index == 0 ? m_geometry_index_offset_local : m_lods[m_lod_index - 1].index_offset; }
+		auto GeometryDrawIndexCount()	const { return m_lod_index == 0 ? m_geometryIndexCount : m_lods[m_lod_index - 1].index_count; }
+		auto GeometryDrawVertexOffset()	const { return m_geometry_vertex_offset_local; }
 		const Math::BoundingBox& GetAabb();
 		//=====================================================================================================
 
+		//= LOD =================================================================================================================
+		// Picks the coarsest LOD whose error projects to less than error_threshold pixels, projection_scale converts a size
+		// at a distance of one unit to pixels. A coarser LOD has to beat the threshold by the hysteresis fraction to be picked.
+		void LodSelect(const Math::Vector3& camera_position, float projection_scale, float error_threshold, float hysteresis);
+		auto LodIndex() const { return m_lod_index; }
+		auto LodCount() const { return static_cast<uint32_t>(m_lods.size()) + 1; }
+		//=======================================================================================================================
+
+		//= CLUSTERS ==========================================================================================================
+		// Culls the clusters of the full detail geometry against the camera frustum and, if back faces are culled, against their
+		// normal cones. The visible clusters are merged into as few index ranges (offset, count) as possible.
+		void ClustersCull(Camera* camera, bool cull_back_faces);
+		auto ClustersActive() const			{ return m_lod_index == 0 && !m_clusters.empty(); }
+		const auto& ClustersVisible() const	{ return m_clusters_visible; }
+		//=====================================================================================================================
+
 		//= MATERIAL ============================================================
 		// Sets a material from memory (adds it to the resource cache by default)
 		void SetMaterial(const std::shared_ptr<Material>& material);
@@ -104,12 +126,21 @@ namespace Spartan
 		//=========================================================================================
 
 	private:
+		void GeometryResolve();
+
 		std::string m_geometryName;
 		uint32_t m_geometryIndexOffset;
 		uint32_t m_geometryIndexCount;
 		uint32_t m_geometryVertexOffset;
 		uint32_t m_geometryVertexCount;
+		uint32_t m_geometry_submesh				= 0;
+		uint32_t m_geometry_index_offset_local	= 0;
+		uint32_t m_geometry_vertex_offset_local	= 0;
 		std::shared_ptr<Model> m_model;
+		std::vector<Mesh_Lod> m_lods;
+		uint32_t m_lod_index = 0;
+		std::vector<Mesh_Cluster> m_clusters;
+		std::vector<std::pair<uint32_t, uint32_t>> m_clusters_visible;
 		Geometry_Type m_geometry_type;
 		Math::BoundingBox m_bounding_box;
 		Math::BoundingBox m_aabb;
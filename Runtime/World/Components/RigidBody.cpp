@@ -66,14 +66,20 @@ namespace Spartan
 			m_rigidBody->m_hasSimulated = true;
 		}
 
-		// Update from bullet, BULLET -> ENGINE
+		// Update from bullet, BULLET -> ENGINE (the world can be stepping on a worker, so this only records the state, RigidBody::Present() writes it to the transform)
 		void setWorldTransform(const btTransform& worldTrans) override
 		{
 			Quaternion newWorldRot	= ToQuaternion(worldTrans.getRotation());
 			Vector3 newWorldPos		= ToVector3(worldTrans.getOrigin()) - newWorldRot * m_rigidBody->GetCenterOfMass();
 
-			m_rigidBody->GetTransform()->SetPosition(newWorldPos);
-			m_rigidBody->GetTransform()->SetRotation(newWorldRot);
+			m_rigidBody->m_state_position[0]	= m_rigidBody->m_state_position[1];
+			m_rigidBody->m_state_rotation[0]	= m_rigidBody->m_state_rotation[1];
+			m_rigidBody->m_state_position[1]	= newWorldPos;
+			m_rigidBody->m_state_rotation[1]	= newWorldRot;
+			m_rigidBody->m_state_step			= m_rigidBody->m_physics->GetStepCount();
+
+			// Bullet only synchronizes active bodies, so bodies at rest never get here
+			m_rigidBody->m_physics->Body_Moved(m_rigidBody);
 
 			m_rigidBody->m_hasSimulated = true;
 		}
@@ -88,6 +94,8 @@ namespace Spartan
 		m_frictionRolling	= DEFAULT_FRICTION_ROLLING;
 		m_useGravity		= true;
 		m_isKinematic		= false;
+		m_collisionLayer	= 0;
+		m_collisionMask		= 0xFFFFFFFF;
 		m_hasSimulated		= false;
 		m_positionLock		= Vector3::Zero;
 		m_rotationLock		= Vector3::Zero;
@@ -101,6 +109,8 @@ namespace Spartan
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_restitution, float);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_useGravity, bool);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_isKinematic, bool);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_collisionLayer, uint32_t);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_collisionMask, uint32_t);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_gravity, Vector3);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_positionLock, Vector3);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_rotationLock, Vector3);
@@ -131,10 +141,17 @@ namespace Spartan
 
 	void RigidBody::OnTick(float delta_time)
 	{
-		// When in editor mode, get position from transform (so the user can move the body around)
+		// When in editor mode, get the pose from the transform (so the user can move the body around). Only when it
+		// changed though, as setting it wakes the body up and resting bodies should cost nothing once the game starts.
 		if (!m_context->m_engine->EngineMode_IsSet(Engine_Game))
 		{
-			SetPosition(GetTransform()->GetPosition());
+			const auto& position = GetTransform()->GetPosition();
+			const auto& rotation = GetTransform()->GetRotation();
+			if (position != m_synced_position || rotation != m_synced_rotation)
+			{
+				SetPosition(position);
+				SetRotation(rotation);
+			}
 		}
 	}
 
@@ -150,6 +167,8 @@ namespace Spartan
 		stream->Write(m_positionLock);
 		stream->Write(m_rotationLock);
 		stream->Write(m_inWorld);
+		stream->Write(m_collisionLayer);
+		stream->Write(~m_collisionMask); // Inverted, so that records written before it read as colliding with every layer
 	}
 
 	void RigidBody::Deserialize(FileStream* stream)
@@ -164,6 +183,9 @@ namespace Spartan
 		stream->Read(&m_positionLock);
 		stream->Read(&m_rotationLock);
 		stream->Read(&m_inWorld);
+		stream->Read(&m_collisionLayer);
+		m_collisionMask		= ~stream->ReadAs<uint32_t>();
+		m_collisionLayer	= Min(m_collisionLayer, 31u);
 
 		Body_AcquireShape();
 		Body_AddToWorld();
@@ -234,6 +256,30 @@ namespace Spartan
 		Body_AddToWorld();
 	}
 
+	void RigidBody::SetCollisionLayer(const uint32_t layer)
+	{
+		if (layer > 31)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		if (layer == m_collisionLayer)
+			return;
+
+		m_collisionLayer = layer;
+		Body_AddToWorld();
+	}
+
+	void RigidBody::SetCollisionMask(const uint32_t mask)
+	{
+		if (mask == m_collisionMask)
+			return;
+
+		m_collisionMask = mask;
+		Body_AddToWorld();
+	}
+
 	//= FORCE/TORQUE ========================================================
 	void RigidBody::SetLinearVelocity(const Vector3& velocity) const
 	{
@@ -391,6 +437,7 @@ namespace Spartan
 			m_rigidBody->setInterpolationWorldTransform(interpTrans);
 		}
 
+		State_Reset();
 		Activate();
 	}
 
@@ -426,6 +473,7 @@ namespace Spartan
 
 		m_rigidBody->updateInertiaTensor();
 
+		State_Reset();
 		Activate();
 	}
 
@@ -457,6 +505,28 @@ namespace Spartan
 		m_rigidBody->setActivationState(WANTS_DEACTIVATION);
 	}
 
+	bool RigidBody::Present(const uint64_t step, float alpha)
+	{
+		// Bodies which didn't move in the given step rest at their current state, which only has to be written once
+		if (m_state_step != step)
+		{
+			if (m_state_presented)
+				return false;
+
+			alpha = 1.0f;
+		}
+		m_state_presented = m_state_step != step;
+
+		const auto position = m_state_position[0] + (m_state_position[1] - m_state_position[0]) * alpha;
+		const auto rotation = Quaternion::Lerp(m_state_rotation[0], m_state_rotation[1], alpha);
+		GetTransform()->SetPosition(position);
+		GetTransform()->SetRotation(rotation);
+		m_synced_position = position;
+		m_synced_rotation = rotation;
+
+		return true;
+	}
+
 	void RigidBody::AddConstraint(Constraint* constraint)
 	{
 		m_constraints.emplace_back(constraint);
@@ -509,6 +579,7 @@ namespace Spartan
 		}
 		
 		Body_Release();
+		m_physics->StepWait();
 
 		// CONSTRUCTION
 		{
@@ -547,7 +618,7 @@ namespace Spartan
 		SetRotationLock(m_rotationLock);
 
 		// Add to world
-		m_physics->GetWorld()->addRigidBody(m_rigidBody);
+		m_physics->GetWorld()->addRigidBody(m_rigidBody, static_cast<int>(1u << m_collisionLayer), static_cast<int>(m_collisionMask));
 		if (m_mass > 0.0f)
 		{
 			Activate();
@@ -567,6 +638,9 @@ namespace Spartan
 		if (!m_rigidBody)
 			return;
 
+		m_physics->StepWait();
+		m_physics->Body_Removed(this);
+
 		// Release any constraints that refer to it
 		for (const auto& constraint : m_constraints)
 		{
@@ -587,6 +661,7 @@ namespace Spartan
 
 		if (m_inWorld)
 		{
+			m_physics->StepWait();
 			m_physics->GetWorld()->removeRigidBody(m_rigidBody);
 			delete m_rigidBody->getMotionState();
 			delete m_rigidBody;
@@ -648,6 +723,17 @@ namespace Spartan
 		}
 	}
 
+	void RigidBody::State_Reset()
+	{
+		// Teleported, there is nothing to interpolate from
+		m_state_position[0]	= m_state_position[1]	= GetPosition();
+		m_state_rotation[0]	= m_state_rotation[1]	= GetRotation();
+		m_state_presented	= false;
+		m_synced_position	= GetTransform()->GetPosition();
+		m_synced_rotation	= GetTransform()->GetRotation();
+		m_physics->Body_Present(this);
+	}
+
 	bool RigidBody::IsActivated() const
 	{
 		return m_rigidBody->isActive();
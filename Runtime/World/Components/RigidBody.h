@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "IComponent.h"
 #include <memory>
 #include "../../Math/Vector3.h"
+#include "../../Math/Quaternion.h"
 #include <vector>
 //=============================
 
@@ -91,6 +92,14 @@ namespace Spartan
 		bool GetIsKinematic() { return m_isKinematic; }
 		//===========================================
 
+		//= COLLISION LAYER ========================================================================
+		// The layer (0 to 31) the body is in and a mask of the layers it collides with, queries filter by layer too
+		uint32_t GetCollisionLayer() const { return m_collisionLayer; }
+		void SetCollisionLayer(uint32_t layer);
+		uint32_t GetCollisionMask() const { return m_collisionMask; }
+		void SetCollisionMask(uint32_t mask);
+		//==========================================================================================
+
 		//= VELOCITY/FORCE/TORQUE ==========================================================================
 		void SetLinearVelocity(const Math::Vector3& velocity) const;
 		void SetAngularVelocity(const Math::Vector3& velocity);
@@ -139,7 +148,14 @@ namespace Spartan
 		void RemoveConstraint(Constraint* constraint);
 		void SetShape(btCollisionShape* shape);
 
+		// Writes the simulated state to the transform, alpha of the way from the state before the given step to the one after it.
+		// Returns false if there was nothing to write, the body rests where it was last presented.
+		bool Present(uint64_t step, float alpha);
+		bool IsPresented() const { return m_state_presented; }
+
 	private:
+		friend class MotionState;
+		friend class Physics;
 		void Body_AddToWorld();
 		void Body_Release();
 		void Body_RemoveFromWorld();
@@ -147,6 +163,7 @@ namespace Spartan
 		void Flags_UpdateKinematic();
 		void Flags_UpdateGravity();
 		bool IsActivated() const;
+		void State_Reset();
 
 		float m_mass;
 		float m_friction;
@@ -154,6 +171,8 @@ namespace Spartan
 		float m_restitution;
 		bool m_useGravity;
 		bool m_isKinematic;
+		uint32_t m_collisionLayer;
+		uint32_t m_collisionMask;
 		Math::Vector3 m_gravity;
 		Math::Vector3 m_positionLock;
 		Math::Vector3 m_rotationLock;
@@ -164,6 +183,18 @@ namespace Spartan
 		std::vector<Constraint*> m_constraints;
 		bool m_inWorld;
 		Physics* m_physics;
+
+		// Previous and current state (written by the thread which steps the world) and the step they were last written in
+		Math::Vector3 m_state_position[2];
+		Math::Quaternion m_state_rotation[2];
+		uint64_t m_state_step		= 0;
+		bool m_state_presented		= true;
+		bool m_state_moved			= false; // Queued for Physics::Present()
+		bool m_state_presenting		= false; // Presented every tick, until it rests
+
+		// The pose last exchanged with the transform, in editor mode the body only follows the transform when it differs
+		Math::Vector3 m_synced_position;
+		Math::Quaternion m_synced_rotation;
 	public:
 		bool m_hasSimulated;
 	};
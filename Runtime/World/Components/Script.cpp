@@ -54,26 +54,17 @@ namespace Spartan
 		m_scriptInstance->ExecuteStart();
 	}
 
-	void Script::OnTick(float delta_time)
-	{
-		if (!m_scriptInstance)
-			return;
-
-		if (!m_scriptInstance->IsInstantiated())
-			return;
-
-		m_scriptInstance->ExecuteUpdate(delta_time);
-	}
-
 	void Script::Serialize(FileStream* stream)
 	{
 		stream->Write(m_scriptInstance ? m_scriptInstance->GetScriptPath() : "");
+		stream->Write(static_cast<uint32_t>(m_priority));
 	}
 
 	void Script::Deserialize(FileStream* stream)
 	{
 		string script_path;
 		stream->Read(&script_path);
+		m_priority = static_cast<ScriptPriority>(stream->ReadAs<uint32_t>());
 
 		if (!script_path.empty())
 		{
@@ -86,6 +77,7 @@ namespace Spartan
 	{
 		// Instantiate the script
 		m_scriptInstance = make_shared<ScriptInstance>();
+		m_scriptInstance->SetPriority(m_priority);
 		m_scriptInstance->Instantiate(filePath, GetEntity_PtrWeak(), GetContext()->GetSubsystem<Scripting>());
 
 		// Check if the script has been instantiated successfully.
@@ -96,6 +88,16 @@ namespace Spartan
 		return true;
 	}
 
+	void Script::SetPriority(const ScriptPriority priority)
+	{
+		m_priority = priority;
+
+		if (m_scriptInstance)
+		{
+			m_scriptInstance->SetPriority(priority);
+		}
+	}
+
 	string Script::GetScriptPath()
 	{
 		return m_scriptInstance ? m_scriptInstance->GetScriptPath() : "";
@@ -36,7 +36,6 @@ namespace Spartan
 
 		//= ICOMPONENT ===============================
 		void OnStart() override;
-		void OnTick(float delta_time) override;
 		void Serialize(FileStream* stream) override;
 		void Deserialize(FileStream* stream) override;
 		//============================================
@@ -45,8 +44,13 @@ namespace Spartan
 		std::string GetScriptPath();
 		std::string GetName();
 
+		// Update() is dispatched by the scripting subsystem, low priority scripts are updated when there is time left in the frame
+		ScriptPriority GetPriority() const { return m_priority; }
+		void SetPriority(ScriptPriority priority);
+
 	private:
 		std::shared_ptr<ScriptInstance> m_scriptInstance;
 		std::string m_name;
+		ScriptPriority m_priority = Priority_Normal;
 	};
 }
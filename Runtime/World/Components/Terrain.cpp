@@ -22,6 +22,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ============================
 #include "Terrain.h"
 #include "Renderable.h"
+#include "Transform.h"
+#include "Collider.h"
+#include "RigidBody.h"
+#include "Camera.h"
 #include "..\Entity.h"
 #include "..\..\RHI\RHI_Texture2D.h"
 #include "..\..\Logging\Log.h"
@@ -33,6 +37,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "..\..\Threading\Threading.h"
 #include "..\..\Resource\ResourceCache.h"
 #include "..\..\Rendering\Mesh.h"
+#include "..\World.h"
+#include "..\..\Core\Stopwatch.h"
+#include "..\..\Rendering\Renderer.h"
+#include <emmintrin.h>
+#include <mutex>
 //=======================================
 
 //= NAMESPACES ===============
@@ -42,9 +51,345 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    namespace _Terrain
+    {
+        static const uint32_t lod_count             = 4;            // Including the full detail grid, every level doubles the spacing
+        static const float skirt_margin             = 0.01f;        // Of the height range, added to the depth the LODs need
+        static const char* chunk_name_prefix        = "Terrain_Chunk_";
+        static const uint32_t streaming_reads_max   = 4;            // In flight at a time, so that a camera cut doesn't flood the job system
+        static const uint32_t streaming_tag         = 0x4D525453;   // "STRM", precedes the streaming settings (older terrains end before it)
+
+        struct chunk_geometry
+        {
+            vector<uint32_t> indices;
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+            vector<vector<uint32_t>> lods;
+            vector<float> lod_deviations;   // Largest height difference from the full detail grid, in world units
+            uint32_t skirt_offset = 0;      // First skirt vertex
+        };
+
+        // Grid lines kept at a given spacing, the last one is always kept so that chunks of any size close
+        inline vector<uint32_t> grid_lines(const uint32_t quads, const uint32_t spacing)
+        {
+            vector<uint32_t> lines;
+            for (uint32_t i = 0; i < quads; i += spacing)
+            {
+                lines.emplace_back(i);
+            }
+            lines.emplace_back(quads);
+
+            return lines;
+        }
+
+        // Interleaves the bits of x and y, so that sorting by it walks the chunks in quadtree order
+        inline uint32_t morton_code(const uint32_t x, const uint32_t y)
+        {
+            uint32_t code = 0;
+            for (uint32_t bit = 0; bit < 16; bit++)
+            {
+                code |= ((x >> bit) & 1) << (bit * 2);
+                code |= ((y >> bit) & 1) << (bit * 2 + 1);
+            }
+            return code;
+        }
+
+        // Positions of three rows, one array per component, so that four neighbouring vertices load at once
+        struct rows_soa
+        {
+            rows_soa(const uint32_t width) { for (auto& component : components) { component.resize(static_cast<size_t>(width) * 3); } }
+            vector<float> components[3];
+        };
+
+        struct vector3_sse
+        {
+            __m128 x, y, z;
+        };
+
+        inline vector3_sse load(const rows_soa& rows, const uint32_t width, const uint32_t row, const uint32_t x)
+        {
+            const size_t offset = static_cast<size_t>(row) * width + x;
+            return { _mm_loadu_ps(&rows.components[0][offset]), _mm_loadu_ps(&rows.components[1][offset]), _mm_loadu_ps(&rows.components[2][offset]) };
+        }
+
+        inline vector3_sse sub(const vector3_sse& a, const vector3_sse& b) { return { _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) }; }
+        inline vector3_sse add(const vector3_sse& a, const vector3_sse& b) { return { _mm_add_ps(a.x, b.x), _mm_add_ps(a.y, b.y), _mm_add_ps(a.z, b.z) }; }
+        inline vector3_sse mul(const vector3_sse& a, const __m128 b)       { return { _mm_mul_ps(a.x, b), _mm_mul_ps(a.y, b), _mm_mul_ps(a.z, b) }; }
+        inline __m128 dot(const vector3_sse& a, const vector3_sse& b)      { return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z)); }
+
+        inline vector3_sse cross(const vector3_sse& a, const vector3_sse& b)
+        {
+            return
+            {
+                _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+                _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+                _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))
+            };
+        }
+
+        inline vector3_sse normalize(const vector3_sse& v)
+        {
+            return mul(v, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(dot(v, v), _mm_set1_ps(1e-24f)))));
+        }
+
+        // Unnormalized, so that bigger triangles weigh more
+        inline Vector3 face_normal(const Vector3& a, const Vector3& b, const Vector3& c) { return Vector3::Cross(a - b, b - c); }
+        inline vector3_sse face_normal(const vector3_sse& a, const vector3_sse& b, const vector3_sse& c) { return cross(sub(a, b), sub(b, c)); }
+
+        // Grid quads are split into (bottom right, bottom left, top left) and (bottom right, top left, top right), "top" being the next row.
+        // A vertex is shared by up to six of those triangles, the normal is their sum and the tangent is the sum of their edges along
+        // the rows (where U grows), made orthogonal to the normal.
+        void compute_normal_tangent(RHI_Vertex_PosTexNorTan* vertices, const uint32_t width, const uint32_t height, const uint32_t x, const uint32_t y)
+        {
+            const auto p = [vertices, width](const uint32_t i, const uint32_t j)
+            {
+                const auto& vertex = vertices[static_cast<size_t>(j) * width + i];
+                return Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+            };
+
+            const bool left     = x > 0;
+            const bool right    = x + 1 < width;
+            const bool down     = y > 0;
+            const bool up       = y + 1 < height;
+            Vector3 normal      = Vector3::Zero;
+            Vector3 tangent     = Vector3::Zero;
+
+            if (right && up)    // Quad (x, y), the vertex is its bottom left
+            {
+                normal  += face_normal(p(x + 1, y), p(x, y), p(x, y + 1));
+                tangent += p(x + 1, y) - p(x, y);
+            }
+            if (left && up)     // Quad (x - 1, y), bottom right
+            {
+                normal  += face_normal(p(x, y), p(x - 1, y), p(x - 1, y + 1));
+                normal  += face_normal(p(x, y), p(x - 1, y + 1), p(x, y + 1));
+                tangent += p(x, y) - p(x - 1, y);
+                tangent += p(x, y + 1) - p(x - 1, y + 1);
+            }
+            if (right && down)  // Quad (x, y - 1), top left
+            {
+                normal  += face_normal(p(x + 1, y - 1), p(x, y - 1), p(x, y));
+                normal  += face_normal(p(x + 1, y - 1), p(x, y), p(x + 1, y));
+                tangent += p(x + 1, y - 1) - p(x, y - 1);
+                tangent += p(x + 1, y) - p(x, y);
+            }
+            if (left && down)   // Quad (x - 1, y - 1), top right
+            {
+                normal  += face_normal(p(x, y - 1), p(x - 1, y), p(x, y));
+                tangent += p(x, y) - p(x - 1, y);
+            }
+
+            normal.Normalize();
+            tangent = tangent - normal * Vector3::Dot(normal, tangent);
+            tangent.Normalize();
+
+            auto& vertex = vertices[static_cast<size_t>(y) * width + x];
+            vertex.nor[0] = normal.x;   vertex.nor[1] = normal.y;   vertex.nor[2] = normal.z;
+            vertex.tan[0] = tangent.x;  vertex.tan[1] = tangent.y;  vertex.tan[2] = tangent.z;
+        }
+
+        // Same as compute_normal_tangent() but for four vertices at once, they all have to have the six triangles around them
+        void compute_normals_tangents_sse(RHI_Vertex_PosTexNorTan* vertices, const rows_soa& rows, const uint32_t width, const uint32_t x, const uint32_t y)
+        {
+            // Rows 0, 1 and 2 hold y - 1, y and y + 1
+            const auto p10 = load(rows, width, 0, x); const auto p20 = load(rows, width, 0, x + 1);
+            const auto p01 = load(rows, width, 1, x - 1); const auto p11 = load(rows, width, 1, x); const auto p21 = load(rows, width, 1, x + 1);
+            const auto p02 = load(rows, width, 2, x - 1); const auto p12 = load(rows, width, 2, x);
+
+            auto normal = face_normal(p21, p11, p12);
+            normal      = add(normal, face_normal(p11, p01, p02));
+            normal      = add(normal, face_normal(p11, p02, p12));
+            normal      = add(normal, face_normal(p20, p10, p11));
+            normal      = add(normal, face_normal(p20, p11, p21));
+            normal      = add(normal, face_normal(p10, p01, p11));
+            normal      = normalize(normal);
+
+            // Edges along the rows, the one from the vertex to its right neighbour and the one from its left one count twice
+            const auto edge_left    = sub(p11, p01);
+            const auto edge_right   = sub(p21, p11);
+            auto tangent            = add(mul(add(edge_left, edge_right), _mm_set1_ps(2.0f)), add(sub(p12, p02), sub(p20, p10)));
+            tangent                 = normalize(sub(tangent, mul(normal, dot(normal, tangent))));
+
+            float nx[4], ny[4], nz[4], tx[4], ty[4], tz[4];
+            _mm_storeu_ps(nx, normal.x);  _mm_storeu_ps(ny, normal.y);  _mm_storeu_ps(nz, normal.z);
+            _mm_storeu_ps(tx, tangent.x); _mm_storeu_ps(ty, tangent.y); _mm_storeu_ps(tz, tangent.z);
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                auto& vertex = vertices[static_cast<size_t>(y) * width + x + i];
+                vertex.nor[0] = nx[i]; vertex.nor[1] = ny[i]; vertex.nor[2] = nz[i];
+                vertex.tan[0] = tx[i]; vertex.tan[1] = ty[i]; vertex.tan[2] = tz[i];
+            }
+        }
+
+        void compute_normals_tangents_row(RHI_Vertex_PosTexNorTan* vertices, const uint32_t width, const uint32_t height, const uint32_t y, rows_soa* rows)
+        {
+            uint32_t x = 0;
+
+            // Interior vertices go four at a time
+            if (y > 0 && y + 1 < height && width > 5)
+            {
+                for (uint32_t row = 0; row < 3; row++)
+                {
+                    for (uint32_t i = 0; i < width; i++)
+                    {
+                        const auto& vertex = vertices[static_cast<size_t>(y + row - 1) * width + i];
+                        for (uint32_t component = 0; component < 3; component++)
+                        {
+                            rows->components[component][static_cast<size_t>(row) * width + i] = vertex.pos[component];
+                        }
+                    }
+                }
+
+                compute_normal_tangent(vertices, width, height, 0, y);
+                for (x = 1; x + 4 < width; x += 4)
+                {
+                    compute_normals_tangents_sse(vertices, *rows, width, x, y);
+                }
+            }
+
+            for (; x < width; x++)
+            {
+                compute_normal_tangent(vertices, width, height, x, y);
+            }
+        }
+
+        // Skirts hang from the border of a chunk and hide the cracks between neighbours of different LODs,
+        // they are two sided as they have to be seen from both chunks
+        inline void add_skirt(vector<uint32_t>* indices, const uint32_t a, const uint32_t b, const uint32_t skirt_a, const uint32_t skirt_b)
+        {
+            indices->insert(indices->end(), { a, b, skirt_b, a, skirt_b, skirt_a, a, skirt_b, b, a, skirt_a, skirt_b });
+        }
+
+        // Builds the chunk covering quads [x, x + width) and [y, y + height) of the grid
+        void build_chunk(const vector<RHI_Vertex_PosTexNorTan>& grid, const uint32_t grid_width, const uint32_t x, const uint32_t y, const uint32_t width, const uint32_t height, chunk_geometry* chunk)
+        {
+            const uint32_t row = width + 1;
+
+            // Grid vertices
+            chunk->vertices.reserve(static_cast<size_t>(row) * (height + 1) + 2 * (width + 1) + 2 * (height + 1));
+            for (uint32_t j = 0; j <= height; j++)
+            {
+                for (uint32_t i = 0; i <= width; i++)
+                {
+                    chunk->vertices.emplace_back(grid[static_cast<size_t>(y + j) * grid_width + x + i]);
+                }
+            }
+
+            // Skirt vertices, a copy of every border vertex (lowered once the skirt depth is known)
+            chunk->skirt_offset         = static_cast<uint32_t>(chunk->vertices.size());
+            const uint32_t skirt_bottom = chunk->skirt_offset;
+            const uint32_t skirt_top    = skirt_bottom + row;
+            const uint32_t skirt_left   = skirt_top + row;
+            const uint32_t skirt_right  = skirt_left + height + 1;
+            for (uint32_t i = 0; i <= width; i++)   { chunk->vertices.emplace_back(chunk->vertices[i]); }
+            for (uint32_t i = 0; i <= width; i++)   { chunk->vertices.emplace_back(chunk->vertices[height * row + i]); }
+            for (uint32_t j = 0; j <= height; j++)  { chunk->vertices.emplace_back(chunk->vertices[j * row]); }
+            for (uint32_t j = 0; j <= height; j++)  { chunk->vertices.emplace_back(chunk->vertices[j * row + width]); }
+
+            const auto height_at = [&chunk, row](const uint32_t i, const uint32_t j) { return chunk->vertices[j * row + i].pos[1]; };
+
+            for (uint32_t lod = 0; lod < lod_count; lod++)
+            {
+                const uint32_t spacing = 1 << lod;
+                if (lod != 0 && spacing >= max(width, height))
+                    break;
+
+                const auto xs = grid_lines(width, spacing);
+                const auto ys = grid_lines(height, spacing);
+                vector<uint32_t> indices;
+                indices.reserve((xs.size() - 1) * (ys.size() - 1) * 6 + (xs.size() + ys.size()) * 24);
+
+                // Same triangulation as the full detail grid
+                float deviation = 0.0f;
+                for (size_t j = 0; j + 1 < ys.size(); j++)
+                {
+                    for (size_t i = 0; i + 1 < xs.size(); i++)
+                    {
+                        const uint32_t bottom_left  = ys[j] * row + xs[i];
+                        const uint32_t bottom_right = ys[j] * row + xs[i + 1];
+                        const uint32_t top_left     = ys[j + 1] * row + xs[i];
+                        const uint32_t top_right    = ys[j + 1] * row + xs[i + 1];
+                        indices.insert(indices.end(), { bottom_right, bottom_left, top_left, bottom_right, top_left, top_right });
+
+                        if (spacing == 1)
+                            continue;
+
+                        // How far the heights this cell skips are from the two triangles which replace them
+                        const float h_bl = height_at(xs[i], ys[j]);
+                        const float h_br = height_at(xs[i + 1], ys[j]);
+                        const float h_tl = height_at(xs[i], ys[j + 1]);
+                        const float h_tr = height_at(xs[i + 1], ys[j + 1]);
+                        for (uint32_t v = ys[j]; v <= ys[j + 1]; v++)
+                        {
+                            for (uint32_t u = xs[i]; u <= xs[i + 1]; u++)
+                            {
+                                const float fx  = static_cast<float>(u - xs[i]) / (xs[i + 1] - xs[i]);
+                                const float fy  = static_cast<float>(v - ys[j]) / (ys[j + 1] - ys[j]);
+                                const float h   = (fx + fy <= 1.0f) ? h_bl + fx * (h_br - h_bl) + fy * (h_tl - h_bl) : h_tr + (1.0f - fx) * (h_tl - h_tr) + (1.0f - fy) * (h_br - h_tr);
+                                deviation       = max(deviation, fabs(h - height_at(u, v)));
+                            }
+                        }
+                    }
+                }
+
+                // Skirts
+                for (size_t i = 0; i + 1 < xs.size(); i++)
+                {
+                    add_skirt(&indices, xs[i], xs[i + 1], skirt_bottom + xs[i], skirt_bottom + xs[i + 1]);
+                    add_skirt(&indices, height * row + xs[i], height * row + xs[i + 1], skirt_top + xs[i], skirt_top + xs[i + 1]);
+                }
+                for (size_t j = 0; j + 1 < ys.size(); j++)
+                {
+                    add_skirt(&indices, ys[j] * row, ys[j + 1] * row, skirt_left + ys[j], skirt_left + ys[j + 1]);
+                    add_skirt(&indices, ys[j] * row + width, ys[j + 1] * row + width, skirt_right + ys[j], skirt_right + ys[j + 1]);
+                }
+
+                if (lod == 0)
+                {
+                    chunk->indices = move(indices);
+                }
+                else
+                {
+                    chunk->lods.emplace_back(move(indices));
+                    chunk->lod_deviations.emplace_back(deviation);
+                }
+            }
+        }
+
+        // Memory a resident chunk takes, its geometry stays on the CPU (for the collider) and a copy of about the same size goes to the GPU
+        inline uint64_t chunk_memory(const Model_Submesh& submesh)
+        {
+            const uint64_t geometry = submesh.chunk_size != 0 ? submesh.chunk_size : submesh.mesh->Geometry_MemoryUsage();
+            return geometry * 2;
+        }
+
+        inline float distance_to_aabb(const Vector3& point, const BoundingBox& aabb)
+        {
+            const auto& min = aabb.GetMin();
+            const auto& max = aabb.GetMax();
+            return Vector3::Distance(point, Vector3(Clamp(point.x, min.x, max.x), Clamp(point.y, min.y, max.y), Clamp(point.z, min.z, max.z)));
+        }
+    }
+
+    // Chunks read by workers, waiting for the main thread to load them. The tasks share it, so the terrain can go away while they run.
+    struct Terrain_Streaming_Queue
+    {
+        struct read
+        {
+            uint32_t chunk      = 0;
+            uint32_t generation = 0;
+            bool result         = false;
+            vector<uint32_t> indices;
+            vector<RHI_Vertex_PosTexNorTan> vertices;
+        };
+
+        mutex reads_mutex;
+        vector<read> reads;
+        atomic<uint32_t> pending = 0;
+    };
+
     Terrain::Terrain(Context* context, Entity* entity, uint32_t id /*= 0*/) : IComponent(context, entity, id)
     {
-        
+        m_streaming_queue = make_shared<Terrain_Streaming_Queue>();
     }
 
     void Terrain::OnInitialize()
@@ -52,6 +397,33 @@ namespace Spartan
         
     }
 
+    void Terrain::OnTick(float delta_time)
+    {
+        // Generation only builds the model, the entities of the chunks and their colliders are updated here, on the main thread.
+        // Chunks which are still being read come from the file the new model is about to be saved to, so it waits for them.
+        if (m_is_generating)
+        {
+            if (!m_is_generated || m_streaming_queue->pending != 0)
+                return;
+
+            GenerateFinish();
+        }
+
+        if (m_is_deserialized)
+        {
+            m_is_deserialized = false;
+            if (m_model && m_model->GetSubmeshCount() != 0)
+            {
+                UpdateFromModel(m_model);
+            }
+        }
+
+        if (!m_streaming || !m_model || m_chunks.empty())
+            return;
+
+        StreamingUpdate();
+    }
+
     void Terrain::Serialize(FileStream* stream)
     {
         string no_path;
@@ -60,6 +432,9 @@ namespace Spartan
         stream->Write(m_model ? m_model->GetResourceName() : no_path);
         stream->Write(m_min_y);
         stream->Write(m_max_y);
+        stream->Write(_Terrain::streaming_tag);
+        stream->Write(m_streaming_radius);
+        stream->Write(m_streaming_budget);
     }
 
     void Terrain::Deserialize(FileStream* stream)
@@ -69,8 +444,17 @@ namespace Spartan
         m_model         = resource_cache->GetByName<Model>(stream->ReadAs<string>());
         stream->Read(&m_min_y);
         stream->Read(&m_max_y);
+        if (stream->ReadAs<uint32_t>() == _Terrain::streaming_tag)
+        {
+            stream->Read(&m_streaming_radius);
+            stream->Read(&m_streaming_budget);
+        }
+
+        // Whether the terrain streams is saved with its model, which then only loaded its submesh table
+        m_streaming = m_model && m_model->GetSubmeshStreaming();
 
-        UpdateFromModel(m_model);
+        // The chunk entities, their colliders and rigid bodies are left to the main thread, physics can be stepping on a worker while the world loads
+        m_is_deserialized = true;
     }
 
     void Terrain::SetHeightMap(const shared_ptr<RHI_Texture2D>& height_map)
@@ -93,18 +477,16 @@ namespace Spartan
 
             m_context->GetSubsystem<ResourceCache>()->Remove(m_model);
             m_model.reset();
-            if (shared_ptr<Renderable>& renderable = m_entity->AddComponent<Renderable>())
-            {
-                renderable->GeometryClear();
-            }
+            ChunksClear();
             
             return;
         }
 
+        // Streaming stops until the new model is in place
+        m_is_generating = true;
+        m_is_generated  = false;
         m_context->GetSubsystem<Threading>()->AddTask([this]()
         {
-            m_is_generating = true;
-
             // Get height map data
             vector<std::byte> height_map_data = m_height_map->GetMipmap(0);
             if (height_map_data.empty())
@@ -118,30 +500,29 @@ namespace Spartan
             m_vertex_count                      = m_height * m_width;
             m_face_count                        = (m_height - 1) * (m_width - 1) * 2;
             m_progress_jobs_done                = 0;
-            m_progress_job_count                = m_vertex_count * 2 + m_face_count + m_vertex_count * m_face_count;
+            m_progress_job_count                = m_vertex_count * 4;
 
             // Pre-allocate memory for the calculations that follow
             vector<Vector3> positions                 = vector<Vector3>(m_height * m_width);
             vector<RHI_Vertex_PosTexNorTan> vertices  = vector<RHI_Vertex_PosTexNorTan>(m_vertex_count);
-            vector<uint32_t> indices                  = vector<uint32_t>(m_face_count * 3);
 
             // Read height map and construct positions
             m_progress_desc = "Generating positions...";
             if (GeneratePositions(positions, height_map_data))
             {
-                // Compute the vertices (without the normals) and the indices
-                m_progress_desc = "Generating terrain vertices and indices...";
-                if (GenerateVerticesIndices(positions, indices, vertices))
+                // Compute the vertices (without the normals)
+                m_progress_desc = "Generating terrain vertices...";
+                if (GenerateVertices(positions, vertices))
                 {
                     m_progress_desc = "Generating normals and tangents...";
                     positions.clear();
                     positions.shrink_to_fit();
 
-                    // Compute the normals by doing normal averaging (very expensive)
-                    if (GenerateNormalTangents(indices, vertices))
+                    if (GenerateNormalTangents(vertices))
                     {
-                        // Create a model and set it to the renderable component
-                        UpdateFromVertices(indices, vertices);
+                        // Split into chunks and create a model out of them
+                        m_progress_desc = "Generating chunks...";
+                        GenerateChunks(vertices, &m_model_generated);
                     }
                 }
             }
@@ -151,10 +532,35 @@ namespace Spartan
             m_progress_job_count = 1;
             m_progress_desc.clear();
 
-            m_is_generating = false;
+            m_is_generated = true;
         });
     }
 
+    void Terrain::GenerateFinish()
+    {
+        m_is_generating = false;
+        if (!m_model_generated)
+            return;
+
+        // Replace the model, the previous one stays alive until the renderables of the chunks have moved to the new one
+        const auto model_previous       = m_model;
+        ResourceCache* resource_cache   = m_context->GetSubsystem<ResourceCache>().get();
+        resource_cache->Remove(m_model);
+        m_model_generated->SetResourceFilePath(resource_cache->GetProjectDirectory() + m_entity->GetName() + "_terrain_" + to_string(m_id) + string(EXTENSION_MODEL));
+        m_model_generated->SetSubmeshStreaming(m_streaming);
+        m_model = resource_cache->Cache(m_model_generated);
+        m_model_generated.reset();
+
+        if (m_model)
+        {
+            UpdateFromModel(m_model);
+        }
+        else
+        {
+            ChunksClear();
+        }
+    }
+
     bool Terrain::GeneratePositions(vector<Vector3>& positions, const vector<std::byte>& height_map)
     {
         if (height_map.empty())
@@ -189,7 +595,7 @@ namespace Spartan
         return true;
     }
 
-    bool Terrain::GenerateVerticesIndices(const vector<Vector3>& positions, vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    bool Terrain::GenerateVertices(const vector<Vector3>& positions, vector<RHI_Vertex_PosTexNorTan>& vertices)
     {
         if (positions.empty())
         {
@@ -197,240 +603,525 @@ namespace Spartan
             return false;
         }
 
-        uint32_t index      = 0;
-        uint32_t k          = 0;
-        uint32_t u_index    = 0;
-        uint32_t v_index    = 0;
+        // One vertex per height map pixel, textures repeat every quad
+        for (uint32_t y = 0; y < m_height; y++)
+        {
+            for (uint32_t x = 0; x < m_width; x++)
+            {
+                const uint32_t index    = y * m_width + x;
+                vertices[index]         = RHI_Vertex_PosTexNorTan(positions[index], Vector2(static_cast<float>(x), static_cast<float>(y)));
+            }
+
+            // track progress
+            m_progress_jobs_done += m_width;
+        }
+
+        return true;
+    }
+
+    bool Terrain::GenerateNormalTangents(vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        if (vertices.size() != static_cast<size_t>(m_width) * m_height || m_width < 2 || m_height < 2)
+        {
+            LOG_ERROR("Vertices don't match the height map");
+            return false;
+        }
 
-        for (uint32_t y = 0; y < m_height - 1; y++)
+        // The triangles around a vertex are known from the grid, so every vertex is computed on its own
+        // from its neighbours, in a single pass. Rows only write their own vertices and can be split across threads.
+        Stopwatch timer;
+        m_context->GetSubsystem<Threading>()->Loop([this, &vertices](const uint32_t start, const uint32_t end)
         {
-            for (uint32_t x = 0; x < m_width - 1; x++)
+            _Terrain::rows_soa rows(m_width);
+            for (uint32_t y = start; y < end; y++)
             {
-                uint32_t index_bottom_left  = y * m_width + x;
-                uint32_t index_bottom_right = y * m_width + x + 1;
-                uint32_t index_top_left     = (y + 1) * m_width + x;
-                uint32_t index_top_right    = (y + 1) * m_width + x + 1;
+                _Terrain::compute_normals_tangents_row(vertices.data(), m_width, m_height, y, &rows);
+                m_progress_jobs_done += m_width;
+            }
+        }, m_height);
 
-                // Bottom right of quad
-                index           = index_bottom_right;
-                indices[k]      = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 1.0f));
+        LOGF_INFO("Computed normals and tangents for %d vertices in %.2f ms", static_cast<int>(vertices.size()), static_cast<float>(timer.GetElapsedTimeMs()));
 
-                // Bottom left of quad
-                index           = index_bottom_left;
-                indices[k + 1]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 1.0f));
+        return true;
+    }
 
-                // Top left of quad
-                index           = index_top_left;
-                indices[k + 2]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 0.0f));
+    bool Terrain::GenerateChunks(const vector<RHI_Vertex_PosTexNorTan>& vertices, shared_ptr<Model>* model)
+    {
+        if (vertices.size() != static_cast<size_t>(m_width) * m_height || m_width < 2 || m_height < 2 || m_chunk_size == 0 || !model)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
 
-                // Bottom right of quad
-                index           = index_bottom_right;
-                indices[k + 3]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 1.0f));
+        // Chunk rectangles, in quadtree order so that neighbours are close in the model too
+        struct chunk_rect { uint32_t x, y, width, height, code; };
+        vector<chunk_rect> rects;
+        const uint32_t quads_x = m_width - 1;
+        const uint32_t quads_y = m_height - 1;
+        for (uint32_t y = 0; y < quads_y; y += m_chunk_size)
+        {
+            for (uint32_t x = 0; x < quads_x; x += m_chunk_size)
+            {
+                rects.push_back({ x, y, min(m_chunk_size, quads_x - x), min(m_chunk_size, quads_y - y), _Terrain::morton_code(x / m_chunk_size, y / m_chunk_size) });
+            }
+        }
+        sort(rects.begin(), rects.end(), [](const chunk_rect& a, const chunk_rect& b) { return a.code < b.code; });
 
-                // Top left of quad
-                index           = index_top_left;
-                indices[k + 4]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 0.0f, v_index + 0.0f));
+        // Build them on the job system
+        const auto chunk_count = static_cast<uint32_t>(rects.size());
+        vector<_Terrain::chunk_geometry> chunks(chunk_count);
+        const auto vertices_per_job = static_cast<uint64_t>(m_vertex_count / max(chunk_count, 1u));
+        m_context->GetSubsystem<Threading>()->Loop([this, &vertices, &rects, &chunks, vertices_per_job](const uint32_t start, const uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                const auto& rect = rects[i];
+                _Terrain::build_chunk(vertices, m_width, rect.x, rect.y, rect.width, rect.height, &chunks[i]);
+                m_progress_jobs_done += vertices_per_job;
+            }
+        }, chunk_count);
 
-                // Top right of quad
-                index           = index_top_right;
-                indices[k + 5]  = index;
-                vertices[index] = RHI_Vertex_PosTexNorTan(positions[index], Vector2(u_index + 1.0f, v_index + 0.0f));
+        // Skirts have to reach as low as the coarsest neighbour can be
+        float skirt_depth = (m_max_y - m_min_y) * _Terrain::skirt_margin;
+        for (const auto& chunk : chunks)
+        {
+            for (const auto deviation : chunk.lod_deviations)
+            {
+                skirt_depth = max(skirt_depth, deviation + (m_max_y - m_min_y) * _Terrain::skirt_margin);
+            }
+        }
 
-                k += 6; // next quad
+        // A new model, the current one is still in use until GenerateFinish() replaces it
+        *model = make_shared<Model>(m_context);
+        for (uint32_t i = 0; i < chunk_count; i++)
+        {
+            auto& chunk = chunks[i];
+            for (auto v = chunk.skirt_offset; v < chunk.vertices.size(); v++)
+            {
+                chunk.vertices[v].pos[1] -= skirt_depth;
+            }
 
-                u_index++;
+            uint32_t index_offset = 0;
+            (*model)->AppendGeometry(chunk.indices, chunk.vertices, &index_offset, nullptr, _Terrain::chunk_name_prefix + to_string(i));
 
-                // track progress
-                m_progress_jobs_done++;
+            // LOD errors are relative to the extent of the geometry
+            const auto size = BoundingBox(chunk.vertices).GetSize();
+            const auto extent = max(size.x, max(size.y, size.z));
+            for (size_t lod = 0; lod < chunk.lods.size(); lod++)
+            {
+                (*model)->AppendGeometryLod(index_offset, chunk.lods[lod], chunk.lod_deviations[lod] / max(extent, M_EPSILON));
             }
-            u_index = 0;
-            v_index++;
         }
+        (*model)->UpdateGeometry();
 
         return true;
     }
 
-    bool Terrain::GenerateNormalTangents(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    void Terrain::UpdateFromModel(const shared_ptr<Model>& model)
     {
-        if (indices.empty())
+        if (!model || model->GetSubmeshCount() == 0)
         {
-            LOG_ERROR("Indices are empty");
-            return false;
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
         }
 
-        if (vertices.empty())
+        // Terrains used to be a single renderable on this entity, with a mesh collider built from it. Chunks are children now,
+        // and they collide with heightfields of their own, so the collider (and the rigid body it needs) go with the renderable.
+        if (m_entity->HasComponent<Renderable>())
         {
-            LOG_ERROR("Vertices are empty");
-            return false;
+            m_entity->RemoveComponent<Renderable>();
+
+            const auto collider = m_entity->GetComponent<Collider>();
+            if (collider && collider->GetShapeType() == ColliderShape_Mesh)
+            {
+                m_entity->RemoveComponent<Collider>();
+                if (m_entity->HasComponent<RigidBody>())
+                {
+                    m_entity->RemoveComponent<RigidBody>();
+                }
+            }
         }
 
-        // Normals are computed by normal averaging, which can be crazy slow
-        uint32_t face_count     = static_cast<uint32_t>(indices.size()) / 3;
-        uint32_t vertex_count   = static_cast<uint32_t>(vertices.size());
+        // Chunk entities which were saved with the world are reused, extra ones are removed
+        vector<shared_ptr<Entity>> entities(model->GetSubmeshCount());
+        vector<shared_ptr<Entity>> entities_extra;
+        for (const auto child : m_transform->GetChildren())
+        {
+            const auto name = child->GetEntityName();
+            if (name.rfind(_Terrain::chunk_name_prefix, 0) != 0)
+                continue;
+
+            const auto index = static_cast<uint32_t>(strtoul(name.c_str() + strlen(_Terrain::chunk_name_prefix), nullptr, 10));
+            auto& entity = index < entities.size() && !entities[index] ? entities[index] : entities_extra.emplace_back();
+            entity = child->GetEntity_PtrShared();
+        }
 
-        // Compute face normals and tangents
-        vector<Vector3> face_normals(face_count);
-        vector<Vector3> face_tangents(face_count);
+        for (const auto& entity : entities_extra)
         {
-            for (uint32_t i = 0; i < face_count; ++i)
+            m_context->GetSubsystem<World>()->EntityRemove(entity);
+        }
+
+        m_chunks.clear();
+        m_chunks.resize(model->GetSubmeshCount());
+        for (uint32_t i = 0; i < model->GetSubmeshCount(); i++)
+        {
+            const auto submesh = model->GetSubmesh(i);
+            auto& entity = entities[i];
+            if (!entity)
             {
-                Vector3 edge_a;
-                Vector3 edge_b;
+                entity = m_context->GetSubsystem<World>()->EntityCreate();
+                entity->SetName(_Terrain::chunk_name_prefix + to_string(i));
+                entity->GetTransform_PtrRaw()->SetParent(m_transform);
+            }
 
-                // Normal
+            if (const auto renderable = entity->AddComponent<Renderable>())
+            {
+                renderable->GeometrySet(
+                    entity->GetName(),
+                    submesh->index_offset,
+                    submesh->index_count,
+                    submesh->vertex_offset,
+                    submesh->vertex_count,
+                    submesh->aabb,
+                    model.get()
+                );
+
+                if (!renderable->GetMaterial())
                 {
-                    // Get the vector describing one edge of our triangle (edge 0, 1)
-                    edge_a = Vector3(
-                        vertices[indices[(i * 3)]].pos[0] - vertices[indices[(i * 3) + 1]].pos[0],
-                        vertices[indices[(i * 3)]].pos[1] - vertices[indices[(i * 3) + 1]].pos[1],
-                        vertices[indices[(i * 3)]].pos[2] - vertices[indices[(i * 3) + 1]].pos[2]
-                    );
-
-                    // Get the vector describing another edge of our triangle (edge 2,1)
-                    edge_b = Vector3(
-                        vertices[indices[(i * 3) + 1]].pos[0] - vertices[indices[(i * 3) + 2]].pos[0],
-                        vertices[indices[(i * 3) + 1]].pos[1] - vertices[indices[(i * 3) + 2]].pos[1],
-                        vertices[indices[(i * 3) + 1]].pos[2] - vertices[indices[(i * 3) + 2]].pos[2]
-                    );
-
-                    // Cross multiply the two edge vectors to get the unnormalized face normal
-                    face_normals[i] = Vector3::Cross(edge_a, edge_b);
+                    renderable->UseDefaultMaterial();
                 }
+            }
 
-                // Tangent
-                {
-                    // find first texture coordinate edge 2d vector
-                    float tcU1 = vertices[indices[(i * 3)]].tex[0] - vertices[indices[(i * 3) + 1]].tex[0];
-                    float tcV1 = vertices[indices[(i * 3)]].tex[1] - vertices[indices[(i * 3) + 1]].tex[1];
-
-                    // find second texture coordinate edge 2d vector
-                    float tcU2 = vertices[indices[(i * 3) + 1]].tex[0] - vertices[indices[(i * 3) + 2]].tex[0];
-                    float tcV2 = vertices[indices[(i * 3) + 1]].tex[1] - vertices[indices[(i * 3) + 2]].tex[1];
-
-                    // find tangent using both tex coord edges and position edges
-                    face_tangents[i].x = (tcV1 * edge_a.x - tcV2 * edge_b.x * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
-                    face_tangents[i].y = (tcV1 * edge_a.y - tcV2 * edge_b.y * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
-                    face_tangents[i].z = (tcV1 * edge_a.z - tcV2 * edge_b.z * (1.0f / (tcU1 * tcV2 - tcU2 * tcV1)));
-                }
+            // Grid spacing is a unit, skirts don't reach past the grid
+            auto& chunk     = m_chunks[i];
+            chunk.submesh   = i;
+            chunk.aabb      = submesh->aabb;
+            chunk.entity    = entity;
+            chunk.width     = static_cast<uint32_t>(round(submesh->aabb.GetSize().x)) + 1;
+            chunk.length    = static_cast<uint32_t>(round(submesh->aabb.GetSize().z)) + 1;
+            chunk.resident  = submesh->IsLoaded();
+        }
 
-                // track progress
-                m_progress_jobs_done++;
+        // Reads of the previous chunks are dropped when they arrive
+        m_streaming_generation++;
+        m_streaming_memory = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_chunks.size()); i++)
+        {
+            if (m_chunks[i].resident)
+            {
+                m_streaming_memory += _Terrain::chunk_memory(*model->GetSubmesh(i));
             }
+
+            ChunkColliderUpdate(i);
         }
 
-        
-        // Compute vertex normals and tangents (normals averaging) - This is very expensive show we split it into multiple threads below
-        const auto compute_vertex_normals_tangents = [this, &face_normals , &face_tangents, &vertices, &indices, &vertex_count, &face_count](uint32_t i_start, uint32_t i_end)
-        {
-            Vector3 normal_sum  = Vector3::Zero;
-            Vector3 tangent_sum = Vector3::Zero;
-            float faces_using   = 0;
+        QuadtreeBuild();
+    }
 
-            for (uint32_t i = i_start; i < i_end; ++i)
+    void Terrain::ChunksClear()
+    {
+        for (const auto& chunk : m_chunks)
+        {
+            if (const auto entity = chunk.entity.lock())
             {
-                // Check which triangles use this vertex
-                for (uint32_t j = 0; j < face_count; ++j)
-                {
-                    if (indices[j * 3] == i || indices[(j * 3) + 1] == i || indices[(j * 3) + 2] == i)
-                    {
-                        // If a face is using the vertex, accumulate the face normal/tangent
-                        normal_sum  += face_normals[j];
-                        tangent_sum += face_tangents[j];
-                        faces_using++;
-                    }
+                m_context->GetSubsystem<World>()->EntityRemove(entity);
+            }
+        }
 
-                    // Track progress but only every time the inner loop (face_count) finished.
-                    // This is because different threads increment the progress tracker which is also an atomic so it locks and unlocks.
-                    if (j == face_count < 1)
-                    {
-                        m_progress_jobs_done += face_count;
-                    }
-                }
+        m_chunks.clear();
+        m_nodes.clear();
+        m_streaming_generation++;
+        m_streaming_memory = 0;
+    }
+
+    void Terrain::QuadtreeBuild()
+    {
+        m_nodes.clear();
+        if (m_chunks.empty())
+            return;
 
-                // Compute actual normal
-                normal_sum /= faces_using;
-                normal_sum.Normalize();
+        // Nodes are split into the quadrants around their center until they hold a single chunk, breadth first so that siblings are contiguous
+        vector<vector<uint32_t>> node_chunks(1);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_chunks.size()); i++)
+        {
+            node_chunks[0].emplace_back(i);
+        }
+        m_nodes.emplace_back();
 
-                // Compute actual tangent
-                tangent_sum /= faces_using;
-                tangent_sum.Normalize();
+        for (uint32_t node = 0; node < m_nodes.size(); node++)
+        {
+            const auto chunks = node_chunks[node];
+            auto aabb = m_chunks[chunks[0]].aabb;
+            for (const auto chunk : chunks)
+            {
+                aabb.Merge(m_chunks[chunk].aabb);
+            }
+            m_nodes[node].aabb = aabb;
 
-                // Write normal to vertex
-                vertices[i].nor[0] = normal_sum.x;
-                vertices[i].nor[1] = normal_sum.y;
-                vertices[i].nor[2] = normal_sum.z;
+            if (chunks.size() == 1)
+            {
+                m_nodes[node].chunk = chunks[0];
+                continue;
+            }
 
-                // Write tangent to vertex
-                vertices[i].tan[0] = tangent_sum.x;
-                vertices[i].tan[1] = tangent_sum.y;
-                vertices[i].tan[2] = tangent_sum.z;
+            vector<uint32_t> quadrants[4];
+            const auto center = aabb.GetCenter();
+            for (const auto chunk : chunks)
+            {
+                const auto chunk_center = m_chunks[chunk].aabb.GetCenter();
+                quadrants[(chunk_center.x < center.x ? 0 : 1) + (chunk_center.z < center.z ? 0 : 2)].emplace_back(chunk);
+            }
 
-                // Reset
-                normal_sum  = Vector3::Zero;
-                tangent_sum = Vector3::Zero;
-                faces_using = 0;
+            // Chunks which all fall in one quadrant (e.g. a row of them) are halved instead
+            if (any_of(begin(quadrants), end(quadrants), [&chunks](const vector<uint32_t>& quadrant) { return quadrant.size() == chunks.size(); }))
+            {
+                for (auto& quadrant : quadrants) { quadrant.clear(); }
+                quadrants[0].assign(chunks.begin(), chunks.begin() + chunks.size() / 2);
+                quadrants[1].assign(chunks.begin() + chunks.size() / 2, chunks.end());
             }
-        };
 
-        m_context->GetSubsystem<Threading>()->Loop(compute_vertex_normals_tangents, vertex_count);
+            m_nodes[node].child_first = static_cast<uint32_t>(m_nodes.size());
+            for (auto& quadrant : quadrants)
+            {
+                if (quadrant.empty())
+                    continue;
 
-        return true;
+                m_nodes.emplace_back();
+                node_chunks.emplace_back(move(quadrant));
+                m_nodes[node].child_count++;
+            }
+        }
     }
 
-    void Terrain::UpdateFromModel(const shared_ptr<Model>& model)
+    void Terrain::QueryChunks(const BoundingBox& aabb, vector<uint32_t>* chunks) const
     {
-        if (!model)
+        if (!chunks || m_nodes.empty())
+            return;
+
+        vector<uint32_t> stack = { 0 };
+        while (!stack.empty())
         {
-            LOG_ERROR_INVALID_PARAMETER();
+            const auto& node = m_nodes[stack.back()];
+            stack.pop_back();
+
+            if (aabb.IsInside(node.aabb) == Outside)
+                continue;
+
+            if (node.child_count == 0)
+            {
+                chunks->emplace_back(node.chunk);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < node.child_count; i++)
+            {
+                stack.emplace_back(node.child_first + i);
+            }
+        }
+    }
+
+    void Terrain::SetStreaming(const bool streaming)
+    {
+        if (m_streaming == streaming)
             return;
+
+        m_streaming = streaming;
+        if (!m_model)
+            return;
+
+        // The model saves it, so that a streamed terrain only reads its submesh table when the world loads
+        m_model->SetSubmeshStreaming(streaming);
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_chunks.size()); i++)
+        {
+            if (!streaming && !m_chunks[i].resident)
+            {
+                ChunkLoad(i);
+            }
+
+            ChunkColliderUpdate(i);
+        }
+    }
+
+    void Terrain::StreamingUpdate()
+    {
+        const auto& camera = m_context->GetSubsystem<Renderer>()->GetCamera();
+        if (!camera)
+            return;
+
+        // Chunks around the camera (in the space of the terrain), nearest first, as many as the budget allows
+        const auto position = camera->GetTransform()->GetPosition() * m_transform->GetMatrix().Inverted();
+        const auto extent   = Vector3(m_streaming_radius);
+        vector<uint32_t> chunks;
+        QueryChunks(BoundingBox(position - extent, position + extent), &chunks);
+
+        vector<pair<float, uint32_t>> wanted;
+        for (const auto chunk : chunks)
+        {
+            const auto distance = _Terrain::distance_to_aabb(position, m_chunks[chunk].aabb);
+            if (distance <= m_streaming_radius)
+            {
+                wanted.emplace_back(distance, chunk);
+            }
+        }
+        sort(wanted.begin(), wanted.end());
+
+        vector<bool> keep(m_chunks.size(), false);
+        uint64_t memory = 0;
+        for (const auto& [distance, chunk] : wanted)
+        {
+            memory += _Terrain::chunk_memory(*m_model->GetSubmesh(m_chunks[chunk].submesh));
+            if (memory > m_streaming_budget)
+                break;
+
+            keep[chunk] = true;
+        }
+
+        // Evict first, so that what loads next fits
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_chunks.size()); i++)
+        {
+            if (m_chunks[i].resident && !keep[i])
+            {
+                ChunkUnload(i);
+            }
         }
 
-        if (shared_ptr<Renderable>& renderable = m_entity->AddComponent<Renderable>())
+        // Load the chunks which finished reading, unless the camera moved away in the meantime
+        vector<Terrain_Streaming_Queue::read> reads;
         {
-            renderable->GeometrySet(
-                "Terrain",
-                0,                                  // index offset
-                model->GetMesh()->Indices_Count(),  // index count
-                0,                                  // vertex offset
-                model->GetMesh()->Vertices_Count(), // vertex count
-                model->GetAabb(),
-                model.get()
-            );
+            lock_guard<mutex> lock(m_streaming_queue->reads_mutex);
+            reads.swap(m_streaming_queue->reads);
+        }
+        for (auto& read : reads)
+        {
+            if (read.generation != m_streaming_generation)
+                continue;
+
+            m_chunks[read.chunk].pending = false;
+            if (read.result && keep[read.chunk])
+            {
+                ChunkLoad(read.chunk, &read.indices, &read.vertices);
+            }
+        }
+
+        // Read the missing ones
+        for (const auto& [distance, chunk] : wanted)
+        {
+            if (!keep[chunk] || m_streaming_queue->pending >= _Terrain::streaming_reads_max)
+                break;
+
+            if (!m_chunks[chunk].resident && !m_chunks[chunk].pending)
+            {
+                ChunkRead(chunk);
+            }
+        }
+    }
 
-            renderable->UseDefaultMaterial();
+    void Terrain::ChunkRead(const uint32_t index)
+    {
+        auto& chunk = m_chunks[index];
+
+        // Chunks which were never saved still have their geometry on the CPU, only their buffers are missing
+        if (m_model->GetSubmesh(chunk.submesh)->chunk_size == 0)
+        {
+            ChunkLoad(index);
+            return;
         }
+
+        chunk.pending = true;
+        m_streaming_queue->pending++;
+        m_context->GetSubsystem<Threading>()->AddTask([queue = m_streaming_queue, model = m_model, submesh = chunk.submesh, index, generation = m_streaming_generation]()
+        {
+            Terrain_Streaming_Queue::read read;
+            read.chunk      = index;
+            read.generation = generation;
+            read.result     = model->SubmeshRead(submesh, &read.indices, &read.vertices);
+
+            {
+                lock_guard<mutex> lock(queue->reads_mutex);
+                queue->reads.emplace_back(move(read));
+            }
+            queue->pending--;
+        });
     }
 
-    void Terrain::UpdateFromVertices(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    void Terrain::ChunkLoad(const uint32_t index, vector<uint32_t>* indices /*= nullptr*/, vector<RHI_Vertex_PosTexNorTan>* vertices /*= nullptr*/)
     {
-        // Add vertices and indices into a model struct (and cache that)
-        if (!m_model)
+        auto& chunk = m_chunks[index];
+        if (chunk.resident)
+            return;
+
+        const auto loaded = (indices && vertices) ? m_model->SubmeshLoad(chunk.submesh, indices, vertices) : m_model->SubmeshLoad(chunk.submesh);
+        if (!loaded)
+            return;
+
+        chunk.resident      = true;
+        m_streaming_memory  += _Terrain::chunk_memory(*m_model->GetSubmesh(chunk.submesh));
+        ChunkColliderUpdate(index);
+    }
+
+    void Terrain::ChunkUnload(const uint32_t index)
+    {
+        auto& chunk = m_chunks[index];
+        if (!chunk.resident)
+            return;
+
+        // Measured while the geometry is still there, chunks which were never saved are measured by it
+        m_streaming_memory  -= min(m_streaming_memory, _Terrain::chunk_memory(*m_model->GetSubmesh(chunk.submesh)));
+        chunk.resident      = false;
+        m_model->SubmeshUnload(chunk.submesh);
+        ChunkColliderUpdate(index);
+    }
+
+    void Terrain::ChunkColliderUpdate(const uint32_t index)
+    {
+        const auto& chunk   = m_chunks[index];
+        const auto entity   = chunk.entity.lock();
+        if (!entity)
+            return;
+
+        // Resident chunks collide, which is all of them unless the terrain streams
+        if (!chunk.resident)
         {
-            // Create new model
-            m_model = make_shared<Model>(m_context);
+            if (entity->HasComponent<RigidBody>())
+            {
+                entity->RemoveComponent<RigidBody>();
+            }
 
-            // Set geometry
-            m_model->AppendGeometry(indices, vertices);
-            m_model->UpdateGeometry();
+            if (entity->HasComponent<Collider>())
+            {
+                entity->RemoveComponent<Collider>();
+            }
 
-            // Set a file path so the model can be used by the resource cache
-            ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>().get();
-            m_model->SetResourceFilePath(resource_cache->GetProjectDirectory() + m_entity->GetName() + "_terrain_" + to_string(m_id) + string(EXTENSION_MODEL));
-            m_model = resource_cache->Cache(m_model);
+            return;
         }
-        else
+
+        // The full detail grid comes first in the vertices of a chunk, row by row
+        const auto& vertices    = m_model->GetSubmesh(chunk.submesh)->mesh->Vertices_Get();
+        const auto vertex_count = static_cast<size_t>(chunk.width) * chunk.length;
+        if (vertices.size() < vertex_count)
+            return;
+
+        vector<float> heights(vertex_count);
+        float height_min = numeric_limits<float>::max();
+        float height_max = numeric_limits<float>::lowest();
+        for (size_t i = 0; i < vertex_count; i++)
         {
-            // Update with new geometry
-            m_model->Clear();
-            m_model->AppendGeometry(indices, vertices);
-            m_model->UpdateGeometry();
+            heights[i] = vertices[i].pos[1];
+            height_min = min(height_min, heights[i]);
+            height_max = max(height_max, heights[i]);
         }
 
-        UpdateFromModel(m_model);
+        if (const auto collider = entity->AddComponent<Collider>())
+        {
+            const auto center = chunk.aabb.GetCenter();
+            collider->SetCenter(Vector3(center.x, (height_min + height_max) * 0.5f, center.z));
+            collider->SetHeightfield(move(heights), chunk.width, chunk.length);
+        }
+
+        if (const auto rigid_body = entity->AddComponent<RigidBody>())
+        {
+            rigid_body->SetMass(0.0f);
+        }
     }
 }
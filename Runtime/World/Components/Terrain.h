@@ -25,16 +25,40 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "IComponent.h"
 #include <atomic>
 #include "../../RHI/RHI_Definition.h"
+#include "../../Math/BoundingBox.h"
 //===================================
 
 namespace Spartan
 {
     class Model;
+    struct Terrain_Streaming_Queue;
     namespace Math
     {
         class Vector3;
     }
 
+    // A square of the terrain, drawn, culled and shadowed as its own renderable (a child entity), with LODs of its own.
+    // It's also the tile the terrain streams, heights and normals live in its submesh (a chunk of the model file).
+    struct Terrain_Chunk
+    {
+        uint32_t submesh = 0; // In the terrain model
+        Math::BoundingBox aabb;
+        std::weak_ptr<Entity> entity;
+        uint32_t width      = 0;        // Grid vertices along x
+        uint32_t length     = 0;        // Grid vertices along z
+        bool resident       = false;    // Its geometry is loaded
+        bool pending        = false;    // Being read from disk
+    };
+
+    // Quadtree over the chunks, a leaf holds a single chunk
+    struct Terrain_Node
+    {
+        Math::BoundingBox aabb;
+        uint32_t child_first    = 0; // Children are contiguous
+        uint32_t child_count    = 0;
+        uint32_t chunk          = 0; // Leaves only
+    };
+
     class SPARTAN_CLASS Terrain : public IComponent
     {
     public:
@@ -43,6 +67,7 @@ namespace Spartan
 
         //= IComponent ===============================
         void OnInitialize() override;
+        void OnTick(float delta_time) override;
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
         //============================================
@@ -61,19 +86,49 @@ namespace Spartan
 
         void GenerateAsync();
 
+        // Quads per chunk side, a power of two (takes effect on the next generation)
+        auto GetChunkSize() const                   { return m_chunk_size; }
+        void SetChunkSize(const uint32_t size)      { m_chunk_size = size; }
+        const auto& GetChunks() const               { return m_chunks; }
+
+        // Chunks whose bounding box touches aabb (in the space of the terrain)
+        void QueryChunks(const Math::BoundingBox& aabb, std::vector<uint32_t>* chunks) const;
+
+        // Streaming keeps the chunks within a radius around the camera resident, nearest first and as long as they fit the memory budget.
+        // Chunks are read from the model file on workers and only resident ones get a (heightfield) collider. Without it every chunk is resident.
+        auto GetStreaming() const                       { return m_streaming; }
+        void SetStreaming(bool streaming);
+        auto GetStreamingRadius() const                 { return m_streaming_radius; }
+        void SetStreamingRadius(const float radius)     { m_streaming_radius = radius; }
+        auto GetStreamingBudget() const                 { return m_streaming_budget; }
+        void SetStreamingBudget(const uint64_t budget)  { m_streaming_budget = budget; }
+        auto GetStreamingMemoryUsage() const            { return m_streaming_memory; }
+
     private:
         bool GeneratePositions(std::vector<Math::Vector3>& positions, const std::vector<std::byte>& height_map);
-        bool GenerateVerticesIndices(const std::vector<Math::Vector3>& positions, std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
-        bool GenerateNormalTangents(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        bool GenerateVertices(const std::vector<Math::Vector3>& positions, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        bool GenerateNormalTangents(std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        bool GenerateChunks(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::shared_ptr<Model>* model);
+        void GenerateFinish();
         void UpdateFromModel(const std::shared_ptr<Model>& model);
-        void UpdateFromVertices(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        void ChunksClear();
+        void QuadtreeBuild();
+        void StreamingUpdate();
+        void ChunkRead(uint32_t index);
+        void ChunkLoad(uint32_t index, std::vector<uint32_t>* indices = nullptr, std::vector<RHI_Vertex_PosTexNorTan>* vertices = nullptr);
+        void ChunkUnload(uint32_t index);
+        void ChunkColliderUpdate(uint32_t index);
 
         uint32_t m_width                            = 0;
         uint32_t m_height                           = 0;
+        uint32_t m_chunk_size                       = 64;
         float m_min_y                               = 0.0f;
         float m_max_y                               = 30.0f;
         float m_vertex_density                      = 1.0f;
         bool m_is_generating                        = false;
+        std::atomic<bool> m_is_generated            = false;    // The generation task is done, m_model_generated holds its result (if it succeeded)
+        std::shared_ptr<Model> m_model_generated;
+        bool m_is_deserialized                      = false;    // Deserialized on the world loading thread, the chunks are updated from the model on the next tick
         uint64_t m_vertex_count                     = 0;
         uint64_t m_face_count                       = 0;
         std::atomic<uint64_t> m_progress_jobs_done  = 0;
@@ -81,5 +136,15 @@ namespace Spartan
         std::string m_progress_desc;
         std::shared_ptr<RHI_Texture2D> m_height_map;
         std::shared_ptr<Model> m_model;
+        std::vector<Terrain_Chunk> m_chunks;
+        std::vector<Terrain_Node> m_nodes;
+
+        // Streaming
+        bool m_streaming                            = false;
+        float m_streaming_radius                    = 512.0f;
+        uint64_t m_streaming_budget                 = 256 * 1024 * 1024;
+        uint64_t m_streaming_memory                 = 0;
+        uint32_t m_streaming_generation             = 0; // Reads which were issued for older chunks are dropped
+        std::shared_ptr<Terrain_Streaming_Queue> m_streaming_queue;
     };
 }
@@ -66,7 +66,6 @@ namespace Spartan
 		stream->Write(m_rotationLocal);
 		stream->Write(m_scaleLocal);
 		stream->Write(m_lookAt);
-		stream->Write(m_parent ? m_parent->GetEntity_PtrRaw()->GetId() : 0);
 	}
 
 	void Transform::Deserialize(FileStream* stream)
@@ -75,18 +74,9 @@ namespace Spartan
 		stream->Read(&m_rotationLocal);
 		stream->Read(&m_scaleLocal);
 		stream->Read(&m_lookAt);
-		uint32_t parententity_id = 0;
-		stream->Read(&parententity_id);
 
-		if (parententity_id != 0)
-		{
-			if (const auto parent = GetContext()->GetSubsystem<World>()->EntityGetById(parententity_id))
-			{
-				parent->GetTransform_PtrRaw()->AddChild(this);
-			}
-		}
-
-		UpdateTransform();
+		// The hierarchy is serialized by the world, which also updates the transforms once it's resolved
+		m_matrixLocal = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
 	}
 	//===============================================================================================
 	void Transform::UpdateTransform()
@@ -293,6 +283,16 @@ namespace Spartan
 		UpdateTransform();
 	}
 
+	void Transform::SetParent_NoResolve(Transform* new_parent)
+	{
+		m_parent = new_parent;
+
+		if (m_parent)
+		{
+			m_parent->m_children.emplace_back(this);
+		}
+	}
+
 	void Transform::AddChild(Transform* child)
 	{
 		if (!child)
@@ -88,6 +88,7 @@ namespace Spartan
 		bool IsRoot() const		{ return !HasParent(); }
 		bool HasParent() const	{ return m_parent; }
 		void SetParent(Transform* new_parent);
+		void SetParent_NoResolve(Transform* new_parent); // no validation and no hierarchy resolving, for loaders which know the entire hierarchy upfront
 		void BecomeOrphan();
 		bool HasChildren() const			{ return GetChildrenCount() > 0 ? true : false; }
 		uint32_t GetChildrenCount() const	{ return static_cast<uint32_t>(m_children.size()); }
@@ -22,7 +22,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =================================
 #include "Entity.h"
 #include "World.h"
-#include "../IO/FileStream.h"
 #include "../Core/Context.h"
 #include "../World/Components/Camera.h"
 #include "../World/Components/Collider.h"
@@ -36,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/AudioSource.h"
 #include "../World/Components/AudioListener.h"
 #include "../World/Components/Terrain.h"
+#include "../World/Components/Animator.h"
 //============================================
 
 //= NAMESPACES =====
@@ -150,130 +150,6 @@ namespace Spartan
 		}
 	}
 
-	void Entity::Serialize(FileStream* stream)
-	{
-        // BASIC DATA
-        {
-            stream->Write(m_is_active);
-            stream->Write(m_hierarchy_visibility);
-            stream->Write(GetId());
-            stream->Write(m_name);
-        }
-
-		// COMPONENTS
-        {
-            stream->Write(static_cast<uint32_t>(m_components.size()));
-            for (const auto& component : m_components)
-            {
-                stream->Write(static_cast<uint32_t>(component->GetType()));
-                stream->Write(component->GetId());
-            }
-
-            for (const auto& component : m_components)
-            {
-                component->Serialize(stream);
-            }
-        }
-
-        // CHILDREN
-        {
-            auto children = GetTransform_PtrRaw()->GetChildren();
-
-            // Children count
-            stream->Write(static_cast<uint32_t>(children.size()));
-
-            // Children IDs
-            for (const auto& child : children)
-            {
-                stream->Write(child->GetId());
-            }
-
-            // Children
-            for (const auto& child : children)
-            {
-                if (child->GetEntity_PtrRaw())
-                {
-                    child->GetEntity_PtrRaw()->Serialize(stream);
-                }
-                else
-                {
-                    LOG_ERROR("Aborting , child entity is nullptr.");
-                    break;
-                }
-            }
-        }
-	}
-
-	void Entity::Deserialize(FileStream* stream, Transform* parent)
-	{
-        // BASIC DATA
-        {
-            stream->Read(&m_is_active);
-            stream->Read(&m_hierarchy_visibility);
-            stream->Read(&m_id);
-            stream->Read(&m_name);
-        }
-
-        // COMPONENTS
-        {
-            const auto component_count = stream->ReadAs<uint32_t>();
-            for (uint32_t i = 0; i < component_count; i++)
-            {
-                uint32_t type   = ComponentType_Unknown;
-                uint32_t id     = 0;
-
-                stream->Read(&type);	// load component's type
-                stream->Read(&id);		// load component's id
-
-                auto component = AddComponent(static_cast<ComponentType>(type), id);
-            }
-
-            // Sometimes there are component dependencies, e.g. a collider that needs
-            // to set it's shape to a rigibody. So, it's important to first create all 
-            // the components (like above) and then deserialize them (like here).
-            for (const auto& component : m_components)
-            {
-                component->Deserialize(stream);
-            }
-
-            // Set the transform's parent
-            if (m_transform)
-            {
-                m_transform->SetParent(parent);
-            }
-        }
-
-        // CHILDREN
-        {
-            // Children count
-            const auto children_count = stream->ReadAs<uint32_t>();
-
-            // Children IDs
-            auto scene = m_context->GetSubsystem<World>();
-            vector<std::weak_ptr<Entity>> children;
-            for (uint32_t i = 0; i < children_count; i++)
-            {
-                auto child = scene->EntityCreate();
-                child->SetId(stream->ReadAs<uint32_t>());
-                children.emplace_back(child);
-            }
-
-            // Children
-            for (const auto& child : children)
-            {
-                child.lock()->Deserialize(stream, GetTransform_PtrRaw());
-            }
-
-            if (m_transform)
-            {
-                m_transform->AcquireChildren();
-            }
-        }
-
-		// Make the scene resolve
-		FIRE_EVENT(Event_World_Resolve_Pending);
-	}
-
     shared_ptr<IComponent> Entity::AddComponent(const ComponentType type, uint32_t id /*= 0*/)
     {
         // This is the only hardcoded part regarding components. It's 
@@ -293,6 +169,7 @@ namespace Spartan
             case ComponentType_Environment:		component = AddComponent<Environment>(id);		break;
             case ComponentType_Transform:		component = AddComponent<Transform>(id);	    break;
             case ComponentType_Terrain:		    component = AddComponent<Terrain>(id);	        break;
+            case ComponentType_Animator:		component = AddComponent<Animator>(id);	        break;
             case ComponentType_Unknown:														    break;
             default:																		    break;
         }
@@ -43,8 +43,6 @@ namespace Spartan
 		void Start();
 		void Stop();
 		void Tick(float delta_time);
-		void Serialize(FileStream* stream);
-		void Deserialize(FileStream* stream, Transform* parent);
 
 		//= PROPERTIES ===================================================================================================
 		const std::string& GetName() const								{ return m_name; }
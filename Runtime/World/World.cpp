@@ -21,6 +21,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==========================
 #include "World.h"
+#include <atomic>
+#include <limits>
+#include <unordered_map>
 #include "Entity.h"
 #include "Components/Transform.h"
 #include "Components/Camera.h"
@@ -35,6 +38,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Profiling/Profiler.h"
 #include "../Rendering/Renderer.h"
 #include "../Input/Input.h"
+#include "../Physics/Physics.h"
+#include "../Threading/Threading.h"
+#include "../Scripting/Scripting.h"
 //=====================================
 
 //= NAMESPACES ================
@@ -44,6 +50,143 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	namespace _World
+	{
+		// A world file is a header, a chunk table and the chunks. Readers skip chunks they don't know (or which are newer than
+		// what they can read), so a change in the layout of a component only affects the chunk of that component type.
+		static const uint32_t file_magic	= 0x44575053; // "SPWD"
+		static const uint32_t file_version	= 1;
+		static const uint32_t chunk_version	= 1;
+		static const uint32_t no_parent		= numeric_limits<uint32_t>::max();
+
+		enum Chunk_Type : uint32_t
+		{
+			Chunk_Strings,		// String table
+			Chunk_Entities,		// Entity index, the properties, parent and components of every entity (parents always precede their children)
+			Chunk_Components	// Every component of a given type, a record per component: component slot (in entity index order), size, data
+		};
+
+		struct chunk
+		{
+			uint32_t type			= Chunk_Strings;
+			uint32_t component_type	= ComponentType_Unknown;
+			uint32_t version		= chunk_version;
+			uint64_t offset			= 0;
+			uint64_t size			= 0;
+			vector<std::byte> data;			// when saving
+			const std::byte* span = nullptr;	// when loading, points into the memory mapped file
+		};
+		static const uint64_t header_size		= sizeof(uint32_t) * 3;
+		static const uint64_t chunk_entry_size	= sizeof(uint32_t) * 3 + sizeof(uint64_t) * 2;
+
+		struct record
+		{
+			uint32_t slot;
+			uint32_t size;
+			uint64_t offset;
+		};
+
+		// Component types whose deserialization only touches the component itself, they are deserialized concurrently
+		static bool is_thread_safe(const ComponentType type)
+		{
+			return
+				type == ComponentType_Transform		||
+				type == ComponentType_Camera		||
+				type == ComponentType_Light			||
+				type == ComponentType_AudioListener	||
+				type == ComponentType_Environment	||
+				type == ComponentType_Animator;
+		}
+
+		// The rest talk to the resource cache, physics, scripting etc, so they are deserialized one after the other, in this order
+		static const ComponentType serial_order[] =
+		{
+			ComponentType_Renderable,
+			ComponentType_Terrain,
+			ComponentType_Collider,
+			ComponentType_RigidBody,
+			ComponentType_Constraint,
+			ComponentType_AudioSource,
+			ComponentType_Script
+		};
+
+		static bool is_supported(const chunk& chunk)
+		{
+			if (chunk.version > chunk_version)
+				return false;
+
+			return chunk.type == Chunk_Strings || chunk.type == Chunk_Entities || (chunk.type == Chunk_Components && chunk.component_type < ComponentType_Unknown);
+		}
+
+		// Runs job(i) for every i in [0, count) on the job system. Jobs are pulled one at a time, so a few large ones can't stall the rest.
+		template <typename Function>
+		static void parallel_for_each(Threading* threading, const uint32_t count, Function&& job)
+		{
+			atomic<uint32_t> next = 0;
+			threading->Loop([&next, &job, count](uint32_t, uint32_t)
+			{
+				for (uint32_t i = next++; i < count; i = next++)
+				{
+					job(i);
+				}
+			}, count);
+		}
+
+		static const uint64_t entity_size_min	= sizeof(uint32_t) * 4 + sizeof(bool) * 2;	// id, name, active, visible, parent, component count
+		static const uint64_t component_size	= sizeof(uint32_t) * 2;						// type and id, in the entity index
+		static const uint64_t record_size_min	= sizeof(uint32_t) * 2;						// slot and size
+
+		// Counts come from the file, so a corrupt one could claim billions of entries. Every entry takes
+		// at least entry_size_min bytes, which bounds the count by what is left of the stream.
+		static uint32_t read_count(FileStream& stream, const uint64_t stream_size, const uint64_t entry_size_min)
+		{
+			const auto count		= stream.ReadAs<uint32_t>();
+			const auto position		= stream.GetPosition();
+			const auto count_max	= position < stream_size ? (stream_size - position) / entry_size_min : 0;
+			if (count > count_max)
+			{
+				LOGF_WARNING("Count of %d exceeds the %d entries that the data can hold, the file is corrupt", count, static_cast<uint32_t>(count_max));
+				return static_cast<uint32_t>(count_max);
+			}
+
+			return count;
+		}
+
+		static vector<record> read_records(const chunk& chunk)
+		{
+			FileStream stream(chunk.span, chunk.size);
+			vector<record> records(read_count(stream, chunk.size, record_size_min));
+			for (auto& record : records)
+			{
+				record.slot		= stream.ReadAs<uint32_t>();
+				record.size		= stream.ReadAs<uint32_t>();
+				record.offset	= stream.GetPosition();
+				stream.Skip(record.size);
+			}
+
+			return records;
+		}
+
+		static void deserialize_records(const chunk& chunk, const vector<record>& records, const vector<IComponent*>& components, const uint32_t start, const uint32_t end)
+		{
+			for (uint32_t i = start; i < end; i++)
+			{
+				const auto& record = records[i];
+				if (record.slot >= components.size() || record.offset + record.size > chunk.size)
+					continue;
+
+				// Every record is read through a stream of its own, so a component which reads less (or more) than it was written can't derail
+				// the rest. Reading past the end of a record yields zeros, which is what fields added after the record was written read as.
+				auto component = components[record.slot];
+				if (component && component->GetType() == chunk.component_type)
+				{
+					FileStream stream(chunk.span + record.offset, record.size);
+					component->Deserialize(&stream);
+				}
+			}
+		}
+	}
+
 	World::World(Context* context) : ISubsystem(context)
 	{
 		// Subscribe to events
@@ -57,12 +200,16 @@ namespace Spartan
 		Unload();
         m_input     = nullptr;
         m_profiler  = nullptr;
+        m_physics   = nullptr;
+        m_scripting = nullptr;
 	}
 
 	bool World::Initialize()
 	{
 		m_input		= m_context->GetSubsystem<Input>().get();
 		m_profiler	= m_context->GetSubsystem<Profiler>().get();
+		m_physics	= m_context->GetSubsystem<Physics>().get();
+		m_scripting	= m_context->GetSubsystem<Scripting>().get();
 
 		CreateCamera();
 		CreateEnvironment();
@@ -84,6 +231,9 @@ namespace Spartan
 
         TIME_BLOCK_START_CPU(m_profiler);
 
+        // Physics steps while the renderer draws, wait for it so that components can touch rigid bodies
+        m_physics->StepWait();
+
         // Tick entities
 		{
             // Detect game toggling
@@ -114,6 +264,9 @@ namespace Spartan
             {
                 entity->Tick(delta_time);
             }
+
+            // Scripts, batched per script class
+            m_scripting->ExecuteUpdates(delta_time);
 		}
 
         if (m_is_dirty)
@@ -178,31 +331,156 @@ namespace Spartan
 			return false;
 		}
 
-		// Only save root entities as they will also save their descendants
-		auto root_actors = EntityGetRoots();
-		const auto root_entity_count = static_cast<uint32_t>(root_actors.size());
+		// Flatten the hierarchy, depth first, so that parents always precede their children
+		vector<Entity*> entities;
+		vector<uint32_t> parents;
+		{
+			vector<pair<Transform*, uint32_t>> stack;
+			auto roots = EntityGetRoots();
+			for (auto it = roots.rbegin(); it != roots.rend(); it++)
+			{
+				stack.emplace_back((*it)->GetTransform_PtrRaw(), _World::no_parent);
+			}
 
-		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
+			while (!stack.empty())
+			{
+				const auto [transform, parent] = stack.back();
+				stack.pop_back();
+
+				const auto index = static_cast<uint32_t>(entities.size());
+				entities.emplace_back(transform->GetEntity_PtrRaw());
+				parents.emplace_back(parent);
+
+				const auto& children = transform->GetChildren();
+				for (auto it = children.rbegin(); it != children.rend(); it++)
+				{
+					stack.emplace_back(*it, index);
+				}
+			}
+		}
 
-		// Save root entity count
-		file->Write(root_entity_count);
+		vector<_World::chunk> chunks(2);
+		chunks[0].type = _World::Chunk_Strings;
+		chunks[1].type = _World::Chunk_Entities;
 
-		// Save root entity IDs
-		for (const auto& root : root_actors)
+		// Entity index and string table
+		vector<vector<pair<uint32_t, IComponent*>>> components(ComponentType_Unknown); // per type: slot and component
 		{
-			file->Write(root->GetId());
+			vector<string> strings;
+			unordered_map<string, uint32_t> string_indices;
+
+			FileStream stream(&chunks[1].data, FileStream_Write);
+			stream.Write(static_cast<uint32_t>(entities.size()));
+
+			uint32_t slot = 0;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+			{
+				const auto entity = entities[i];
+
+				// Names repeat a lot, so they are stored once
+				const auto it_string = string_indices.emplace(entity->GetName(), static_cast<uint32_t>(strings.size())).first;
+				if (it_string->second == strings.size())
+				{
+					strings.emplace_back(entity->GetName());
+				}
+
+				stream.Write(entity->GetId());
+				stream.Write(it_string->second);
+				stream.Write(entity->IsActive());
+				stream.Write(entity->IsVisibleInHierarchy());
+				stream.Write(parents[i]);
+
+				const auto& entity_components = entity->GetAllComponents();
+				stream.Write(static_cast<uint32_t>(entity_components.size()));
+				for (const auto& component : entity_components)
+				{
+					stream.Write(static_cast<uint32_t>(component->GetType()));
+					stream.Write(component->GetId());
+
+					if (component->GetType() < ComponentType_Unknown)
+					{
+						components[component->GetType()].emplace_back(slot, component.get());
+					}
+					slot++;
+				}
+			}
+
+			FileStream(&chunks[0].data, FileStream_Write).Write(strings);
+		}
+
+		// Component chunks
+		for (uint32_t type = 0; type < ComponentType_Unknown; type++)
+		{
+			if (components[type].empty())
+				continue;
+
+			auto& chunk				= chunks.emplace_back();
+			chunk.type				= _World::Chunk_Components;
+			chunk.component_type	= type;
 		}
 
-		// Save root entities
-		for (const auto& root : root_actors)
+		ProgressReport::Get().SetJobCount(g_progress_world, static_cast<int>(chunks.size()));
+
+		// Serialize the components, a chunk per task
+		mutex mutex_progress;
+		_World::parallel_for_each(m_context->GetSubsystem<Threading>().get(), static_cast<uint32_t>(chunks.size()), [&chunks, &components, &mutex_progress](const uint32_t i)
 		{
-			root->Serialize(file.get());
+			auto& chunk = chunks[i];
+			if (chunk.type == _World::Chunk_Components)
+			{
+				const auto& chunk_components = components[chunk.component_type];
+
+				FileStream stream(&chunk.data, FileStream_Write);
+				stream.Write(static_cast<uint32_t>(chunk_components.size()));
+				for (const auto& [slot, component] : chunk_components)
+				{
+					stream.Write(slot);
+
+					// Reserve the size, serialize, then go back and write the size
+					const auto position_size = stream.GetPosition();
+					stream.Write(static_cast<uint32_t>(0));
+					component->Serialize(&stream);
+					const auto position_end = stream.GetPosition();
+					stream.Seek(position_size);
+					stream.Write(static_cast<uint32_t>(position_end - position_size - sizeof(uint32_t)));
+					stream.Seek(position_end);
+				}
+			}
+
+			lock_guard<mutex> lock(mutex_progress);
 			ProgressReport::Get().IncrementJobsDone(g_progress_world);
+		});
+
+		// Header
+		file->Write(_World::file_magic);
+		file->Write(_World::file_version);
+		file->Write(static_cast<uint32_t>(chunks.size()));
+
+		// Chunk table
+		auto offset = _World::header_size + _World::chunk_entry_size * chunks.size();
+		for (auto& chunk : chunks)
+		{
+			chunk.offset	= offset;
+			chunk.size		= chunk.data.size();
+			offset			+= chunk.size;
+
+			file->Write(chunk.type);
+			file->Write(chunk.component_type);
+			file->Write(chunk.version);
+			file->Write(chunk.offset);
+			file->Write(chunk.size);
+		}
+
+		// Chunks
+		for (const auto& chunk : chunks)
+		{
+			file->WriteBytes(chunk.data.data(), chunk.data.size());
 		}
+		file->Close();
 
 		// Finish with progress report and timer
 		ProgressReport::Get().SetIsLoading(g_progress_world, false);
-		LOG_INFO("Saving took " + to_string(static_cast<int>(timer.GetElapsedTimeMs())) + " ms");
+		LOGF_INFO("Saving %d entities took %d ms", static_cast<int>(entities.size()), static_cast<int>(timer.GetElapsedTimeMs()));
 
 		// Notify subsystems waiting for us to finish
 		FIRE_EVENT(Event_World_Saved);
@@ -230,39 +508,226 @@ namespace Spartan
 		// Unload current entities
 		Unload();
 
-		// Read all the resource file paths
-		auto file = make_unique<FileStream>(file_path, FileStream_Read);
-		if (!file->IsOpen())
+		// On failure, resume ticking the (now empty) world
+		const auto fail = [this]()
+		{
+			ProgressReport::Get().SetIsLoading(g_progress_world, false);
+			m_state = Ticking;
 			return false;
+		};
+
+		// Read the header and the chunk table, the file stays mapped until loading is done
+		vector<_World::chunk> chunks;
+		auto file = make_unique<FileStream>(file_path, FileStream_Read);
+		{
+			if (!file->IsOpen())
+				return fail();
+
+			if (file->ReadAs<uint32_t>() != _World::file_magic)
+			{
+				// Worlds from before the chunked format start with their root entity count. Their components were written back to back
+				// without sizes, in layouts which have changed since, so there is no reliable way to read them anymore.
+				LOGF_ERROR("\"%s\" is not a world, or it was saved in the unversioned format of older engine versions which can't be migrated. Rebuild the world (re-import its models) and save it again.", file_path.c_str());
+				return fail();
+			}
+
+			const auto version = file->ReadAs<uint32_t>();
+			if (version > _World::file_version)
+			{
+				LOGF_ERROR("\"%s\" was saved by a newer version of the engine (format version %d)", file_path.c_str(), version);
+				return fail();
+			}
+
+			// The whole table has to be in the file, which also bounds the chunk count
+			const auto chunk_count	= file->ReadAs<uint32_t>();
+			const auto table		= file->ReadSpan(_World::chunk_entry_size * chunk_count);
+			if (!table)
+			{
+				LOGF_ERROR("\"%s\" is truncated, its chunk table claims %d chunks", file_path.c_str(), chunk_count);
+				return fail();
+			}
+
+			FileStream stream(table, _World::chunk_entry_size * chunk_count);
+			chunks.resize(chunk_count);
+			for (auto& chunk : chunks)
+			{
+				stream.Read(&chunk.type);
+				stream.Read(&chunk.component_type);
+				stream.Read(&chunk.version);
+				stream.Read(&chunk.offset);
+				stream.Read(&chunk.size);
+			}
+
+			// Chunks are read in place, unknown chunks are never touched
+			for (auto& chunk : chunks)
+			{
+				if (!_World::is_supported(chunk))
+				{
+					LOGF_WARNING("Skipping unknown chunk (type %d, component type %d, version %d)", chunk.type, chunk.component_type, chunk.version);
+					continue;
+				}
+
+				file->Seek(chunk.offset);
+				chunk.span = file->ReadSpan(chunk.size);
+				if (!chunk.span)
+				{
+					LOGF_WARNING("Skipping truncated chunk (type %d, component type %d)", chunk.type, chunk.component_type);
+				}
+			}
+		}
 
 		m_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
 
 		// Notify subsystems that need to load data
 		FIRE_EVENT(Event_World_Load);
 
-		// Load root entity count
-        const auto root_entity_count = file->ReadAs<uint32_t>();
+		auto threading = m_context->GetSubsystem<Threading>().get();
+		ProgressReport::Get().SetJobCount(g_progress_world, static_cast<int>(chunks.size()));
+
+		_World::chunk* chunk_strings	= nullptr;
+		_World::chunk* chunk_entities	= nullptr;
+		vector<_World::chunk*> chunks_components(ComponentType_Unknown, nullptr);
+		for (auto& chunk : chunks)
+		{
+			if (!chunk.span)
+				continue;
 
-		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
+			chunk_strings							= (chunk.type == _World::Chunk_Strings)		? &chunk : chunk_strings;
+			chunk_entities							= (chunk.type == _World::Chunk_Entities)	? &chunk : chunk_entities;
+			if (chunk.type == _World::Chunk_Components)
+			{
+				chunks_components[chunk.component_type] = &chunk;
+			}
+		}
 
-		// Load root entity IDs
-		for (uint32_t i = 0; i < root_entity_count; i++)
+		if (!chunk_strings || !chunk_entities)
 		{
-			auto& entity = EntityCreate();
-			entity->SetId(file->ReadAs<uint32_t>());
+			LOGF_ERROR("\"%s\" is missing its entity index", file_path.c_str());
+			return fail();
 		}
 
-		// Serialize root entities
-		for (uint32_t i = 0; i < root_entity_count; i++)
+		// Create the entities and their components
+		vector<IComponent*> components; // in entity index order, records refer to these by slot
+		vector<uint32_t> parents;
 		{
-			m_entities[i]->Deserialize(file.get(), nullptr);
+			vector<string> strings;
+			FileStream(chunk_strings->span, chunk_strings->size).Read(&strings);
+
+			FileStream stream(chunk_entities->span, chunk_entities->size);
+			const auto entity_count = _World::read_count(stream, chunk_entities->size, _World::entity_size_min);
+			m_entities.reserve(entity_count);
+			parents.reserve(entity_count);
+
+			vector<pair<uint32_t, uint32_t>> entity_components; // type and id
+			for (uint32_t i = 0; i < entity_count; i++)
+			{
+				const auto id					= stream.ReadAs<uint32_t>();
+				const auto name_index			= stream.ReadAs<uint32_t>();
+				const auto is_active			= stream.ReadAs<bool>();
+				const auto is_visible			= stream.ReadAs<bool>();
+				const auto parent				= stream.ReadAs<uint32_t>();
+				const auto component_count		= _World::read_count(stream, chunk_entities->size, _World::component_size);
+
+				// Read the components first, so the entity can be created with the transform it was saved with
+				uint32_t transform_id = 0;
+				entity_components.resize(component_count);
+				for (auto& [type, component_id] : entity_components)
+				{
+					type			= stream.ReadAs<uint32_t>();
+					component_id	= stream.ReadAs<uint32_t>();
+					transform_id	= (type == ComponentType_Transform) ? component_id : transform_id;
+				}
+
+				auto& entity = m_entities.emplace_back(make_shared<Entity>(m_context, transform_id));
+				entity->SetId(id);
+				entity->SetName(name_index < strings.size() ? strings[name_index] : string());
+				entity->SetActive(is_active);
+				entity->SetHierarchyVisibility(is_visible);
+				parents.emplace_back(parent < i ? parent : _World::no_parent);
+
+				// It's important to first create all the components and then deserialize them, as 
+				// there are dependencies, e.g. a collider that needs to set it's shape to a rigibody.
+				for (const auto& [type, component_id] : entity_components)
+				{
+					components.emplace_back(type < ComponentType_Unknown ? entity->AddComponent(static_cast<ComponentType>(type), component_id).get() : nullptr);
+				}
+			}
+		}
+
+		mutex mutex_progress;
+		const auto chunk_done = [&mutex_progress]()
+		{
+			lock_guard<mutex> lock(mutex_progress);
 			ProgressReport::Get().IncrementJobsDone(g_progress_world);
+		};
+		chunk_done(); // strings
+		chunk_done(); // entities
+
+		// Transforms go first (and in parallel), as other components may depend on them
+		if (const auto chunk = chunks_components[ComponentType_Transform])
+		{
+			const auto records = _World::read_records(*chunk);
+			threading->Loop([chunk, &records, &components](uint32_t start, uint32_t end)
+			{
+				_World::deserialize_records(*chunk, records, components, start, end);
+			}, static_cast<uint32_t>(records.size()));
+			chunk_done();
+		}
+
+		// Resolve the hierarchy and the world transforms
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_entities.size()); i++)
+		{
+			if (parents[i] != _World::no_parent)
+			{
+				m_entities[i]->GetTransform_PtrRaw()->SetParent_NoResolve(m_entities[parents[i]]->GetTransform_PtrRaw());
+			}
 		}
+		for (const auto& entity : m_entities)
+		{
+			if (entity->GetTransform_PtrRaw()->IsRoot())
+			{
+				entity->GetTransform_PtrRaw()->UpdateTransform();
+			}
+		}
+
+		// The rest of the chunks, the ones which are not thread safe are deserialized by the first job, one after the other
+		vector<_World::chunk*> jobs = { nullptr };
+		for (uint32_t type = 0; type < ComponentType_Unknown; type++)
+		{
+			if (chunks_components[type] && type != ComponentType_Transform && _World::is_thread_safe(static_cast<ComponentType>(type)))
+			{
+				jobs.emplace_back(chunks_components[type]);
+			}
+		}
+
+		_World::parallel_for_each(threading, static_cast<uint32_t>(jobs.size()), [&jobs, &chunks_components, &components, &chunk_done](const uint32_t i)
+		{
+			const auto deserialize = [&components, &chunk_done](_World::chunk* chunk)
+			{
+				const auto records = _World::read_records(*chunk);
+				_World::deserialize_records(*chunk, records, components, 0, static_cast<uint32_t>(records.size()));
+				chunk_done();
+			};
+
+			if (jobs[i])
+			{
+				deserialize(jobs[i]);
+				return;
+			}
+
+			for (const auto type : _World::serial_order)
+			{
+				if (chunks_components[type])
+				{
+					deserialize(chunks_components[type]);
+				}
+			}
+		});
 
 		m_is_dirty	= true;
 		m_state		= Ticking;
 		ProgressReport::Get().SetIsLoading(g_progress_world, false);	
-		LOG_INFO("Loading took " + to_string(static_cast<int>(timer.GetElapsedTimeMs())) + " ms");	
+		LOGF_INFO("Loading %d entities took %d ms", static_cast<int>(m_entities.size()), static_cast<int>(timer.GetElapsedTimeMs()));
 
 		FIRE_EVENT(Event_World_Loaded);
 		return true;
@@ -35,6 +35,8 @@ namespace Spartan
 	class Light;
 	class Input;
 	class Profiler;
+	class Physics;
+	class Scripting;
 
 	enum Scene_State
 	{
@@ -87,6 +89,8 @@ namespace Spartan
         Scene_State m_state         = Ticking;	
         Input* m_input              = nullptr;
         Profiler* m_profiler        = nullptr;
+        Physics* m_physics          = nullptr;
+        Scripting* m_scripting      = nullptr;
 
         std::vector<std::shared_ptr<Entity>> m_entities;
 	};
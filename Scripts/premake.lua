@@ -20,8 +20,10 @@
 SOLUTION_NAME 		= "Spartan"
 EDITOR_NAME 		= "Editor"
 RUNTIME_NAME 		= "Runtime"
+BULLET_NAME 		= "Bullet"
 EDITOR_DIR			= "../" .. EDITOR_NAME
 RUNTIME_DIR			= "../" .. RUNTIME_NAME
+BULLET_DIR			= "../ThirdParty/Bullet_2.88"
 LIBRARY_DIR 		= "../ThirdParty/libraries"
 DEBUG_FORMAT		= "c7"
 TARGET_DIR_RELEASE 	= "../Binaries/Release"
@@ -41,7 +43,8 @@ solution (SOLUTION_NAME)
 	defines
 	{
 		"SPARTAN_RUNTIME_STATIC=1",
-		"SPARTAN_RUNTIME_SHARED=0"
+		"SPARTAN_RUNTIME_SHARED=0",
+		"BT_THREADSAFE=1" -- Bullet's headers change with it, so everything which includes them has to agree
 	}
 	
 	filter { "platforms:x64" }
@@ -61,9 +64,43 @@ solution (SOLUTION_NAME)
 		symbols "Off"	
 		optimize "Full"
 
+-- Bullet --------------------------------------------------------------------------------------------------
+-- Built from source, the multithreaded world only runs in parallel when Bullet is compiled with BT_THREADSAFE
+project (BULLET_NAME)
+	location (BULLET_DIR)
+	objdir (INTERMEDIATE_DIR)
+	kind "StaticLib"
+	staticruntime "On"
+	warnings "Off"
+	
+	-- Files
+	files 
+	{ 
+		BULLET_DIR .. "/BulletCollision/**.h",
+		BULLET_DIR .. "/BulletCollision/**.cpp",
+		BULLET_DIR .. "/BulletDynamics/**.h",
+		BULLET_DIR .. "/BulletDynamics/**.cpp",
+		BULLET_DIR .. "/LinearMath/**.h",
+		BULLET_DIR .. "/LinearMath/**.cpp"
+	}
+	
+	-- Includes
+	includedirs { BULLET_DIR }
+	
+	-- 	"Debug"
+	filter "configurations:Debug"
+		targetdir (TARGET_DIR_DEBUG)
+		debugformat (DEBUG_FORMAT)
+		
+	-- 	"Release"
+	filter "configurations:Release"
+		targetdir (TARGET_DIR_RELEASE)
+
 -- Runtime -------------------------------------------------------------------------------------------------
 project (RUNTIME_NAME)
 	location (RUNTIME_DIR)
+	links { BULLET_NAME }
+	dependson { BULLET_NAME }
 	objdir (INTERMEDIATE_DIR)
 	kind "StaticLib"
 	staticruntime "On"
@@ -84,7 +121,7 @@ project (RUNTIME_NAME)
 	includedirs { "../ThirdParty/Vulkan_1.1.121.0" }
 	includedirs { "../ThirdParty/AngelScript_2.33.0" }
 	includedirs { "../ThirdParty/Assimp_5.0.0" }
-	includedirs { "../ThirdParty/Bullet_2.88" }
+	includedirs { BULLET_DIR }
 	includedirs { "../ThirdParty/FMOD_1.10.10" }
 	includedirs { "../ThirdParty/FreeImage_3.18.0" }
 	includedirs { "../ThirdParty/FreeType_2.10.0" }
@@ -104,7 +141,6 @@ project (RUNTIME_NAME)
 		links { "fmodL64_vc" }
 		links { "FreeImageLib_debug" }
 		links { "freetype_debug" }
-		links { "BulletCollision_debug", "BulletDynamics_debug", "BulletSoftBody_debug", "LinearMath_debug" }
 		links { "pugixml_debug" }
 		links { "IrrXML_debug" }
 			
@@ -118,7 +154,6 @@ project (RUNTIME_NAME)
 		links { "fmod64_vc" }
 		links { "FreeImageLib" }
 		links { "freetype" }
-		links { "BulletCollision", "BulletDynamics", "BulletSoftBody", "LinearMath" }
 		links { "pugixml" }
 		links { "IrrXML" }
 